@@ -7,12 +7,17 @@
 #include "../src/lib/localeHandling.h"
 #include "mlt++/Mlt.h"
 #include "renderjob.h"
+#include "renderprofiler.h"
+#include "rendersegments.h"
+#include "renderworker.h"
 #include <../config-kdenlive.h>
 #include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
 #include <QDomDocument>
+#include <QJsonDocument>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QtGlobal>
 
@@ -27,7 +32,7 @@ int main(int argc, char **argv)
     parser.addHelpOption();
     parser.addVersionOption();
 
-    parser.addPositionalArgument("mode", "Render mode. Either \"delivery\" or \"preview-chunks\".");
+    parser.addPositionalArgument("mode", "Render mode. Either \"delivery\", \"preview-chunks\", \"profile\" or \"worker\".");
     parser.parse(QCoreApplication::arguments());
     QStringList args = parser.positionalArguments();
     const QString mode = args.isEmpty() ? QString() : args.first();
@@ -143,6 +148,115 @@ int main(int argc, char **argv)
         return 0;
     }
 
+    if (mode == "profile") {
+        parser.clearPositionalArguments();
+        parser.addPositionalArgument("profile", "Mode: Measure the render time of each track, clip, effect and composition of a timeline.");
+        parser.addPositionalArgument("source", "Source file (usually MLT XML).");
+        parser.addPositionalArgument("report", "Destination of the JSON report.");
+
+        QCommandLineOption profileOption("mlt-profile", "Path to the MLT profile, the profile of the source is used if not set.", "path");
+        parser.addOption(profileOption);
+
+        QCommandLineOption inOption("in", "First frame to measure, the in point of the consumer of the source by default.", "frame", QString::number(-1));
+        parser.addOption(inOption);
+
+        QCommandLineOption outOption("out", "Last frame to measure, the out point of the consumer of the source by default.", "frame", QString::number(-1));
+        parser.addOption(outOption);
+
+        QCommandLineOption samplesOption("samples", "Number of frames rendered to measure the timeline.", "count", QString::number(100));
+        parser.addOption(samplesOption);
+
+        parser.process(app);
+        args = parser.positionalArguments();
+        if (args.count() != 3) {
+            qCritical() << "Error: wrong number of arguments specified\n";
+            parser.showHelp(1);
+            // the command above will quit the app with return 1;
+        }
+        Mlt::Factory::init();
+        LocaleHandling::resetAllLocale();
+
+        const QString playlist = args.at(1);
+        const QString report = args.at(2);
+        std::unique_ptr<Mlt::Profile> profile;
+        if (parser.isSet(profileOption)) {
+            profile.reset(new Mlt::Profile(parser.value(profileOption).toUtf8().constData()));
+            profile->set_explicit(1);
+        } else {
+            profile.reset(new Mlt::Profile());
+        }
+        Mlt::Producer prod(*profile.get(), nullptr, playlist.toUtf8().constData());
+        if (!prod.is_valid()) {
+            fprintf(stderr, "INVALID playlist: %s \n", playlist.toUtf8().constData());
+            return 1;
+        }
+        QLocale::setDefault(QLocale(prod.get_lcnumeric()));
+
+        int in = parser.value(inOption).toInt();
+        int out = parser.value(outOption).toInt();
+        QFile f(playlist);
+        QDomDocument doc;
+        if ((in < 0 || out < 0) && f.open(QIODevice::ReadOnly) && doc.setContent(&f, false)) {
+            QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+            if (in < 0) {
+                in = consumer.attribute(QStringLiteral("in"), QString::number(0)).toInt();
+            }
+            if (out < 0) {
+                out = consumer.attribute(QStringLiteral("out"), QString::number(prod.get_playtime() - 1)).toInt();
+            }
+        }
+        f.close();
+        in = qMax(0, in);
+        if (out < 0) {
+            out = prod.get_playtime() - 1;
+        }
+
+        RenderProfiler profiler(*profile.get(), prod);
+        const QJsonObject result = profiler.run(in, out, parser.value(samplesOption).toInt());
+        if (result.isEmpty()) {
+            fprintf(stderr, "Not a Kdenlive timeline: %s \n", playlist.toUtf8().constData());
+            return 1;
+        }
+        QFile file(report);
+        if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(result).toJson()) < 0) {
+            fprintf(stderr, "Cannot write to %s \n", report.toUtf8().constData());
+            return 1;
+        }
+        file.close();
+        return 0;
+    }
+
+    if (mode == "worker") {
+        parser.clearPositionalArguments();
+        parser.addPositionalArgument("worker", "Mode: Run the render tasks sent by Kdenlive.");
+        parser.addPositionalArgument("server", "Name of the Kdenlive render server.");
+        parser.addPositionalArgument("renderer", "Path to MLT melt renderer.");
+
+        QCommandLineOption idOption("id", "Id of the worker, given by the server.", "id", QString::number(-1));
+        parser.addOption(idOption);
+
+        QCommandLineOption ffmpegOption("ffmpeg", "Path to ffmpeg, used to copy the unmodified clips of a smart render.", "path");
+        parser.addOption(ffmpegOption);
+
+        QCommandLineOption cpusOption("cpus", "Run the worker on these processor cores, for example \"0-3,8\".", "list");
+        parser.addOption(cpusOption);
+
+        parser.process(app);
+        args = parser.positionalArguments();
+        if (args.count() != 3) {
+            qCritical() << "Error: wrong number of arguments specified\n";
+            parser.showHelp(1);
+            // the command above will quit the app with return 1;
+        }
+        if (parser.isSet(cpusOption) && !RenderWorker::setAffinity(parser.value(cpusOption))) {
+            qWarning() << "Cannot run the worker on cores" << parser.value(cpusOption);
+        }
+        auto *worker = new RenderWorker(args.at(1), parser.value(idOption).toInt(), args.at(2), parser.value(ffmpegOption), &app);
+        QObject::connect(worker, &RenderWorker::finished, &app, &QCoreApplication::quit);
+        QMetaObject::invokeMethod(worker, "start", Qt::QueuedConnection);
+        return app.exec();
+    }
+
     if (mode == "delivery") {
         parser.clearPositionalArguments();
         parser.addPositionalArgument("delivery", "Mode: Render to a final output file.");
@@ -161,6 +275,35 @@ int main(int argc, char **argv)
         QCommandLineOption subtitleOption("subtitle", "Subtitle file.", "file");
         parser.addOption(subtitleOption);
 
+        QCommandLineOption segmentsOption("segments",
+                                          "Split the render in this number of segments encoded in parallel, then joined without re-encoding. Falls back to "
+                                          "a single render if the output format does not allow it.",
+                                          "count", QString::number(1));
+        parser.addOption(segmentsOption);
+
+        QCommandLineOption brokerOption("broker",
+                                        "Name of the Kdenlive render server distributing the segments to its workers. The segments are rendered by "
+                                        "this job if the server is not available.",
+                                        "server");
+        parser.addOption(brokerOption);
+
+        QCommandLineOption smartOption("smart",
+                                       "Copy the parts of the timeline showing an unmodified clip already encoded in the output codec from their file, "
+                                       "only encode the rest of the timeline. Only for MPEG-TS and Matroska outputs.");
+        parser.addOption(smartOption);
+
+        QCommandLineOption intermediateOption("intermediate",
+                                              "Scene list rendered before the source, which encodes its output. Its output is removed if the render "
+                                              "fails.",
+                                              "file");
+        parser.addOption(intermediateOption);
+
+        QCommandLineOption removeIntermediateOption("remove-intermediate",
+                                                    "Output of an intermediate scene list rendered by another job and encoded by the source, removed "
+                                                    "when the render ends.",
+                                                    "file");
+        parser.addOption(removeIntermediateOption);
+
         parser.process(app);
         args = parser.positionalArguments();
 
@@ -232,6 +375,36 @@ int main(int argc, char **argv)
         QString subtitleFile = parser.value(subtitleOption);
 
         auto *rJob = new RenderJob(render, playlist, target, pid, in, out, subtitleFile, &app);
+        int segmentCount = qMax(1, parser.value(segmentsOption).toInt());
+        bool smart = parser.isSet(smartOption);
+        if ((segmentCount > 1 || smart) && !target.isEmpty()) {
+            // Keep the segments next to the destination, they take as much space as the final file
+            QTemporaryDir folder(QFileInfo(target).absoluteDir().absoluteFilePath(QStringLiteral(".kdenlive-segments-XXXXXX")));
+            folder.setAutoRemove(false);
+            if (folder.isValid()) {
+                const QVector<RenderSegment> segments = RenderSegments::prepare(doc, playlist, segmentCount, folder.path(), smart);
+                if (segments.isEmpty()) {
+                    folder.remove();
+                } else {
+                    rJob->setSegments(segments, folder.path(), segmentCount);
+                    rJob->setBroker(parser.value(brokerOption));
+                }
+            }
+        }
+        if (parser.isSet(intermediateOption)) {
+            QFile intermediateFile(parser.value(intermediateOption));
+            QDomDocument intermediate;
+            if (!intermediateFile.open(QIODevice::ReadOnly) || !intermediate.setContent(&intermediateFile, false)) {
+                qWarning() << "Failed to read the intermediate scene list" << intermediateFile.fileName();
+                return 1;
+            }
+            intermediateFile.close();
+            QDomElement intermediateConsumer = intermediate.documentElement().firstChildElement(QStringLiteral("consumer"));
+            rJob->setIntermediate(intermediateFile.fileName(), intermediateConsumer.attribute(QStringLiteral("target")),
+                                  intermediateConsumer.attribute(QStringLiteral("in"), QString::number(0)).toInt());
+        } else if (parser.isSet(removeIntermediateOption)) {
+            rJob->setIntermediateFile(parser.value(removeIntermediateOption));
+        }
         QObject::connect(rJob, &RenderJob::renderingFinished, rJob, [&]() {
             rJob->deleteLater();
             app.quit();
@@ -10,14 +10,15 @@
 #include <QThread>
 #ifndef NODBUS
 #include <QtDBus>
-#else
+#endif
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#endif
 #include <QDebug>
 #include <QDir>
 #include <QElapsedTimer>
 #include <QStandardPaths>
+#include <QTimer>
 #include <utility>
 // Can't believe I need to do this to sleep.
 class SleepThread : QThread
@@ -49,6 +50,12 @@ RenderJob::RenderJob(const QString &render, const QString &scenelist, const QStr
     , m_pid(pid)
     , m_dualpass(false)
     , m_subtitleFile(subtitleFile)
+    , m_maxSegmentProcesses(1)
+    , m_nextSegment(0)
+    , m_finishedSegments(0)
+    , m_brokerSocket(nullptr)
+    , m_intermediateIn(0)
+    , m_renderingIntermediate(false)
 {
     m_renderProcess = new QProcess(&m_looper);
     m_renderProcess->setReadChannel(QProcess::StandardError);
@@ -119,11 +126,15 @@ void RenderJob::sendFinish(int status, const QString &error)
 void RenderJob::slotAbort()
 {
     m_renderProcess->kill();
+    stopSegments();
     sendFinish(-3, QString());
     if (m_erase) {
         QFile(m_scenelist).remove();
     }
     QFile(m_dest).remove();
+    if (!m_intermediateFile.isEmpty()) {
+        QFile(m_intermediateFile).remove();
+    }
     m_logstream << "Job aborted by user"
                 << "\n";
     m_logstream.flush();
@@ -142,6 +153,10 @@ void RenderJob::receivedStderr()
     } else {
         int progress = result.section(QLatin1Char(' '), -1).toInt();
         int frame = result.section(QLatin1Char(','), 0, 0).section(QLatin1Char(' '), -1).toInt();
+        if (!m_intermediateScenelist.isEmpty() && progress > 0 && progress <= 100) {
+            // The intermediate render and its encoding share the progress
+            progress = m_renderingIntermediate ? progress / 2 : 50 + progress / 2;
+        }
         if (progress <= m_progress || progress <= 0 || progress > 100) {
             return;
         }
@@ -271,11 +286,23 @@ void RenderJob::start()
     }
 #endif
 
-    // Because of the logging, we connect to stderr in all cases.
-    connect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
-    m_renderProcess->start(m_prog, m_args);
-    m_logstream << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' ')) << "\n";
-    m_logstream.flush();
+    if (!m_segments.isEmpty()) {
+        startSegments();
+    } else {
+        // Because of the logging, we connect to stderr in all cases.
+        connect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
+        if (!m_intermediateScenelist.isEmpty()) {
+            m_renderingIntermediate = true;
+            m_frame = m_intermediateIn;
+            const QStringList args = {QStringLiteral("-progress"), m_intermediateScenelist};
+            m_renderProcess->start(m_prog, args);
+            m_logstream << "Started intermediate render process: " << m_prog << ' ' << args.join(QLatin1Char(' ')) << "\n";
+        } else {
+            m_renderProcess->start(m_prog, m_args);
+            m_logstream << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' ')) << "\n";
+        }
+        m_logstream.flush();
+    }
     m_looper.exec();
 }
 
@@ -327,11 +354,32 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
         Q_EMIT renderingFinished();
         // qApp->quit();
     }
+    bool crashed = status == QProcess::CrashExit || m_renderProcess->error() != QProcess::UnknownError || m_renderProcess->exitCode() != 0;
+    if (m_renderingIntermediate) {
+        m_renderingIntermediate = false;
+        if (m_erase) {
+            QFile(m_intermediateScenelist).remove();
+        }
+        if (!crashed && isWritable) {
+            m_logstream << "Rendered intermediate file " << m_intermediateFile << "\n";
+            m_frame = m_framein;
+            // Start the encoding once the finished process emitted all its signals
+            QTimer::singleShot(0, this, [this]() {
+                m_renderProcess->start(m_prog, m_args);
+                m_logstream << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' ')) << "\n";
+                m_logstream.flush();
+            });
+            return;
+        }
+    }
     if (m_erase) {
         QFile(m_scenelist).remove();
     }
-    if (status == QProcess::CrashExit || m_renderProcess->error() != QProcess::UnknownError || m_renderProcess->exitCode() != 0) {
+    if (crashed) {
         // rendering crashed
+        if (!m_intermediateFile.isEmpty()) {
+            QFile(m_intermediateFile).remove();
+        }
         sendFinish(-2, m_errorMessage);
         QStringList args;
         QString error = tr("Rendering of %1 aborted, resulting video will probably be corrupted.").arg(m_dest);
@@ -346,31 +394,16 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
         m_logstream << "Rendering of " << m_dest << " finished"
                     << "\n";
         m_logstream.flush();
+        if (!m_intermediateFile.isEmpty() && m_intermediateScenelist.isEmpty()) {
+            // Last job encoding the intermediate file
+            QFile(m_intermediateFile).remove();
+        }
         if (m_dualpass) {
             deleteLater();
         } else {
             m_logfile.remove();
-            if (!m_subtitleFile.isEmpty()) {
-                // Embed subtitles
-                QString ffmpegExe = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
-                if (!ffmpegExe.isEmpty()) {
-                    QFileInfo videoRender(m_dest);
-                    m_temporaryRenderFile = QDir::temp().absoluteFilePath(videoRender.fileName());
-                    QStringList args = {
-                        "-y", "-v", "quiet", "-stats", "-i", m_dest, "-i", m_subtitleFile, "-c", "copy", "-f", "matroska", m_temporaryRenderFile};
-                    qDebug() << "::: JOB ARGS: " << args;
-                    m_progress = 0;
-                    disconnect(m_renderProcess, &QProcess::stateChanged, this, &RenderJob::slotCheckProcess);
-                    disconnect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
-                    m_subsProcess = new QProcess(&m_looper);
-                    m_subsProcess->setProcessChannelMode(QProcess::MergedChannels);
-                    connect(m_subsProcess, &QProcess::readyReadStandardOutput, this, &RenderJob::receivedSubtitleProgress);
-                    m_subsProcess->start(ffmpegExe, args);
-                    m_subsProcess->waitForStarted(-1);
-                    m_subsProcess->waitForFinished(-1);
-                    slotCheckSubtitleProcess(m_subsProcess->exitCode(), m_subsProcess->exitStatus());
-                    return;
-                }
+            if (!m_subtitleFile.isEmpty() && embedSubtitles()) {
+                return;
             }
             sendFinish(-1, QString());
         }
@@ -379,6 +412,29 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
     m_looper.quit();
 }
 
+bool RenderJob::embedSubtitles()
+{
+    QString ffmpegExe = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
+    if (ffmpegExe.isEmpty()) {
+        return false;
+    }
+    QFileInfo videoRender(m_dest);
+    m_temporaryRenderFile = QDir::temp().absoluteFilePath(videoRender.fileName());
+    QStringList args = {"-y", "-v", "quiet", "-stats", "-i", m_dest, "-i", m_subtitleFile, "-c", "copy", "-f", "matroska", m_temporaryRenderFile};
+    qDebug() << "::: JOB ARGS: " << args;
+    m_progress = 0;
+    disconnect(m_renderProcess, &QProcess::stateChanged, this, &RenderJob::slotCheckProcess);
+    disconnect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
+    m_subsProcess = new QProcess(&m_looper);
+    m_subsProcess->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_subsProcess, &QProcess::readyReadStandardOutput, this, &RenderJob::receivedSubtitleProgress);
+    m_subsProcess->start(ffmpegExe, args);
+    m_subsProcess->waitForStarted(-1);
+    m_subsProcess->waitForFinished(-1);
+    slotCheckSubtitleProcess(m_subsProcess->exitCode(), m_subsProcess->exitStatus());
+    return true;
+}
+
 void RenderJob::receivedSubtitleProgress()
 {
     QString outputData = QString::fromLocal8Bit(m_subsProcess->readAllStandardOutput()).simplified();
@@ -430,3 +486,300 @@ void RenderJob::slotCheckSubtitleProcess(int exitCode, QProcess::ExitStatus exit
     Q_EMIT renderingFinished();
     m_looper.quit();
 }
+
+void RenderJob::setSegments(const QVector<RenderSegment> &segments, const QString &folder, int processes)
+{
+    m_segments = segments;
+    m_segmentFolder = folder;
+    m_maxSegmentProcesses = qMax(1, processes);
+}
+
+void RenderJob::setBroker(const QString &server)
+{
+    m_brokerName = server;
+}
+
+void RenderJob::setIntermediate(const QString &scenelist, const QString &file, int in)
+{
+    m_intermediateScenelist = scenelist;
+    m_intermediateFile = file;
+    m_intermediateIn = in;
+}
+
+void RenderJob::setIntermediateFile(const QString &file)
+{
+    m_intermediateFile = file;
+}
+
+void RenderJob::startSegments()
+{
+    m_segmentFrames.fill(0, m_segments.count());
+    m_segmentProcesses.fill(nullptr, m_segments.count());
+    m_nextSegment = 0;
+    m_finishedSegments = 0;
+    if (!m_brokerName.isEmpty() && submitSegments()) {
+        return;
+    }
+    // The audio pass comes first, it is not counted in the process limit so that it runs alongside the video segments
+    int videoSegments = 0;
+    while (m_nextSegment < m_segments.count() && (m_segments.at(m_nextSegment).audio || videoSegments < m_maxSegmentProcesses)) {
+        if (!m_segments.at(m_nextSegment).audio) {
+            ++videoSegments;
+        }
+        startSegment(m_nextSegment++);
+    }
+}
+
+void RenderJob::startSegment(int index)
+{
+    auto *process = new QProcess(&m_looper);
+    process->setReadChannel(QProcess::StandardError);
+    connect(process, &QProcess::readyReadStandardError, this, [this, index]() { receivedSegmentStderr(index); });
+    connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+            [this, index](int exitCode, QProcess::ExitStatus status) { segmentFinished(index, exitCode, status); });
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            segmentsFailed(tr("Cannot start %1.").arg(process->program()));
+        }
+    });
+    m_segmentProcesses[index] = process;
+    const RenderSegment &segment = m_segments.at(index);
+    // Unmodified clips of a smart render are copied from their file by ffmpeg
+    const QString program = segment.copyArguments.isEmpty() ? m_prog : QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
+    const QStringList args = segment.copyArguments.isEmpty() ? QStringList{QStringLiteral("-progress"), segment.scenelist} : segment.copyArguments;
+    process->start(program, args);
+    m_logstream << "Started segment process: " << program << ' ' << args.join(QLatin1Char(' ')) << "\n";
+    m_logstream.flush();
+}
+
+void RenderJob::receivedSegmentStderr(int index)
+{
+    QString result = QString::fromLocal8Bit(m_segmentProcesses.at(index)->readAllStandardError()).simplified();
+    int progressIndex = result.lastIndexOf(QLatin1String("Current Frame"));
+    if (progressIndex < 0) {
+        m_errorMessage.append(result + QStringLiteral("<br>"));
+        m_logstream << result;
+        return;
+    }
+    segmentProgress(index, result.mid(progressIndex).section(QLatin1Char(' '), -1).toInt());
+}
+
+void RenderJob::segmentProgress(int index, int progress)
+{
+    const RenderSegment &segment = m_segments.at(index);
+    if (segment.audio) {
+        // The audio pass is much faster than the video, it is not part of the progress
+        return;
+    }
+    progress = qBound(0, progress, 100);
+    m_segmentFrames[index] = (segment.out - segment.in + 1) * progress / 100;
+    int done = 0;
+    int total = 0;
+    for (int i = 0; i < m_segments.count(); ++i) {
+        if (!m_segments.at(i).audio) {
+            done += m_segmentFrames.at(i);
+            total += m_segments.at(i).out - m_segments.at(i).in + 1;
+        }
+    }
+    // Keep the last percent for the join
+    progress = qMin(99, int(100 * qint64(done) / qMax(1, total)));
+    if (progress <= m_progress) {
+        return;
+    }
+    m_progress = progress;
+    qint64 elapsedTime = m_startTime.secsTo(QDateTime::currentDateTime());
+    if (elapsedTime == m_seconds) {
+        return;
+    }
+    int frame = m_framein + done;
+    int speed = (frame - m_frame) / (elapsedTime - m_seconds);
+    m_seconds = elapsedTime;
+    m_frame = frame;
+    updateProgress(speed);
+}
+
+void RenderJob::segmentFinished(int index, int exitCode, QProcess::ExitStatus status)
+{
+    if (status == QProcess::CrashExit || exitCode != 0) {
+        segmentsFailed(tr("Rendering of segment %1 failed.").arg(m_segments.at(index).target));
+        return;
+    }
+    m_logstream << "Rendering of segment " << m_segments.at(index).target << " finished"
+                << "\n";
+    m_logstream.flush();
+    if (!m_segments.at(index).audio) {
+        m_segmentFrames[index] = m_segments.at(index).out - m_segments.at(index).in + 1;
+        // Only a finished video segment frees a process slot
+        if (m_nextSegment < m_segments.count()) {
+            startSegment(m_nextSegment++);
+        }
+    }
+    if (++m_finishedSegments < m_segments.count()) {
+        return;
+    }
+    joinSegments();
+}
+
+bool RenderJob::submitSegments()
+{
+    m_brokerSocket = new QLocalSocket(this);
+    m_brokerSocket->connectToServer(m_brokerName);
+    if (!m_brokerSocket->waitForConnected(3000)) {
+        m_logstream << "Cannot connect to the render workers of " << m_brokerName << ", rendering the segments in this job"
+                    << "\n";
+        m_logstream.flush();
+        delete m_brokerSocket;
+        m_brokerSocket = nullptr;
+        return false;
+    }
+    connect(m_brokerSocket, &QLocalSocket::readyRead, this, &RenderJob::receivedBrokerMessage);
+    connect(m_brokerSocket, &QLocalSocket::disconnected, this, [this]() { segmentsFailed(tr("Lost the connection to the render workers.")); });
+    for (int index = 0; index < m_segments.count(); ++index) {
+        const RenderSegment &segment = m_segments.at(index);
+        QJsonObject args;
+        // All segments of the job are in the same queue of the server
+        args["queue"] = m_dest;
+        args["id"] = index;
+        if (segment.copyArguments.isEmpty()) {
+            args["program"] = QStringLiteral("melt");
+            args["arguments"] = QJsonArray::fromStringList({QStringLiteral("-progress"), segment.scenelist});
+        } else {
+            args["program"] = QStringLiteral("ffmpeg");
+            args["arguments"] = QJsonArray::fromStringList(segment.copyArguments);
+        }
+        QJsonObject method;
+        method["submitTask"] = args;
+        m_brokerSocket->write(QJsonDocument(method).toJson());
+        m_logstream << "Submitted segment " << segment.target << " to the render workers"
+                    << "\n";
+    }
+    m_brokerSocket->flush();
+    m_logstream.flush();
+    m_nextSegment = m_segments.count();
+    return true;
+}
+
+void RenderJob::receivedBrokerMessage()
+{
+    while (m_brokerSocket && m_brokerSocket->canReadLine()) {
+        const QString line = QString::fromUtf8(m_brokerSocket->readLine()).chopped(1);
+        m_brokerBlock.append(line);
+        if (line != QLatin1String("}")) {
+            continue;
+        }
+        const QJsonObject json = QJsonDocument::fromJson(m_brokerBlock.toUtf8()).object();
+        m_brokerBlock.clear();
+        if (json.contains("taskProgress")) {
+            const int index = json["taskProgress"]["id"].toInt(-1);
+            if (index >= 0 && index < m_segments.count()) {
+                segmentProgress(index, json["taskProgress"]["progress"].toInt());
+            }
+        } else if (json.contains("taskFinished")) {
+            const int index = json["taskFinished"]["id"].toInt(-1);
+            if (index < 0 || index >= m_segments.count()) {
+                continue;
+            }
+            // The server already retried a failed segment
+            const int status = json["taskFinished"]["status"].toInt();
+            if (status != 0) {
+                m_errorMessage.append(json["taskFinished"]["error"].toString() + QStringLiteral("<br>"));
+            }
+            segmentFinished(index, status, QProcess::NormalExit);
+        }
+    }
+}
+
+void RenderJob::joinSegments()
+{
+    QString ffmpegExe = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
+    QFile list(QDir(m_segmentFolder).absoluteFilePath(QStringLiteral("segments.ffconcat")));
+    if (ffmpegExe.isEmpty() || !list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        segmentsFailed(tr("Cannot join the segments of %1.").arg(m_dest));
+        return;
+    }
+    QString audioTarget;
+    QTextStream listStream(&list);
+    listStream << "ffconcat version 1.0\n";
+    for (const RenderSegment &segment : qAsConst(m_segments)) {
+        if (segment.audio) {
+            audioTarget = segment.target;
+        } else {
+            // Paths are relative to the list file
+            listStream << "file '" << QFileInfo(segment.target).fileName() << "'\n";
+        }
+    }
+    listStream.flush();
+    list.close();
+    QStringList args = {QStringLiteral("-y"), QStringLiteral("-v"), QStringLiteral("error"), QStringLiteral("-f"), QStringLiteral("concat"),
+                        QStringLiteral("-i"), list.fileName()};
+    if (!audioTarget.isEmpty()) {
+        args << QStringLiteral("-i") << audioTarget << QStringLiteral("-map") << QStringLiteral("0:v") << QStringLiteral("-map") << QStringLiteral("1:a");
+    }
+    args << QStringLiteral("-c") << QStringLiteral("copy") << m_dest;
+    m_logstream << "Joining segments: " << ffmpegExe << ' ' << args.join(QLatin1Char(' ')) << "\n";
+    m_logstream.flush();
+    QProcess join;
+    join.setProcessChannelMode(QProcess::MergedChannels);
+    join.start(ffmpegExe, args);
+    join.waitForStarted(-1);
+    join.waitForFinished(-1);
+    if (join.exitStatus() == QProcess::CrashExit || join.exitCode() != 0 || !QFile::exists(m_dest)) {
+        m_errorMessage.append(QString::fromLocal8Bit(join.readAll()) + QStringLiteral("<br>"));
+        segmentsFailed(tr("Cannot join the segments of %1.").arg(m_dest));
+        return;
+    }
+    stopSegments();
+    if (m_erase) {
+        QFile(m_scenelist).remove();
+    }
+    m_logstream << "Rendering of " << m_dest << " finished"
+                << "\n";
+    m_logstream.flush();
+    m_logfile.remove();
+    if (!m_subtitleFile.isEmpty() && embedSubtitles()) {
+        return;
+    }
+    sendFinish(-1, QString());
+    Q_EMIT renderingFinished();
+    m_looper.quit();
+}
+
+void RenderJob::segmentsFailed(const QString &error)
+{
+    stopSegments();
+    if (m_erase) {
+        QFile(m_scenelist).remove();
+    }
+    sendFinish(-2, m_errorMessage + error);
+    m_logstream << error << "\n";
+    m_logstream.flush();
+    QProcess::startDetached(QStringLiteral("kdialog"), {QStringLiteral("--error"), error});
+    Q_EMIT renderingFinished();
+    m_looper.quit();
+}
+
+void RenderJob::stopSegments()
+{
+    if (m_brokerSocket) {
+        // The server aborts the segments of a job that disconnects
+        m_brokerSocket->disconnect(this);
+        m_brokerSocket->abort();
+        m_brokerSocket->deleteLater();
+        m_brokerSocket = nullptr;
+    }
+    for (QProcess *process : qAsConst(m_segmentProcesses)) {
+        if (process == nullptr) {
+            continue;
+        }
+        // Do not handle the end of the other processes as a failure
+        process->disconnect(this);
+        if (process->state() != QProcess::NotRunning) {
+            process->kill();
+            process->waitForFinished();
+        }
+    }
+    if (!m_segmentFolder.isEmpty()) {
+        QDir(m_segmentFolder).removeRecursively();
+        m_segmentFolder.clear();
+    }
+}
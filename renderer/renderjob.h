@@ -6,19 +6,21 @@
 
 #pragma once
 
-#ifdef NODBUS
-#include <QLocalSocket>
-#else
+#ifndef NODBUS
 #include <QDBusInterface>
 #endif
+#include <QLocalSocket>
 #include <QDateTime>
 #include <QEventLoop>
 #include <QFile>
 #include <QObject>
 #include <QProcess>
+#include <QVector>
 // Testing
 #include <QTextStream>
 
+#include "rendersegments.h"
+
 class RenderJob : public QObject
 {
     Q_OBJECT
@@ -27,6 +29,19 @@ public:
     RenderJob(const QString &render, const QString &scenelist, const QString &target, int pid = -1, int in = -1, int out = -1,
               const QString &subtitleFile = QString(), QObject *parent = nullptr);
     ~RenderJob() override;
+    /** @brief Render @p segments concurrently instead of the whole scene list, then join them in the destination.
+     *  @param folder the folder containing the segments, removed when the job ends
+     *  @param processes the maximum number of video segments rendered at the same time, the audio pass is not counted */
+    void setSegments(const QVector<RenderSegment> &segments, const QString &folder, int processes);
+    /** @brief Submit the segments to the workers of the Kdenlive render server @p server instead of starting them,
+     *  the segments are rendered by this job if the server is not available */
+    void setBroker(const QString &server);
+    /** @brief Render @p scenelist to the intermediate @p file before the source scene list, which encodes it.
+     *  @param in the first frame of @p scenelist
+     *  The file is kept for another job if the render succeeds, and removed if it fails */
+    void setIntermediate(const QString &scenelist, const QString &file, int in);
+    /** @brief The source scene list encodes @p file, rendered by another job. It is removed when this job ends */
+    void setIntermediateFile(const QString &file);
 
 public Q_SLOTS:
     void start();
@@ -72,6 +87,25 @@ private:
     QStringList m_args;
     /** @brief Used to write to the log file. */
     QTextStream m_logstream;
+    QVector<RenderSegment> m_segments;
+    /** @brief The process of each segment, nullptr until it is started */
+    QVector<QProcess *> m_segmentProcesses;
+    int m_maxSegmentProcesses;
+    int m_nextSegment;
+    /** @brief Number of frames rendered by each segment process */
+    QVector<int> m_segmentFrames;
+    int m_finishedSegments;
+    QString m_segmentFolder;
+    QString m_brokerName;
+    /** @brief The connection to the render server running the segments, nullptr if they run in this job */
+    QLocalSocket *m_brokerSocket;
+    /** @brief The incomplete message received from the render server */
+    QString m_brokerBlock;
+    /** @brief The scene list rendered to m_intermediateFile before the source, empty if another job renders it */
+    QString m_intermediateScenelist;
+    QString m_intermediateFile;
+    int m_intermediateIn;
+    bool m_renderingIntermediate;
 #ifdef NODBUS
     void fromServer();
 #else
@@ -80,6 +114,21 @@ private:
     void sendFinish(int status, const QString &error);
     void updateProgress(int speed = -1);
     void sendProgress();
+    /** @brief Embed the subtitle file in the rendered file, returns false if ffmpeg is not available */
+    bool embedSubtitles();
+    void startSegments();
+    void startSegment(int index);
+    void receivedSegmentStderr(int index);
+    /** @brief Update the render progress with the @p progress percent of segment @p index */
+    void segmentProgress(int index, int progress);
+    /** @brief Submit all segments to the render server, returns false if it is not available */
+    bool submitSegments();
+    void receivedBrokerMessage();
+    void segmentFinished(int index, int exitCode, QProcess::ExitStatus status);
+    /** @brief Join the video segments and the audio pass in the destination without re-encoding */
+    void joinSegments();
+    void segmentsFailed(const QString &error);
+    void stopSegments();
 
 Q_SIGNALS:
     void renderingFinished();
@@ -0,0 +1,238 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "renderprofiler.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+
+#include <algorithm>
+#include <iterator>
+
+RenderProfiler::RenderProfiler(Mlt::Profile &profile, Mlt::Producer &producer)
+    : m_profile(profile)
+    , m_producer(producer)
+{
+}
+
+std::shared_ptr<Mlt::Tractor> RenderProfiler::findTimeline(Mlt::Service &service, int depth)
+{
+    if (service.type() != mlt_service_tractor_type || depth > 3) {
+        return nullptr;
+    }
+    auto tractor = std::make_shared<Mlt::Tractor>(service);
+    for (int i = 0; i < tractor->count(); i++) {
+        std::unique_ptr<Mlt::Producer> track(tractor->track(i));
+        if (track && track->property_exists("kdenlive:trackheight")) {
+            return tractor;
+        }
+    }
+    // The sequence of a project render is wrapped in another tractor
+    for (int i = 0; i < tractor->count(); i++) {
+        std::unique_ptr<Mlt::Producer> track(tractor->track(i));
+        if (track && track->type() == mlt_service_tractor_type) {
+            auto timeline = findTimeline(*track, depth + 1);
+            if (timeline) {
+                return timeline;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void RenderProfiler::collectFilters(Mlt::Service &service, QJsonObject info, int in, int out)
+{
+    int index = 0;
+    for (int i = 0; i < service.filter_count(); i++) {
+        auto filter = std::shared_ptr<Mlt::Service>(service.filter(i));
+        // Only the effects of the user, not the filters added by Kdenlive or MLT
+        if (!filter || !filter->property_exists("kdenlive_id") || filter->get_int("_loader") == 1) {
+            continue;
+        }
+        info[QStringLiteral("type")] = QStringLiteral("effect");
+        info[QStringLiteral("index")] = index++;
+        info[QStringLiteral("id")] = QString::fromUtf8(filter->get("kdenlive_id"));
+        m_items.append({info, in, out, filter, "disable", 1, -1});
+    }
+}
+
+void RenderProfiler::collect(Mlt::Tractor &timeline, int in, int out)
+{
+    collectFilters(timeline, {{QStringLiteral("owner"), QStringLiteral("master")}}, in, out);
+    for (int i = 0; i < timeline.count(); i++) {
+        auto track = std::shared_ptr<Mlt::Producer>(timeline.track(i));
+        if (!track || !track->property_exists("kdenlive:trackheight")) {
+            // Black background or timeline preview
+            continue;
+        }
+        const int trackItem = m_items.count();
+        m_items.append({{{QStringLiteral("type"), QStringLiteral("track")}, {QStringLiteral("track"), i}}, in, out, track, "hide", 3, -1});
+        collectFilters(*track, {{QStringLiteral("owner"), QStringLiteral("track")}, {QStringLiteral("track"), i}}, in, out);
+        QVector<std::shared_ptr<Mlt::Producer>> playlists;
+        if (track->type() == mlt_service_tractor_type) {
+            Mlt::Tractor trackTractor(*track);
+            for (int j = 0; j < trackTractor.count(); j++) {
+                playlists << std::shared_ptr<Mlt::Producer>(trackTractor.track(j));
+            }
+        } else {
+            playlists << track;
+        }
+        for (int j = 0; j < playlists.count(); j++) {
+            if (!playlists.at(j) || playlists.at(j)->type() != mlt_service_playlist_type) {
+                continue;
+            }
+            Mlt::Playlist playlist(*playlists.at(j));
+            for (int k = 0; k < playlist.count(); k++) {
+                if (playlist.is_blank(k)) {
+                    continue;
+                }
+                const int start = playlist.clip_start(k);
+                const int end = start + playlist.clip_length(k) - 1;
+                if (end < in || start > out) {
+                    continue;
+                }
+                std::unique_ptr<Mlt::Producer> clip(playlist.get_clip(k));
+                QJsonObject info{{QStringLiteral("track"), i}, {QStringLiteral("playlist"), j}, {QStringLiteral("position"), start}};
+                QJsonObject clipInfo = info;
+                clipInfo[QStringLiteral("type")] = QStringLiteral("clip");
+                clipInfo[QStringLiteral("service")] = QString::fromUtf8(clip->parent().get("mlt_service"));
+                m_items.append({clipInfo, qMax(start, in), qMin(end, out), nullptr, nullptr, 0, trackItem});
+                info[QStringLiteral("owner")] = QStringLiteral("clip");
+                collectFilters(*clip, info, qMax(start, in), qMin(end, out));
+            }
+        }
+    }
+    std::unique_ptr<Mlt::Service> service(timeline.field());
+    while (service && service->is_valid()) {
+        if (service->type() == mlt_service_transition_type) {
+            auto transition = std::make_shared<Mlt::Transition>(mlt_transition(service->get_service()));
+            service.reset(service->producer());
+            // Skip the track compositing added by Kdenlive, it is part of the track cost
+            if (!transition->property_exists("kdenlive_id") || transition->get_int("internal_added") > 0) {
+                continue;
+            }
+            const int start = transition->get_in();
+            const int end = transition->get_out();
+            if (end < in || start > out) {
+                continue;
+            }
+            QJsonObject info{{QStringLiteral("type"), QStringLiteral("composition")},
+                             {QStringLiteral("track"), transition->get_b_track()},
+                             {QStringLiteral("aTrack"), transition->get_a_track()},
+                             {QStringLiteral("position"), start},
+                             {QStringLiteral("id"), QString::fromUtf8(transition->get("kdenlive_id"))}};
+            m_items.append({info, qMax(start, in), qMin(end, out), transition, "disable", 1, -1});
+        } else {
+            service.reset(service->producer());
+        }
+    }
+}
+
+double RenderProfiler::renderFrame(int position)
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_producer.seek(position);
+    std::unique_ptr<Mlt::Frame> frame(m_producer.get_frame());
+    if (frame && frame->is_valid()) {
+        mlt_image_format imageFormat = mlt_image_yuv422;
+        int width = m_profile.width();
+        int height = m_profile.height();
+        frame->get_image(imageFormat, width, height);
+        mlt_audio_format audioFormat = mlt_audio_s16;
+        int frequency = 48000;
+        int channels = 2;
+        int samples = mlt_audio_calculate_frame_samples(float(m_profile.fps()), frequency, position);
+        frame->get_audio(audioFormat, frequency, channels, samples);
+    }
+    return timer.nsecsElapsed() / 1000000.;
+}
+
+QMap<int, double> RenderProfiler::measure(const QVector<int> &positions)
+{
+    QMap<int, double> times;
+    for (int position : positions) {
+        times.insert(position, renderFrame(position));
+    }
+    return times;
+}
+
+QJsonObject RenderProfiler::run(int in, int out, int samples)
+{
+    auto timeline = findTimeline(m_producer);
+    if (!timeline || out < in) {
+        return QJsonObject();
+    }
+    collect(*timeline, in, out);
+
+    // Evenly spaced frames, and at least one frame in each item
+    QVector<int> positions;
+    const int step = qMax(1, (out - in + 1) / qMax(1, samples));
+    for (int position = in; position <= out; position += step) {
+        positions << position;
+    }
+    for (const Item &item : qAsConst(m_items)) {
+        if (std::none_of(positions.cbegin(), positions.cend(), [&item](int position) { return position >= item.in && position <= item.out; })) {
+            positions << (item.in + item.out) / 2;
+        }
+    }
+    std::sort(positions.begin(), positions.end());
+
+    // Open the decoders and fill the caches before measuring
+    measure(positions);
+    const QMap<int, double> reference = measure(positions);
+    QVector<QMap<int, double>> costs(m_items.count());
+    for (int i = 0; i < m_items.count(); i++) {
+        fprintf(stderr, "PROGRESS:%d\n", 100 * i / m_items.count());
+        const Item &item = m_items.at(i);
+        if (!item.service) {
+            continue;
+        }
+        QVector<int> itemPositions;
+        std::copy_if(positions.cbegin(), positions.cend(), std::back_inserter(itemPositions),
+                     [&item](int position) { return position >= item.in && position <= item.out; });
+        const int original = item.service->get_int(item.property);
+        item.service->set(item.property, item.value);
+        const QMap<int, double> times = measure(itemPositions);
+        item.service->set(item.property, original);
+        for (auto it = times.cbegin(); it != times.cend(); ++it) {
+            costs[i].insert(it.key(), qMax(0., reference.value(it.key()) - it.value()));
+        }
+    }
+
+    QJsonArray items;
+    for (int i = 0; i < m_items.count(); i++) {
+        const Item &item = m_items.at(i);
+        // A clip costs what its track costs on its frames
+        const QMap<int, double> &itemCosts = item.trackItem >= 0 ? costs.at(item.trackItem) : costs.at(i);
+        double total = 0.;
+        int frames = 0;
+        for (auto it = itemCosts.cbegin(); it != itemCosts.cend(); ++it) {
+            if (it.key() >= item.in && it.key() <= item.out) {
+                total += it.value();
+                frames++;
+            }
+        }
+        QJsonObject info = item.info;
+        info[QStringLiteral("in")] = item.in;
+        info[QStringLiteral("out")] = item.out;
+        info[QStringLiteral("frames")] = frames;
+        info[QStringLiteral("msPerFrame")] = frames > 0 ? total / frames : 0.;
+        items.append(info);
+    }
+    QJsonArray frames;
+    double total = 0.;
+    for (auto it = reference.cbegin(); it != reference.cend(); ++it) {
+        frames.append(QJsonObject{{QStringLiteral("position"), it.key()}, {QStringLiteral("ms"), it.value()}});
+        total += it.value();
+    }
+    fprintf(stderr, "PROGRESS:100\n");
+    return {{QStringLiteral("in"), in},
+            {QStringLiteral("out"), out},
+            {QStringLiteral("msPerFrame"), reference.isEmpty() ? 0. : total / reference.count()},
+            {QStringLiteral("samples"), frames},
+            {QStringLiteral("items"), items}};
+}
@@ -0,0 +1,62 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "mlt++/Mlt.h"
+
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+/** @class RenderProfiler
+    @brief Measures the render time of each item of a Kdenlive timeline.
+    MLT services compute their frames lazily when the consumer requests the image, so the time spent in
+    one service cannot be measured directly. The profiler renders a sample of the timeline frames, then
+    renders the frames of each item again with the item disabled: the difference is the cost of the item.
+    Effects and compositions are disabled, tracks are hidden, and the cost of a clip is the cost of its
+    track on the frames of the clip, including its effects.
+    The report lists the items by track and position, so that Kdenlive can find the matching clips and effects.
+ */
+class RenderProfiler
+{
+public:
+    RenderProfiler(Mlt::Profile &profile, Mlt::Producer &producer);
+    /** @brief Measure the items of the timeline between @p in and @p out on about @p samples frames,
+     *  returns the report or an empty object if the producer is not a Kdenlive timeline */
+    QJsonObject run(int in, int out, int samples);
+
+private:
+    struct Item
+    {
+        /** @brief The description of the item in the report */
+        QJsonObject info;
+        int in;
+        int out;
+        /** @brief The service disabled to measure the item, null for a clip measured with its track */
+        std::shared_ptr<Mlt::Service> service;
+        /** @brief The property set to 1 ("disable") or 3 ("hide") to remove the item */
+        const char *property;
+        int value;
+        /** @brief The index of the track item of a clip */
+        int trackItem;
+    };
+
+    Mlt::Profile &m_profile;
+    Mlt::Producer &m_producer;
+    QVector<Item> m_items;
+
+    /** @brief Returns the tractor of the Kdenlive timeline in @p service, nullptr if there is none */
+    static std::shared_ptr<Mlt::Tractor> findTimeline(Mlt::Service &service, int depth = 0);
+    void collect(Mlt::Tractor &timeline, int in, int out);
+    void collectFilters(Mlt::Service &service, QJsonObject info, int in, int out);
+    /** @brief Render the frame at @p position, returns the time it took in milliseconds */
+    double renderFrame(int position);
+    QMap<int, double> measure(const QVector<int> &positions);
+};
@@ -0,0 +1,255 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "rendersegments.h"
+#include "smartrender.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <cmath>
+
+namespace {
+/** @brief Segments shorter than this are not worth the cost of an additional melt process */
+const int MinimumSegmentSeconds = 10;
+/** @brief GOP size of the segments when the render does not set one, the default keyframe interval of x264 and x265 */
+const int DefaultGop = 250;
+
+bool isSet(const QDomElement &consumer, const QString &name)
+{
+    return consumer.attribute(name).toInt() == 1;
+}
+
+bool writeDocument(const QDomDocument &doc, const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Failed to write segment scene list" << path;
+        return false;
+    }
+    QTextStream outStream(&file);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    outStream.setCodec("UTF-8");
+#endif
+    outStream << doc.toString();
+    file.close();
+    return true;
+}
+} // namespace
+
+QVector<QPair<int, int>> RenderSegments::split(int in, int out, int count, int gop, int minimumLength)
+{
+    QVector<QPair<int, int>> ranges;
+    if (out < in) {
+        return ranges;
+    }
+    const int length = out - in + 1;
+    gop = qMax(1, gop);
+    count = qBound(1, count, length / qMax(1, minimumLength));
+    int start = in;
+    for (int i = 1; i < count; ++i) {
+        // Move the ideal boundary to the closest keyframe position
+        const int boundary = in + int(std::lround(double(length) * i / count / gop)) * gop;
+        if (boundary <= start || boundary > out) {
+            continue;
+        }
+        ranges.append({start, boundary - 1});
+        start = boundary;
+    }
+    ranges.append({start, out});
+    return ranges;
+}
+
+QString RenderSegments::unsupportedReason(const QDomDocument &doc)
+{
+    const QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    if (consumer.isNull()) {
+        return QStringLiteral("no consumer");
+    }
+    if (consumer.attribute(QStringLiteral("mlt_service")) != QLatin1String("avformat")) {
+        return QStringLiteral("not an avformat render");
+    }
+    const int in = consumer.attribute(QStringLiteral("in"), QStringLiteral("-1")).toInt();
+    const int out = consumer.attribute(QStringLiteral("out"), QStringLiteral("-1")).toInt();
+    if (in < 0 || out <= in) {
+        return QStringLiteral("unknown render range");
+    }
+    const QString target = consumer.attribute(QStringLiteral("target"));
+    if (target.isEmpty()) {
+        return QStringLiteral("no target");
+    }
+    static const QRegularExpression sequence(QStringLiteral("%[0-9]*d"));
+    if (sequence.match(target).hasMatch()) {
+        return QStringLiteral("image sequence");
+    }
+    if (consumer.hasAttribute(QStringLiteral("pass"))) {
+        return QStringLiteral("2 pass encoding");
+    }
+    if (isSet(consumer, QStringLiteral("vn")) || isSet(consumer, QStringLiteral("video_off"))) {
+        return QStringLiteral("audio only render");
+    }
+    // Containers that the ffmpeg concat demuxer can join with stream copy
+    static const QStringList joinableFormats = {QStringLiteral("mp4"),      QStringLiteral("mov"),    QStringLiteral("matroska"), QStringLiteral("webm"),
+                                                QStringLiteral("mpegts"),   QStringLiteral("avi"),    QStringLiteral("mxf"),      QStringLiteral("dv"),
+                                                QStringLiteral("mpeg")};
+    const QString format = consumer.attribute(QStringLiteral("f"));
+    if (!joinableFormats.contains(format)) {
+        return QStringLiteral("format %1 cannot be joined without re-encoding").arg(format);
+    }
+    if (QStandardPaths::findExecutable(QStringLiteral("ffmpeg")).isEmpty()) {
+        return QStringLiteral("ffmpeg not found");
+    }
+    return QString();
+}
+
+QVector<RenderSegment> RenderSegments::prepare(const QDomDocument &doc, const QString &source, int count, const QString &folder, bool smart)
+{
+    QVector<RenderSegment> segments;
+    if (count < 2 && !smart) {
+        return segments;
+    }
+    const QString reason = unsupportedReason(doc);
+    if (!reason.isEmpty()) {
+        qDebug() << "Cannot render in segments:" << reason;
+        return segments;
+    }
+    const QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    const QDomElement profile = doc.documentElement().firstChildElement(QStringLiteral("profile"));
+    double fps = 25.;
+    if (!profile.isNull() && profile.attribute(QStringLiteral("frame_rate_den")).toInt() > 0) {
+        fps = profile.attribute(QStringLiteral("frame_rate_num")).toDouble() / profile.attribute(QStringLiteral("frame_rate_den")).toDouble();
+    }
+    const int in = consumer.attribute(QStringLiteral("in")).toInt();
+    const int out = consumer.attribute(QStringLiteral("out")).toInt();
+    // Without an explicit GOP size, every segment is encoded with the same fixed one so that the segment boundaries fall on its keyframe cadence
+    const bool fixedGop = consumer.attribute(QStringLiteral("g")).toInt() <= 0;
+    const int gop = fixedGop ? DefaultGop : consumer.attribute(QStringLiteral("g")).toInt();
+    const int minimumLength = qMax(2 * gop, int(fps * MinimumSegmentSeconds));
+    QMap<QString, QString> encoderProperties;
+    const QVector<CopyRange> copies = smart ? SmartRender::copyRanges(doc, source, &encoderProperties) : QVector<CopyRange>();
+
+    // The encoded parts of the timeline, between the copied ranges, each one split in up to count segments
+    QVector<QPair<int, int>> ranges;
+    QVector<int> copyBefore;
+    int position = in;
+    for (int i = 0; i <= copies.count(); ++i) {
+        const int end = i < copies.count() ? copies.at(i).in - 1 : out;
+        if (end >= position) {
+            const QVector<QPair<int, int>> parts = split(position, end, count, gop, minimumLength);
+            for (const auto &part : parts) {
+                ranges << part;
+                copyBefore << i;
+            }
+        }
+        if (i < copies.count()) {
+            position = copies.at(i).out + 1;
+        }
+    }
+    if (copies.isEmpty() && ranges.count() < 2) {
+        qDebug() << "Cannot render in segments: render range is too short";
+        return segments;
+    }
+    const bool hasAudio = !isSet(consumer, QStringLiteral("an")) && !isSet(consumer, QStringLiteral("audio_off"));
+    // Share the frame threads requested for the render between the concurrent processes
+    const int threads = -consumer.attribute(QStringLiteral("real_time"), QStringLiteral("-1")).toInt();
+    const int segmentThreads = qMax(1, threads / qBound(1, count, qMax(1, ranges.count())));
+    const QString extension = QFileInfo(consumer.attribute(QStringLiteral("target"))).suffix();
+    // Copied streams keep their own parameter sets, MPEG-TS carries them in band so the joined file can switch between them
+    const QString segmentExtension = copies.isEmpty() ? extension : QStringLiteral("ts");
+    QDir dir(folder);
+
+    auto writeSegment = [&](const QString &name, int segmentIn, int segmentOut, bool audio) {
+        QDomDocument copy = doc.cloneNode(true).toDocument();
+        QDomElement root = copy.documentElement();
+        if (!root.hasAttribute(QStringLiteral("root"))) {
+            // Relative paths were resolved from the location of the original scene list
+            root.setAttribute(QStringLiteral("root"), QFileInfo(source).absolutePath());
+        }
+        QDomElement segmentConsumer = root.firstChildElement(QStringLiteral("consumer"));
+        RenderSegment segment{dir.absoluteFilePath(name + QStringLiteral(".mlt")),
+                              dir.absoluteFilePath(QStringLiteral("%1.%2").arg(name, audio ? extension : segmentExtension)),
+                              segmentIn,
+                              segmentOut,
+                              audio,
+                              QStringList()};
+        segmentConsumer.setAttribute(QStringLiteral("in"), segmentIn);
+        segmentConsumer.setAttribute(QStringLiteral("out"), segmentOut);
+        segmentConsumer.setAttribute(QStringLiteral("target"), segment.target);
+        if (audio) {
+            segmentConsumer.setAttribute(QStringLiteral("vn"), 1);
+            segmentConsumer.setAttribute(QStringLiteral("video_off"), 1);
+        } else {
+            segmentConsumer.setAttribute(QStringLiteral("an"), 1);
+            segmentConsumer.setAttribute(QStringLiteral("audio_off"), 1);
+            segmentConsumer.setAttribute(QStringLiteral("real_time"), -segmentThreads);
+            if (fixedGop) {
+                segmentConsumer.setAttribute(QStringLiteral("g"), gop);
+            }
+            if (segmentExtension != extension) {
+                segmentConsumer.setAttribute(QStringLiteral("f"), QStringLiteral("mpegts"));
+            }
+            for (auto i = encoderProperties.constBegin(); i != encoderProperties.constEnd(); ++i) {
+                segmentConsumer.setAttribute(i.key(), i.value());
+            }
+        }
+        if (!writeDocument(copy, segment.scenelist)) {
+            return false;
+        }
+        segments.append(segment);
+        return true;
+    };
+    auto segmentName = [&segments]() { return QStringLiteral("segment-%1").arg(segments.count(), 4, 10, QLatin1Char('0')); };
+    auto copySegment = [&](const CopyRange &range) {
+        const QString target = dir.absoluteFilePath(QStringLiteral("%1.%2").arg(segmentName(), segmentExtension));
+        const QStringList args = {QStringLiteral("-y"),
+                                  QStringLiteral("-v"),
+                                  QStringLiteral("error"),
+                                  QStringLiteral("-ss"),
+                                  range.start,
+                                  QStringLiteral("-i"),
+                                  range.resource,
+                                  QStringLiteral("-map"),
+                                  QStringLiteral("0:%1").arg(range.stream),
+                                  QStringLiteral("-frames:v"),
+                                  QString::number(range.out - range.in + 1),
+                                  QStringLiteral("-c"),
+                                  QStringLiteral("copy"),
+                                  QStringLiteral("-f"),
+                                  QStringLiteral("mpegts"),
+                                  target};
+        segments.append(RenderSegment{QString(), target, range.in, range.out, false, args});
+    };
+
+    int copied = 0;
+    for (int i = 0; i < ranges.count(); ++i) {
+        while (copied < copyBefore.at(i)) {
+            copySegment(copies.at(copied++));
+        }
+        if (!writeSegment(segmentName(), ranges.at(i).first, ranges.at(i).second, false)) {
+            segments.clear();
+            return segments;
+        }
+    }
+    while (copied < copies.count()) {
+        copySegment(copies.at(copied++));
+    }
+    if (!copies.isEmpty()) {
+        qDebug() << "Smart render copies" << copies.count() << "ranges and encodes" << ranges.count() << "segments";
+    }
+    if (hasAudio) {
+        if (!writeSegment(QStringLiteral("audio"), in, out, true)) {
+            segments.clear();
+            return segments;
+        }
+        // The audio pass is needed for the join, start it with the first video segments
+        segments.move(segments.count() - 1, 0);
+    }
+    return segments;
+}
@@ -0,0 +1,49 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDomDocument>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/** @brief One melt process of a segmented delivery render */
+struct RenderSegment
+{
+    QString scenelist;
+    QString target;
+    int in;
+    int out;
+    /** @brief True for the pass encoding the audio of the whole range, the other segments are video only */
+    bool audio;
+    /** @brief The ffmpeg arguments of a segment copied from a source file, empty for a segment rendered by melt */
+    QStringList copyArguments;
+};
+
+/** @namespace RenderSegments
+    @brief Split a delivery render in video segments encoded concurrently and joined without re-encoding.
+    Every segment starts on a multiple of the GOP size from the render in point, so that the keyframe
+    cadence of the joined file is the same as with a single encoder. When the render does not set a GOP
+    size, a fixed one is set on every segment. Audio is never split: encoders add
+    priming samples at the start of every stream, which would cause gaps at the segment boundaries, so a
+    separate pass encodes the audio of the whole range and is muxed with the joined video. This pass runs
+    alongside the video segments, it is not counted in the number of concurrent processes.
+ */
+namespace RenderSegments {
+/** @brief Split the @p in - @p out range in at most @p count ranges, all starting on a multiple of @p gop frames
+ *  from @p in. The number of ranges is reduced so that none is shorter than @p minimumLength frames */
+QVector<QPair<int, int>> split(int in, int out, int count, int gop, int minimumLength);
+/** @brief Returns the reason why the render described by @p doc cannot be segmented, or an empty string */
+QString unsupportedReason(const QDomDocument &doc);
+/** @brief Write the scene lists of the segments of the render described by @p doc in @p folder.
+ *  @param source the scene list of the render, used to resolve relative paths
+ *  @param count the number of segments the render, or each encoded part of a smart render, is split in
+ *  @param smart copy the unmodified clips in the output codec from their file, only the rest of the timeline is encoded
+ *  @return the audio pass if the render has audio, then the segments in timeline order, or an empty list if the render cannot be segmented */
+QVector<RenderSegment> prepare(const QDomDocument &doc, const QString &source, int count, const QString &folder, bool smart = false);
+} // namespace RenderSegments
@@ -0,0 +1,205 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "renderworker.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStandardPaths>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#endif
+
+namespace {
+/** @brief Size of the command output kept to explain a failure */
+const int MaxErrorLog = 4000;
+} // namespace
+
+RenderWorker::RenderWorker(const QString &server, int id, const QString &melt, const QString &ffmpeg, QObject *parent)
+    : QObject(parent)
+    , m_server(server)
+    , m_id(id)
+    , m_melt(melt)
+    , m_ffmpeg(ffmpeg.isEmpty() ? QStandardPaths::findExecutable(QStringLiteral("ffmpeg")) : ffmpeg)
+    , m_progress(-1)
+    , m_aborted(false)
+{
+    m_process.setReadChannel(QProcess::StandardError);
+    connect(&m_process, &QProcess::readyReadStandardError, this, &RenderWorker::receivedStderr);
+    connect(&m_process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &RenderWorker::taskEnded);
+    connect(&m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            m_errorLog = tr("Cannot start %1.").arg(m_process.program());
+            taskEnded(1, QProcess::NormalExit);
+        }
+    });
+    m_heartbeat.setInterval(1000);
+    connect(&m_heartbeat, &QTimer::timeout, this, &RenderWorker::sendHeartbeat);
+    connect(&m_socket, &QLocalSocket::readyRead, this, &RenderWorker::receivedMessage);
+    connect(&m_socket, &QLocalSocket::disconnected, this, &RenderWorker::finished);
+    connect(&m_socket, &QLocalSocket::errorOccurred, this, [this]() {
+        qWarning() << "Render worker" << m_id << "lost the connection to" << m_server << m_socket.errorString();
+        Q_EMIT finished();
+    });
+    // Disable VDPAU so that rendering will work even if there is a Kdenlive instance using VDPAU
+    qputenv("MLT_NO_VDPAU", "1");
+}
+
+RenderWorker::~RenderWorker()
+{
+    m_process.disconnect(this);
+    if (m_process.state() != QProcess::NotRunning) {
+        m_process.kill();
+        m_process.waitForFinished();
+    }
+}
+
+bool RenderWorker::setAffinity(const QString &cpus)
+{
+#ifdef Q_OS_LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    const QStringList ranges = cpus.split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &range : ranges) {
+        bool ok = false;
+        const int first = range.section(QLatin1Char('-'), 0, 0).toInt(&ok);
+        if (!ok) {
+            return false;
+        }
+        const int last = range.contains(QLatin1Char('-')) ? range.section(QLatin1Char('-'), 1, 1).toInt(&ok) : first;
+        if (!ok || first < 0 || last < first) {
+            return false;
+        }
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    // Child processes inherit the affinity of the worker
+    return CPU_COUNT(&set) > 0 && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    Q_UNUSED(cpus)
+    return false;
+#endif
+}
+
+void RenderWorker::start()
+{
+    connect(&m_socket, &QLocalSocket::connected, this, [this]() {
+        send(QStringLiteral("workerReady"), QJsonObject());
+        m_heartbeat.start();
+    });
+    m_socket.connectToServer(m_server);
+}
+
+void RenderWorker::receivedMessage()
+{
+    while (m_socket.canReadLine()) {
+        const QString line = QString::fromUtf8(m_socket.readLine()).chopped(1);
+        m_block.append(line);
+        if (line == QLatin1String("}")) { // end of json object
+            QJsonParseError error;
+            const QJsonObject json = QJsonDocument::fromJson(m_block.toUtf8(), &error).object();
+            m_block.clear();
+            if (error.error != QJsonParseError::NoError) {
+                qWarning() << "Render worker" << m_id << "received an invalid message:" << error.errorString();
+                continue;
+            }
+            handleJson(json);
+        }
+    }
+}
+
+void RenderWorker::handleJson(const QJsonObject &json)
+{
+    if (json.contains("runTask")) {
+        const QJsonObject args = json["runTask"].toObject();
+        QStringList arguments;
+        const QJsonArray array = args["arguments"].toArray();
+        for (const auto &argument : array) {
+            arguments << argument.toString();
+        }
+        runTask(args["program"].toString(), arguments);
+    } else if (json.contains("abortTask")) {
+        if (m_process.state() != QProcess::NotRunning) {
+            m_aborted = true;
+            m_process.kill();
+        }
+    }
+}
+
+void RenderWorker::runTask(const QString &program, const QStringList &arguments)
+{
+    m_progress = -1;
+    m_errorLog.clear();
+    m_aborted = false;
+    if (m_process.state() != QProcess::NotRunning) {
+        m_errorLog = tr("The render worker is busy.");
+        send(QStringLiteral("taskFinished"), {{"status", 1}, {"error", m_errorLog}});
+        return;
+    }
+    // Only run the executables of the render, not any program the server would ask for
+    QString executable;
+    if (program == QLatin1String("melt")) {
+        executable = m_melt;
+    } else if (program == QLatin1String("ffmpeg")) {
+        executable = m_ffmpeg;
+    }
+    if (executable.isEmpty()) {
+        send(QStringLiteral("taskFinished"), {{"status", 1}, {"error", tr("Cannot run %1.").arg(program)}});
+        return;
+    }
+    m_process.start(executable, arguments);
+}
+
+void RenderWorker::receivedStderr()
+{
+    const QString result = QString::fromLocal8Bit(m_process.readAllStandardError());
+    // melt -progress writes lines like "Current Frame:   123, percentage:   45"
+    int progressIndex = result.lastIndexOf(QLatin1String("percentage:"));
+    if (progressIndex >= 0) {
+        m_progress = qBound(0, result.mid(progressIndex + 11).section(QLatin1Char('\r'), 0, 0).simplified().section(QLatin1Char(' '), 0, 0).toInt(), 100);
+    }
+    if (!result.contains(QLatin1String("Current Frame"))) {
+        m_errorLog.append(result);
+        if (m_errorLog.size() > MaxErrorLog) {
+            m_errorLog = m_errorLog.right(MaxErrorLog);
+        }
+    }
+}
+
+void RenderWorker::taskEnded(int exitCode, QProcess::ExitStatus status)
+{
+    const bool success = !m_aborted && status == QProcess::NormalExit && exitCode == 0;
+    QJsonObject args;
+    args["status"] = success ? 0 : 1;
+    args["error"] = m_aborted ? QString() : m_errorLog.simplified();
+    send(QStringLiteral("taskFinished"), args);
+    m_progress = -1;
+    m_aborted = false;
+}
+
+void RenderWorker::sendHeartbeat()
+{
+    QJsonObject args;
+    if (m_process.state() != QProcess::NotRunning) {
+        args["progress"] = m_progress;
+    }
+    send(QStringLiteral("heartbeat"), args);
+}
+
+void RenderWorker::send(const QString &method, QJsonObject args)
+{
+    if (m_socket.state() != QLocalSocket::ConnectedState) {
+        return;
+    }
+    args["worker"] = m_id;
+    QJsonObject message;
+    message[method] = args;
+    m_socket.write(QJsonDocument(message).toJson());
+    m_socket.flush();
+}
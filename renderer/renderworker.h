@@ -0,0 +1,65 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+
+/** @class RenderWorker
+    @brief A headless render process of the Kdenlive worker pool.
+    The worker connects to the render server of Kdenlive and runs the melt or ffmpeg commands it receives,
+    one at a time. While connected it sends a heartbeat every second with the progress of the running
+    command, so that the server can detect a worker that stopped responding. The worker quits when the
+    server closes the connection.
+ */
+class RenderWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @param id the id given to this worker by the server
+     *  @param melt the path of the melt executable
+     *  @param ffmpeg the path of the ffmpeg executable, found in the path if empty */
+    RenderWorker(const QString &server, int id, const QString &melt, const QString &ffmpeg, QObject *parent = nullptr);
+    ~RenderWorker() override;
+    /** @brief Restrict this process and the commands it starts to the processor cores in @p cpus, like "0-3,8".
+     *  Returns false if the cores could not be set */
+    static bool setAffinity(const QString &cpus);
+
+public Q_SLOTS:
+    void start();
+
+Q_SIGNALS:
+    void finished();
+
+private:
+    QString m_server;
+    int m_id;
+    QString m_melt;
+    QString m_ffmpeg;
+    QLocalSocket m_socket;
+    QProcess m_process;
+    QTimer m_heartbeat;
+    /** @brief The incomplete message received from the server */
+    QString m_block;
+    /** @brief Progress of the running command in percent, -1 if unknown */
+    int m_progress;
+    /** @brief The output of the running command that is not progress information */
+    QString m_errorLog;
+    bool m_aborted;
+
+    void receivedMessage();
+    void handleJson(const QJsonObject &json);
+    void runTask(const QString &program, const QStringList &arguments);
+    void receivedStderr();
+    void taskEnded(int exitCode, QProcess::ExitStatus status);
+    void sendHeartbeat();
+    void send(const QString &method, QJsonObject args);
+};
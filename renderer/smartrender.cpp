@@ -0,0 +1,709 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "smartrender.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+/** @brief Unmodified clips shorter than this are encoded, copying them is not worth an additional segment */
+const int MinimumCopySeconds = 2;
+/** @brief Nested playlists and tractors deeper than this are not analyzed */
+const int MaximumDepth = 32;
+/** @brief Value of the internal_added property of the compositions and filters added automatically by Kdenlive */
+const int InternalAsset = 237;
+
+QString property(const QDomElement &element, const QString &name)
+{
+    for (QDomElement child = element.firstChildElement(QStringLiteral("property")); !child.isNull();
+         child = child.nextSiblingElement(QStringLiteral("property"))) {
+        if (child.attribute(QStringLiteral("name")) == name) {
+            return child.text();
+        }
+    }
+    return QString();
+}
+
+/** @brief Convert an MLT time, in frames, clock or SMPTE format, to frames */
+int toFrames(const QString &time, double fps)
+{
+    if (!time.contains(QLatin1Char(':'))) {
+        return time.toInt();
+    }
+    static const QRegularExpression separator(QStringLiteral("[:;]"));
+    const QStringList parts = time.split(separator);
+    if (parts.count() < 3) {
+        return 0;
+    }
+    const double seconds = parts.at(0).toInt() * 3600 + parts.at(1).toInt() * 60 + parts.at(2).toDouble();
+    int frames = qRound(seconds * fps);
+    if (parts.count() == 4) {
+        frames += parts.at(3).toInt();
+    }
+    return frames;
+}
+
+/** @brief Returns the value of a "num/den" or "num:den" ratio, 0 if it is not valid */
+double ratio(const QString &value)
+{
+    static const QRegularExpression separator(QStringLiteral("[/:]"));
+    const QStringList parts = value.split(separator);
+    if (parts.count() != 2 || parts.at(1).toDouble() <= 0.) {
+        return 0.;
+    }
+    return parts.at(0).toDouble() / parts.at(1).toDouble();
+}
+
+/** @brief Returns true if @p element has an enabled filter that can change the image */
+bool hasVideoFilter(const QDomElement &element)
+{
+    static const QStringList audioFilters = {QStringLiteral("volume"),   QStringLiteral("panner"),           QStringLiteral("audiolevel"),
+                                             QStringLiteral("audiomap"), QStringLiteral("channelcopy"),      QStringLiteral("mono"),
+                                             QStringLiteral("sox"),      QStringLiteral("loudness"),         QStringLiteral("dynamic_loudness"),
+                                             QStringLiteral("resample"), QStringLiteral("audioseam"),        QStringLiteral("swresample")};
+    for (QDomElement filter = element.firstChildElement(QStringLiteral("filter")); !filter.isNull();
+         filter = filter.nextSiblingElement(QStringLiteral("filter"))) {
+        if (property(filter, QStringLiteral("disable")).toInt() == 1) {
+            continue;
+        }
+        const QString service = property(filter, QStringLiteral("mlt_service"));
+        if (audioFilters.contains(service) || service.startsWith(QLatin1String("ladspa")) || service.startsWith(QLatin1String("lv2")) ||
+            service.startsWith(QLatin1String("vst2"))) {
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+SourceSpan makeSpan(SourceSpan::Kind kind, int in, int out)
+{
+    return SourceSpan{kind, in, out, QString(), -1, 0};
+}
+
+/** @brief Append @p next to @p spans, merging it with the last span if it continues it */
+void append(QVector<SourceSpan> &spans, const SourceSpan &next)
+{
+    if (!spans.isEmpty()) {
+        SourceSpan &last = spans.last();
+        if (last.kind == next.kind && last.out + 1 == next.in &&
+            (next.kind != SourceSpan::Source ||
+             (last.resource == next.resource && last.stream == next.stream && last.sourceIn + next.in - last.in == next.sourceIn))) {
+            last.out = next.out;
+            return;
+        }
+    }
+    spans.append(next);
+}
+
+/** @brief Stack @p layers, the last one on top, and return what is visible from 0 to @p length - 1.
+ *  The spans of each layer are sorted and do not overlap. Blank spans and frames that are not covered by a layer show the layers below. */
+QVector<SourceSpan> overlay(const QVector<QVector<SourceSpan>> &layers, int length)
+{
+    QVector<int> bounds = {0, length};
+    for (const QVector<SourceSpan> &layer : layers) {
+        for (const SourceSpan &span : layer) {
+            bounds << span.in << span.out + 1;
+        }
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    bounds.erase(std::remove_if(bounds.begin(), bounds.end(), [length](int bound) { return bound < 0 || bound > length; }), bounds.end());
+
+    QVector<SourceSpan> result;
+    QVector<int> cursors(layers.count(), 0);
+    for (int i = 0; i + 1 < bounds.count(); ++i) {
+        const int start = bounds.at(i);
+        const int end = bounds.at(i + 1) - 1;
+        SourceSpan visible = makeSpan(SourceSpan::Blank, start, end);
+        for (int l = layers.count() - 1; l >= 0; --l) {
+            const QVector<SourceSpan> &layer = layers.at(l);
+            int &cursor = cursors[l];
+            while (cursor < layer.count() && layer.at(cursor).out < start) {
+                ++cursor;
+            }
+            if (cursor == layer.count() || layer.at(cursor).in > start || layer.at(cursor).kind == SourceSpan::Blank) {
+                continue;
+            }
+            visible = layer.at(cursor);
+            visible.sourceIn += start - visible.in;
+            visible.in = start;
+            visible.out = end;
+            break;
+        }
+        append(result, visible);
+    }
+    return result;
+}
+
+/** @brief Returns the part of @p spans between @p in and @p out, moved to start at 0, padded with Blank spans */
+QVector<SourceSpan> window(const QVector<SourceSpan> &spans, int in, int out)
+{
+    QVector<SourceSpan> shifted;
+    for (SourceSpan span : spans) {
+        if (span.out < in || span.in > out) {
+            continue;
+        }
+        if (span.in < in) {
+            span.sourceIn += in - span.in;
+            span.in = in;
+        }
+        span.out = qMin(span.out, out);
+        span.in -= in;
+        span.out -= in;
+        shifted << span;
+    }
+    return overlay({shifted}, out - in + 1);
+}
+
+/** @class TimelineReader
+    @brief Follows the producers, playlists and tractors of an MLT XML document to find what is displayed at each frame
+ */
+class TimelineReader
+{
+public:
+    TimelineReader(const QDomDocument &doc, const QString &root)
+        : m_root(doc.documentElement().attribute(QStringLiteral("root"), root))
+        , m_fps(25.)
+    {
+        const QDomElement profile = doc.documentElement().firstChildElement(QStringLiteral("profile"));
+        if (profile.attribute(QStringLiteral("frame_rate_den")).toInt() > 0) {
+            m_fps = profile.attribute(QStringLiteral("frame_rate_num")).toDouble() / profile.attribute(QStringLiteral("frame_rate_den")).toDouble();
+        }
+        static const QStringList services = {QStringLiteral("producer"), QStringLiteral("chain"), QStringLiteral("playlist"), QStringLiteral("tractor")};
+        for (QDomElement element = doc.documentElement().firstChildElement(); !element.isNull(); element = element.nextSiblingElement()) {
+            if (services.contains(element.tagName())) {
+                m_services.insert(element.attribute(QStringLiteral("id")), element);
+                // Like melt, play the last service of the document
+                m_rootService = element.attribute(QStringLiteral("id"));
+            }
+        }
+    }
+
+    QVector<SourceSpan> spans(int in, int out) const { return serviceSpans(m_rootService, in, out, 0); }
+
+private:
+    QMap<QString, QDomElement> m_services;
+    QString m_rootService;
+    QString m_root;
+    double m_fps;
+
+    QVector<SourceSpan> serviceSpans(const QString &id, int in, int out, int depth) const
+    {
+        if (out < in) {
+            return {};
+        }
+        const QDomElement element = m_services.value(id);
+        if (element.isNull() || depth > MaximumDepth) {
+            return {makeSpan(SourceSpan::Rendered, 0, out - in)};
+        }
+        if (element.tagName() == QLatin1String("playlist")) {
+            return playlistSpans(element, in, out, depth);
+        }
+        if (element.tagName() == QLatin1String("tractor")) {
+            return tractorSpans(element, in, out, depth);
+        }
+        return producerSpans(element, in, out);
+    }
+
+    QVector<SourceSpan> producerSpans(const QDomElement &producer, int in, int out) const
+    {
+        const int last = out - in;
+        if (property(producer, QStringLiteral("set.test_image")).toInt() == 1 || property(producer, QStringLiteral("video_index")) == QLatin1String("-1")) {
+            // Audio part of a clip
+            return {makeSpan(SourceSpan::Blank, 0, last)};
+        }
+        if (!property(producer, QStringLiteral("mlt_service")).startsWith(QLatin1String("avformat")) || hasVideoFilter(producer) ||
+            !producer.firstChildElement(QStringLiteral("link")).isNull()) {
+            // Generated clip, effects or speed change
+            return {makeSpan(SourceSpan::Rendered, 0, last)};
+        }
+        for (QDomElement child = producer.firstChildElement(QStringLiteral("property")); !child.isNull();
+             child = child.nextSiblingElement(QStringLiteral("property"))) {
+            if (child.attribute(QStringLiteral("name")).startsWith(QLatin1String("force_")) && !child.text().isEmpty() && child.text() != QLatin1String("0")) {
+                // Overridden frame rate, aspect ratio, field order or colorspace
+                return {makeSpan(SourceSpan::Rendered, 0, last)};
+            }
+        }
+        const QString resource = property(producer, QStringLiteral("resource"));
+        const QString stream = property(producer, QStringLiteral("video_index"));
+        return {SourceSpan{SourceSpan::Source, 0, last, QDir(m_root).absoluteFilePath(resource), stream.isEmpty() ? -1 : stream.toInt(), in}};
+    }
+
+    QVector<SourceSpan> playlistSpans(const QDomElement &playlist, int in, int out, int depth) const
+    {
+        if (hasVideoFilter(playlist)) {
+            return {makeSpan(SourceSpan::Rendered, 0, out - in)};
+        }
+        QVector<SourceSpan> spans;
+        int position = 0;
+        for (QDomElement child = playlist.firstChildElement(); !child.isNull() && position <= out; child = child.nextSiblingElement()) {
+            if (child.tagName() == QLatin1String("blank")) {
+                position += toFrames(child.attribute(QStringLiteral("length")), m_fps);
+                continue;
+            }
+            if (child.tagName() != QLatin1String("entry")) {
+                continue;
+            }
+            if (!child.hasAttribute(QStringLiteral("out"))) {
+                // The length of the entry is unknown, so are the positions of the following ones
+                spans << makeSpan(SourceSpan::Rendered, position, qMax(position, out));
+                break;
+            }
+            const int entryIn = toFrames(child.attribute(QStringLiteral("in")), m_fps);
+            const int entryOut = toFrames(child.attribute(QStringLiteral("out")), m_fps);
+            if (entryOut < entryIn) {
+                continue;
+            }
+            if (position + entryOut - entryIn >= in) {
+                const QVector<SourceSpan> entrySpans = hasVideoFilter(child)
+                                                           ? QVector<SourceSpan>{makeSpan(SourceSpan::Rendered, 0, entryOut - entryIn)}
+                                                           : serviceSpans(child.attribute(QStringLiteral("producer")), entryIn, entryOut, depth + 1);
+                for (SourceSpan span : entrySpans) {
+                    span.in += position;
+                    span.out += position;
+                    spans << span;
+                }
+            }
+            position += entryOut - entryIn + 1;
+        }
+        return window(spans, in, out);
+    }
+
+    QVector<SourceSpan> tractorSpans(const QDomElement &tractor, int in, int out, int depth) const
+    {
+        const int length = out - in + 1;
+        if (hasVideoFilter(tractor)) {
+            return {makeSpan(SourceSpan::Rendered, 0, length - 1)};
+        }
+        QDomElement tracks = tractor.firstChildElement(QStringLiteral("multitrack"));
+        if (tracks.isNull()) {
+            tracks = tractor;
+        }
+        QVector<QVector<SourceSpan>> layers;
+        bool firstTrack = true;
+        for (QDomElement track = tracks.firstChildElement(QStringLiteral("track")); !track.isNull(); track = track.nextSiblingElement(QStringLiteral("track"))) {
+            const QString id = track.attribute(QStringLiteral("producer"));
+            const QString hide = track.attribute(QStringLiteral("hide"));
+            const bool background = firstTrack && property(m_services.value(id), QStringLiteral("mlt_service")) == QLatin1String("color");
+            firstTrack = false;
+            if (hide == QLatin1String("video") || hide == QLatin1String("both") || background) {
+                // Audio tracks and the black background track
+                continue;
+            }
+            const int offset = toFrames(track.attribute(QStringLiteral("in")), m_fps);
+            layers << serviceSpans(id, in + offset, out + offset, depth + 1);
+        }
+        // Compositions and same track mixes. The automatic compositing of the tracks displays the topmost clip as is
+        QVector<SourceSpan> compositions;
+        for (QDomElement transition = tractor.firstChildElement(QStringLiteral("transition")); !transition.isNull();
+             transition = transition.nextSiblingElement(QStringLiteral("transition"))) {
+            if (property(transition, QStringLiteral("internal_added")).toInt() == InternalAsset ||
+                property(transition, QStringLiteral("disable")).toInt() == 1 || property(transition, QStringLiteral("mlt_service")) == QLatin1String("mix")) {
+                continue;
+            }
+            const int compositionIn = transition.hasAttribute(QStringLiteral("in")) ? toFrames(transition.attribute(QStringLiteral("in")), m_fps) : in;
+            const int compositionOut = transition.hasAttribute(QStringLiteral("out")) ? toFrames(transition.attribute(QStringLiteral("out")), m_fps) : out;
+            if (compositionOut >= in && compositionIn <= out) {
+                compositions << makeSpan(SourceSpan::Rendered, qMax(compositionIn, in) - in, qMin(compositionOut, out) - in);
+            }
+        }
+        std::sort(compositions.begin(), compositions.end(), [](const SourceSpan &a, const SourceSpan &b) { return a.in < b.in; });
+        QVector<SourceSpan> rendered;
+        for (const SourceSpan &composition : qAsConst(compositions)) {
+            if (!rendered.isEmpty() && composition.in <= rendered.last().out + 1) {
+                rendered.last().out = qMax(rendered.last().out, composition.out);
+            } else {
+                rendered << composition;
+            }
+        }
+        layers << rendered;
+        return overlay(layers, length);
+    }
+};
+
+/** @brief The properties of a video stream that must match the render to copy it */
+struct StreamInfo
+{
+    bool valid = false;
+    int index = -1;
+    QString codec;
+    QString pixelFormat;
+    QString fieldOrder;
+    int width = 0;
+    int height = 0;
+    double fps = 0.;
+    double sampleAspect = 1.;
+    /** @brief Time of the first frame, in seconds */
+    double start = 0.;
+    int frames = 0;
+    int rotation = 0;
+    /** @brief Codec profile and level, bit depth and reference frames, the decoder is set up for them */
+    QString profile;
+    int level = 0;
+    int bitDepth = 0;
+    int refs = 0;
+    QString colorSpace;
+    QString colorTransfer;
+    QString colorPrimaries;
+    QString colorRange;
+};
+
+/** @brief Returns the ffprobe value of a stream property, an empty string if it is not known */
+QString probedValue(const QJsonObject &properties, const QString &name)
+{
+    const QString value = properties.value(name).toVariant().toString();
+    return value == QLatin1String("unknown") ? QString() : value;
+}
+
+/** @brief Returns the name of a profile as written by ffprobe or passed to the encoder, in lower case without spaces */
+QString profileName(const QString &profile)
+{
+    return profile.toLower().remove(QLatin1Char(' ')).remove(QLatin1Char('-'));
+}
+
+/** @brief Returns the level of an encoder option in the unit used by ffprobe for @p codec, 0 if it is not known */
+int levelValue(const QString &codec, const QString &level)
+{
+    bool ok;
+    const double value = level.toDouble(&ok);
+    if (!ok || value <= 0.) {
+        return 0;
+    }
+    if (codec == QLatin1String("hevc")) {
+        // general_level_idc is 30 times the level
+        return qRound(value < 10. ? value * 30. : value);
+    }
+    if (codec == QLatin1String("h264")) {
+        return qRound(value < 10. ? value * 10. : value);
+    }
+    return qRound(value);
+}
+
+/** @brief Returns the bit depth of the samples of a pixel format */
+int bitDepth(const QString &pixelFormat)
+{
+    static const QRegularExpression depth(QStringLiteral("p(9|10|12|14|16)(le|be)$"));
+    const QRegularExpressionMatch match = depth.match(pixelFormat);
+    return match.hasMatch() ? match.captured(1).toInt() : 8;
+}
+
+/** @brief Returns the ffprobe name of an MLT colorspace */
+QString colorSpaceName(int colorspace)
+{
+    switch (colorspace) {
+    case 240:
+        return QStringLiteral("smpte240m");
+    case 601:
+        return QStringLiteral("smpte170m");
+    case 2020:
+        return QStringLiteral("bt2020nc");
+    default:
+        return QStringLiteral("bt709");
+    }
+}
+
+QByteArray runProbe(const QString &ffprobe, const QStringList &args)
+{
+    QProcess process;
+    process.start(ffprobe, args);
+    if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        return QByteArray();
+    }
+    return process.readAllStandardOutput();
+}
+
+StreamInfo probeStream(const QString &ffprobe, const QString &resource, int stream)
+{
+    StreamInfo info;
+    const QJsonObject json =
+        QJsonDocument::fromJson(runProbe(ffprobe, {QStringLiteral("-v"), QStringLiteral("error"), QStringLiteral("-select_streams"),
+                                                   stream < 0 ? QStringLiteral("v:0") : QString::number(stream), QStringLiteral("-show_streams"),
+                                                   QStringLiteral("-show_format"), QStringLiteral("-of"), QStringLiteral("json"), resource}))
+            .object();
+    const QJsonArray streams = json.value(QStringLiteral("streams")).toArray();
+    if (streams.isEmpty()) {
+        return info;
+    }
+    const QJsonObject properties = streams.first().toObject();
+    if (properties.value(QStringLiteral("codec_type")).toString() != QLatin1String("video")) {
+        return info;
+    }
+    info.valid = true;
+    info.index = properties.value(QStringLiteral("index")).toInt();
+    info.codec = properties.value(QStringLiteral("codec_name")).toString();
+    info.pixelFormat = properties.value(QStringLiteral("pix_fmt")).toString();
+    info.fieldOrder = properties.value(QStringLiteral("field_order")).toString();
+    info.width = properties.value(QStringLiteral("width")).toInt();
+    info.height = properties.value(QStringLiteral("height")).toInt();
+    info.fps = ratio(properties.value(QStringLiteral("r_frame_rate")).toString());
+    const double sampleAspect = ratio(properties.value(QStringLiteral("sample_aspect_ratio")).toString());
+    if (sampleAspect > 0.) {
+        info.sampleAspect = sampleAspect;
+    }
+    info.start = properties.value(QStringLiteral("start_time")).toString().toDouble();
+    info.frames = properties.value(QStringLiteral("nb_frames")).toString().toInt();
+    if (info.frames <= 0) {
+        double duration = properties.value(QStringLiteral("duration")).toString().toDouble();
+        if (duration <= 0.) {
+            duration = json.value(QStringLiteral("format")).toObject().value(QStringLiteral("duration")).toString().toDouble();
+        }
+        info.frames = qRound(duration * info.fps);
+    }
+    info.profile = profileName(probedValue(properties, QStringLiteral("profile")));
+    info.level = properties.value(QStringLiteral("level")).toInt();
+    info.bitDepth = properties.value(QStringLiteral("bits_per_raw_sample")).toString().toInt();
+    if (info.bitDepth <= 0) {
+        info.bitDepth = bitDepth(info.pixelFormat);
+    }
+    info.refs = properties.value(QStringLiteral("refs")).toInt();
+    info.colorSpace = probedValue(properties, QStringLiteral("color_space"));
+    info.colorTransfer = probedValue(properties, QStringLiteral("color_transfer"));
+    info.colorPrimaries = probedValue(properties, QStringLiteral("color_primaries"));
+    info.colorRange = probedValue(properties, QStringLiteral("color_range"));
+    info.rotation = properties.value(QStringLiteral("tags")).toObject().value(QStringLiteral("rotate")).toString().toInt();
+    const QJsonArray sideData = properties.value(QStringLiteral("side_data_list")).toArray();
+    for (const QJsonValue &data : sideData) {
+        if (data.toObject().value(QStringLiteral("rotation")).toInt() != 0) {
+            info.rotation = data.toObject().value(QStringLiteral("rotation")).toInt();
+        }
+    }
+    return info;
+}
+
+/** @brief Returns the keyframes of the stream between @p from and @p to seconds where a copy can start or end, their frame number mapped to their time */
+QMap<int, QString> keyframes(const QString &ffprobe, const QString &resource, const StreamInfo &info, double from, double to)
+{
+    // Read a bit further than the range, the pictures following its last keyframe tell if that keyframe opens a closed GOP
+    const QString interval = QString::number(qMax(0., from), 'f', 6) + QLatin1Char('%') + QString::number(to + 1., 'f', 6);
+    const QByteArray output = runProbe(ffprobe, {QStringLiteral("-v"), QStringLiteral("error"), QStringLiteral("-select_streams"), QString::number(info.index),
+                                                 QStringLiteral("-read_intervals"), interval, QStringLiteral("-show_entries"),
+                                                 QStringLiteral("packet=pts_time,flags"), QStringLiteral("-of"), QStringLiteral("csv=p=0"), resource});
+    // Reading the packets does not decode the stream, it only takes a fraction of the time of the render
+    return SmartRender::closedKeyframes(output, info.start, info.fps);
+}
+} // namespace
+
+QString SmartRender::codecName(const QString &encoder)
+{
+    // Only codecs that the MPEG-TS segments can carry with their parameters in band
+    if (encoder == QLatin1String("libx264") || encoder.startsWith(QLatin1String("h264_"))) {
+        return QStringLiteral("h264");
+    }
+    if (encoder == QLatin1String("libx265") || encoder.startsWith(QLatin1String("hevc_"))) {
+        return QStringLiteral("hevc");
+    }
+    if (encoder == QLatin1String("mpeg2video") || encoder.startsWith(QLatin1String("mpeg2_"))) {
+        return QStringLiteral("mpeg2video");
+    }
+    return QString();
+}
+
+QMap<int, QString> SmartRender::closedKeyframes(const QByteArray &packets, double start, double fps)
+{
+    // The packets are listed in decoding order
+    QVector<QPair<double, QString>> times;
+    QVector<int> keys;
+    const QList<QByteArray> lines = packets.split('\n');
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> fields = line.trimmed().split(',');
+        if (fields.count() < 2) {
+            continue;
+        }
+        bool ok;
+        const double time = fields.at(0).toDouble(&ok);
+        if (!ok) {
+            continue;
+        }
+        if (fields.at(1).startsWith('K')) {
+            keys << times.count();
+        }
+        times.append({time, QString::fromLatin1(fields.at(0))});
+    }
+    QMap<int, QString> result;
+    for (int i = 0; i < keys.count(); ++i) {
+        const int key = keys.at(i);
+        const int next = i + 1 < keys.count() ? keys.at(i + 1) : times.count();
+        // Pictures decoded after an open GOP keyframe but displayed before it reference the previous GOP.
+        // Such a keyframe, or a recovery point flagged as keyframe, cannot start or end a copy
+        bool closed = true;
+        for (int j = key + 1; j < next && closed; ++j) {
+            closed = times.at(j).first >= times.at(key).first;
+        }
+        if (closed) {
+            result.insert(qRound((times.at(key).first - start) * fps), times.at(key).second);
+        }
+    }
+    return result;
+}
+
+QVector<SourceSpan> SmartRender::sourceSpans(const QDomDocument &doc, int in, int out, const QString &root)
+{
+    QVector<SourceSpan> spans = TimelineReader(doc, root).spans(in, out);
+    for (SourceSpan &span : spans) {
+        span.in += in;
+        span.out += in;
+    }
+    return spans;
+}
+
+QVector<CopyRange> SmartRender::copyRanges(const QDomDocument &doc, const QString &source, QMap<QString, QString> *encoderProperties)
+{
+    QVector<CopyRange> ranges;
+    const QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    const QDomElement profile = doc.documentElement().firstChildElement(QStringLiteral("profile"));
+    const QString codec = codecName(consumer.attribute(QStringLiteral("vcodec")));
+    if (codec.isEmpty()) {
+        qDebug() << "Cannot copy unmodified clips with the encoder" << consumer.attribute(QStringLiteral("vcodec"));
+        return ranges;
+    }
+    // The copied and encoded parts have their own parameter sets, only these containers keep them in band for the decoder
+    const QString format = consumer.attribute(QStringLiteral("f"));
+    if (format != QLatin1String("mpegts") && format != QLatin1String("matroska")) {
+        qDebug() << "Cannot copy unmodified clips in the format" << format;
+        return ranges;
+    }
+    const QString ffprobe = QStandardPaths::findExecutable(QStringLiteral("ffprobe"));
+    if (ffprobe.isEmpty()) {
+        qDebug() << "Cannot copy unmodified clips: ffprobe not found";
+        return ranges;
+    }
+    if (profile.attribute(QStringLiteral("progressive"), QStringLiteral("1")).toInt() != 1 || profile.attribute(QStringLiteral("frame_rate_den")).toInt() <= 0) {
+        qDebug() << "Cannot copy unmodified clips: interlaced or unknown profile";
+        return ranges;
+    }
+    const double fps = profile.attribute(QStringLiteral("frame_rate_num")).toDouble() / profile.attribute(QStringLiteral("frame_rate_den")).toDouble();
+    int width = consumer.attribute(QStringLiteral("width"), profile.attribute(QStringLiteral("width"))).toInt();
+    int height = consumer.attribute(QStringLiteral("height"), profile.attribute(QStringLiteral("height"))).toInt();
+    const double scale = consumer.attribute(QStringLiteral("scale")).toDouble();
+    if (scale > 0.) {
+        width = int(width * scale);
+        height = int(height * scale);
+    }
+    double sampleAspect = 1.;
+    if (profile.attribute(QStringLiteral("sample_aspect_den")).toInt() > 0) {
+        sampleAspect = profile.attribute(QStringLiteral("sample_aspect_num")).toDouble() / profile.attribute(QStringLiteral("sample_aspect_den")).toDouble();
+    }
+    // Hardware encoders are fed with the semi planar equivalent of the output pixel format
+    QString pixelFormat = consumer.attribute(QStringLiteral("pix_fmt"), QStringLiteral("yuv420p"));
+    if (pixelFormat == QLatin1String("nv12")) {
+        pixelFormat = QStringLiteral("yuv420p");
+    } else if (pixelFormat == QLatin1String("p010le")) {
+        pixelFormat = QStringLiteral("yuv420p10le");
+    }
+    // The stream properties set by the render, in the ffprobe format. MLT converts the frames to the colorspace of the profile
+    const int colorspace = consumer.attribute(QStringLiteral("colorspace"), profile.attribute(QStringLiteral("colorspace"))).toInt();
+    const QString colorSpace = colorSpaceName(colorspace > 0 ? colorspace : (height < 720 ? 601 : 709));
+    const QString rangeOption = consumer.attribute(QStringLiteral("color_range"));
+    const bool fullRange = rangeOption == QLatin1String("jpeg") || rangeOption == QLatin1String("pc") || rangeOption == QLatin1String("full");
+    const QString colorRange = fullRange ? QStringLiteral("pc") : QStringLiteral("tv");
+    const QString colorTransfer = consumer.attribute(QStringLiteral("color_trc"));
+    const QString colorPrimaries = consumer.attribute(QStringLiteral("color_primaries"));
+    const QString codecProfile = profileName(consumer.attribute(QStringLiteral("vprofile"), consumer.attribute(QStringLiteral("profile:v"))));
+    const int level = levelValue(codec, consumer.attribute(QStringLiteral("level")));
+    const int refs = consumer.attribute(QStringLiteral("refs")).toInt();
+    const int in = consumer.attribute(QStringLiteral("in")).toInt();
+    const int out = consumer.attribute(QStringLiteral("out")).toInt();
+    const int minimumLength = qMax(consumer.attribute(QStringLiteral("g")).toInt(), int(fps * MinimumCopySeconds));
+    // All the copied streams must have the parameters of the first one, the encoded parts are pinned to it
+    StreamInfo reference;
+
+    const QVector<SourceSpan> spans = sourceSpans(doc, in, out, QFileInfo(source).absolutePath());
+    QHash<QString, StreamInfo> streams;
+    for (const SourceSpan &span : spans) {
+        if (span.kind != SourceSpan::Source || span.out - span.in + 1 < minimumLength) {
+            continue;
+        }
+        const QString key = span.resource + QLatin1Char('#') + QString::number(span.stream);
+        if (!streams.contains(key)) {
+            StreamInfo info = probeStream(ffprobe, span.resource, span.stream);
+            QString reason;
+            if (!info.valid || info.codec != codec || info.pixelFormat != pixelFormat) {
+                reason = QStringLiteral("codec %1 %2 does not match the render").arg(info.codec, info.pixelFormat);
+            } else if (info.width != width || info.height != height || qAbs(info.sampleAspect - sampleAspect) > 1e-3) {
+                reason = QStringLiteral("frame size %1x%2 does not match the render").arg(info.width).arg(info.height);
+            } else if (qAbs(info.fps - fps) > fps * 1e-4) {
+                reason = QStringLiteral("frame rate %1 does not match the render").arg(info.fps);
+            } else if (info.rotation != 0) {
+                reason = QStringLiteral("rotated stream");
+            } else if (!info.fieldOrder.isEmpty() && info.fieldOrder != QLatin1String("progressive") && info.fieldOrder != QLatin1String("unknown")) {
+                reason = QStringLiteral("interlaced stream");
+            } else if (info.bitDepth != bitDepth(pixelFormat)) {
+                reason = QStringLiteral("bit depth %1 does not match the render").arg(info.bitDepth);
+            } else if ((!info.colorSpace.isEmpty() && info.colorSpace != colorSpace) || (!info.colorRange.isEmpty() && info.colorRange != colorRange) ||
+                       (!colorTransfer.isEmpty() && info.colorTransfer != colorTransfer) ||
+                       (!colorPrimaries.isEmpty() && info.colorPrimaries != colorPrimaries)) {
+                reason = QStringLiteral("colors %1 %2 %3 %4 do not match the render").arg(info.colorSpace, info.colorTransfer, info.colorPrimaries, info.colorRange);
+            } else if ((!codecProfile.isEmpty() && info.profile != codecProfile) || (level > 0 && info.level != level) || (refs > 0 && info.refs != refs)) {
+                reason = QStringLiteral("profile %1 level %2 with %3 reference frames does not match the render").arg(info.profile).arg(info.level).arg(info.refs);
+            } else if (reference.valid &&
+                       (info.profile != reference.profile || info.level != reference.level || info.refs != reference.refs ||
+                        info.colorSpace != reference.colorSpace || info.colorTransfer != reference.colorTransfer ||
+                        info.colorPrimaries != reference.colorPrimaries || info.colorRange != reference.colorRange)) {
+                reason = QStringLiteral("parameters differ from the other copied files");
+            }
+            if (!reason.isEmpty()) {
+                qDebug() << "Cannot copy" << span.resource << ":" << reason;
+                info.valid = false;
+            } else if (!reference.valid) {
+                reference = info;
+            }
+            streams.insert(key, info);
+        }
+        const StreamInfo info = streams.value(key);
+        if (!info.valid) {
+            continue;
+        }
+        // Copy whole closed groups of pictures: from the first closed keyframe of the clip to the frame before its last one
+        const int sourceOut = span.sourceIn + span.out - span.in;
+        const QMap<int, QString> keys = keyframes(ffprobe, span.resource, info, info.start + (span.sourceIn - 1) / fps, info.start + (sourceOut + 2) / fps);
+        const auto first = keys.lowerBound(span.sourceIn);
+        if (first == keys.constEnd()) {
+            continue;
+        }
+        int last = -1;
+        if (info.frames == sourceOut + 1) {
+            // The end of the file closes the last group of pictures
+            last = info.frames;
+        } else {
+            auto next = keys.upperBound(sourceOut + 1);
+            if (next != keys.constBegin()) {
+                last = (--next).key();
+            }
+        }
+        if (last - first.key() < minimumLength) {
+            continue;
+        }
+        const int copyIn = span.in + first.key() - span.sourceIn;
+        // Seek half a frame after the keyframe, so that the rounding of its time cannot select the previous one
+        ranges << CopyRange{copyIn, copyIn + last - first.key() - 1, span.resource, info.index, QString::number(first.value().toDouble() + 0.5 / fps, 'f', 6)};
+    }
+    if (encoderProperties && !ranges.isEmpty()) {
+        // Tag the encoded parts like the copied streams and let them use as many reference frames
+        encoderProperties->clear();
+        if (refs <= 0 && reference.refs > 0) {
+            encoderProperties->insert(QStringLiteral("refs"), QString::number(reference.refs));
+        }
+        if (colorTransfer.isEmpty() && !reference.colorTransfer.isEmpty()) {
+            encoderProperties->insert(QStringLiteral("color_trc"), reference.colorTransfer);
+        }
+        if (colorPrimaries.isEmpty() && !reference.colorPrimaries.isEmpty()) {
+            encoderProperties->insert(QStringLiteral("color_primaries"), reference.colorPrimaries);
+        }
+    }
+    return ranges;
+}
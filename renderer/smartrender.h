@@ -0,0 +1,76 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDomDocument>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+/** @brief What a range of the rendered timeline shows */
+struct SourceSpan
+{
+    enum Kind {
+        /** @brief Nothing but the black background */
+        Blank,
+        /** @brief A single file, displayed as is */
+        Source,
+        /** @brief Effects, compositions, generated clips or anything that has to be rendered */
+        Rendered
+    };
+    Kind kind;
+    /** @brief First and last frame of the range, in timeline frames */
+    int in;
+    int out;
+    /** @brief For a Source span, the absolute path of the file */
+    QString resource;
+    /** @brief For a Source span, the index of the video stream, -1 for the default stream */
+    int stream;
+    /** @brief For a Source span, the frame of the file displayed at @p in */
+    int sourceIn;
+};
+
+/** @brief A range of the render that can be stream copied from a file */
+struct CopyRange
+{
+    int in;
+    int out;
+    QString resource;
+    /** @brief Index of the video stream in the file */
+    int stream;
+    /** @brief Seek position of the first copied keyframe in the file, in seconds */
+    QString start;
+};
+
+/** @namespace SmartRender
+    @brief Find the parts of a render that can be copied from the source files without re-encoding.
+    The scene list is read as written by Kdenlive: a range can be copied when the only visible video is a
+    single clip without effects, speed change or compositions, from a file already encoded with the codec,
+    frame size, frame rate, pixel format and colors of the render. The copied part of such a range is reduced to
+    whole groups of pictures of the file, so it starts on a keyframe and ends right before the next one.
+    Only closed groups of pictures are copied, the range is encoded when the file uses open ones.
+    All the copied files must share their profile, level, reference frames and colors, and the render must
+    use a container carrying the parameter sets in band (MPEG-TS or Matroska), as the decoder switches
+    between those of the copied and encoded parts.
+ */
+namespace SmartRender {
+/** @brief Returns the codec produced by the ffmpeg @p encoder, if smart rendering supports it */
+QString codecName(const QString &encoder);
+/** @brief Returns the keyframes of the ffprobe packet list @p packets that open a closed group of pictures,
+ *  their frame number mapped to their time
+ *  @param packets the pts_time,flags csv output of ffprobe, in decoding order
+ *  @param start the time of the first frame of the stream
+ *  @param fps the frame rate of the stream */
+QMap<int, QString> closedKeyframes(const QByteArray &packets, double start, double fps);
+/** @brief Describe what the timeline of @p doc shows between @p in and @p out
+ *  @param root the folder used to resolve relative paths */
+QVector<SourceSpan> sourceSpans(const QDomDocument &doc, int in, int out, const QString &root);
+/** @brief Find the ranges of the render described by @p doc that can be stream copied, in timeline order
+ *  @param source the scene list of the render, used to resolve relative paths
+ *  @param encoderProperties if not null, set to the consumer properties that make the encoded parts match the copied streams */
+QVector<CopyRange> copyRanges(const QDomDocument &doc, const QString &source, QMap<QString, QString> *encoderProperties = nullptr);
+} // namespace SmartRender
@@ -96,6 +96,18 @@ protected:
     /** @brief Returns the path to the assets' preferred list*/
     virtual QString assetPreferredListPath() const = 0;
 
+    /** @brief Returns the name of the on-disk cache of this repository, or an empty string to disable caching */
+    virtual QString assetCacheName() const { return QString(); }
+
+    /** @brief Increment when the content of the assets cache changes */
+    static constexpr quint32 assetCacheVersion = 1;
+    static constexpr quint32 assetCacheMagic = 0x4b415243;
+    /** @brief Returns a key identifying the MLT install, language and custom asset files the repository is built from */
+    QByteArray assetCacheKey(Mlt::Properties *mltAssets) const;
+    /** @brief Fill the repository from the cache file if it was built with the given key */
+    bool loadAssetCache(const QString &cachePath, const QByteArray &key);
+    void saveAssetCache(const QString &cachePath, const QByteArray &key) const;
+
     std::unordered_map<QString, Info> m_assets;
 
     QSet<QString> m_blacklist;
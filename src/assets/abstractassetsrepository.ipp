@@ -6,9 +6,14 @@
 #include "xml/xml.hpp"
 #include "kdenlivesettings.h"
 #include "core.h"
+#include <config-kdenlive.h>
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QSaveFile>
 #include <QStandardPaths>
 #include <QString>
 #include <QTextStream>
@@ -31,6 +36,18 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
 
     // Retrieve the list of MLT's available assets.
     QScopedPointer<Mlt::Properties> assets(retrieveListFromMlt());
+
+    // Querying MLT's metadata for each asset is slow, reuse the previous result if nothing changed
+    QString cachePath;
+    QByteArray cacheKey;
+    if (!assetCacheName().isEmpty()) {
+        cachePath = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).absoluteFilePath(QStringLiteral("assets/") + assetCacheName());
+        cacheKey = assetCacheKey(assets.data());
+        if (loadAssetCache(cachePath, cacheKey)) {
+            return;
+        }
+    }
+
     QStringList emptyMetaAssets;
     int max = assets->count();
     QString sox = QStringLiteral("sox.");
@@ -80,6 +97,8 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
 
     // We add the custom assets
     QStringList missingDependency;
+    // Names of all MLT filters and transitions, only built if an asset has a dependency
+    QSet<QString> mltServices;
     for (const auto &custom : customAssets) {
         // Custom assets should override default ones
         if (emptyMetaAssets.contains(custom.second.mltId)) {
@@ -89,33 +108,23 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
         m_assets[custom.first] = custom.second;
 
         QString dependency = custom.second.xml.attribute(QStringLiteral("dependency"), QString());
-        if(!dependency.isEmpty()) {
-            bool found = false;
-            QScopedPointer<Mlt::Properties> effects(pCore->getMltRepository()->filters());
-            for(int i = 0; i < effects->count(); ++i) {
-                if(effects->get_name(i) == dependency) {
-                    found = true;
-                    break;
+        if (!dependency.isEmpty()) {
+            if (mltServices.isEmpty()) {
+                QScopedPointer<Mlt::Properties> effects(pCore->getMltRepository()->filters());
+                for (int i = 0; i < effects->count(); ++i) {
+                    mltServices.insert(effects->get_name(i));
                 }
-            }
-
-            if(!found) {
                 QScopedPointer<Mlt::Properties> transitions(pCore->getMltRepository()->transitions());
-                for(int i = 0; i < transitions->count(); ++i) {
-                    if(transitions->get_name(i) == dependency) {
-                        found = true;
-                        break;
-                    }
+                for (int i = 0; i < transitions->count(); ++i) {
+                    mltServices.insert(transitions->get_name(i));
                 }
             }
-
-            if(!found) {
+            if (!mltServices.contains(dependency)) {
                 // asset depends on another asset that is invalid so remove this asset too
                 missingDependency << custom.first;
                 qDebug() << "Asset" << custom.first << "has invalid dependency" << dependency << "and is going to be removed";
             }
         }
-
     }
     // Remove really invalid assets
     emptyMetaAssets << missingDependency;
@@ -123,6 +132,97 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
     for (const auto &invalid : qAsConst(emptyMetaAssets)) {
         m_assets.erase(invalid);
     }
+    if (!cachePath.isEmpty()) {
+        saveAssetCache(cachePath, cacheKey);
+    }
+}
+
+template <typename AssetType> QByteArray AbstractAssetsRepository<AssetType>::assetCacheKey(Mlt::Properties *mltAssets) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArrayLiteral(KDENLIVE_VERSION));
+    hash.addData(QByteArray(mlt_version_get_string()));
+    // Asset names and descriptions are translated
+    hash.addData(KLocalizedString::languages().join(QLatin1Char(',')).toUtf8());
+    for (int i = 0; i < mltAssets->count(); ++i) {
+        hash.addData(QByteArray(mltAssets->get_name(i)));
+    }
+    const QStringList dirs = assetDirs();
+    for (const QString &dir : dirs) {
+        const QFileInfoList files = QDir(dir).entryInfoList({QStringLiteral("*.xml")}, QDir::Files, QDir::Name);
+        for (const QFileInfo &file : files) {
+            hash.addData(file.absoluteFilePath().toUtf8());
+            hash.addData(QByteArray::number(file.lastModified().toMSecsSinceEpoch()));
+            hash.addData(QByteArray::number(file.size()));
+        }
+    }
+    return hash.result();
+}
+
+template <typename AssetType> bool AbstractAssetsRepository<AssetType>::loadAssetCache(const QString &cachePath, const QByteArray &key)
+{
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    quint32 magic;
+    quint32 version;
+    QByteArray cachedKey;
+    stream >> magic >> version >> cachedKey;
+    if (magic != assetCacheMagic || version != assetCacheVersion || cachedKey != key) {
+        return false;
+    }
+    quint32 count;
+    stream >> count;
+    std::unordered_map<QString, Info> assets;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString assetId;
+        Info info;
+        qint32 type;
+        QString xml;
+        stream >> assetId >> info.id >> info.mltId >> info.name >> info.description >> info.author >> info.version_str >> info.version >> type >> xml;
+        info.type = AssetType(type);
+        if (!xml.isEmpty()) {
+            QDomDocument doc;
+            if (!doc.setContent(xml)) {
+                return false;
+            }
+            info.xml = doc.documentElement();
+        }
+        assets[assetId] = info;
+    }
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "Corrupted assets cache" << cachePath;
+        return false;
+    }
+    m_assets = std::move(assets);
+    return true;
+}
+
+template <typename AssetType> void AbstractAssetsRepository<AssetType>::saveAssetCache(const QString &cachePath, const QByteArray &key) const
+{
+    QDir().mkpath(QFileInfo(cachePath).absolutePath());
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write assets cache" << cachePath;
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream << assetCacheMagic << assetCacheVersion << key << quint32(m_assets.size());
+    for (const auto &asset : m_assets) {
+        const Info &info = asset.second;
+        QString xml;
+        if (!info.xml.isNull()) {
+            QTextStream xmlStream(&xml);
+            info.xml.save(xmlStream, 0);
+        }
+        stream << asset.first << info.id << info.mltId << info.name << info.description << info.author << info.version_str << qint32(info.version)
+               << qint32(info.type) << xml;
+    }
+    file.commit();
 }
 
 template <typename AssetType> void AbstractAssetsRepository<AssetType>::parseAssetList(const QString &filePath, QSet<QString> &destination)
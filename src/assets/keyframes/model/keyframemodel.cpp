@@ -16,6 +16,7 @@
 #include <QJsonDocument>
 #include <QLineF>
 #include <QSize>
+#include <algorithm>
 #include <mlt++/Mlt.h>
 #include <utility>
 
@@ -54,6 +55,9 @@ void KeyframeModel::setup()
         Q_EMIT modelChanged();
     });
     connect(this, &KeyframeModel::modelChanged, this, &KeyframeModel::sendModification);
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(80);
+    connect(&m_updateTimer, &QTimer::timeout, this, &KeyframeModel::applyModification);
 }
 
 bool KeyframeModel::addKeyframe(GenTime pos, KeyframeType type, QVariant value, bool notify, Fun &undo, Fun &redo)
@@ -532,6 +536,7 @@ Fun KeyframeModel::updateKeyframe_lambda(GenTime pos, KeyframeType type, const Q
         int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
         m_keyframeList[pos].first = type;
         m_keyframeList[pos].second = value;
+        invalidateCurve();
         if (notify) Q_EMIT dataChanged(index(row), index(row), {ValueRole, NormalizedValueRole, TypeRole});
         return true;
     };
@@ -552,6 +557,7 @@ Fun KeyframeModel::addKeyframe_lambda(GenTime pos, KeyframeType type, const QVar
         if (notify) beginInsertRows(QModelIndex(), insertionRow, insertionRow);
         m_keyframeList[pos].first = type;
         m_keyframeList[pos].second = value;
+        invalidateCurve();
         if (notify) endInsertRows();
         return true;
     };
@@ -568,6 +574,7 @@ Fun KeyframeModel::deleteKeyframe_lambda(GenTime pos, bool notify)
         int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
         if (notify) beginRemoveRows(QModelIndex(), row, row);
         m_keyframeList.erase(pos);
+        invalidateCurve();
         if (notify) endRemoveRows();
         qDebug() << "after" << getAnimProperty();
         return true;
@@ -1102,6 +1109,53 @@ QVariant KeyframeModel::getNormalizedValue(double newVal) const
     return QVariant();
 }
 
+void KeyframeModel::invalidateCurve()
+{
+    QMutexLocker lock(&m_curveMutex);
+    m_curveValid = false;
+}
+
+void KeyframeModel::compileCurve() const
+{
+    const double fps = pCore->getCurrentFps();
+    const bool mltAnimation = m_paramType == ParamType::AnimatedRect || m_paramType == ParamType::Color;
+    int length = 0;
+    if (mltAnimation) {
+        if (auto ptr = m_model.lock()) {
+            length = ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
+        }
+    }
+    if (m_curveValid && qFuzzyCompare(m_curveFps, fps) && length == m_curveLength) {
+        return;
+    }
+    m_curveFrames.clear();
+    m_curveValues.clear();
+    m_curveTypes.clear();
+    m_curveProperties.reset();
+    if (mltAnimation) {
+        // Let MLT parse the animation once, queries then don't need to reparse it
+        m_curveProperties.reset(new Mlt::Properties());
+        if (auto ptr = m_model.lock()) {
+            ptr->passProperties(*m_curveProperties.get());
+        }
+        m_curveProperties->set("key", getAnimProperty().toUtf8().constData());
+        // This is a fake query to force the animation to be parsed
+        (void)m_curveProperties->anim_get_double("key", 0, length);
+    } else {
+        m_curveFrames.reserve(m_keyframeList.size());
+        m_curveValues.reserve(m_keyframeList.size());
+        m_curveTypes.reserve(m_keyframeList.size());
+        for (const auto &keyframe : m_keyframeList) {
+            m_curveFrames.push_back(keyframe.first.frames(fps));
+            m_curveValues.push_back(keyframe.second.second.toDouble());
+            m_curveTypes.push_back(keyframe.second.first);
+        }
+    }
+    m_curveFps = fps;
+    m_curveLength = length;
+    m_curveValid = true;
+}
+
 QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
 {
     if (m_keyframeList.count(pos) > 0) {
@@ -1110,39 +1164,56 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
     if (m_keyframeList.size() == 0) {
         return QVariant();
     }
-    Mlt::Properties mlt_prop;
-    QString animData;
-    int out = 0;
-    bool useOpacity = false;
-    if (auto ptr = m_model.lock()) {
-        ptr->passProperties(mlt_prop);
-        out = ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
-        useOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
-        animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
-    }
-
-    if (!animData.isEmpty() && (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel)) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        return QVariant(mlt_prop.anim_get_double("key", pos.frames(pCore->getCurrentFps())));
+    if (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel) {
+        QMutexLocker lock(&m_curveMutex);
+        compileCurve();
+        // Same interpolation as MLT's animation, but with a binary search on the cached keyframes
+        const int frame = pos.frames(m_curveFps);
+        auto next = std::upper_bound(m_curveFrames.cbegin(), m_curveFrames.cend(), frame);
+        if (next == m_curveFrames.cbegin()) {
+            return QVariant(m_curveValues.front());
+        }
+        if (next == m_curveFrames.cend()) {
+            return QVariant(m_curveValues.back());
+        }
+        const size_t ix = size_t(std::distance(m_curveFrames.cbegin(), next)) - 1;
+        const double y1 = m_curveValues[ix];
+        const double y2 = m_curveValues[ix + 1];
+        const double t = double(frame - m_curveFrames[ix]) / (m_curveFrames[ix + 1] - m_curveFrames[ix]);
+        switch (m_curveTypes[ix]) {
+        case KeyframeType::Discrete:
+            return QVariant(y1);
+        case KeyframeType::Curve: {
+            // Catmull-Rom spline, using the surrounding keyframes when they exist
+            const double y0 = ix > 0 ? m_curveValues[ix - 1] : y1;
+            const double y3 = ix + 2 < m_curveValues.size() ? m_curveValues[ix + 2] : y2;
+            const double a0 = -0.5 * y0 + 1.5 * y1 - 1.5 * y2 + 0.5 * y3;
+            const double a1 = y0 - 2.5 * y1 + 2 * y2 - 0.5 * y3;
+            const double a2 = -0.5 * y0 + 0.5 * y2;
+            return QVariant(((a0 * t + a1) * t + a2) * t + y1);
+        }
+        default:
+            return QVariant(y1 + (y2 - y1) * t);
+        }
     }
-    if (!animData.isEmpty() && m_paramType == ParamType::AnimatedRect) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        mlt_rect rect = mlt_prop.anim_get_rect("key", pos.frames(pCore->getCurrentFps()));
+    if (m_paramType == ParamType::AnimatedRect) {
+        bool useOpacity = false;
+        if (auto ptr = m_model.lock()) {
+            useOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
+        }
+        QMutexLocker lock(&m_curveMutex);
+        compileCurve();
+        mlt_rect rect = m_curveProperties->anim_get_rect("key", pos.frames(m_curveFps));
         QString res = QStringLiteral("%1 %2 %3 %4").arg(int(rect.x)).arg(int(rect.y)).arg(int(rect.w)).arg(int(rect.h));
         if (useOpacity) {
             res.append(QStringLiteral(" %1").arg(QString::number(rect.o, 'f')));
         }
         return QVariant(res);
     }
-    if (!animData.isEmpty() && m_paramType == ParamType::Color) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        mlt_color mltColor = mlt_prop.anim_get_color("key", pos.frames(pCore->getCurrentFps()));
+    if (m_paramType == ParamType::Color) {
+        QMutexLocker lock(&m_curveMutex);
+        compileCurve();
+        mlt_color mltColor = m_curveProperties->anim_get_color("key", pos.frames(m_curveFps));
         QColor color(mltColor.r, mltColor.g, mltColor.b, mltColor.a);
         return QVariant(QColorUtils::colorToString(color, true));
     }
@@ -1191,6 +1262,27 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
 }
 
 void KeyframeModel::sendModification()
+{
+    if (m_throttleUpdates) {
+        // Serializing and reparsing the animation is expensive, only update once in a while
+        if (!m_updateTimer.isActive()) {
+            m_updateTimer.start();
+        }
+        return;
+    }
+    applyModification();
+}
+
+void KeyframeModel::setThrottleUpdates(bool throttle)
+{
+    m_throttleUpdates = throttle;
+    if (!throttle && m_updateTimer.isActive()) {
+        m_updateTimer.stop();
+        applyModification();
+    }
+}
+
+void KeyframeModel::applyModification()
 {
     if (auto ptr = m_model.lock()) {
         Q_ASSERT(m_index.isValid());
@@ -11,10 +11,13 @@
 #include "utils/gentime.h"
 
 #include <QAbstractListModel>
+#include <QMutex>
 #include <QReadWriteLock>
+#include <QTimer>
 
 #include <map>
 #include <memory>
+#include <vector>
 
 class AssetParameterModel;
 class DocUndoStack;
@@ -87,6 +90,9 @@ public:
     bool offsetKeyframes(int oldPos, int pos, bool logUndo);
     bool moveKeyframe(GenTime oldPos, GenTime pos, QVariant newVal, bool logUndo);
     bool moveKeyframe(GenTime oldPos, GenTime pos, const QVariant &newVal, Fun &undo, Fun &redo, bool updateView = true);
+    /** @brief When enabled, the keyframes are passed to the asset at most every few milliseconds instead of on each change,
+        used during interactive moves. Disabling it immediately commits pending changes */
+    void setThrottleUpdates(bool throttle);
 
     /** @brief updates the value of a keyframe
        @param old is the position of the keyframe
@@ -175,8 +181,10 @@ protected:
     /** @brief Connects the signals of this object */
     void setup();
 
-    /** @brief Commit the modification to the model */
+    /** @brief Commit the modification to the model, or schedule it if updates are throttled */
     void sendModification();
+    /** @brief Serialize the keyframes and pass them to the asset */
+    void applyModification();
 
     /** @brief returns the keyframes as a Mlt Anim Property string.
         It is defined as pairs of frame and value, separated by ;
@@ -203,6 +211,25 @@ private:
     mutable QReadWriteLock m_lock;
 
     std::map<GenTime, std::pair<KeyframeType, QVariant>> m_keyframeList;
+    /** @brief Cached copy of the keyframes in sorted arrays, used to answer interpolation queries without MLT round-trips */
+    mutable std::vector<int> m_curveFrames;
+    mutable std::vector<double> m_curveValues;
+    mutable std::vector<KeyframeType> m_curveTypes;
+    /** @brief Parsed animation for parameter types that MLT has to interpolate (rect, color) */
+    mutable std::unique_ptr<Mlt::Properties> m_curveProperties;
+    mutable double m_curveFps{-1.};
+    /** @brief Duration of the owner when m_curveProperties was parsed, keyframes relative to the end depend on it */
+    mutable int m_curveLength{-1};
+    mutable bool m_curveValid{false};
+    mutable QMutex m_curveMutex;
+    /** @brief Used to throttle the asset updates, see setThrottleUpdates() */
+    QTimer m_updateTimer;
+    bool m_throttleUpdates{false};
+    /** @brief Rebuild the interpolation cache if the keyframes, the frame rate or the owner duration changed since the last query.
+        Must be called with m_curveMutex locked */
+    void compileCurve() const;
+    /** @brief Mark the interpolation cache as outdated, must be called on every keyframe change */
+    void invalidateCurve();
     bool moveOneKeyframe(GenTime oldPos, GenTime pos, QVariant newVal, Fun &undo, Fun &redo, bool updateView = true);
 
 Q_SIGNALS:
@@ -234,6 +234,13 @@ bool KeyframeModelList::moveKeyframeWithUndo(GenTime oldPos, GenTime pos, Fun &u
     return result;
 }
 
+void KeyframeModelList::setThrottleUpdates(bool throttle)
+{
+    for (const auto &param : m_parameters) {
+        param.second->setThrottleUpdates(throttle);
+    }
+}
+
 bool KeyframeModelList::updateKeyframe(GenTime oldPos, GenTime pos, const QVariant &normalizedVal, bool logUndo)
 {
     QWriteLocker locker(&m_lock);
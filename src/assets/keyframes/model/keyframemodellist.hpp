@@ -63,6 +63,8 @@ public:
     */
     bool moveKeyframe(GenTime oldPos, GenTime pos, bool logUndo, bool updateView = true);
     bool moveKeyframeWithUndo(GenTime oldPos, GenTime pos, Fun &undo, Fun &redo);
+    /** @brief Throttle the asset updates of all parameters during an interactive keyframe move, see KeyframeModel::setThrottleUpdates() */
+    void setThrottleUpdates(bool throttle);
 
     /** @brief updates the value of a keyframe
        @param old is the position of the keyframe
@@ -470,6 +470,10 @@ void KeyframeView::mouseMoveEvent(QMouseEvent *event)
         if (m_model->activeKeyframe() > 0 && m_currentKeyframeOriginal > -1 && m_clickPoint == -1 &&
             (m_moveKeyframeMode ||
              (qAbs(pos - (m_currentKeyframeOriginal - offset)) * m_scale * m_zoomFactor < QApplication::startDragDistance() && m_keyframeZonePress))) {
+            if (!m_moveKeyframeMode) {
+                // Don't rebuild the whole animation on each mouse move
+                m_model->setThrottleUpdates(true);
+            }
             m_moveKeyframeMode = true;
             if (!m_model->hasKeyframe(pos + offset)) {
                 int delta = pos - (m_model->getPosAtIndex(m_model->activeKeyframe()).frames(pCore->getCurrentFps()) - offset);
@@ -644,6 +648,9 @@ void KeyframeView::mouseReleaseEvent(QMouseEvent *event)
         pCore->pushUndo(undo, redo, i18np("Move keyframe", "Move keyframes", m_model->selectedKeyframes().size()));
         qDebug() << "RELEASING keyframe move" << delta;
     }
+    if (m_moveKeyframeMode) {
+        m_model->setThrottleUpdates(false);
+    }
     m_moveKeyframeMode = false;
     m_keyframeZonePress = false;
 }
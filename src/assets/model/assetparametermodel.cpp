@@ -30,6 +30,7 @@ AssetParameterModel::AssetParameterModel(std::unique_ptr<Mlt::Properties> asset,
     , m_keyframes(nullptr)
     , m_activeKeyframe(-1)
     , m_filterProgress(0)
+    , m_hasDynamicAttributes(false)
 {
     Q_ASSERT(m_asset->is_valid());
     QDomNodeList parameterNodes = assetXml.elementsByTagName(QStringLiteral("parameter"));
@@ -105,8 +106,11 @@ AssetParameterModel::AssetParameterModel(std::unique_ptr<Mlt::Properties> asset,
         ParamRow currentRow;
         currentRow.type = paramTypeFromStr(type);
         currentRow.xml = currentParameter;
+        if (compileDescriptor(currentRow)) {
+            m_hasDynamicAttributes = true;
+        }
         if (value.isEmpty()) {
-            QVariant defaultValue = parseAttribute(m_ownerId, QStringLiteral("default"), currentParameter);
+            QVariant defaultValue = currentRow.descriptor.defaultValue.value;
             value = defaultValue.toString();
             qDebug() << "QLocale: Default value is" << defaultValue << "parsed:" << value;
         }
@@ -220,6 +224,9 @@ AssetParameterModel::AssetParameterModel(std::unique_ptr<Mlt::Properties> asset,
     }
 
     qDebug() << "END parsing of " << assetId << ". Number of found parameters" << m_rows.size();
+    if (m_hasDynamicAttributes) {
+        connect(pCore.get(), &Core::monitorProfileUpdated, this, &AssetParameterModel::updateDescriptors);
+    }
     Q_EMIT modelChanged();
 }
 
@@ -433,7 +440,7 @@ AssetParameterModel::~AssetParameterModel() = default;
 
 QVariant AssetParameterModel::data(const QModelIndex &index, int role) const
 {
-    const QVector<int> bypassRoles = {AssetParameterModel::InRole,
+    static const QVector<int> bypassRoles = {AssetParameterModel::InRole,
                                       AssetParameterModel::OutRole,
                                       AssetParameterModel::ParentInRole,
                                       AssetParameterModel::ParentDurationRole,
@@ -469,6 +476,7 @@ QVariant AssetParameterModel::data(const QModelIndex &index, int role) const
     QString paramName = m_rows[index.row()];
     Q_ASSERT(m_params.count(paramName) > 0);
     const QDomElement &element = m_params.at(paramName).xml;
+    const ParamDescriptor &descriptor = m_params.at(paramName).descriptor;
     switch (role) {
     case Qt::DisplayRole:
     case Qt::EditRole:
@@ -486,23 +494,23 @@ QVariant AssetParameterModel::data(const QModelIndex &index, int role) const
         return comment;
     }
     case MinRole:
-        return parseAttribute(m_ownerId, QStringLiteral("min"), element);
+        return descriptor.min.value;
     case MaxRole:
-        return parseAttribute(m_ownerId, QStringLiteral("max"), element);
+        return descriptor.max.value;
     case FactorRole:
-        return parseAttribute(m_ownerId, QStringLiteral("factor"), element, 1);
+        return descriptor.factor.value;
     case ScaleRole:
-        return parseAttribute(m_ownerId, QStringLiteral("scale"), element, 0);
+        return descriptor.scale.value;
     case DecimalsRole:
-        return parseAttribute(m_ownerId, QStringLiteral("decimals"), element);
+        return descriptor.decimals.value;
     case OddRole:
         return element.attribute(QStringLiteral("odd")) == QLatin1String("1");
     case VisualMinRole:
-        return parseAttribute(m_ownerId, QStringLiteral("visualmin"), element);
+        return descriptor.visualMin.value;
     case VisualMaxRole:
-        return parseAttribute(m_ownerId, QStringLiteral("visualmax"), element);
+        return descriptor.visualMax.value;
     case DefaultRole:
-        return parseAttribute(m_ownerId, QStringLiteral("default"), element);
+        return descriptor.defaultValue.value;
     case FilterRole:
         return parseAttribute(m_ownerId, QStringLiteral("filter"), element);
     case FilterParamsRole:
@@ -546,15 +554,14 @@ QVariant AssetParameterModel::data(const QModelIndex &index, int role) const
                 values << val;
             }
             if (!valueFound) {
-                return (element.attribute(QStringLiteral("value")).isNull() ? parseAttribute(m_ownerId, QStringLiteral("default"), element)
-                                                                            : element.attribute(QStringLiteral("value")));
+                return (element.attribute(QStringLiteral("value")).isNull() ? descriptor.defaultValue.value : element.attribute(QStringLiteral("value")));
             }
             return values.join(QLatin1Char('\n'));
         }
         QString value(m_asset->get(paramName.toUtf8().constData()));
         if (value.isEmpty()) {
             if (element.hasAttribute(QStringLiteral("default"))) {
-                value = parseAttribute(m_ownerId, QStringLiteral("default"), element).toString();
+                value = descriptor.defaultValue.value.toString();
             } else {
                 value = element.attribute(QStringLiteral("value"));
             }
@@ -762,11 +769,15 @@ QVariant AssetParameterModel::parseAttribute(const ObjectId &owner, const QStrin
             return defaultValue;
         }
     }
+    const bool adjustCenter = type == ParamType::AnimatedRect && content == QLatin1String("adjustcenter");
+    if (!adjustCenter && !content.contains(QLatin1Char('%'))) {
+        return parseStaticAttribute(type, attribute, content, defaultValue);
+    }
     std::unique_ptr<ProfileModel> &profile = pCore->getCurrentProfile();
     int width = profile->width();
     int height = profile->height();
     QSize frameSize = pCore->getItemFrameSize(owner);
-    if (type == ParamType::AnimatedRect && content == "adjustcenter" && !frameSize.isEmpty()) {
+    if (adjustCenter && !frameSize.isEmpty()) {
         int contentHeight = height;
         int contentWidth = width;
         double sourceDar = frameSize.width() / frameSize.height();
@@ -829,7 +840,13 @@ QVariant AssetParameterModel::parseAttribute(const ObjectId &owner, const QStrin
             p.set("eval", content.prepend(QLatin1Char('@')).toLatin1().constData());
             return p.get_double("eval");
         }
-    } else if (type == ParamType::Double || type == ParamType::Hidden) {
+    }
+    return parseStaticAttribute(type, attribute, content, defaultValue);
+}
+
+QVariant AssetParameterModel::parseStaticAttribute(ParamType type, const QString &attribute, const QString &content, const QVariant &defaultValue)
+{
+    if (type == ParamType::Double || type == ParamType::Hidden) {
         if (attribute == QLatin1String("default")) {
             if (content.isEmpty()) {
                 return QVariant();
@@ -860,6 +877,50 @@ QVariant AssetParameterModel::parseAttribute(const ObjectId &owner, const QStrin
     return content;
 }
 
+AssetParameterModel::CachedAttribute AssetParameterModel::compileAttribute(const QString &attribute, const QDomElement &element, QVariant defaultValue) const
+{
+    CachedAttribute cached;
+    const ParamType type = paramTypeFromStr(element.attribute(QStringLiteral("type")));
+    const QString content = element.attribute(attribute);
+    // Depends on the profile, the owner or the installed files
+    cached.dynamic = content.contains(QLatin1Char('%')) || (type == ParamType::AnimatedRect && content == QLatin1String("adjustcenter")) ||
+                     (type == ParamType::UrlList && attribute == QLatin1String("default") &&
+                      element.attribute(QStringLiteral("paramlist")) == QLatin1String("%lutPaths"));
+    cached.value = parseAttribute(m_ownerId, attribute, element, defaultValue);
+    return cached;
+}
+
+bool AssetParameterModel::compileDescriptor(ParamRow &row, bool dynamicOnly) const
+{
+    bool dynamic = false;
+    auto compile = [this, &row, dynamicOnly, &dynamic](CachedAttribute &cached, const QString &attribute, const QVariant &defaultValue) {
+        if (!dynamicOnly || cached.dynamic) {
+            cached = compileAttribute(attribute, row.xml, defaultValue);
+        }
+        dynamic = dynamic || cached.dynamic;
+    };
+    ParamDescriptor &descriptor = row.descriptor;
+    compile(descriptor.min, QStringLiteral("min"), QVariant());
+    compile(descriptor.max, QStringLiteral("max"), QVariant());
+    compile(descriptor.factor, QStringLiteral("factor"), 1);
+    compile(descriptor.scale, QStringLiteral("scale"), 0);
+    compile(descriptor.decimals, QStringLiteral("decimals"), QVariant());
+    compile(descriptor.visualMin, QStringLiteral("visualmin"), QVariant());
+    compile(descriptor.visualMax, QStringLiteral("visualmax"), QVariant());
+    compile(descriptor.defaultValue, QStringLiteral("default"), QVariant());
+    return dynamic;
+}
+
+void AssetParameterModel::updateDescriptors()
+{
+    if (!m_hasDynamicAttributes) {
+        return;
+    }
+    for (auto &param : m_params) {
+        compileDescriptor(param.second, true);
+    }
+}
+
 QVariant AssetParameterModel::parseSubAttributes(const QString &attribute, const QDomElement &element) const
 {
     QDomNodeList nodeList = element.elementsByTagName(attribute);
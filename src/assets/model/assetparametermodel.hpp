@@ -197,6 +197,9 @@ public:
     Mlt::Properties *getAsset();
     /** @brief Returns a frame time as click time (00:00:00.000) */
     const QString framesToTime(int t) const;
+    /** @brief Evaluate again the parameter attributes using keywords like %width or %out.
+     *  This must be called when the profile, the duration or the frame size of the owner change */
+    void updateDescriptors();
 
 public Q_SLOTS:
     /** @brief Sets the value of a list of parameters
@@ -222,6 +225,8 @@ protected:
        If keywords are found, mathematical operations are supported for double type params. For example "%width -1" is a valid value.
     */
     QVariant parseAttribute(const ObjectId &owner, const QString &attribute, const QDomElement &element, QVariant defaultValue = QVariant()) const;
+    /** @brief Helper function for parseAttribute(), handles attribute contents without keywords */
+    static QVariant parseStaticAttribute(ParamType type, const QString &attribute, const QString &content, const QVariant &defaultValue);
     QVariant parseSubAttributes(const QString &attribute, const QDomElement &element) const;
 
     /** @brief Helper function to register one more parameter that is keyframable.
@@ -229,14 +234,42 @@ protected:
     */
     void addKeyframeParam(const QModelIndex &index);
 
+    /** @brief An attribute of a parameter, evaluated when the model is built */
+    struct CachedAttribute
+    {
+        QVariant value;
+        /** @brief True if the attribute uses keywords depending on the profile or on the owner, see updateDescriptors() */
+        bool dynamic{false};
+    };
+
+    /** @brief The attributes of a parameter that are frequently queried by the views */
+    struct ParamDescriptor
+    {
+        CachedAttribute min;
+        CachedAttribute max;
+        CachedAttribute factor;
+        CachedAttribute scale;
+        CachedAttribute decimals;
+        CachedAttribute visualMin;
+        CachedAttribute visualMax;
+        CachedAttribute defaultValue;
+    };
+
     struct ParamRow
     {
         ParamType type;
         QDomElement xml;
         QVariant value;
         QString name;
+        ParamDescriptor descriptor;
     };
 
+    /** @brief Parse an attribute for the descriptor, see parseAttribute() */
+    CachedAttribute compileAttribute(const QString &attribute, const QDomElement &element, QVariant defaultValue = QVariant()) const;
+    /** @brief Fill the descriptor of a parameter, returns true if some of its attributes are dynamic
+     *  @param dynamicOnly if true, only evaluate again the dynamic attributes */
+    bool compileDescriptor(ParamRow &row, bool dynamicOnly = false) const;
+
     QString m_assetId;
     ObjectId m_ownerId;
     bool m_active;
@@ -260,6 +293,8 @@ protected:
     bool m_isAudio;
     /** @brief Store a filter's job progress */
     int m_filterProgress;
+    /** @brief true if some parameter attributes depend on the profile or on the owner */
+    bool m_hasDynamicAttributes;
 
     /** @brief Set the parameter with given name to the given value. This should be called when first
      *  building an effect in the constructor, so that we don't call shared_from_this
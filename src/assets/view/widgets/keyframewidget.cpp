@@ -689,12 +689,16 @@ void KeyframeWidget::connectMonitor(bool active)
         connect(monitor, &Monitor::addRemoveKeyframe, m_keyframeview, &KeyframeView::slotAddRemove, Qt::UniqueConnection);
         connect(this, &KeyframeWidget::updateEffectKeyframe, monitor, &Monitor::setEffectKeyframe, Qt::DirectConnection);
         connect(monitor, &Monitor::seekToKeyframe, this, &KeyframeWidget::slotSeekToKeyframe, Qt::UniqueConnection);
+        // Dragging a rectangle or spline on the monitor changes the keyframe on each mouse move
+        connect(monitor, &Monitor::effectDragged, m_keyframes.get(), &KeyframeModelList::setThrottleUpdates, Qt::UniqueConnection);
     } else {
         disconnect(monitor, &Monitor::seekToNextKeyframe, m_keyframeview, &KeyframeView::slotGoToNext);
         disconnect(monitor, &Monitor::seekToPreviousKeyframe, m_keyframeview, &KeyframeView::slotGoToPrev);
         disconnect(monitor, &Monitor::addRemoveKeyframe, m_keyframeview, &KeyframeView::slotAddRemove);
         disconnect(this, &KeyframeWidget::updateEffectKeyframe, monitor, &Monitor::setEffectKeyframe);
         disconnect(monitor, &Monitor::seekToKeyframe, this, &KeyframeWidget::slotSeekToKeyframe);
+        disconnect(monitor, &Monitor::effectDragged, m_keyframes.get(), &KeyframeModelList::setThrottleUpdates);
+        m_keyframes->setThrottleUpdates(false);
     }
     for (const auto &w : m_parameters) {
         auto type = m_model->data(w.first, AssetParameterModel::TypeRole).value<ParamType>();
@@ -0,0 +1,73 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "audiolevelbuffer.hpp"
+#include <QtGlobal>
+
+constexpr int AudioLevelBuffer::MaxChannels;
+
+AudioLevelBuffer::AudioLevelBuffer(int capacity)
+    : m_slots(new Slot[size_t(qMax(1, capacity))])
+    , m_capacity(qMax(1, capacity))
+{
+}
+
+void AudioLevelBuffer::publish(int position, const double *levels, int channels)
+{
+    if (position < 0) {
+        return;
+    }
+    channels = qBound(0, channels, MaxChannels);
+    Slot &slot = m_slots[size_t(position % m_capacity)];
+    // An odd sequence tells readers that the slot is being written
+    const quint32 sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.position.store(position, std::memory_order_relaxed);
+    slot.generation.store(m_generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    slot.channels.store(channels, std::memory_order_relaxed);
+    for (int i = 0; i < channels; ++i) {
+        slot.levels[size_t(i)].store(levels[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool AudioLevelBuffer::read(int position, QVector<double> &levels) const
+{
+    if (position < 0) {
+        return false;
+    }
+    const Slot &slot = m_slots[size_t(position % m_capacity)];
+    std::array<double, MaxChannels> values;
+    const quint32 sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence & 1) {
+        // Being written, this frame is not ready
+        return false;
+    }
+    const int storedPosition = slot.position.load(std::memory_order_relaxed);
+    const quint32 generation = slot.generation.load(std::memory_order_relaxed);
+    const int channels = slot.channels.load(std::memory_order_relaxed);
+    for (int i = 0; i < channels; ++i) {
+        values[size_t(i)] = slot.levels[size_t(i)].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+        // Overwritten while we were reading
+        return false;
+    }
+    if (storedPosition != position || generation != m_generation.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    levels.resize(channels);
+    for (int i = 0; i < channels; ++i) {
+        levels[i] = values[size_t(i)];
+    }
+    return true;
+}
+
+void AudioLevelBuffer::clear()
+{
+    m_generation.fetch_add(1, std::memory_order_relaxed);
+}
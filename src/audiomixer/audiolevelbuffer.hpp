@@ -0,0 +1,50 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QVector>
+#include <array>
+#include <atomic>
+#include <memory>
+
+/** @class AudioLevelBuffer
+    @brief A lock-free ring buffer storing the audio levels of the last frames of a track, indexed by frame position.
+    The levels are published by MLT's consumer thread from the audiolevel filter and read by the mixer
+    from the GUI thread when the frame is displayed. Each slot is protected by a sequence counter, so
+    neither side ever blocks: a reader simply reports missing levels if the slot is being overwritten.
+    Only one thread may publish at a time.
+ */
+class AudioLevelBuffer
+{
+public:
+    /** @brief Maximum number of audio channels stored per frame */
+    static constexpr int MaxChannels = 8;
+
+    /** @param capacity the number of frames kept in the buffer */
+    explicit AudioLevelBuffer(int capacity);
+
+    /** @brief Store the levels of the frame at @p position, overwriting the oldest frame */
+    void publish(int position, const double *levels, int channels);
+    /** @brief Fetch the levels of the frame at @p position
+        @return false if the levels for this frame are not available */
+    bool read(int position, QVector<double> &levels) const;
+    /** @brief Discard all stored levels, for example when a filter affecting the levels changed */
+    void clear();
+
+private:
+    struct Slot
+    {
+        std::atomic<quint32> sequence{0};
+        std::atomic<int> position{-1};
+        std::atomic<quint32> generation{0};
+        std::atomic<int> channels{0};
+        std::array<std::atomic<double>, MaxChannels> levels;
+    };
+    std::unique_ptr<Slot[]> m_slots;
+    int m_capacity;
+    /** @brief Incremented on clear, slots written before are ignored */
+    std::atomic<quint32> m_generation{0};
+};
@@ -0,0 +1,283 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "loudnessmeter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Number of frames converted at once when processing integer samples
+constexpr int ConversionFrames = 4096;
+constexpr double AbsoluteGate = -70.;
+constexpr double RelativeGate = -10.;
+} // namespace
+
+constexpr double LoudnessMeter::Silence;
+constexpr int LoudnessMeter::HistogramBins;
+constexpr int LoudnessMeter::ShortTermBlocks;
+constexpr int LoudnessMeter::MomentaryBlocks;
+
+LoudnessMeter::LoudnessMeter(int sampleRate, int channels)
+{
+    setFormat(sampleRate, channels);
+}
+
+void LoudnessMeter::setFormat(int sampleRate, int channels)
+{
+    m_sampleRate = std::max(8000, sampleRate);
+    m_channels = std::max(1, channels);
+
+    // K-weighting filters, coefficients computed for the sample rate as described in ITU-R BS.1770
+    const double pi = std::acos(-1.);
+    double f0 = 1681.974450955533;
+    double gain = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(pi * f0 / m_sampleRate);
+    const double vh = std::pow(10., gain / 20.);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1. + k / q + k * k;
+    m_shelf = {(vh + vb * k / q + k * k) / a0, 2. * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0, 2. * (k * k - 1.) / a0, (1. - k / q + k * k) / a0};
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(pi * f0 / m_sampleRate);
+    a0 = 1. + k / q + k * k;
+    m_highPass = {1., -2., 1., 2. * (k * k - 1.) / a0, (1. - k / q + k * k) / a0};
+
+    // True peak needs a sample rate of at least 192kHz
+    m_oversampling = m_sampleRate < 96000 ? 4 : (m_sampleRate < 192000 ? 2 : 1);
+    m_tapsPerPhase = 12;
+    const int taps = m_oversampling * m_tapsPerPhase;
+    const double center = (taps - 1) / 2.;
+    m_oversamplingFilter.assign(size_t(taps), 0.f);
+    for (int phase = 0; phase < m_oversampling; ++phase) {
+        std::vector<double> coefficients(static_cast<size_t>(m_tapsPerPhase));
+        double sum = 0.;
+        for (int j = 0; j < m_tapsPerPhase; ++j) {
+            // Windowed sinc low pass at the original Nyquist frequency
+            const int index = j * m_oversampling + phase;
+            const double x = (index - center) / m_oversampling;
+            const double sinc = std::abs(x) < 1e-9 ? 1. : std::sin(pi * x) / (pi * x);
+            const double window = 0.5 + 0.5 * std::cos(2. * pi * (index - center) / taps);
+            coefficients[size_t(j)] = sinc * window;
+            sum += coefficients[size_t(j)];
+        }
+        // Coefficients are stored reversed so that they apply to the history window in chronological order
+        for (int j = 0; j < m_tapsPerPhase; ++j) {
+            m_oversamplingFilter[size_t(phase * m_tapsPerPhase + m_tapsPerPhase - 1 - j)] = float(coefficients[size_t(j)] / sum);
+        }
+    }
+
+    m_state.assign(size_t(m_channels), ChannelState());
+    for (int c = 0; c < m_channels; ++c) {
+        // Surround channels have a +1.5dB weight and the LFE channel is ignored
+        double weight = 1.;
+        if (m_channels == 6) {
+            weight = c == 3 ? 0. : (c > 3 ? 1.41 : 1.);
+        } else if (m_channels == 4 && c > 1) {
+            weight = 1.41;
+        }
+        m_state[size_t(c)].weight = weight;
+    }
+    m_blockFrames = m_sampleRate / 10;
+    m_histogramCount.assign(HistogramBins, 0);
+    m_histogramEnergy.assign(HistogramBins, 0.);
+    reset();
+}
+
+void LoudnessMeter::reset()
+{
+    for (ChannelState &state : m_state) {
+        state.x1 = state.x2 = state.y1 = state.y2 = state.z1 = state.z2 = 0.;
+        state.history.assign(size_t(2 * m_tapsPerPhase), 0.f);
+        state.historyPos = 0;
+        state.peak = 0.f;
+    }
+    m_blockFill = 0;
+    m_blockSum = 0.;
+    m_blocks.fill(0.);
+    m_blockIndex = 0;
+    m_blockCount = 0;
+    std::fill(m_histogramCount.begin(), m_histogramCount.end(), 0);
+    std::fill(m_histogramEnergy.begin(), m_histogramEnergy.end(), 0.);
+    m_maxShortTerm = Silence;
+}
+
+void LoudnessMeter::process(const float *samples, int frames)
+{
+    while (frames > 0) {
+        // Never let a chunk cross a 100ms block boundary
+        const int count = std::min(frames, m_blockFrames - m_blockFill);
+        processChunk(samples, count);
+        m_blockFill += count;
+        if (m_blockFill == m_blockFrames) {
+            finishBlock();
+        }
+        samples += count * m_channels;
+        frames -= count;
+    }
+}
+
+void LoudnessMeter::process(const int16_t *samples, int frames)
+{
+    m_conversionBuffer.resize(size_t(ConversionFrames * m_channels));
+    while (frames > 0) {
+        const int count = std::min(frames, ConversionFrames);
+        const int values = count * m_channels;
+        float *buffer = m_conversionBuffer.data();
+        for (int i = 0; i < values; ++i) {
+            buffer[i] = samples[i] / 32768.f;
+        }
+        process(buffer, count);
+        samples += values;
+        frames -= count;
+    }
+}
+
+void LoudnessMeter::processChunk(const float *samples, int frames)
+{
+    const Biquad &s = m_shelf;
+    const Biquad &h = m_highPass;
+    for (int c = 0; c < m_channels; ++c) {
+        ChannelState &state = m_state[size_t(c)];
+        const float *input = samples + c;
+        double x1 = state.x1, x2 = state.x2, y1 = state.y1, y2 = state.y2, z1 = state.z1, z2 = state.z2;
+        double sum = 0.;
+        float peak = state.peak;
+        float *history = state.history.data();
+        int pos = state.historyPos;
+        for (int i = 0; i < frames; ++i) {
+            const float sample = input[i * m_channels];
+            // K-weighting: high shelf followed by high pass, the high pass input history is the shelf output history
+            const double x = sample;
+            const double y = s.b0 * x + s.b1 * x1 + s.b2 * x2 - s.a1 * y1 - s.a2 * y2;
+            const double z = y - 2. * y1 + y2 - h.a1 * z1 - h.a2 * z2;
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            z2 = z1;
+            z1 = z;
+            sum += z * z;
+
+            // True peak, the history window [pos + 1, pos + taps] holds the last samples in chronological order
+            pos = pos + 1 == m_tapsPerPhase ? 0 : pos + 1;
+            history[pos] = sample;
+            history[pos + m_tapsPerPhase] = sample;
+            peak = std::max(peak, std::abs(sample));
+            if (m_oversampling > 1) {
+                const float *window = history + pos + 1;
+                for (int phase = 0; phase < m_oversampling; ++phase) {
+                    const float *coefficients = m_oversamplingFilter.data() + phase * m_tapsPerPhase;
+                    float value = 0.f;
+                    for (int j = 0; j < m_tapsPerPhase; ++j) {
+                        value += coefficients[j] * window[j];
+                    }
+                    peak = std::max(peak, std::abs(value));
+                }
+            }
+        }
+        state.x1 = x1;
+        state.x2 = x2;
+        state.y1 = y1;
+        state.y2 = y2;
+        state.z1 = z1;
+        state.z2 = z2;
+        state.historyPos = pos;
+        state.peak = peak;
+        m_blockSum += state.weight * sum;
+    }
+}
+
+void LoudnessMeter::finishBlock()
+{
+    m_blocks[size_t(m_blockIndex)] = m_blockSum / m_blockFrames;
+    m_blockIndex = (m_blockIndex + 1) % ShortTermBlocks;
+    m_blockCount = std::min(m_blockCount + 1, ShortTermBlocks);
+    m_blockFill = 0;
+    m_blockSum = 0.;
+    if (m_blockCount >= MomentaryBlocks) {
+        // 400ms gating blocks with a 75% overlap
+        const double energy = blockEnergy(MomentaryBlocks);
+        const double loudness = energyToLoudness(energy);
+        if (loudness > AbsoluteGate) {
+            const int bin = std::min(HistogramBins - 1, int((loudness - AbsoluteGate) * 10.));
+            m_histogramCount[size_t(bin)]++;
+            m_histogramEnergy[size_t(bin)] += energy;
+        }
+    }
+    if (m_blockCount == ShortTermBlocks) {
+        m_maxShortTerm = std::max(m_maxShortTerm, shortTermLoudness());
+    }
+}
+
+double LoudnessMeter::blockEnergy(int count) const
+{
+    count = std::min(count, m_blockCount);
+    if (count < MomentaryBlocks) {
+        return 0.;
+    }
+    double sum = 0.;
+    for (int i = 1; i <= count; ++i) {
+        sum += m_blocks[size_t((m_blockIndex - i + ShortTermBlocks) % ShortTermBlocks)];
+    }
+    return sum / count;
+}
+
+double LoudnessMeter::energyToLoudness(double energy)
+{
+    if (energy <= 0.) {
+        return Silence;
+    }
+    return std::max(Silence, -0.691 + 10. * std::log10(energy));
+}
+
+double LoudnessMeter::momentaryLoudness() const
+{
+    return energyToLoudness(blockEnergy(MomentaryBlocks));
+}
+
+double LoudnessMeter::shortTermLoudness() const
+{
+    return energyToLoudness(blockEnergy(ShortTermBlocks));
+}
+
+double LoudnessMeter::integratedLoudness() const
+{
+    uint64_t count = 0;
+    double energy = 0.;
+    for (int i = 0; i < HistogramBins; ++i) {
+        count += m_histogramCount[size_t(i)];
+        energy += m_histogramEnergy[size_t(i)];
+    }
+    if (count == 0) {
+        return Silence;
+    }
+    const double gate = energyToLoudness(energy / count) + RelativeGate;
+    count = 0;
+    energy = 0.;
+    for (int i = 0; i < HistogramBins; ++i) {
+        // Bins are compared by their center
+        if (AbsoluteGate + (i + 0.5) / 10. >= gate) {
+            count += m_histogramCount[size_t(i)];
+            energy += m_histogramEnergy[size_t(i)];
+        }
+    }
+    return count == 0 ? Silence : energyToLoudness(energy / count);
+}
+
+double LoudnessMeter::maximumShortTermLoudness() const
+{
+    return m_maxShortTerm;
+}
+
+double LoudnessMeter::truePeak() const
+{
+    float peak = 0.f;
+    for (const ChannelState &state : m_state) {
+        peak = std::max(peak, state.peak);
+    }
+    return peak <= 0.f ? Silence : std::max(Silence, 20. * std::log10(double(peak)));
+}
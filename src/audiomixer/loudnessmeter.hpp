@@ -0,0 +1,97 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/** @class LoudnessMeter
+    @brief Streaming loudness and true peak meter following ITU-R BS.1770-4 / EBU R128.
+    Audio is fed in interleaved blocks of any size and the meter keeps the momentary (400ms),
+    short-term (3s) and gated integrated loudness, as well as the true peak measured on a 4x
+    oversampled signal. Memory use does not depend on the duration of the measured audio, the
+    gating blocks are accumulated in a histogram with a 0.1 LU resolution.
+    The meter is not thread safe, it must be fed and read from the same thread.
+ */
+class LoudnessMeter
+{
+public:
+    /** @brief Value returned when there is not enough audio (or only silence) to measure */
+    static constexpr double Silence = -100.;
+
+    explicit LoudnessMeter(int sampleRate = 48000, int channels = 2);
+    /** @brief Change the audio format, which also resets all measurements */
+    void setFormat(int sampleRate, int channels);
+    /** @brief Discard all measurements */
+    void reset();
+
+    /** @brief Process @p frames interleaved samples of all channels */
+    void process(const float *samples, int frames);
+    void process(const int16_t *samples, int frames);
+
+    /** @brief Loudness of the last 400ms in LUFS */
+    double momentaryLoudness() const;
+    /** @brief Loudness of the last 3s in LUFS */
+    double shortTermLoudness() const;
+    /** @brief Gated loudness since the last reset in LUFS */
+    double integratedLoudness() const;
+    /** @brief Highest short-term loudness since the last reset in LUFS */
+    double maximumShortTermLoudness() const;
+    /** @brief Highest inter-sample peak of all channels since the last reset in dBTP */
+    double truePeak() const;
+
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+
+private:
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+    };
+    struct ChannelState
+    {
+        // Direct form I state of the two K-weighting filters
+        double x1{0}, x2{0}, y1{0}, y2{0};
+        double z1{0}, z2{0};
+        // Oversampling history, stored twice so that the filter window is always contiguous
+        std::vector<float> history;
+        int historyPos{0};
+        float peak{0};
+        double weight{1.};
+    };
+    /** @brief Gating blocks are stored as 0.1 LU bins from -70 LUFS */
+    static constexpr int HistogramBins = 1000;
+    static constexpr int ShortTermBlocks = 30;
+    static constexpr int MomentaryBlocks = 4;
+
+    void processChunk(const float *samples, int frames);
+    void finishBlock();
+    double blockEnergy(int count) const;
+    static double energyToLoudness(double energy);
+
+    int m_sampleRate;
+    int m_channels;
+    Biquad m_shelf;
+    Biquad m_highPass;
+    std::vector<ChannelState> m_state;
+    /** @brief Polyphase oversampling filter, one row of m_tapsPerPhase coefficients per phase */
+    std::vector<float> m_oversamplingFilter;
+    int m_oversampling;
+    int m_tapsPerPhase;
+    /** @brief Frames per 100ms block, the step of momentary and short-term measurements */
+    int m_blockFrames;
+    int m_blockFill;
+    double m_blockSum;
+    /** @brief Mean square of the last 100ms blocks */
+    std::array<double, ShortTermBlocks> m_blocks;
+    int m_blockIndex;
+    int m_blockCount;
+    std::vector<uint64_t> m_histogramCount;
+    std::vector<double> m_histogramEnergy;
+    double m_maxShortTerm;
+    std::vector<float> m_conversionBuffer;
+};
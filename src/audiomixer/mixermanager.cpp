@@ -17,6 +17,7 @@
 
 #include <KLocalizedString>
 #include <QApplication>
+#include <QGuiApplication>
 #include <QHBoxLayout>
 #include <QModelIndex>
 #include <QScreen>
@@ -33,7 +34,19 @@ MixerManager::MixerManager(QWidget *parent)
     , m_recommendedWidth(300)
     , m_monitorTrack(-1)
     , m_filterIsV2(false)
+    , m_levelsPosition(-1)
 {
+    QScreen *screen = QGuiApplication::primaryScreen();
+    const qreal refreshRate = screen ? qMax(screen->refreshRate(), 30.) : 60.;
+    m_levelsTimer.setSingleShot(true);
+    m_levelsTimer.setInterval(int(1000 / refreshRate));
+    connect(&m_levelsTimer, &QTimer::timeout, this, &MixerManager::refreshLevels);
+    connect(pCore.get(), &Core::updateMixerLevels, this, [this](int pos) {
+        m_levelsPosition = pos;
+        if (!m_levelsTimer.isActive()) {
+            m_levelsTimer.start();
+        }
+    });
     m_masterBox = new QHBoxLayout;
     setContentsMargins(0, 0, 0, 0);
     m_channelsBox = new QScrollArea(this);
@@ -110,7 +123,6 @@ void MixerManager::registerTrack(int tid, std::shared_ptr<Mlt::Tractor> service,
     if (m_visibleMixerManager) {
         mixer->connectMixer(!KdenliveSettings::mixerCollapse());
     }
-    connect(pCore.get(), &Core::updateMixerLevels, mixer.get(), &MixerWidget::updateAudioLevel);
     connect(this, &MixerManager::clearMixers, mixer.get(), &MixerWidget::clear);
     connect(mixer.get(), &MixerWidget::toggleSolo, this, [&](int trid, bool solo) {
         if (!solo) {
@@ -252,6 +264,16 @@ void MixerManager::collapseMixers()
     }
 }
 
+void MixerManager::refreshLevels()
+{
+    if (!m_visibleMixerManager || KdenliveSettings::mixerCollapse()) {
+        return;
+    }
+    for (const auto &item : m_mixers) {
+        item.second->updateAudioLevel(m_levelsPosition);
+    }
+}
+
 void MixerManager::resetSizePolicy()
 {
     setMaximumWidth(QWIDGETSIZE_MAX);
@@ -9,6 +9,7 @@
 #include <memory>
 #include <unordered_map>
 
+#include <QTimer>
 #include <QWidget>
 
 namespace Mlt {
@@ -52,6 +53,8 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void resetSizePolicy();
+    /** @brief Update the track meters with the levels of the last displayed frame */
+    void refreshLevels();
 
 Q_SIGNALS:
     void updateLevels(int);
@@ -78,4 +81,7 @@ private:
     int m_recommendedWidth;
     int m_monitorTrack;
     bool m_filterIsV2;
+    /** @brief Meters are refreshed at most once per display refresh, whatever the project frame rate */
+    QTimer m_levelsTimer;
+    int m_levelsPosition;
 };
@@ -9,7 +9,9 @@
 #include "capture/mediacapture.h"
 #include "core.h"
 #include "iecscale.h"
+#include "jobs/loudnesstask.h"
 #include "kdenlivesettings.h"
+#include "loudnessmeter.hpp"
 #include "mixermanager.hpp"
 #include "mlt++/MltEvent.h"
 #include "mlt++/MltFilter.h"
@@ -25,6 +27,7 @@
 #include <QFontDatabase>
 #include <QGridLayout>
 #include <QLabel>
+#include <QMenu>
 #include <QMouseEvent>
 #include <QSlider>
 #include <QSpinBox>
@@ -49,17 +52,13 @@ void MixerWidget::property_changed(mlt_service, MixerWidget *widget, mlt_event_d
     if (widget && !strcmp(Mlt::EventData(data).to_string(), "_position")) {
         mlt_properties filter_props = MLT_FILTER_PROPERTIES(widget->m_monitorFilter->get_filter());
         int pos = mlt_properties_get_int(filter_props, "_position");
-        if (!widget->m_levels.contains(pos)) {
-            QVector<double> levels;
-            for (int i = 0; i < widget->m_channels; i++) {
-                // NOTE: this is an approximation. To get the real peak level, we need version 2 of audiolevel MLT filter, see property_changedV2
-                levels << log10(mlt_properties_get_double(filter_props, QString("_audio_level.%1").arg(i).toUtf8().constData()) / 1.18) * 20;
-            }
-            widget->m_levels[pos] = std::move(levels);
-            if (widget->m_levels.size() > widget->m_maxLevels) {
-                widget->m_levels.erase(widget->m_levels.begin());
-            }
+        double levels[AudioLevelBuffer::MaxChannels];
+        const int channels = qMin(widget->m_channels, int(AudioLevelBuffer::MaxChannels));
+        for (int i = 0; i < channels; i++) {
+            // NOTE: this is an approximation. To get the real peak level, we need version 2 of audiolevel MLT filter, see property_changedV2
+            levels[i] = log10(mlt_properties_get_double(filter_props, QString("_audio_level.%1").arg(i).toUtf8().constData()) / 1.18) * 20;
         }
+        widget->m_levels.publish(pos, levels, channels);
     }
 }
 
@@ -68,16 +67,12 @@ void MixerWidget::property_changedV2(mlt_service, MixerWidget *widget, mlt_event
     if (widget && !strcmp(Mlt::EventData(data).to_string(), "_position")) {
         mlt_properties filter_props = MLT_FILTER_PROPERTIES(widget->m_monitorFilter->get_filter());
         int pos = mlt_properties_get_int(filter_props, "_position");
-        if (!widget->m_levels.contains(pos)) {
-            QVector<double> levels;
-            for (int i = 0; i < widget->m_channels; i++) {
-                levels << mlt_properties_get_double(filter_props, QString("_audio_level.%1").arg(i).toUtf8().constData());
-            }
-            widget->m_levels[pos] = std::move(levels);
-            if (widget->m_levels.size() > widget->m_maxLevels) {
-                widget->m_levels.erase(widget->m_levels.begin());
-            }
+        double levels[AudioLevelBuffer::MaxChannels];
+        const int channels = qMin(widget->m_channels, int(AudioLevelBuffer::MaxChannels));
+        for (int i = 0; i < channels; i++) {
+            levels[i] = mlt_properties_get_double(filter_props, QString("_audio_level.%1").arg(i).toUtf8().constData());
         }
+        widget->m_levels.publish(pos, levels, channels);
     }
 }
 
@@ -88,12 +83,13 @@ MixerWidget::MixerWidget(int tid, std::shared_ptr<Mlt::Tractor> service, QString
     , m_levelFilter(nullptr)
     , m_monitorFilter(nullptr)
     , m_balanceFilter(nullptr)
+    , m_levels(qMax(30, int(service->get_fps() * 1.5)))
     , m_channels(pCore->audioChannels())
     , m_balanceSlider(nullptr)
-    , m_maxLevels(qMax(30, int(service->get_fps() * 1.5)))
     , m_solo(nullptr)
     , m_collapse(nullptr)
     , m_monitor(nullptr)
+    , m_loudness(nullptr)
     , m_lastVolume(0)
     , m_listener(nullptr)
     , m_recording(false)
@@ -109,13 +105,14 @@ MixerWidget::MixerWidget(int tid, Mlt::Tractor *service, QString trackTag, const
     , m_levelFilter(nullptr)
     , m_monitorFilter(nullptr)
     , m_balanceFilter(nullptr)
+    , m_levels(qMax(30, int(service->get_fps() * 1.5)))
     , m_channels(pCore->audioChannels())
     , m_balanceSpin(nullptr)
     , m_balanceSlider(nullptr)
-    , m_maxLevels(qMax(30, int(service->get_fps() * 1.5)))
     , m_solo(nullptr)
     , m_collapse(nullptr)
     , m_monitor(nullptr)
+    , m_loudness(nullptr)
     , m_lastVolume(0)
     , m_listener(nullptr)
     , m_recording(false)
@@ -324,6 +321,21 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackName)
             m_collapse->setIcon(m_collapse->isChecked() ? QIcon::fromTheme("arrow-left") : QIcon::fromTheme("arrow-right"));
             m_manager->collapseMixers();
         });
+
+        m_loudness = new QToolButton(this);
+        m_loudness->setAutoRaise(true);
+        m_loudness->setPopupMode(QToolButton::InstantPopup);
+        m_loudness->setToolButtonStyle(Qt::ToolButtonTextOnly);
+        m_loudness->setWhatsThis(xi18nc("@info:whatsthis", "Short-term loudness of the played audio. The tooltip shows the momentary and integrated "
+                                                           "loudness and the true peak measured since playback started."));
+        auto *loudnessMenu = new QMenu(this);
+        loudnessMenu->addAction(i18n("Reset Loudness Measurement"), this, [this]() {
+            Q_EMIT pCore->resetAudioLoudness();
+            setLoudness({});
+        });
+        loudnessMenu->addAction(i18n("Analyze Timeline Loudness"), this, []() { LoudnessTask::start(); });
+        m_loudness->setMenu(loudnessMenu);
+        setLoudness({});
     }
     showEffects = new QToolButton(this);
     showEffects->setIcon(QIcon::fromTheme("autocorrection"));
@@ -406,6 +418,9 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackName)
     hlay->addWidget(m_volumeSlider);
     lay->addLayout(hlay);
     lay->addWidget(m_volumeSpin);
+    if (m_loudness) {
+        lay->addWidget(m_loudness);
+    }
     lay->setStretch(4, 10);
     setLayout(lay);
     if (service->get_int("hide") > 1) {
@@ -476,10 +491,8 @@ void MixerWidget::updateLabel()
 
 void MixerWidget::updateAudioLevel(int pos)
 {
-    QMutexLocker lk(&m_storeMutex);
-    if (m_levels.contains(pos)) {
-        m_audioMeterWidget->setAudioValues(m_levels.value(pos));
-        // m_levels.remove(pos);
+    if (m_levels.read(pos, m_displayedLevels)) {
+        m_audioMeterWidget->setAudioValues(m_displayedLevels);
     } else {
         m_audioMeterWidget->setAudioValues(m_audioData);
     }
@@ -487,14 +500,12 @@ void MixerWidget::updateAudioLevel(int pos)
 
 void MixerWidget::reset()
 {
-    QMutexLocker lk(&m_storeMutex);
     m_levels.clear();
     m_audioMeterWidget->setAudioValues(m_audioData);
 }
 
 void MixerWidget::clear()
 {
-    QMutexLocker lk(&m_storeMutex);
     m_levels.clear();
 }
 
@@ -526,6 +537,22 @@ void MixerWidget::gotRecLevels(QVector<qreal> levels)
     }
 }
 
+void MixerWidget::setLoudness(const QVector<double> &loudness)
+{
+    if (m_loudness == nullptr) {
+        return;
+    }
+    auto format = [](double value) { return value <= LoudnessMeter::Silence ? QStringLiteral("-∞") : QString::number(value, 'f', 1); };
+    if (loudness.size() < 4) {
+        m_loudness->setText(i18n("%1 LUFS", format(LoudnessMeter::Silence)));
+        m_loudness->setToolTip(i18n("Loudness"));
+        return;
+    }
+    m_loudness->setText(i18n("%1 LUFS", format(loudness.at(1))));
+    m_loudness->setToolTip(i18n("Momentary: %1 LUFS\nShort-term: %2 LUFS\nIntegrated: %3 LUFS\nTrue peak: %4 dBTP", format(loudness.at(0)),
+                                format(loudness.at(1)), format(loudness.at(2)), format(loudness.at(3))));
+}
+
 void MixerWidget::updateMonitorState()
 {
     QSignalBlocker bk(m_volumeSpin);
@@ -581,6 +608,7 @@ void MixerWidget::connectMixer(bool doConnect)
         if (m_tid == -1) {
             // Master level
             connect(pCore.get(), &Core::audioLevelsAvailable, m_audioMeterWidget.get(), &AudioLevelWidget::setAudioValues);
+            connect(pCore.get(), &Core::audioLoudnessAvailable, this, &MixerWidget::setLoudness, Qt::UniqueConnection);
         } else if (m_listener == nullptr) {
             m_listener = m_monitorFilter->listen("property-changed", this,
                                                  m_manager->audioLevelV2() ? reinterpret_cast<mlt_listener>(property_changedV2)
@@ -589,6 +617,7 @@ void MixerWidget::connectMixer(bool doConnect)
     } else {
         if (m_tid == -1) {
             disconnect(pCore.get(), &Core::audioLevelsAvailable, m_audioMeterWidget.get(), &AudioLevelWidget::setAudioValues);
+            disconnect(pCore.get(), &Core::audioLoudnessAvailable, this, &MixerWidget::setLoudness);
         } else {
             delete m_listener;
             m_listener = nullptr;
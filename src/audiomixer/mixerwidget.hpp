@@ -5,10 +5,10 @@
 
 #pragma once
 
+#include "audiolevelbuffer.hpp"
 #include "definitions.h"
 #include "mlt++/MltService.h"
 
-#include <QMutex>
 #include <QWidget>
 #include <memory>
 #include <unordered_map>
@@ -67,6 +67,8 @@ protected:
 public Q_SLOTS:
     void updateAudioLevel(int pos);
     void setRecordState(bool recording);
+    /** @brief Display the master loudness: momentary, short-term, integrated (LUFS) and true peak (dBTP) */
+    void setLoudness(const QVector<double> &loudness);
 
 private Q_SLOTS:
     void gotRecLevels(QVector<qreal> levels);
@@ -77,13 +79,13 @@ protected:
     std::shared_ptr<Mlt::Filter> m_levelFilter;
     std::shared_ptr<Mlt::Filter> m_monitorFilter;
     std::shared_ptr<Mlt::Filter> m_balanceFilter;
-    QMap<int, QVector<double>> m_levels;
+    /** @brief Levels published by MLT's consumer thread, read when the frame is displayed */
+    AudioLevelBuffer m_levels;
     int m_channels;
     KDualAction *m_muteAction;
     QSpinBox *m_balanceSpin;
     QSlider *m_balanceSlider;
     QDoubleSpinBox *m_volumeSpin;
-    int m_maxLevels;
 
 private:
     std::shared_ptr<AudioLevelWidget> m_audioMeterWidget;
@@ -91,10 +93,12 @@ private:
     QToolButton *m_solo;
     QToolButton *m_collapse;
     QToolButton *m_monitor;
+    /** @brief Loudness display of the master */
+    QToolButton *m_loudness;
     KSqueezedTextLabel *m_trackLabel;
-    QMutex m_storeMutex;
     double m_lastVolume;
     QVector<double> m_audioData;
+    QVector<double> m_displayedLevels;
     Mlt::Event *m_listener;
     bool m_recording;
     const QString m_trackTag;
@@ -3320,11 +3320,18 @@ void Bin::slotOpenCurrent()
 
 void Bin::openProducer(std::shared_ptr<ProjectClip> controller)
 {
+    if (controller) {
+        // Monitor will be refreshed once the real producer is loaded
+        controller->loadDeferredProducer();
+    }
     Q_EMIT openClip(std::move(controller));
 }
 
 void Bin::openProducer(std::shared_ptr<ProjectClip> controller, int in, int out)
 {
+    if (controller) {
+        controller->loadDeferredProducer();
+    }
     Q_EMIT openClip(std::move(controller), in, out);
 }
 
@@ -14,6 +14,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "doc/kdenlivedoc.h"
 #include "doc/kthumb.h"
 #include "effects/effectstack/model/effectstackmodel.hpp"
+#include "jobs/analysistask.h"
 #include "jobs/audiolevelstask.h"
 #include "jobs/cachetask.h"
 #include "jobs/cliploadtask.h"
@@ -134,8 +135,8 @@ ProjectClip::ProjectClip(const QString &id, const QIcon &thumb, const std::share
     if (m_clipStatus == FileStatus::StatusProxy || m_clipStatus == FileStatus::StatusReady || m_clipStatus == FileStatus::StatusProxyOnly) {
         // Generate clip thumbnail
         ClipLoadTask::start({ObjectType::BinClip, m_binId.toInt()}, QDomElement(), true, -1, -1, this);
-        // Generate audio thumbnail
-        if (KdenliveSettings::audiothumbnails() &&
+        // Generate audio thumbnail, deferred clips will do it once their producer is loaded
+        if (KdenliveSettings::audiothumbnails() && !isLazy() &&
             (m_clipType == ClipType::AV || m_clipType == ClipType::Audio || (m_hasAudio && m_clipType != ClipType::Timeline))) {
             AudioLevelsTask::start({ObjectType::BinClip, m_binId.toInt()}, this, false);
         }
@@ -246,7 +247,8 @@ void ProjectClip::updateAudioThumbnail(bool cachedThumb)
     Q_EMIT audioThumbReady();
     if (m_clipType == ClipType::Audio) {
         QImage thumb = ThumbnailCache::get()->getThumbnail(m_binId, 0);
-        if (thumb.isNull() && !pCore->taskManager.hasPendingJob({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::AUDIOTHUMBJOB)) {
+        if (thumb.isNull() && !pCore->taskManager.hasPendingJob({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::AUDIOTHUMBJOB) &&
+            !pCore->taskManager.hasPendingJob({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::MEDIAANALYSISJOB)) {
             int iconHeight = int(QFontInfo(qApp->font()).pixelSize() * 3.5);
             QImage img(QSize(int(iconHeight * pCore->getCurrentDar()), iconHeight), QImage::Format_ARGB32);
             img.fill(Qt::darkGray);
@@ -421,6 +423,7 @@ void ProjectClip::reloadProducer(bool refreshOnly, bool isProxy, bool forceAudio
         ThumbnailCache::get()->invalidateThumbsForClip(m_binId);
         pCore->taskManager.discardJobs({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::LOADJOB, true);
         pCore->taskManager.discardJobs({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::CACHEJOB);
+        pCore->taskManager.discardJobs({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::MEDIAANALYSISJOB);
         m_thumbsProducer.reset();
         // Reset uuid to enforce reloading thumbnails from qml cache
         m_uuid = QUuid::createUuid();
@@ -430,6 +433,7 @@ void ProjectClip::reloadProducer(bool refreshOnly, bool isProxy, bool forceAudio
         // If another load job is running?
         pCore->taskManager.discardJobs({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::LOADJOB, true);
         pCore->taskManager.discardJobs({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::CACHEJOB);
+        pCore->taskManager.discardJobs({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::MEDIAANALYSISJOB);
         if (QFile::exists(m_path) && (!isProxy && !hasProxy()) && m_properties) {
             clearBackupProperties();
         }
@@ -649,10 +653,8 @@ bool ProjectClip::setProducer(std::shared_ptr<Mlt::Producer> producer, bool gene
         // Generate video thumb
         ClipLoadTask::start({ObjectType::BinClip, m_binId.toInt()}, QDomElement(), true, -1, -1, this);
     }
-    if (KdenliveSettings::audiothumbnails() &&
-        (m_clipType == ClipType::AV || m_clipType == ClipType::Audio || (m_hasAudio && m_clipType != ClipType::Timeline))) {
-        AudioLevelsTask::start({ObjectType::BinClip, m_binId.toInt()}, this, false);
-    }
+    const bool audioThumbs = KdenliveSettings::audiothumbnails() &&
+                             (m_clipType == ClipType::AV || m_clipType == ClipType::Audio || (m_hasAudio && m_clipType != ClipType::Timeline));
     if (pCore->bin()) {
         pCore->bin()->reloadMonitorIfActive(clipId());
     }
@@ -711,10 +713,10 @@ bool ProjectClip::setProducer(std::shared_ptr<Mlt::Producer> producer, bool gene
             generateProxy = true;
         }
     }
-    if (!generateProxy && KdenliveSettings::hoverPreview() &&
-        (m_clipType == ClipType::AV || m_clipType == ClipType::Video || m_clipType == ClipType::Playlist)) {
-        QTimer::singleShot(1000, this, [this]() { CacheTask::start({ObjectType::BinClip, m_binId.toInt()}, 30, 0, 0, this); });
-    }
+    const bool hoverThumbs = !generateProxy && KdenliveSettings::hoverPreview() &&
+                             (m_clipType == ClipType::AV || m_clipType == ClipType::Video || m_clipType == ClipType::Playlist);
+    // Decodes the clip once for all the thumbnails, or starts the separate tasks if it cannot
+    AnalysisTask::start({ObjectType::BinClip, m_binId.toInt()}, this, hoverThumbs, audioThumbs);
     if (generateProxy) {
         QMetaObject::invokeMethod(pCore->currentDoc(), "slotProxyCurrentItem", Q_ARG(bool, true), Q_ARG(QList<std::shared_ptr<ProjectClip>>, clipList),
                                   Q_ARG(bool, false));
@@ -962,6 +964,10 @@ std::shared_ptr<Mlt::Producer> ProjectClip::getTimelineProducer(int trackId, int
     if (!m_masterProducer) {
         return nullptr;
     }
+    if (isLazy()) {
+        // The placeholder is used until the real producer is ready, timeline instances are then replaced
+        QMetaObject::invokeMethod(this, &ProjectClip::loadDeferredProducer, Qt::QueuedConnection);
+    }
     if (qFuzzyCompare(speed, 1.0) && !timeremap) {
         // we are requesting a normal speed producer
         bool byPassTrackProducer = false;
@@ -2022,6 +2028,7 @@ void ProjectClip::discardAudioThumb()
         return;
     }
     pCore->taskManager.discardJobs({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::AUDIOTHUMBJOB);
+    pCore->taskManager.discardJobs({ObjectType::BinClip, m_binId.toInt()}, AbstractTask::MEDIAANALYSISJOB);
     QString audioThumbPath;
     QList<int> streams = m_audioInfo->streams().keys();
     // Delete audio thumbnail data
@@ -2580,6 +2587,26 @@ int ProjectClip::getAudioMax(int stream)
     return int(max);
 }
 
+qint64 ProjectClip::memoryCost()
+{
+    if (!m_masterProducer) {
+        return 0;
+    }
+    qint64 cost = FunctionalUndoCommand::propertiesCost(*m_masterProducer.get());
+    // The audio levels are stored as data of the producer
+    const int count = m_masterProducer->count();
+    for (int i = 0; i < count; ++i) {
+        const QByteArray name(m_masterProducer->get_name(i));
+        if (name.startsWith("_kdenlive:audio")) {
+            auto *levels = static_cast<QVector<uint8_t> *>(m_masterProducer->get_data(name.constData()));
+            if (levels) {
+                cost += levels->size();
+            }
+        }
+    }
+    return cost;
+}
+
 const QVector<uint8_t> ProjectClip::audioFrameCache(int stream)
 {
     QVector<uint8_t> audioLevels;
@@ -2827,6 +2854,15 @@ QStringList ProjectClip::getAudioStreamEffect(int streamIndex) const
     return effects;
 }
 
+void ProjectClip::loadDeferredProducer()
+{
+    if (!isLazy() || isReloading) {
+        return;
+    }
+    qCDebug(KDENLIVE_LOG) << "Loading deferred clip" << m_binId;
+    reloadProducer();
+}
+
 void ProjectClip::updateTimelineOnReload()
 {
     if (m_registeredClips.size() > 0 && m_registeredClips.size() < 3) {
@@ -228,6 +228,8 @@ public:
     /** @brief Return audio cache for a stream
      */
     const QVector <uint8_t> audioFrameCache(int stream = -1);
+    /** @brief Returns the approximate memory held by the producer properties and audio levels of this clip, in bytes */
+    qint64 memoryCost();
     /** @brief Return FFmpeg's audio stream index for an MLT audio stream index
      */
     int getAudioStreamFfmpegIndex(int mltStream);
@@ -278,6 +280,8 @@ public:
     void saveZone(QPoint zone, const QDir &dir);
     /** @brief When a sequence clip has a track change, update info and properties panel */
     void refreshTracksState(int tracksCount = -1);
+    /** @brief If this clip was deferred on project load, start loading its real producer. */
+    void loadDeferredProducer();
 
 protected:
     friend class ClipModel;
@@ -723,6 +723,10 @@ bool ProjectItemModel::requestBinClipDeletion(const std::shared_ptr<AbstractProj
         } else {
             Fun checkAudio = clip->getAudio_lambda();
             PUSH_LAMBDA(checkAudio, reverse);
+            if (clip->itemType() == AbstractProjectItem::ClipItem) {
+                // The undo keeps the clip and its producer alive
+                FunctionalUndoCommand::reportMemoryCost(std::static_pointer_cast<ProjectClip>(clip)->memoryCost());
+            }
         }
         UPDATE_UNDO_REDO(operation, reverse, undo, redo);
     }
@@ -29,6 +29,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "timeline2/model/timelineitemmodel.hpp"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/tracer.hpp"
 #include <mlt++/MltRepository.h>
 
 #include "utils/KMessageBox_KdenliveCompat.h"
@@ -79,6 +80,7 @@ bool Core::build(const QString &packageType, bool testMode)
     if (m_self) {
         return true;
     }
+    TRACE_SCOPE("Core::build", "startup");
     m_self.reset(new Core(packageType));
     m_self->initLocale();
 
@@ -134,9 +136,13 @@ bool Core::build(const QString &packageType, bool testMode)
 
 void Core::initGUI(bool inSandbox, const QString &MltPath, const QUrl &Url, const QString &clipsToLoad)
 {
+    TRACE_SCOPE("Core::initGUI", "startup");
     m_profile = KdenliveSettings::default_profile();
     m_currentProfile = m_profile;
-    m_mainWindow = new MainWindow();
+    {
+        TRACE_SCOPE("MainWindow construction", "startup");
+        m_mainWindow = new MainWindow();
+    }
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
 
     QStringList styles = QQuickStyle::availableStyles();
@@ -185,7 +191,10 @@ void Core::initGUI(bool inSandbox, const QString &MltPath, const QUrl &Url, cons
     }
     m_projectItemModel->buildPlaylist(QUuid());
     // load the profiles from disk
-    ProfileRepository::get()->refresh();
+    {
+        TRACE_SCOPE("Profiles refresh", "startup");
+        ProfileRepository::get()->refresh();
+    }
     // load default profile
     m_profile = KdenliveSettings::default_profile();
     // load default profile and ask user to select one if not found.
@@ -242,10 +251,12 @@ void Core::initGUI(bool inSandbox, const QString &MltPath, const QUrl &Url, cons
     m_mainWindow->show();
     bin->slotUpdatePalette();
     Q_EMIT m_mainWindow->GUISetupDone();
+    Tracer::instance().write();
 }
 
 void Core::buildDocks()
 {
+    TRACE_SCOPE("Core::buildDocks", "startup");
     // Mixer
     m_mixerWidget = new MixerManager(m_mainWindow);
     connect(m_capture.get(), &MediaCapture::recordStateChanged, m_mixerWidget, &MixerManager::recordStateChanged);
@@ -416,6 +416,10 @@ Q_SIGNALS:
     void clipInstanceResized(const QString &binId);
     /** @brief Contains the project audio levels */
     void audioLevelsAvailable(const QVector<double>& levels);
+    /** @brief Contains the project momentary, short-term and integrated loudness (LUFS) and true peak (dBTP) */
+    void audioLoudnessAvailable(const QVector<double> &loudness);
+    /** @brief Restart the project loudness measurement */
+    void resetAudioLoudness();
     /** @brief A frame was displayed in monitor, update audio mixer */
     void updateMixerLevels(int pos);
     /** @brief Audio recording was started or stopped*/
@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "clipcreationdialog.h"
 #include "core.h"
 #include "dialogs/profilesdialog.h"
+#include "doc/docundostack.hpp"
 #include "doc/kdenlivedoc.h"
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
@@ -353,6 +354,7 @@ void KdenliveSettingsDialog::initEnviromentPage()
     connect(m_configEnv.kcfg_librarytodefaultfolder, &QAbstractButton::clicked, this, &KdenliveSettingsDialog::slotEnableLibraryFolder);
 
     m_configEnv.kcfg_proxythreads->setMaximum(qMax(1, QThread::idealThreadCount() - 1));
+    m_configEnv.kcfg_analysissegments->setMaximum(qMax(1, QThread::idealThreadCount()));
 
     // Script rendering files folder
     m_configEnv.videofolderurl->setMode(KFile::Directory);
@@ -1320,6 +1322,13 @@ void KdenliveSettingsDialog::updateSettings()
         m_configEnv.supportedmimes->setPlainText(mimes.join(QLatin1Char(' ')));
     }
 
+    if (m_configMisc.kcfg_undomemorybudget->value() != KdenliveSettings::undomemorybudget()) {
+        KdenliveSettings::setUndomemorybudget(m_configMisc.kcfg_undomemorybudget->value());
+        if (pCore->currentDoc()) {
+            pCore->currentDoc()->commandStack()->setMemoryBudget(qint64(KdenliveSettings::undomemorybudget()) * 1024 * 1024);
+        }
+    }
+
     // proxy/transcode max concurrent jobs
     if (m_configEnv.kcfg_proxythreads->value() != KdenliveSettings::proxythreads()) {
         KdenliveSettings::setProxythreads(m_configEnv.kcfg_proxythreads->value());
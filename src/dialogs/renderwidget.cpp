@@ -17,6 +17,7 @@
 #include "profiles/profilemodel.hpp"
 #include "profiles/profilerepository.hpp"
 #include "project/projectmanager.h"
+#include "render/renderserver.h"
 #include "utils/qstringutils.h"
 #include "utils/sysinfo.hpp"
 #include "utils/timecode.h"
@@ -43,6 +44,7 @@
 #include <knotifications_version.h>
 
 #include "kdenlive_debug.h"
+#include <QCryptographicHash>
 #include <QDBusConnectionInterface>
 #include <QDir>
 #include <QDomDocument>
@@ -74,6 +76,7 @@
 #endif
 #endif
 
+#include <algorithm>
 #include <locale>
 #ifdef Q_OS_MAC
 #include <xlocale.h>
@@ -99,6 +102,7 @@ enum JOBSTATUS { WAITINGJOB = 0, STARTINGJOB, RUNNINGJOB, FINISHEDJOB, FAILEDJOB
 RenderJobItem::RenderJobItem(QTreeWidget *parent, const QStringList &strings, int type)
     : QTreeWidgetItem(parent, strings, type)
     , m_status(-1)
+    , m_hasCost(false)
 {
     setSizeHint(1, QSize(parent->columnWidth(1), parent->fontMetrics().height() * 3));
     setStatus(WAITINGJOB);
@@ -150,6 +154,17 @@ const QString RenderJobItem::metadata() const
     return m_data;
 }
 
+const RenderJobScheduler::Job &RenderJobItem::cost()
+{
+    if (!m_hasCost) {
+        // Arguments are: delivery, renderer path, scene list, ...
+        const QStringList args = data(1, ParametersRole).toStringList();
+        m_cost = RenderJobScheduler::estimate(args.value(2), text(1));
+        m_hasCost = true;
+    }
+    return m_cost;
+}
+
 RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
     : QDialog(parent)
     , m_blockProcessing(false)
@@ -241,6 +256,15 @@ RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
     m_view.processing_threads->setValue(KdenliveSettings::processingthreads());
     connect(m_view.processing_threads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KdenliveSettings::setProcessingthreads);
     connect(m_view.processing_threads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &RenderWidget::refreshParams);
+    m_view.processing_segments->setMaximum(QThread::idealThreadCount());
+    m_view.processing_segments->setValue(KdenliveSettings::rendersegments());
+    connect(m_view.processing_segments, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KdenliveSettings::setRendersegments);
+    m_view.smart_render->setChecked(KdenliveSettings::rendersmart());
+    connect(m_view.smart_render, &QCheckBox::toggled, this, &KdenliveSettings::setRendersmart);
+    m_view.twopass_intermediate->setChecked(KdenliveSettings::rendertwopassintermediate());
+    m_view.twopass_intermediate->setEnabled(false);
+    connect(m_view.twopass_intermediate, &QCheckBox::toggled, this, &KdenliveSettings::setRendertwopassintermediate);
+    connect(m_view.checkTwoPass, &QCheckBox::toggled, m_view.twopass_intermediate, &QWidget::setEnabled);
     if (!KdenliveSettings::parallelrender()) {
         m_view.processing_warning->hide();
     }
@@ -330,6 +354,36 @@ RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
         }
     }
 
+    m_view.concurrent_jobs->setChecked(KdenliveSettings::concurrentrenders());
+    m_view.jobs_threads->setMaximum(QThread::idealThreadCount());
+    m_view.jobs_threads->setValue(KdenliveSettings::renderjobthreads());
+    m_view.jobs_memory->setValue(KdenliveSettings::renderjobmemory());
+    m_view.jobs_threads->setEnabled(m_view.concurrent_jobs->isChecked());
+    m_view.jobs_memory->setEnabled(m_view.concurrent_jobs->isChecked());
+    connect(m_view.concurrent_jobs, &QCheckBox::toggled, this, [this](bool checked) {
+        KdenliveSettings::setConcurrentrenders(checked);
+        m_view.jobs_threads->setEnabled(checked);
+        m_view.jobs_memory->setEnabled(checked);
+        checkRenderStatus();
+    });
+    connect(m_view.jobs_threads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, [this](int value) {
+        KdenliveSettings::setRenderjobthreads(value);
+        checkRenderStatus();
+    });
+    connect(m_view.jobs_memory, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, [this](int value) {
+        KdenliveSettings::setRenderjobmemory(value);
+        checkRenderStatus();
+    });
+    m_view.render_workers->setMaximum(QThread::idealThreadCount());
+    m_view.render_workers->setValue(KdenliveSettings::renderworkers());
+    m_view.worker_pinning->setChecked(KdenliveSettings::renderworkerpinning());
+    m_view.worker_pinning->setEnabled(KdenliveSettings::renderworkers() > 0);
+    connect(m_view.render_workers, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, [this](int value) {
+        KdenliveSettings::setRenderworkers(value);
+        m_view.worker_pinning->setEnabled(value > 0);
+    });
+    connect(m_view.worker_pinning, &QCheckBox::toggled, this, &KdenliveSettings::setRenderworkerpinning);
+
     QDBusConnectionInterface *interface = QDBusConnection::sessionBus().interface();
     if ((interface == nullptr) ||
         (!interface->isServiceRegistered(QStringLiteral("org.kde.ksmserver")) && !interface->isServiceRegistered(QStringLiteral("org.gnome.SessionManager")))) {
@@ -932,6 +986,78 @@ void RenderWidget::generateRenderFiles(const QString playlistPath, QDomDocument
 
     QDomDocument clone;
     int passes = m_view.checkTwoPass->isChecked() ? 2 : 1;
+    QMap<QString, QStringList> jobArgs;
+    if (passes == 2 && !delayedRendering && m_view.twopass_intermediate->isChecked()) {
+        // Render the timeline once to an intermediate file, both passes encode it instead of computing the effects again
+        bool ok;
+        QDir cacheDir = pCore->currentDoc()->getCacheDir(CacheTmpWorkFiles, &ok);
+        if (ok) {
+            const QString hash = QString::fromLatin1(QCryptographicHash::hash(outputFile.toUtf8(), QCryptographicHash::Md5).toHex());
+            const QString intermediateFile = cacheDir.absoluteFilePath(QStringLiteral("twopass-%1.mkv").arg(hash));
+            const QString intermediatePlaylist = QStringUtils::appendToFilename(playlistPath, QStringLiteral("-intermediate"));
+            QDomDocument intermediate = doc.cloneNode(true).toDocument();
+            QDomElement intermediateConsumer = intermediate.elementsByTagName(QStringLiteral("consumer")).at(0).toElement();
+            // Keep the frame and audio format of the output, encode it losslessly
+            static const QStringList keptParams = {QStringLiteral("in"),        QStringLiteral("out"),       QStringLiteral("mlt_service"),
+                                                   QStringLiteral("width"),     QStringLiteral("height"),    QStringLiteral("progressive"),
+                                                   QStringLiteral("top_field_first"), QStringLiteral("deinterlacer"), QStringLiteral("rescale"),
+                                                   QStringLiteral("channels"),  QStringLiteral("frequency"), QStringLiteral("real_time"),
+                                                   QStringLiteral("threads"),   QStringLiteral("an"),        QStringLiteral("vn")};
+            const QDomNamedNodeMap attributes = intermediateConsumer.attributes();
+            QStringList removed;
+            for (int i = 0; i < attributes.count(); i++) {
+                const QString name = attributes.item(i).nodeName();
+                if (!keptParams.contains(name)) {
+                    removed << name;
+                }
+            }
+            for (const QString &name : qAsConst(removed)) {
+                intermediateConsumer.removeAttribute(name);
+            }
+            intermediateConsumer.setAttribute(QStringLiteral("target"), intermediateFile);
+            intermediateConsumer.setAttribute(QStringLiteral("f"), QStringLiteral("matroska"));
+            intermediateConsumer.setAttribute(QStringLiteral("vcodec"), QStringLiteral("ffv1"));
+            // Level 3 allows sliced multithreaded encoding
+            intermediateConsumer.setAttribute(QStringLiteral("level"), 3);
+            intermediateConsumer.setAttribute(QStringLiteral("g"), 1);
+            intermediateConsumer.setAttribute(QStringLiteral("acodec"), QStringLiteral("pcm_s16le"));
+            const QString pixFormat = m_params.value(QStringLiteral("pix_fmt"));
+            if (pixFormat.startsWith(QLatin1String("yuv"))) {
+                intermediateConsumer.setAttribute(QStringLiteral("pix_fmt"), pixFormat);
+            }
+            if (!Xml::docContentToFile(intermediate, intermediatePlaylist)) {
+                pCore->displayMessage(i18n("Cannot write to file %1", intermediatePlaylist), ErrorMessage);
+                return;
+            }
+
+            // The passes encode the intermediate file, with the frames numbered from 0
+            QDomDocument source;
+            QDomElement mlt = source.createElement(QStringLiteral("mlt"));
+            mlt.setAttribute(QStringLiteral("LC_NUMERIC"), doc.documentElement().attribute(QStringLiteral("LC_NUMERIC"), QStringLiteral("C")));
+            source.appendChild(mlt);
+            QDomNodeList profileList = doc.elementsByTagName(QStringLiteral("profile"));
+            if (!profileList.isEmpty()) {
+                mlt.appendChild(source.importNode(profileList.at(profileList.length() - 1), true));
+            }
+            QDomElement sourceConsumer = source.importNode(consumer, true).toElement();
+            sourceConsumer.setAttribute(QStringLiteral("in"), 0);
+            sourceConsumer.setAttribute(QStringLiteral("out"), out - in);
+            mlt.appendChild(sourceConsumer);
+            QDomElement producer = source.createElement(QStringLiteral("producer"));
+            producer.setAttribute(QStringLiteral("id"), QStringLiteral("intermediate"));
+            producer.setAttribute(QStringLiteral("in"), 0);
+            producer.setAttribute(QStringLiteral("out"), out - in);
+            Xml::setXmlProperty(producer, QStringLiteral("resource"), intermediateFile);
+            Xml::setXmlProperty(producer, QStringLiteral("mlt_service"), QStringLiteral("avformat"));
+            mlt.appendChild(producer);
+            doc = source;
+
+            jobArgs.insert(playlistPath, {QStringLiteral("--intermediate"), intermediatePlaylist});
+            jobArgs.insert(QStringUtils::appendToFilename(playlistPath, QStringLiteral("-pass2")), {QStringLiteral("--remove-intermediate"), intermediateFile});
+        } else {
+            qCWarning(KDENLIVE_LOG) << "Cannot access the project cache, rendering both passes from the timeline";
+        }
+    }
     if (passes == 2) {
         // We will generate 2 files, one for each pass.
         clone = doc.cloneNode(true).toDocument();
@@ -983,13 +1109,14 @@ void RenderWidget::generateRenderFiles(const QString playlistPath, QDomDocument
         return;
     }
     QList<RenderJobItem *> jobList;
-    QMap<QString, QString>::const_iterator i = renderFiles.constBegin();
-    while (i != renderFiles.constEnd()) {
-        RenderJobItem *renderItem = createRenderJob(i.key(), i.value(), subtitleFile);
+    QStringList playlists = renderFiles.keys();
+    // Queue the second passes after their first pass
+    std::stable_partition(playlists.begin(), playlists.end(), [](const QString &playlist) { return RenderJobScheduler::firstPass(playlist).isEmpty(); });
+    for (const QString &playlist : qAsConst(playlists)) {
+        RenderJobItem *renderItem = createRenderJob(playlist, renderFiles.value(playlist), subtitleFile, jobArgs.value(playlist));
         if (renderItem != nullptr) {
             jobList << renderItem;
         }
-        ++i;
     }
     if (jobList.count() > 0) {
         m_view.running_jobs->setCurrentItem(jobList.at(0));
@@ -999,13 +1126,17 @@ void RenderWidget::generateRenderFiles(const QString playlistPath, QDomDocument
     checkRenderStatus();
 }
 
-RenderJobItem *RenderWidget::createRenderJob(const QString &playlist, const QString &outputFile, const QString &subtitleFile)
+RenderJobItem *RenderWidget::createRenderJob(const QString &playlist, const QString &outputFile, const QString &subtitleFile, const QStringList &extraArgs)
 {
     QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(outputFile, Qt::MatchExactly, 1);
     RenderJobItem *renderItem = nullptr;
     if (!existing.isEmpty()) {
         renderItem = static_cast<RenderJobItem *>(existing.at(0));
-        if (renderItem->status() == RUNNINGJOB || renderItem->status() == WAITINGJOB || renderItem->status() == STARTINGJOB) {
+        const QString firstPass = RenderJobScheduler::firstPass(playlist);
+        if (!firstPass.isEmpty() && renderItem->status() == WAITINGJOB && renderItem->cost().playlist == firstPass) {
+            // Second pass of a waiting job, both passes write the same file
+            renderItem = nullptr;
+        } else if (renderItem->status() == RUNNINGJOB || renderItem->status() == WAITINGJOB || renderItem->status() == STARTINGJOB) {
             // There is an existing job that is still pending
             KMessageBox::information(this,
                                      i18n("There is already a job writing file:<br /><b>%1</b><br />Abort the job if you want to overwrite it…", outputFile),
@@ -1029,6 +1160,20 @@ RenderJobItem *RenderWidget::createRenderJob(const QString &playlist, const QStr
     if (!subtitleFile.isEmpty()) {
         argsJob << QStringLiteral("--subtitle") << subtitleFile;
     }
+    if (m_view.processing_box->isChecked() && m_view.processing_box->isEnabled() && m_view.processing_segments->value() > 1) {
+        // kdenlive_render falls back to a single process if the output cannot be joined without re-encoding
+        argsJob << QStringLiteral("--segments") << QString::number(m_view.processing_segments->value());
+    }
+    argsJob << extraArgs;
+    if (m_view.smart_render->isChecked()) {
+        // kdenlive_render encodes the whole timeline if no clip can be copied
+        argsJob << QStringLiteral("--smart");
+    }
+    if (RenderServer::workerCount() > 0 && pCore->window()->renderServer() &&
+        (argsJob.contains(QStringLiteral("--segments")) || argsJob.contains(QStringLiteral("--smart")))) {
+        // Segments are rendered by the worker pool, or by the job itself if the workers are not available
+        argsJob << QStringLiteral("--broker") << pCore->window()->renderServer()->serverName();
+    }
     renderItem->setData(1, ParametersRole, argsJob);
     qDebug() << "* CREATED JOB WITH ARGS: " << argsJob;
     renderItem->setData(1, OpenBrowserRole, m_view.open_browser->isChecked());
@@ -1050,46 +1195,76 @@ void RenderWidget::checkRenderStatus()
         return;
     }
 
-    // Make sure no other rendering is running
-    if (runningJobsCount() > 0) {
+    QVector<RenderJobScheduler::Job> running;
+    QVector<RenderJobScheduler::Job> waiting;
+    QList<RenderJobItem *> waitingItems;
+    QStringList failedPlaylists;
+    auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+    while (item != nullptr) {
+        if (item->status() == RUNNINGJOB || item->status() == STARTINGJOB) {
+            running << item->cost();
+        } else if (item->status() == WAITINGJOB) {
+            waiting << item->cost();
+            waitingItems << item;
+        } else if (item->status() == FAILEDJOB || item->status() == ABORTEDJOB) {
+            failedPlaylists << item->cost().playlist;
+        }
+        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
+    }
+    // A second pass cannot run without the statistics of its first pass
+    for (int i = waitingItems.count() - 1; i >= 0; --i) {
+        const QString firstPass = RenderJobScheduler::firstPass(waiting.at(i).playlist);
+        if (!firstPass.isEmpty() && failedPlaylists.contains(firstPass)) {
+            waitingItems.at(i)->setStatus(ABORTEDJOB);
+            waitingItems.removeAt(i);
+            waiting.removeAt(i);
+        }
+    }
+    if (waiting.isEmpty()) {
+        if (running.isEmpty() && m_view.shutdown->isChecked()) {
+            Q_EMIT shutdown();
+        }
         return;
     }
 
-    auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
-
-    bool waitingJob = false;
+    QVector<int> toStart;
+    if (KdenliveSettings::concurrentrenders()) {
+        int threads = KdenliveSettings::renderjobthreads();
+        if (threads <= 0) {
+            threads = QThread::idealThreadCount();
+        }
+        int memory = KdenliveSettings::renderjobmemory();
+        if (memory <= 0) {
+            SysMemInfo meminfo = SysMemInfo::getMemoryInfo();
+            memory = meminfo.isSuccessful() ? meminfo.totalMemory() / 2 : 4096;
+        }
+        toStart = RenderJobScheduler(threads, memory).jobsToStart(running, waiting);
+    } else if (running.isEmpty()) {
+        // Make sure no other rendering is running, then start the first job of the queue
+        toStart << 0;
+    }
 
-    // Find first waiting job
-    while (item != nullptr) {
-        if (item->status() == WAITINGJOB) {
-            QDateTime t = QDateTime::currentDateTime();
-            item->setData(1, StartTimeRole, t);
-            item->setData(1, LastTimeRole, t);
-            waitingJob = true;
-            startRendering(item);
-            // Check for 2 pass encoding
-            QStringList jobData = item->data(1, ParametersRole).toStringList();
-            if (jobData.size() > 2 && jobData.at(1).endsWith(QStringLiteral("-pass2.mlt"))) {
-                // Find and remove 1st pass job
-                QTreeWidgetItem *above = m_view.running_jobs->itemAbove(item);
-                QString firstPassName = jobData.at(1).section(QLatin1Char('-'), 0, -2) + QStringLiteral(".mlt");
-                while (above) {
-                    QStringList aboveData = above->data(1, ParametersRole).toStringList();
-                    qDebug() << "// GOT  JOB: " << aboveData.at(1);
-                    if (aboveData.size() > 2 && aboveData.at(1) == firstPassName) {
-                        delete above;
-                        break;
-                    }
-                    above = m_view.running_jobs->itemAbove(above);
+    for (int index : qAsConst(toStart)) {
+        item = waitingItems.at(index);
+        QDateTime t = QDateTime::currentDateTime();
+        item->setData(1, StartTimeRole, t);
+        item->setData(1, LastTimeRole, t);
+        startRendering(item);
+        const QString firstPass = RenderJobScheduler::firstPass(item->cost().playlist);
+        if (!firstPass.isEmpty()) {
+            // Remove the finished 1st pass job, both passes write the same file
+            auto *above = static_cast<RenderJobItem *>(m_view.running_jobs->itemAbove(item));
+            while (above) {
+                if (above->cost().playlist == firstPass) {
+                    delete above;
+                    break;
                 }
+                above = static_cast<RenderJobItem *>(m_view.running_jobs->itemAbove(above));
             }
+        }
+        if (item->status() == WAITINGJOB) {
             item->setStatus(STARTINGJOB);
-            break;
         }
-        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
-    }
-    if (!waitingJob && m_view.shutdown->isChecked()) {
-        Q_EMIT shutdown();
     }
 }
 
@@ -18,6 +18,7 @@ class Menu;
 
 #include "bin/model/markerlistmodel.hpp"
 #include "definitions.h"
+#include "renderpresets/renderjobscheduler.hpp"
 #include "renderpresets/renderpresetmodel.hpp"
 #include "renderpresets/tree/renderpresettreemodel.hpp"
 #include "ui_renderwidget_ui.h"
@@ -96,10 +97,14 @@ public:
     int status() const;
     void setMetadata(const QString &data);
     const QString metadata() const;
+    /** @brief The estimated cost of the job, read from its scene list on first use */
+    const RenderJobScheduler::Job &cost();
 
 private:
     int m_status;
     QString m_data;
+    RenderJobScheduler::Job m_cost;
+    bool m_hasCost;
 };
 
 class RenderWidget : public QDialog
@@ -239,7 +244,9 @@ private:
     QString generatePlaylistFile(bool delayedRendering);
     void generateRenderFiles(const QString playlistPath, QDomDocument doc, int in, int out, QString outputFile, bool delayedRendering,
                              const QString &subtitleFile = QString());
-    RenderJobItem *createRenderJob(const QString &playlist, const QString &outputFile, const QString &subtitleFile = QString());
+    /** @param extraArgs options of kdenlive_render specific to this playlist */
+    RenderJobItem *createRenderJob(const QString &playlist, const QString &outputFile, const QString &subtitleFile = QString(),
+                                   const QStringList &extraArgs = QStringList());
 
 Q_SIGNALS:
     void abortProcess(const QString &url);
@@ -80,10 +80,48 @@ const QMap<QString, QString> DocumentChecker::getAssetPairs() const
     return assetSearchPairs;
 }
 
+void DocumentChecker::indexDocument()
+{
+    static const QStringList indexedTags = {QStringLiteral("playlist"), QStringLiteral("tractor"),    QStringLiteral("producer"), QStringLiteral("chain"),
+                                            QStringLiteral("entry"),    QStringLiteral("transition"), QStringLiteral("filter")};
+    m_elements.clear();
+    m_entriesByProducer.clear();
+    const QDomElement root = m_doc.documentElement();
+    QDomElement e = root.firstChildElement();
+    // Depth first traversal, so that elements are stored in document order like with elementsByTagName
+    while (!e.isNull()) {
+        const QString tag = e.tagName();
+        if (indexedTags.contains(tag)) {
+            m_elements[tag].append(e);
+            if (tag == QLatin1String("entry")) {
+                m_entriesByProducer[e.attribute(QStringLiteral("producer"))].append(e);
+            }
+        }
+        QDomElement next;
+        if (tag != QLatin1String("property")) {
+            next = e.firstChildElement();
+        }
+        while (next.isNull() && !e.isNull()) {
+            next = e.nextSiblingElement();
+            if (next.isNull()) {
+                QDomNode parent = e.parentNode();
+                e = parent == root ? QDomElement() : parent.toElement();
+            }
+        }
+        e = next;
+    }
+}
+
+const QVector<QDomElement> DocumentChecker::indexedElements(const QString &tagName) const
+{
+    return m_elements.value(tagName);
+}
+
 bool DocumentChecker::hasErrorInClips()
 {
     int max;
     QDomElement baseElement = m_doc.documentElement();
+    indexDocument();
     QString root = baseElement.attribute(QStringLiteral("root"));
     if (!root.isEmpty()) {
         QDir dir(root);
@@ -101,10 +139,10 @@ bool DocumentChecker::hasErrorInClips()
     // Check if strorage folder for temp files exists
     QString storageFolder;
     QDir projectDir(m_url.adjusted(QUrl::RemoveFilename).toLocalFile());
-    QDomNodeList playlists = m_doc.elementsByTagName(QStringLiteral("playlist"));
+    const QVector<QDomElement> playlists = indexedElements(QStringLiteral("playlist"));
     for (int i = 0; i < playlists.count(); ++i) {
-        if (playlists.at(i).toElement().attribute(QStringLiteral("id")) == BinPlaylist::binPlaylistId) {
-            QDomElement mainBinPlaylist = playlists.at(i).toElement();
+        if (playlists.at(i).attribute(QStringLiteral("id")) == BinPlaylist::binPlaylistId) {
+            QDomElement mainBinPlaylist = playlists.at(i);
             m_documentid = Xml::getXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.documentid"));
             if (m_documentid.isEmpty()) {
                 // invalid document id, recreate one
@@ -132,16 +170,13 @@ bool DocumentChecker::hasErrorInClips()
 
     // Fill list of project tractors to detect corruptions
     m_tractorsList.clear();
-    QDomNodeList documentTractors = m_doc.elementsByTagName(QStringLiteral("tractor"));
-    max = documentTractors.count();
-    for (int i = 0; i < max; ++i) {
-        QDomElement e = documentTractors.item(i).toElement();
+    const QVector<QDomElement> documentTractors = indexedElements(QStringLiteral("tractor"));
+    for (const QDomElement &e : documentTractors) {
         m_tractorsList.append(e.attribute(QStringLiteral("id")));
     }
 
-    QDomNodeList documentProducers = m_doc.elementsByTagName(QStringLiteral("producer"));
-    QDomNodeList documentChains = m_doc.elementsByTagName(QStringLiteral("chain"));
-    QDomNodeList entries = m_doc.elementsByTagName(QStringLiteral("entry"));
+    const QVector<QDomElement> documentProducers = indexedElements(QStringLiteral("producer"));
+    const QVector<QDomElement> documentChains = indexedElements(QStringLiteral("chain"));
     QDomElement profile = baseElement.firstChildElement(QStringLiteral("profile"));
     bool hdProfile = true;
     if (!profile.isNull()) {
@@ -154,19 +189,21 @@ bool DocumentChecker::hasErrorInClips()
     m_missingFonts.clear();
     m_changedClips.clear();
     m_fixedSequences.clear();
-    QStringList verifiedPaths;
-    QStringList missingPaths;
+    QSet<QString> verifiedPaths;
+    QSet<QString> missingPaths;
     QStringList serviceToCheck = {QStringLiteral("kdenlivetitle"), QStringLiteral("qimage"), QStringLiteral("pixbuf"), QStringLiteral("timewarp"),
                                   QStringLiteral("framebuffer"),   QStringLiteral("xml"),    QStringLiteral("qtext"),  QStringLiteral("tractor")};
-    max = documentProducers.count();
-    for (int i = 0; i < max; ++i) {
-        QDomElement e = documentProducers.item(i).toElement();
-        verifiedPaths << getMissingProducers(e, entries, verifiedPaths, missingPaths, serviceToCheck, root, storageFolder);
+    for (QDomElement e : documentProducers) {
+        const QString verified = getMissingProducers(e, verifiedPaths, missingPaths, serviceToCheck, root, storageFolder);
+        if (!verified.isEmpty()) {
+            verifiedPaths.insert(verified);
+        }
     }
-    max = documentChains.count();
-    for (int i = 0; i < max; ++i) {
-        QDomElement e = documentChains.item(i).toElement();
-        verifiedPaths << getMissingProducers(e, entries, verifiedPaths, missingPaths, serviceToCheck, root, storageFolder);
+    for (QDomElement e : documentChains) {
+        const QString verified = getMissingProducers(e, verifiedPaths, missingPaths, serviceToCheck, root, storageFolder);
+        if (!verified.isEmpty()) {
+            verifiedPaths.insert(verified);
+        }
     }
 
     // Get list of used Luma files
@@ -176,10 +213,8 @@ bool DocumentChecker::hasErrorInClips()
     QString filePath;
     QMap<QString, QString> lumaSearchPairs = getLumaPairs();
 
-    QDomNodeList trans = m_doc.elementsByTagName(QStringLiteral("transition"));
-    max = trans.count();
-    for (int i = 0; i < max; ++i) {
-        QDomElement transition = trans.at(i).toElement();
+    const QVector<QDomElement> trans = indexedElements(QStringLiteral("transition"));
+    for (const QDomElement &transition : trans) {
         QString service = getProperty(transition, QStringLiteral("mlt_service"));
         QString luma;
         if (lumaSearchPairs.contains(service)) {
@@ -243,8 +278,7 @@ bool DocumentChecker::hasErrorInClips()
         }
     }
     if (!autoFixLuma.isEmpty()) {
-        for (int i = 0; i < max; ++i) {
-            QDomElement transition = trans.at(i).toElement();
+        for (const QDomElement &transition : trans) {
             QString service = getProperty(transition, QStringLiteral("mlt_service"));
             QString luma;
             if (lumaSearchPairs.contains(service)) {
@@ -257,12 +291,10 @@ bool DocumentChecker::hasErrorInClips()
     }
     // Check for missing effects and filter assets
     QMap<QString, QString> assetSearchPairs = getAssetPairs();
-    QDomNodeList effs = m_doc.elementsByTagName(QStringLiteral("filter"));
-    max = effs.count();
+    const QVector<QDomElement> effs = indexedElements(QStringLiteral("filter"));
     QStringList filters;
     QStringList assetsToCheck;
-    for (int i = 0; i < max; ++i) {
-        QDomElement filter = effs.at(i).toElement();
+    for (const QDomElement &filter : effs) {
         QString service = getProperty(filter, QStringLiteral("kdenlive_id"));
         if (service.isEmpty()) {
             service = getProperty(filter, QStringLiteral("mlt_service"));
@@ -296,12 +328,10 @@ bool DocumentChecker::hasErrorInClips()
 
     if (!m_missingFilters.isEmpty()) {
         // Delete missing effects
-        for (int i = 0; i < effs.count(); ++i) {
-            QDomElement e = effs.item(i).toElement();
+        for (const QDomElement &e : effs) {
             if (m_missingFilters.contains(getProperty(e, QStringLiteral("kdenlive_id")))) {
                 // Remove clip
                 e.parentNode().removeChild(e);
-                --i;
             }
         }
     }
@@ -549,7 +579,7 @@ bool DocumentChecker::hasErrorInClips()
         Xml::setXmlProperty(e, QStringLiteral("kdenlive:proxy"), QStringLiteral("-"));
         // Replace proxy url with real clip in MLT producers
         auto replaceProxy = [this](QDomElement &mltProd, const QString &id, const QString &realPath, const QString &originalService,
-                                   const QStringList &missingPaths) {
+                                   const QSet<QString> &missingPaths) {
             QString parentId = Xml::getXmlProperty(mltProd, QStringLiteral("kdenlive:id"));
             if (parentId == id) {
                 // Hit, we must replace url
@@ -703,8 +733,8 @@ const QString DocumentChecker::relocateResource(QString sourceResource)
     return QString();
 }
 
-QString DocumentChecker::getMissingProducers(QDomElement &e, const QDomNodeList &entries, const QStringList &verifiedPaths, QStringList &missingPaths,
-                                             const QStringList &serviceToCheck, const QString &root, const QString &storageFolder)
+QString DocumentChecker::getMissingProducers(QDomElement &e, const QSet<QString> &verifiedPaths, QSet<QString> &missingPaths, const QStringList &serviceToCheck,
+                                             const QString &root, const QString &storageFolder)
 {
     QString service = Xml::getXmlProperty(e, QStringLiteral("mlt_service"));
     if (!service.startsWith(QLatin1String("avformat")) && !serviceToCheck.contains(service)) {
@@ -712,17 +742,12 @@ QString DocumentChecker::getMissingProducers(QDomElement &e, const QDomNodeList
     }
     if (Xml::getXmlProperty(e, QStringLiteral("kdenlive:id")).isEmpty()) {
         // This should not happen, try to recover the producer id
-        int max2 = entries.count();
-        QString producerName = e.attribute(QStringLiteral("id"));
-        for (int j = 0; j < max2; j++) {
-            QDomElement e2 = entries.item(j).toElement();
-            if (e2.attribute(QStringLiteral("producer")) == producerName) {
-                // Matche found
-                QString entryName = Xml::getXmlProperty(e2, QStringLiteral("kdenlive:id"));
-                if (!entryName.isEmpty()) {
-                    Xml::setXmlProperty(e, QStringLiteral("kdenlive:id"), entryName);
-                    break;
-                }
+        const QVector<QDomElement> entries = m_entriesByProducer.value(e.attribute(QStringLiteral("id")));
+        for (const QDomElement &e2 : entries) {
+            QString entryName = Xml::getXmlProperty(e2, QStringLiteral("kdenlive:id"));
+            if (!entryName.isEmpty()) {
+                Xml::setXmlProperty(e, QStringLiteral("kdenlive:id"), entryName);
+                break;
             }
         }
     }
@@ -898,7 +923,7 @@ QString DocumentChecker::getMissingProducers(QDomElement &e, const QDomNodeList
                 // clip has proxy but original clip is missing
                 m_missingSources.append(e);
             }
-            missingPaths.append(original);
+            missingPaths.insert(original);
         } else if (!proxyFound) {
             m_missingProxies.append(e);
         }
@@ -947,10 +972,10 @@ QString DocumentChecker::getMissingProducers(QDomElement &e, const QDomNodeList
                          QLatin1String("timeremap")))) {
             // This is a missing timeline sequence clip with speed effect, trigger recreate on opening
             Xml::setXmlProperty(e, QStringLiteral("_rebuild"), QStringLiteral("1"));
-            missingPaths.append(resource);
+            missingPaths.insert(resource);
         } else {
             m_missingClips.append(e);
-            missingPaths.append(resource);
+            missingPaths.insert(resource);
         }
     } else if (isBinClip &&
                (service.startsWith(QLatin1String("avformat")) || slideshow || service == QLatin1String("qimage") || service == QLatin1String("pixbuf"))) {
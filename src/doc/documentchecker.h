@@ -11,6 +11,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include <QDir>
 #include <QDomElement>
+#include <QHash>
+#include <QSet>
 #include <QUrl>
 
 class DocumentChecker : public QObject
@@ -68,7 +70,10 @@ private:
     QStringList m_changedClips;
     QStringList m_fixedSequences;
     QStringList m_tractorsList;
-    QStringList m_binIds;
+    QSet<QString> m_binIds;
+    QHash<QString, QVector<QDomElement>> m_elements;
+    /** @brief The playlist entries indexed by the id of their producer */
+    QHash<QString, QVector<QDomElement>> m_entriesByProducer;
     // List clips whose proxy is missing
     QList<QDomElement> m_missingProxies;
     // List clips who have a working proxy but no source clip
@@ -87,8 +92,12 @@ private:
     /** @brief Remove _missingsourcec flag in fixed clips */
     void fixMissingSource(const QString &id, const QDomNodeList &producers, const QDomNodeList &chains);
     /** @brief Check for various missing elements */
-    QString getMissingProducers(QDomElement &e, const QDomNodeList &entries, const QStringList &verifiedPaths, QStringList &missingPaths,
-                                const QStringList &serviceToCheck, const QString &root, const QString &storageFolder);
+    QString getMissingProducers(QDomElement &e, const QSet<QString> &verifiedPaths, QSet<QString> &missingPaths, const QStringList &serviceToCheck,
+                                const QString &root, const QString &storageFolder);
+    /** @brief Collect the elements we need to check in a single pass over the document */
+    void indexDocument();
+    /** @brief Returns the indexed elements with tag @param tagName, in document order */
+    const QVector<QDomElement> indexedElements(const QString &tagName) const;
     /** @brief If project path changed, try to relocate its resources */
     const QString relocateResource(QString sourceResource);
 
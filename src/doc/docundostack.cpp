@@ -4,12 +4,53 @@
 */
 
 #include "docundostack.hpp"
+#include "kdenlivesettings.h"
+#include "undohelper.hpp"
 #include <QUndoCommand>
 #include <QUndoGroup>
 
+namespace {
+// Estimate for the commands that do not report their memory usage, they mostly store a few parameter values
+constexpr qint64 DefaultCommandCost = 1024;
+
+qint64 commandCost(const QUndoCommand *cmd)
+{
+    qint64 cost = 0;
+    if (auto *functional = dynamic_cast<const FunctionalUndoCommand *>(cmd)) {
+        cost = functional->memoryCost();
+    } else if (!cmd->isObsolete()) {
+        cost = DefaultCommandCost + cmd->text().size() * qint64(sizeof(QChar));
+    }
+    for (int i = 0; i < cmd->childCount(); ++i) {
+        cost += commandCost(cmd->child(i));
+    }
+    return cost;
+}
+
+/** @brief Free what we can in a command and mark it obsolete, so that it is silently dropped when reached by an undo */
+void discardCommand(QUndoCommand *cmd)
+{
+    if (auto *functional = dynamic_cast<FunctionalUndoCommand *>(cmd)) {
+        functional->compact();
+    }
+    for (int i = 0; i < cmd->childCount(); ++i) {
+        discardCommand(const_cast<QUndoCommand *>(cmd->child(i)));
+    }
+    cmd->setObsolete(true);
+}
+} // namespace
+
 DocUndoStack::DocUndoStack(QUndoGroup *parent)
     : QUndoStack(parent)
+    , m_memoryBudget(qint64(KdenliveSettings::undomemorybudget()) * 1024 * 1024)
+    , m_memoryUsage(0)
 {
+    connect(this, &QUndoStack::indexChanged, this, [this]() {
+        if (count() == 0) {
+            // The history was cleared
+            m_memoryUsage = 0;
+        }
+    });
 }
 
 // TODO: custom undostack everywhere do that
@@ -17,6 +58,49 @@ void DocUndoStack::push(QUndoCommand *cmd)
 {
     if (index() < count()) {
         Q_EMIT invalidate(index());
+        // QUndoStack deletes the steps that could be redone
+        for (int i = index(); i < count(); ++i) {
+            m_memoryUsage -= commandCost(command(i));
+        }
     }
+    const int previousIndex = index();
+    const qint64 previousCost = previousIndex > 0 ? commandCost(command(previousIndex - 1)) : 0;
+    const qint64 cost = commandCost(cmd);
     QUndoStack::push(cmd);
+    if (index() > previousIndex) {
+        m_memoryUsage += cost;
+    } else if (previousIndex > 0) {
+        // The command was merged in the previous one, which may have become obsolete and been deleted
+        m_memoryUsage += (index() == previousIndex ? commandCost(command(previousIndex - 1)) : 0) - previousCost;
+    }
+    if (m_memoryBudget > 0 && m_memoryUsage > m_memoryBudget) {
+        enforceMemoryBudget();
+    }
+}
+
+void DocUndoStack::setMemoryBudget(qint64 bytes)
+{
+    m_memoryBudget = bytes;
+    if (m_memoryBudget > 0 && m_memoryUsage > m_memoryBudget) {
+        enforceMemoryBudget();
+    }
+}
+
+qint64 DocUndoStack::memoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+void DocUndoStack::enforceMemoryBudget()
+{
+    // Always discard the oldest steps first so that the remaining history stays consistent, and never the most recent one
+    const int last = index() - 1;
+    for (int i = 0; i < last && m_memoryUsage > m_memoryBudget; ++i) {
+        auto *cmd = const_cast<QUndoCommand *>(command(i));
+        if (cmd->isObsolete()) {
+            continue;
+        }
+        m_memoryUsage -= commandCost(cmd);
+        discardCommand(cmd);
+    }
 }
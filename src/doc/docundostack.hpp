@@ -16,6 +16,18 @@ class DocUndoStack : public QUndoStack
 public:
     explicit DocUndoStack(QUndoGroup *parent = Q_NULLPTR);
     void push(QUndoCommand *cmd);
+    /** @brief Set the approximate memory (in bytes) the undo history may use, 0 for no limit.
+     *  When exceeded, the oldest undo steps are compacted and can no longer be undone. */
+    void setMemoryBudget(qint64 bytes);
+    /** @brief Returns the approximate memory held by the commands of this stack, in bytes. */
+    qint64 memoryUsage() const;
+
+private:
+    qint64 m_memoryBudget;
+    qint64 m_memoryUsage;
+    /** @brief Compact the oldest undo commands until the history fits in the memory budget. */
+    void enforceMemoryBudget();
+
 Q_SIGNALS:
     void invalidate(int ix);
 };
@@ -46,9 +46,11 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QFile>
 #include <QFileDialog>
 #include <QSaveFile>
+#include <QSet>
 #include <QStandardPaths>
 #include <QUndoGroup>
 #include <QUndoStack>
+#include <QtConcurrent>
 #include <memory>
 #include <mlt++/Mlt.h>
 
@@ -264,6 +266,10 @@ DocOpenResult KdenliveDoc::Open(const QUrl &url, const QString &projectFolder, Q
         return result;
     }
 
+    if (KdenliveSettings::lazyclipload()) {
+        deferUnusedClips(domDoc);
+    }
+
     // create KdenliveDoc object
     auto doc = std::unique_ptr<KdenliveDoc>(new KdenliveDoc(url, domDoc, projectFolder, undoGroup, parent));
     if (!validationResult.second.isEmpty()) {
@@ -327,6 +333,7 @@ KdenliveDoc::~KdenliveDoc()
     m_commandStack->clear();
     m_timelines.clear();
     // qCDebug(KDENLIVE_LOG) << "// DEL CLP MAN done";
+    waitForAutoSave();
     if (m_autosave) {
         if (!m_autosave->fileName().isEmpty()) {
             m_autosave->remove();
@@ -544,28 +551,73 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
            (width < 0 || width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt());
 }
 
-void KdenliveDoc::slotAutoSave(const QString &scene)
+void KdenliveDoc::slotAutoSave(const QString &scene, const QMap<QString, QString> &replacements)
 {
     if (m_autosave != nullptr) {
-        if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
-            // show error: could not open the autosave file
-            qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
-            pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
-            return;
-        }
         if (scene.isEmpty()) {
             // Make sure we don't save if scenelist is corrupted
             KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
             return;
         }
-        m_autosave->resize(0);
-        if (m_autosave->write(scene.toUtf8()) < 0) {
+        // Only one write to the autosave file at a time
+        waitForAutoSave();
+        if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
+            // show error: could not open the autosave file
+            qCDebug(KDENLIVE_LOG) << "ERROR; CANNOT CREATE AUTOSAVE FILE";
             pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
+            return;
         }
-        m_autosave->flush();
+        m_autoSavedCount = m_modificationCount;
+        // Only the MLT scene list is built on the GUI thread. Processing it as a document, encoding and writing it
+        // can take a while on large projects, do it in a background thread
+        KAutoSaveFile *autosave = m_autosave;
+        m_autoSaveFuture = QtConcurrent::run([this, autosave, scene, replacements]() {
+            QString sceneText = scene;
+            QMapIterator<QString, QString> i(replacements);
+            while (i.hasNext()) {
+                i.next();
+                sceneText.replace(i.key(), i.value());
+            }
+            const QDomDocument sceneList = xmlSceneList(sceneText);
+            if (sceneList.isNull()) {
+                // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted. Don't save in that case.
+                QMetaObject::invokeMethod(
+                    this,
+                    [this]() {
+                        m_autoSavedCount = -1;
+                        pCore->displayMessage(
+                            i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"),
+                            ErrorMessage);
+                    },
+                    Qt::QueuedConnection);
+                return;
+            }
+            const QByteArray sceneData = sceneList.toString().toUtf8();
+            autosave->resize(0);
+            if (autosave->write(sceneData) < 0) {
+                const QString message = i18n("Cannot create autosave file %1", autosave->fileName());
+                QMetaObject::invokeMethod(this, [message]() { pCore->displayMessage(message, ErrorMessage); }, Qt::QueuedConnection);
+            }
+            autosave->flush();
+        });
     }
 }
 
+bool KdenliveDoc::autoSaveNeeded() const
+{
+    return m_autoSavedCount != m_modificationCount;
+}
+
+bool KdenliveDoc::isAutoSaving() const
+{
+    return m_autoSaveFuture.isRunning();
+}
+
+void KdenliveDoc::waitForAutoSave()
+{
+    m_autoSaveFuture.waitForFinished();
+}
+
 void KdenliveDoc::setZoom(const QUuid &uuid, int horizontal, int vertical)
 {
     setSequenceProperty(uuid, QStringLiteral("zoom"), horizontal);
@@ -676,15 +728,6 @@ QDomDocument KdenliveDoc::xmlSceneList(const QString &scene)
     }*/
     // addedXml.appendChild(sceneList.importNode(customeffects.documentElement(), true));
 
-    // TODO: move metadata to previous step in saving process
-    QDomElement docmetadata = sceneList.createElement(QStringLiteral("documentmetadata"));
-    QMapIterator<QString, QString> j(m_documentMetadata);
-    while (j.hasNext()) {
-        j.next();
-        docmetadata.setAttribute(j.key(), j.value());
-    }
-    // addedXml.appendChild(docmetadata);
-
     return sceneList;
 }
 
@@ -985,6 +1028,9 @@ void KdenliveDoc::slotModified()
 void KdenliveDoc::setModified(bool mod)
 {
     // fix mantis#3160: The document may have an empty URL if not saved yet, but should have a m_autosave in any case
+    if (mod) {
+        m_modificationCount++;
+    }
     if ((m_autosave != nullptr) && mod && KdenliveSettings::crashrecovery()) {
         Q_EMIT startAutoSave();
     }
@@ -1716,7 +1762,7 @@ void KdenliveDoc::loadDocumentProperties()
 
 void KdenliveDoc::updateProjectProfile(bool reloadProducers, bool reloadThumbs)
 {
-    pCore->taskManager.slotCancelJobs(false, {AbstractTask::PROXYJOB, AbstractTask::AUDIOTHUMBJOB, AbstractTask::TRANSCODEJOB});
+    pCore->taskManager.slotCancelJobs(false, {AbstractTask::PROXYJOB, AbstractTask::AUDIOTHUMBJOB, AbstractTask::MEDIAANALYSISJOB, AbstractTask::TRANSCODEJOB});
     double fps = pCore->getCurrentFps();
     double fpsChanged = m_timecode.fps() / fps;
     m_timecode.setFormat(fps);
@@ -1736,7 +1782,7 @@ void KdenliveDoc::resetProfile(bool reloadThumbs)
 void KdenliveDoc::slotSwitchProfile(const QString &profile_path, bool reloadThumbs)
 {
     // Discard all current jobs except proxy and audio thumbs
-    pCore->taskManager.slotCancelJobs(false, {AbstractTask::PROXYJOB, AbstractTask::AUDIOTHUMBJOB, AbstractTask::TRANSCODEJOB});
+    pCore->taskManager.slotCancelJobs(false, {AbstractTask::PROXYJOB, AbstractTask::AUDIOTHUMBJOB, AbstractTask::MEDIAANALYSISJOB, AbstractTask::TRANSCODEJOB});
     pCore->setCurrentProfile(profile_path);
     updateProjectProfile(true, reloadThumbs);
     // In case we only have one clip in timeline,
@@ -1801,7 +1847,7 @@ void KdenliveDoc::switchProfile(ProfileParam *pf, const QString &clipName)
             switch (answer) {
             case KMessageBox::PrimaryAction:
                 // Discard all current jobs
-                pCore->taskManager.slotCancelJobs(false, {AbstractTask::PROXYJOB, AbstractTask::AUDIOTHUMBJOB, AbstractTask::TRANSCODEJOB});
+                pCore->taskManager.slotCancelJobs(false, {AbstractTask::PROXYJOB, AbstractTask::AUDIOTHUMBJOB, AbstractTask::MEDIAANALYSISJOB, AbstractTask::TRANSCODEJOB});
                 KdenliveSettings::setDefault_profile(profile->path());
                 pCore->setCurrentProfile(profile->path());
                 updateProjectProfile(true, true);
@@ -1837,7 +1883,7 @@ void KdenliveDoc::switchProfile(ProfileParam *pf, const QString &clipName)
                                          .arg(QString::number(double(profile->m_frame_rate_num) / profile->m_frame_rate_den, 'f', 2));
             QString profilePath = ProfileRepository::get()->saveProfile(profile.get());
             // Discard all current jobs
-            pCore->taskManager.slotCancelJobs(false, {AbstractTask::PROXYJOB, AbstractTask::AUDIOTHUMBJOB, AbstractTask::TRANSCODEJOB});
+            pCore->taskManager.slotCancelJobs(false, {AbstractTask::PROXYJOB, AbstractTask::AUDIOTHUMBJOB, AbstractTask::MEDIAANALYSISJOB, AbstractTask::TRANSCODEJOB});
             pCore->setCurrentProfile(profilePath);
             updateProjectProfile(true, true);
             Q_EMIT docModified(true);
@@ -2271,6 +2317,67 @@ void KdenliveDoc::disableSubtitles(QDomDocument &doc)
     }
 }
 
+void KdenliveDoc::deferUnusedClips(QDomDocument &doc)
+{
+    QMap<QString, QDomElement> services;
+    QDomNodeList producers = doc.elementsByTagName(QStringLiteral("producer"));
+    for (int i = 0; i < producers.count(); ++i) {
+        QDomElement e = producers.item(i).toElement();
+        services.insert(e.attribute(QStringLiteral("id")), e);
+    }
+    QDomNodeList chains = doc.elementsByTagName(QStringLiteral("chain"));
+    for (int i = 0; i < chains.count(); ++i) {
+        QDomElement e = chains.item(i).toElement();
+        services.insert(e.attribute(QStringLiteral("id")), e);
+    }
+    // Collect the clips used in a timeline, they need a real producer for playback
+    QSet<QString> usedIds;
+    QList<QDomElement> binEntries;
+    QDomNodeList playlists = doc.elementsByTagName(QStringLiteral("playlist"));
+    for (int i = 0; i < playlists.count(); ++i) {
+        QDomElement playlist = playlists.item(i).toElement();
+        bool isBin = playlist.attribute(QStringLiteral("id")) == BinPlaylist::binPlaylistId;
+        QDomNodeList entries = playlist.elementsByTagName(QStringLiteral("entry"));
+        for (int j = 0; j < entries.count(); ++j) {
+            QDomElement entry = entries.item(j).toElement();
+            if (isBin) {
+                binEntries << entry;
+                continue;
+            }
+            const QDomElement prod = services.value(entry.attribute(QStringLiteral("producer")));
+            if (!prod.isNull()) {
+                usedIds.insert(Xml::getXmlProperty(prod, QStringLiteral("kdenlive:id")));
+            }
+        }
+    }
+    int deferred = 0;
+    for (const QDomElement &entry : qAsConst(binEntries)) {
+        QDomElement prod = services.value(entry.attribute(QStringLiteral("producer")));
+        if (prod.isNull() || usedIds.contains(Xml::getXmlProperty(prod, QStringLiteral("kdenlive:id")))) {
+            continue;
+        }
+        const QString service = Xml::getXmlProperty(prod, QStringLiteral("mlt_service"));
+        if (service != QLatin1String("avformat") && service != QLatin1String("avformat-novalidate")) {
+            continue;
+        }
+        if (prod.hasAttribute(QStringLiteral("_missingsource")) || Xml::hasXmlProperty(prod, QStringLiteral("_placeholder")) ||
+            Xml::getXmlProperty(prod, QStringLiteral("kdenlive:proxy")).length() > 2) {
+            continue;
+        }
+        // We need the saved metadata to describe the clip without opening it
+        if (Xml::getXmlProperty(prod, QStringLiteral("length")).toInt() <= 0 || !Xml::hasXmlProperty(prod, QStringLiteral("meta.media.nb_streams"))) {
+            continue;
+        }
+        Xml::setXmlProperty(prod, QStringLiteral("_lazy_service"), service);
+        Xml::setXmlProperty(prod, QStringLiteral("mlt_service"), QStringLiteral("color"));
+        if (prod.tagName() == QLatin1String("chain")) {
+            prod.setTagName(QStringLiteral("producer"));
+        }
+        deferred++;
+    }
+    qCDebug(KDENLIVE_LOG) << "Deferred the loading of" << deferred << "unused clips";
+}
+
 void KdenliveDoc::processProxyNodes(QDomNodeList producers, const QString &root, const QMap<QString, QString> &proxies)
 {
 
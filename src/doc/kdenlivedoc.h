@@ -15,6 +15,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <KJob>
 #include <QAction>
 #include <QDir>
+#include <QFuture>
 #include <QList>
 #include <QMap>
 #include <QObject>
@@ -142,8 +143,9 @@ public:
     void setZoom(const QUuid &uuid, int horizontal, int vertical = -1);
     QPoint zoom(const QUuid &uuid) const;
     double dar() const;
-    /** @brief Returns the project file xml. */
-    QDomDocument xmlSceneList(const QString &scene);
+    /** @brief Returns the project file xml built from the MLT @p scene, a null document if it is corrupted.
+     *  Only works on its argument, so it can run outside of the GUI thread. */
+    static QDomDocument xmlSceneList(const QString &scene);
     /** @brief Saves the project file xml to a file. */
     bool saveSceneList(const QString &path, const QString &scene);
     void cacheImage(const QString &fileId, const QImage &img) const;
@@ -293,6 +295,14 @@ public:
     static void processProxyNodes(QDomNodeList producers, const QString &root, const QMap<QString, QString> &proxies);
     /** @brief Disable all subtitle filters of @param doc */
     static void disableSubtitles(QDomDocument &doc);
+    /** @brief Replace bin clips that are not used in any timeline by lightweight placeholders, loaded on demand. */
+    static void deferUnusedClips(QDomDocument &doc);
+    /** @brief Returns true if the document changed since the last autosave. */
+    bool autoSaveNeeded() const;
+    /** @brief Returns true if an autosave is currently being written in the background. */
+    bool isAutoSaving() const;
+    /** @brief Block until a pending background autosave has been written. */
+    void waitForAutoSave();
 
 private:
     /** @brief Create a new KdenliveDoc using the provided QDomDocument (an
@@ -314,6 +324,12 @@ private:
 
     /** @brief Tells whether the current document has been changed after being saved. */
     bool m_modified;
+    /** @brief Incremented on each document modification, used to skip autosaves when nothing changed. */
+    int m_modificationCount{0};
+    /** @brief Value of m_modificationCount when the last autosave was started. */
+    int m_autoSavedCount{-1};
+    /** @brief The background task writing the autosave file. */
+    QFuture<void> m_autoSaveFuture;
 
     /** @brief The default recommended proxy extension */
     QString m_proxyExtension;
@@ -370,8 +386,10 @@ public Q_SLOTS:
                               QUndoCommand *masterCommand = nullptr);
     /** @brief Saves the current project at the autosave location.
      *
-     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/ */
-    void slotAutoSave(const QString &scene);
+     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/
+     * @param scene the MLT scene list, processed and written in a background thread
+     * @param replacements the strings to replace in @p scene before processing it */
+    void slotAutoSave(const QString &scene, const QMap<QString, QString> &replacements = QMap<QString, QString>());
     void switchProfile(ProfileParam* pf, const QString &clipName);
 
 private Q_SLOTS:
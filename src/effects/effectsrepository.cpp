@@ -7,6 +7,7 @@
 #include "core.h"
 #include "kdenlivesettings.h"
 #include "profiles/profilemodel.hpp"
+#include "utils/tracer.hpp"
 #include "xml/xml.hpp"
 
 #include <QApplication>
@@ -26,6 +27,7 @@ std::once_flag EffectsRepository::m_onceFlag;
 EffectsRepository::EffectsRepository()
     : AbstractAssetsRepository<AssetListType::AssetType>()
 {
+    TRACE_SCOPE("EffectsRepository", "startup");
     init();
     // Check that our favorite effects are valid
     QStringList invalidEffect;
@@ -200,6 +202,11 @@ QString EffectsRepository::assetPreferredListPath() const
     return QStringLiteral(":data/preferred_effects.txt");
 }
 
+QString EffectsRepository::assetCacheName() const
+{
+    return QStringLiteral("effects.cache");
+}
+
 bool EffectsRepository::isPreferred(const QString &effectId) const
 {
     return m_preferred_list.contains(effectId);
@@ -169,6 +169,7 @@ void EffectStackModel::removeEffect(const std::shared_ptr<EffectItemModel> &effe
     Fun redo = removeItem_lambda(effect->getId());
     bool res = redo();
     if (res) {
+        FunctionalUndoCommand::reportMemoryCost(FunctionalUndoCommand::propertiesCost(effect->filter()));
         int inFades = int(m_fadeIns.size());
         int outFades = int(m_fadeOuts.size());
         m_fadeIns.erase(effect->getId());
@@ -963,6 +964,17 @@ void EffectStackModel::setEffectStackEnabled(bool enabled)
     Q_EMIT enabledStateChanged();
 }
 
+void EffectStackModel::updateDescriptors()
+{
+    QReadLocker locker(&m_lock);
+    for (const auto &leaf : rootItem->getLeaves()) {
+        std::shared_ptr<AbstractEffectItem> item = std::static_pointer_cast<AbstractEffectItem>(leaf);
+        if (item->effectItemType() == EffectItemType::Effect) {
+            std::static_pointer_cast<EffectItemModel>(leaf)->updateDescriptors();
+        }
+    }
+}
+
 std::shared_ptr<AbstractEffectItem> EffectStackModel::getEffectStackRow(int row, const std::shared_ptr<TreeItem> &parentItem)
 {
     return std::static_pointer_cast<AbstractEffectItem>(parentItem ? parentItem->child(row) : rootItem->child(row));
@@ -59,6 +59,9 @@ public:
      */
     void setEffectStackEnabled(bool enabled);
 
+    /** @brief Evaluate again the parameter attributes of the effects that depend on the owner, see AssetParameterModel::updateDescriptors() */
+    void updateDescriptors();
+
     /** @brief Returns an effect or group from the stack (at the given row) */
     std::shared_ptr<AbstractEffectItem> getEffectStackRow(int row, const std::shared_ptr<TreeItem> &parentItem = nullptr);
     std::shared_ptr<AssetParameterModel> getAssetModelById(const QString &effectId);
@@ -44,6 +44,8 @@ AbstractTask::AbstractTask(const ObjectId &owner, JOBTYPE type, QObject *object)
     , m_isForce(false)
     , m_running(false)
     , m_type(type)
+    , m_fps(0)
+    , m_speed(0)
 {
     setAutoDelete(false);
     m_uuid = QUuid::createUuid();
@@ -95,6 +97,22 @@ void AbstractTask::run()
     qDebug() << "============0\n\nABSTRACT TASKSTARTRING\n\n==================";
 }
 
+bool AbstractTask::parseProcessProgress(const QByteArray &data)
+{
+    if (!m_processProgress.parse(data)) {
+        return false;
+    }
+    m_progress = m_processProgress.percent();
+    setProcessThroughput(m_processProgress.fps(), m_processProgress.speed());
+    return true;
+}
+
+void AbstractTask::setProcessThroughput(double fps, double speed)
+{
+    m_fps = qRound(fps * 100);
+    m_speed = qRound(speed * 100);
+}
+
 // Background tasks should not slow down the main UI too much. Unless the user
 // has opted out, lower the priority of proxy and transcode tasks.
 void AbstractTask::setPreferredPriority(qint64 pid)
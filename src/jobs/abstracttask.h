@@ -7,6 +7,7 @@
 #pragma once
 
 #include "definitions.h"
+#include "processprogress.h"
 
 #include <QAtomicInt>
 #include <QMutex>
@@ -32,7 +33,9 @@ public:
         LOADJOB = 8,
         AUDIOTHUMBJOB = 9,
         SPEEDJOB = 10,
-        CACHEJOB = 11
+        CACHEJOB = 11,
+        LOUDNESSJOB = 12,
+        MEDIAANALYSISJOB = 13
     };
     AbstractTask(const ObjectId &owner, JOBTYPE type, QObject* object);
     ~AbstractTask() override;
@@ -53,13 +56,23 @@ protected:
     bool m_isForce;
     bool m_running;
     QUuid m_uuid;
+    /** @brief Parser for the progress reported by the external process of the task */
+    ProcessProgress m_processProgress;
     void run() override;
     void cleanup();
+    /** @brief Parse the output of the task process with m_processProgress and update the task progress and throughput
+     *  @return true if they changed */
+    bool parseProcessProgress(const QByteArray &data);
+    /** @brief Set the throughput of the task processes, in frames per second and relative to realtime */
+    void setProcessThroughput(double fps, double speed);
 
 private:
     //QString cacheKey();
     JOBTYPE m_type;
     int m_priority;
+    /** @brief Throughput of the task process, in hundredths of frames per second and of realtime */
+    QAtomicInt m_fps;
+    QAtomicInt m_speed;
     void cancelJob(bool softDelete = false);
 
 Q_SIGNALS:
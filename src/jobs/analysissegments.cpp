@@ -0,0 +1,109 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "analysissegments.h"
+
+#include <QRegularExpression>
+
+namespace {
+/** @brief Split an animation in its keyframes, as position and value */
+QVector<QPair<int, QString>> keyframes(const QString &animation)
+{
+    QVector<QPair<int, QString>> result;
+    const QStringList entries = animation.split(QLatin1Char(';'), Qt::SkipEmptyParts);
+    for (const QString &entry : entries) {
+        if (!entry.contains(QLatin1Char('='))) {
+            continue;
+        }
+        QString key = entry.section(QLatin1Char('='), 0, 0).trimmed();
+        // Remove the keyframe type
+        while (!key.isEmpty() && !key.at(key.size() - 1).isDigit()) {
+            key.chop(1);
+        }
+        bool ok;
+        const int position = key.toInt(&ok);
+        result.append({ok ? position : -1, entry});
+    }
+    return result;
+}
+} // namespace
+
+QVector<QPair<int, int>> AnalysisSegments::split(int in, int out, int count, int minimumLength)
+{
+    QVector<QPair<int, int>> ranges;
+    if (out < in) {
+        return ranges;
+    }
+    const int length = out - in + 1;
+    count = qBound(1, count, length / qMax(1, minimumLength));
+    int start = in;
+    for (int i = 1; i <= count; ++i) {
+        const int end = i == count ? out : in + int(qint64(length) * i / count) - 1;
+        ranges.append({start, end});
+        start = end + 1;
+    }
+    return ranges;
+}
+
+QByteArray AnalysisSegments::joinMotionData(const QVector<QByteArray> &segments, int overlap)
+{
+    static const QRegularExpression frameNumber(QStringLiteral("^Frame \\d+"));
+    QByteArray result;
+    int frame = 1;
+    for (int i = 0; i < segments.count(); ++i) {
+        if (!segments.at(i).startsWith("VID.STAB")) {
+            return QByteArray();
+        }
+        int skipped = 0;
+        const QList<QByteArray> lines = segments.at(i).split('\n');
+        for (const QByteArray &line : lines) {
+            if (!line.startsWith("Frame ")) {
+                // The header and the analysis parameters are the same in all segments
+                if (i == 0 && !line.isEmpty()) {
+                    result.append(line + '\n');
+                }
+                continue;
+            }
+            if (i > 0 && skipped < overlap) {
+                skipped++;
+                continue;
+            }
+            QString renumbered = QString::fromLatin1(line);
+            renumbered.replace(frameNumber, QStringLiteral("Frame %1").arg(frame++));
+            result.append(renumbered.toLatin1() + '\n');
+        }
+    }
+    return result;
+}
+
+QString AnalysisSegments::joinKeyframes(const QStringList &segments)
+{
+    QStringList result;
+    int last = -1;
+    for (const QString &segment : segments) {
+        const auto frames = keyframes(segment);
+        for (const auto &keyframe : frames) {
+            if (keyframe.first > -1 && keyframe.first <= last) {
+                continue;
+            }
+            result << keyframe.second;
+        }
+        last = qMax(last, lastKeyframePosition(segment));
+    }
+    return result.join(QLatin1Char(';'));
+}
+
+int AnalysisSegments::lastKeyframePosition(const QString &animation)
+{
+    const auto frames = keyframes(animation);
+    return frames.isEmpty() ? -1 : frames.constLast().first;
+}
+
+QString AnalysisSegments::lastKeyframeValue(const QString &animation)
+{
+    const auto frames = keyframes(animation);
+    return frames.isEmpty() ? QString() : frames.constLast().second.section(QLatin1Char('='), 1);
+}
@@ -0,0 +1,41 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/** @namespace AnalysisSegments
+    @brief Split a clip analysis job in segments processed separately and join their results.
+    The results of the completed segments are kept in a folder of the project cache, so that a
+    canceled job restarts from the first missing segment.
+    vid.stab measures the motion of each frame against the previous one, so the stabilization
+    segments are analysed concurrently, each one starting a frame before its range to get the
+    reference of its first frame. Motion tracking follows the tracked rectangle from frame to frame,
+    its segments are processed one after the other, each one starting on the last keyframe of the
+    previous segment with its rectangle.
+ */
+namespace AnalysisSegments {
+/** @brief Split the @p in - @p out range in at most @p count contiguous ranges.
+ *  The number of ranges is reduced so that none is shorter than @p minimumLength frames */
+QVector<QPair<int, int>> split(int in, int out, int count, int minimumLength);
+/** @brief Join the vid.stab motion files of consecutive segments.
+ *  Every segment but the first one starts @p overlap frames before its range, these frames are dropped
+ *  and the frames are numbered from 1 in the joined file.
+ *  @return the joined file, or an empty array if a segment is not a vid.stab file */
+QByteArray joinMotionData(const QVector<QByteArray> &segments, int overlap);
+/** @brief Join the keyframes of consecutive segments, the keyframes of a segment that are not after the
+ *  last keyframe of the previous segments are dropped */
+QString joinKeyframes(const QStringList &segments);
+/** @brief The position of the last keyframe of @p animation, -1 if there is none */
+int lastKeyframePosition(const QString &animation);
+/** @brief The value of the last keyframe of @p animation */
+QString lastKeyframeValue(const QString &animation);
+} // namespace AnalysisSegments
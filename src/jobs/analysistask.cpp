@@ -0,0 +1,399 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "analysistask.h"
+#include "audio/audioStreamInfo.h"
+#include "audiolevelstask.h"
+#include "audiomixer/loudnessmeter.hpp"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "cachetask.h"
+#include "core.h"
+#include "doc/kthumb.h"
+#include "kdenlivesettings.h"
+#include "project/projectmanager.h"
+#include "scenechangedetector.h"
+#include "utils/thumbnailcache.hpp"
+
+#include <KLocalizedString>
+#include <KMessageWidget>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTimer>
+#include <algorithm>
+#include <mlt++/MltFilter.h>
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltProfile.h>
+#include <set>
+
+namespace {
+/** @brief Stores the hover preview thumbnails, at the same positions as the CacheTask */
+class ThumbnailSampler : public MediaAnalyzer
+{
+public:
+    ThumbnailSampler(const QString &clipId, std::set<int> positions, int fullWidth)
+        : m_clipId(clipId)
+        , m_positions(std::move(positions))
+        , m_fullWidth(fullWidth)
+    {
+    }
+    QString name() const override { return QStringLiteral("thumbnails"); }
+    bool wantsImage(int position) const override { return m_positions.count(position) > 0; }
+    void processFrame(const AnalysisFrame &frame) override
+    {
+        if (frame.image == nullptr || !wantsImage(frame.position)) {
+            return;
+        }
+        // The image was already decoded at the thumbnail size, this only converts it
+        QImage result = KThumb::getFrame(frame.frame, 0, 0, m_fullWidth);
+        if (!result.isNull()) {
+            ThumbnailCache::get()->storeThumbnail(m_clipId, frame.position, result, true);
+        }
+    }
+    void finish(QJsonObject &results) override { Q_UNUSED(results) }
+
+private:
+    QString m_clipId;
+    std::set<int> m_positions;
+    int m_fullWidth;
+};
+
+/** @brief Computes the audio thumbnail levels of a single stream, like the AudioLevelsTask */
+class AudioLevelsAnalyzer : public MediaAnalyzer
+{
+public:
+    AudioLevelsAnalyzer(std::shared_ptr<Mlt::Producer> producer, int stream, int channels, const QString &cachePath, QObject *clip)
+        : m_producer(std::move(producer))
+        , m_stream(stream)
+        , m_channels(channels)
+        , m_cachePath(cachePath)
+        , m_clip(clip)
+        , m_maxLevel(1)
+    {
+        for (int i = 0; i < channels; i++) {
+            m_keys << QByteArray("meta.media.audio_level.") + QByteArray::number(i);
+        }
+    }
+    QString name() const override { return QStringLiteral("audiolevels"); }
+    bool wantsAudio() const override { return true; }
+    void processFrame(const AnalysisFrame &frame) override
+    {
+        if (frame.audio != nullptr) {
+            for (int channel = 0; channel < m_channels; ++channel) {
+                uint lev = 256 * qMin(frame.frame->get_double(m_keys.at(channel).constData()) * 0.9, 1.0);
+                m_levels << lev;
+                m_maxLevel = qMax(lev, m_maxLevel);
+            }
+        } else if (!m_levels.isEmpty()) {
+            for (int channel = 0; channel < m_channels; channel++) {
+                m_levels << m_levels.last();
+            }
+        }
+    }
+    void finish(QJsonObject &results) override
+    {
+        Q_UNUSED(results)
+        if (m_levels.isEmpty()) {
+            return;
+        }
+        AudioLevelsTask::storeLevels(m_producer, m_stream, m_channels, m_levels, m_maxLevel, m_cachePath);
+        QMetaObject::invokeMethod(m_clip, "updateAudioThumbnail", Q_ARG(bool, false));
+    }
+
+private:
+    std::shared_ptr<Mlt::Producer> m_producer;
+    int m_stream;
+    int m_channels;
+    QString m_cachePath;
+    QObject *m_clip;
+    QList<QByteArray> m_keys;
+    QVector<uint8_t> m_levels;
+    uint m_maxLevel;
+};
+
+/** @brief Measures the loudness of the clip, see LoudnessMeter */
+class LoudnessAnalyzer : public MediaAnalyzer
+{
+public:
+    LoudnessAnalyzer(int frequency, int channels)
+        : m_meter(frequency, channels)
+    {
+    }
+    QString name() const override { return QStringLiteral("loudness"); }
+    bool wantsAudio() const override { return true; }
+    void processFrame(const AnalysisFrame &frame) override
+    {
+        if (frame.audio == nullptr || frame.samples <= 0) {
+            return;
+        }
+        if (frame.channels != m_meter.channels() || frame.frequency != m_meter.sampleRate()) {
+            m_meter.setFormat(frame.frequency, frame.channels);
+        }
+        m_meter.process(frame.audio, frame.samples);
+    }
+    void finish(QJsonObject &results) override
+    {
+        QJsonObject loudness;
+        loudness.insert(QLatin1String("integrated"), m_meter.integratedLoudness());
+        loudness.insert(QLatin1String("shortTermMax"), m_meter.maximumShortTermLoudness());
+        loudness.insert(QLatin1String("truePeak"), m_meter.truePeak());
+        results.insert(name(), loudness);
+    }
+
+private:
+    LoudnessMeter m_meter;
+};
+
+/** @brief Stores the scene change score of every frame that could start a new scene */
+class SceneChangeAnalyzer : public MediaAnalyzer
+{
+public:
+    QString name() const override { return QStringLiteral("scenes"); }
+    bool wantsImage(int position) const override
+    {
+        Q_UNUSED(position)
+        return true;
+    }
+    void processFrame(const AnalysisFrame &frame) override
+    {
+        if (frame.image == nullptr) {
+            m_detector.reset();
+            return;
+        }
+        const double score = m_detector.process(frame.image, frame.width, frame.height);
+        // Only keep the frames that can be a cut with the usual detection thresholds
+        if (score >= MinimumSceneScore) {
+            m_scores.append(QJsonArray({frame.position, score}));
+        }
+    }
+    void finish(QJsonObject &results) override { results.insert(name(), m_scores); }
+
+private:
+    SceneChangeDetector m_detector;
+    QJsonArray m_scores;
+};
+} // namespace
+
+const double AnalysisTask::MinimumSceneScore = 0.01;
+
+AnalysisTask::AnalysisTask(const ObjectId &owner, QObject *object)
+    : AbstractTask(owner, AbstractTask::MEDIAANALYSISJOB, object)
+    , m_thumbnails(false)
+    , m_audioLevels(false)
+    , m_scenes(false)
+{
+    m_description = i18n("Media analysis");
+}
+
+AnalysisTask::~AnalysisTask() = default;
+
+void AnalysisTask::start(const ObjectId &owner, ProjectClip *clip, bool thumbnails, bool audioLevels)
+{
+    const ClipType::ProducerType type = clip->clipType();
+    bool supported = KdenliveSettings::singlepassanalysis() && (type == ClipType::AV || type == ClipType::Video || type == ClipType::Audio) &&
+                     clip->getProducerProperty(QStringLiteral("mlt_service")).startsWith(QLatin1String("avformat"));
+    bool analyzeAudio = supported && audioLevels && !clip->audioThumbCreated();
+    if (analyzeAudio) {
+        // The streams of a multi stream clip are decoded separately, and cached levels only need to be loaded
+        const QMap<int, QString> streams = clip->audioInfo() ? clip->audioInfo()->streams() : QMap<int, QString>();
+        analyzeAudio = streams.count() == 1 && !QFile::exists(clip->getAudioThumbPath(streams.firstKey()));
+    }
+    if (audioLevels && !analyzeAudio) {
+        AudioLevelsTask::start(owner, clip, false);
+    }
+    const bool scenes = supported && type != ClipType::Audio && KdenliveSettings::analysisscenes() && !cachedResults(clip).contains(QLatin1String("scenes"));
+    if (!supported || (!thumbnails && !analyzeAudio && !scenes)) {
+        if (thumbnails) {
+            QTimer::singleShot(1000, clip, [owner, clip]() { CacheTask::start(owner, 30, 0, 0, clip); });
+        }
+        return;
+    }
+    if (pCore->taskManager.hasPendingJob(owner, AbstractTask::MEDIAANALYSISJOB)) {
+        return;
+    }
+    AnalysisTask *task = new AnalysisTask(owner, clip);
+    task->m_thumbnails = thumbnails && type != ClipType::Audio;
+    task->m_audioLevels = analyzeAudio;
+    task->m_scenes = scenes;
+    pCore->taskManager.startTask(owner.second, task);
+}
+
+QString AnalysisTask::cachePath(ProjectClip *clip)
+{
+    bool ok;
+    QDir cacheFolder = pCore->projectManager()->cacheDir(true, &ok);
+    const QString clipHash = clip->hash(false);
+    if (!ok || clipHash.isEmpty()) {
+        return QString();
+    }
+    // Positions are stored in frames, like the audio thumbnails the cache depends on the project fps
+    return cacheFolder.absoluteFilePath(QStringLiteral("%1_%2_analysis.json").arg(clipHash).arg(int(pCore->getCurrentFps())));
+}
+
+QJsonObject AnalysisTask::cachedResults(ProjectClip *clip)
+{
+    QFile file(cachePath(clip));
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return QJsonObject();
+    }
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+void AnalysisTask::addAnalyzer(std::unique_ptr<MediaAnalyzer> analyzer)
+{
+    m_analyzers.push_back(std::move(analyzer));
+}
+
+void AnalysisTask::run()
+{
+    AbstractTaskDone whenFinished(m_owner.second, this);
+    if (m_isCanceled || pCore->taskManager.isBlocked()) {
+        return;
+    }
+    QMutexLocker lock(&m_runMutex);
+    m_running = true;
+    auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.second));
+    if (binClip == nullptr) {
+        // Clip was deleted
+        return;
+    }
+    std::shared_ptr<Mlt::Producer> master = binClip->originalProducer();
+    if (master == nullptr || !master->is_valid()) {
+        return;
+    }
+    const QString fileName = QFileInfo(binClip->url()).fileName();
+    const int length = master->get_length();
+    if (length == INT_MAX || length <= 0) {
+        // Broken file or live feed
+        QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection,
+                                  Q_ARG(QString, i18n("Media analysis: unknown file length for %1", fileName)), Q_ARG(int, int(KMessageWidget::Warning)));
+        return;
+    }
+    const QJsonObject cached = cachedResults(binClip.get());
+    const QString clipId = QString::number(m_owner.second);
+    if (m_thumbnails) {
+        std::set<int> positions = CacheTask::thumbnailPositions(0, binClip->getFramePlaytime(), 30);
+        for (auto it = positions.begin(); it != positions.end();) {
+            it = ThumbnailCache::get()->hasThumbnail(clipId, *it) ? positions.erase(it) : std::next(it);
+        }
+        if (!positions.empty()) {
+            addAnalyzer(std::make_unique<ThumbnailSampler>(clipId, std::move(positions), CacheTask::thumbnailWidth()));
+        }
+    }
+    int stream = -1;
+    int channels = 2;
+    int frequency = 48000;
+    if (m_audioLevels && !binClip->audioThumbCreated()) {
+        const std::unique_ptr<AudioStreamInfo> &info = binClip->audioInfo();
+        stream = info->streams().firstKey();
+        channels = info->streamChannels().value(stream, info->channels());
+        channels = channels <= 0 ? 2 : channels;
+        frequency = info->samplingRate() <= 0 ? 48000 : info->samplingRate();
+        addAnalyzer(std::make_unique<AudioLevelsAnalyzer>(master, stream, channels, binClip->getAudioThumbPath(stream), m_object));
+        if (!cached.contains(QLatin1String("loudness"))) {
+            addAnalyzer(std::make_unique<LoudnessAnalyzer>(frequency, channels));
+        }
+    }
+    if (m_scenes && !cached.contains(QLatin1String("scenes"))) {
+        addAnalyzer(std::make_unique<SceneChangeAnalyzer>());
+    }
+    if (m_analyzers.empty()) {
+        return;
+    }
+    const bool needsAudio = stream >= 0 && std::any_of(m_analyzers.begin(), m_analyzers.end(), [](const std::unique_ptr<MediaAnalyzer> &a) { return a->wantsAudio(); });
+    const bool needsVideo = binClip->clipType() != ClipType::Audio;
+
+    // Open the file once, at the thumbnail size and with the audio filters of the audio thumbnails
+    QString service = master->get("mlt_service");
+    if (service == QLatin1String("avformat")) {
+        service = QStringLiteral("avformat-novalidate");
+    }
+    Mlt::Producer producer(*pCore->thumbProfile(), service.toUtf8().constData(), master->get("resource"));
+    if (!producer.is_valid()) {
+        QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection,
+                                  Q_ARG(QString, i18n("Media analysis: cannot open file %1", fileName)), Q_ARG(int, int(KMessageWidget::Warning)));
+        return;
+    }
+    Mlt::Properties original(master->get_properties());
+    Mlt::Properties cloneProps(producer.get_properties());
+    cloneProps.pass_list(original, ClipController::getPassPropertiesList());
+    if (needsVideo) {
+        Mlt::Filter scaler(*pCore->thumbProfile(), "swscale");
+        Mlt::Filter padder(*pCore->thumbProfile(), "resize");
+        Mlt::Filter converter(*pCore->thumbProfile(), "avcolor_space");
+        producer.attach(scaler);
+        producer.attach(padder);
+        producer.attach(converter);
+    } else {
+        producer.set("video_index", -1);
+    }
+    if (needsAudio) {
+        producer.set("audio_index", stream);
+        Mlt::Filter chans(*pCore->thumbProfile(), "audiochannels");
+        Mlt::Filter converter(*pCore->thumbProfile(), "audioconvert");
+        Mlt::Filter levels(*pCore->thumbProfile(), "audiolevel");
+        producer.attach(chans);
+        producer.attach(converter);
+        producer.attach(levels);
+    } else {
+        producer.set("audio_index", -1);
+    }
+
+    const double fps = producer.get_fps();
+    producer.seek(0);
+    for (int pos = 0; pos < length && !m_isCanceled; ++pos) {
+        std::unique_ptr<Mlt::Frame> frame(producer.get_frame());
+        if (frame == nullptr || !frame->is_valid()) {
+            continue;
+        }
+        AnalysisFrame data{pos, frame.get(), nullptr, 0, 0, nullptr, 0, channels, frequency};
+        if (needsAudio && frame->get_int("test_audio") == 0) {
+            mlt_audio_format format = mlt_audio_s16;
+            data.samples = mlt_audio_calculate_frame_samples(float(fps), frequency, pos);
+            data.audio = static_cast<const int16_t *>(frame->get_audio(format, data.frequency, data.channels, data.samples));
+        }
+        // Frames that no analyzer looks at are skipped by the decoder
+        if (needsVideo &&
+            std::any_of(m_analyzers.begin(), m_analyzers.end(), [pos](const std::unique_ptr<MediaAnalyzer> &a) { return a->wantsImage(pos); })) {
+            frame->set("consumer.deinterlacer", "onefield");
+            frame->set("consumer.top_field_first", -1);
+            frame->set("consumer.rescale", "nearest");
+            mlt_image_format format = mlt_image_rgba;
+            data.image = frame->get_image(format, data.width, data.height);
+        }
+        for (auto &analyzer : m_analyzers) {
+            analyzer->processFrame(data);
+        }
+        const int progress = int(100. * pos / length);
+        if (progress != m_progress) {
+            m_progress = progress;
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        }
+    }
+    m_progress = 100;
+    QMetaObject::invokeMethod(m_object, "updateJobProgress");
+    if (m_isCanceled) {
+        return;
+    }
+    QJsonObject results = cached;
+    for (auto &analyzer : m_analyzers) {
+        analyzer->finish(results);
+    }
+    if (results == cached) {
+        return;
+    }
+    QFile file(cachePath(binClip.get()));
+    if (file.fileName().isEmpty() || !file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write media analysis cache" << file.fileName();
+        return;
+    }
+    file.write(QJsonDocument(results).toJson(QJsonDocument::Compact));
+}
@@ -0,0 +1,55 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "abstracttask.h"
+#include "mediaanalyzer.h"
+
+#include <QJsonObject>
+#include <QObject>
+#include <QRunnable>
+
+#include <memory>
+#include <vector>
+
+class ProjectClip;
+
+/** @class AnalysisTask
+    @brief Decodes a newly imported clip once and feeds every frame to a set of MediaAnalyzer.
+    This replaces the separate hover thumbnails and audio levels tasks, which each opened and
+    decoded the file, and can also compute scene change scores and loudness during the same pass.
+    Scene scores and loudness are stored in a cache file next to the audio thumbnails, and reused
+    by the scene detection job.
+ */
+class AnalysisTask : public AbstractTask
+{
+public:
+    /** @brief Scene change scores lower than this are not stored in the analysis cache */
+    static const double MinimumSceneScore;
+
+    AnalysisTask(const ObjectId &owner, QObject *object);
+    ~AnalysisTask() override;
+    /** @brief Start the analysis of a newly loaded clip, or the separate thumbnail and audio levels tasks if the clip cannot
+     *  be analyzed in a single pass
+     *  @param thumbnails generate the hover preview thumbnails
+     *  @param audioLevels generate the audio thumbnails */
+    static void start(const ObjectId &owner, ProjectClip *clip, bool thumbnails, bool audioLevels);
+    /** @brief The file storing the analysis results of @p clip, empty if the cache folder is not writable */
+    static QString cachePath(ProjectClip *clip);
+    /** @brief The results of a previous analysis of @p clip, empty if it was never analyzed */
+    static QJsonObject cachedResults(ProjectClip *clip);
+    /** @brief Add an analyzer to the pass, must be called before the task starts */
+    void addAnalyzer(std::unique_ptr<MediaAnalyzer> analyzer);
+
+protected:
+    void run() override;
+
+private:
+    bool m_thumbnails;
+    bool m_audioLevels;
+    bool m_scenes;
+    std::vector<std::unique_ptr<MediaAnalyzer>> m_analyzers;
+};
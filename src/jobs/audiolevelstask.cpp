@@ -51,6 +51,37 @@ void AudioLevelsTask::start(const ObjectId &owner, QObject *object, bool force)
     pCore->taskManager.startTask(owner.second, task);
 }
 
+void AudioLevelsTask::storeLevels(const std::shared_ptr<Mlt::Producer> &producer, int stream, int channels, const QVector<uint8_t> &levels, uint maxLevel,
+                                  const QString &cachePath)
+{
+    QVector<uint8_t> *levelsCopy = new QVector<uint8_t>(levels);
+    producer->lock();
+    QString key = QString("_kdenlive:audio%1").arg(stream);
+    QString key2 = QString("kdenlive:audio_max%1").arg(stream);
+    producer->set(key2.toUtf8().constData(), int(maxLevel));
+    producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor)deleteQVariantList);
+    producer->unlock();
+    // Put into an image for caching.
+    int count = levels.size();
+    QImage image((count + 3) / 4 / channels, channels, QImage::Format_ARGB32);
+    int n = image.width() * image.height();
+    for (int i = 0; i < n; i++) {
+        QRgb p;
+        if ((4 * i + 3) < count) {
+            p = qRgba(levels.at(4 * i), levels.at(4 * i + 1), levels.at(4 * i + 2), levels.at(4 * i + 3));
+        } else {
+            int last = levels.last();
+            int r = (4 * i + 0) < count ? levels.at(4 * i + 0) : last;
+            int g = (4 * i + 1) < count ? levels.at(4 * i + 1) : last;
+            int b = (4 * i + 2) < count ? levels.at(4 * i + 2) : last;
+            int a = last;
+            p = qRgba(r, g, b, a);
+        }
+        image.setPixel(i / channels, i % channels, p);
+    }
+    image.save(cachePath);
+}
+
 void AudioLevelsTask::run()
 {
     AbstractTaskDone whenFinished(m_owner.second, this);
@@ -205,35 +236,10 @@ void AudioLevelsTask::run()
             QMetaObject::invokeMethod(m_object, "updateJobProgress");
         }
         if (mltLevels.size() > 0) {
-            QVector<uint8_t> *levelsCopy = new QVector<uint8_t>(mltLevels);
-            producer->lock();
-            QString key = QString("_kdenlive:audio%1").arg(stream);
-            QString key2 = QString("kdenlive:audio_max%1").arg(stream);
-            producer->set(key2.toUtf8().constData(), int(maxLevel));
-            producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor)deleteQVariantList);
-            producer->unlock();
+            storeLevels(producer, stream, channels, mltLevels, maxLevel, cachePath);
             // qDebug()<<"=== FINISHED PRODUCING AUDIO FOR: "<<key<<", SIZE: "<<levelsCopy->size();
             m_progress = 100;
             QMetaObject::invokeMethod(m_object, "updateJobProgress");
-            // Put into an image for caching.
-            int count = mltLevels.size();
-            QImage image((count + 3) / 4 / channels, channels, QImage::Format_ARGB32);
-            int n = image.width() * image.height();
-            for (int i = 0; i < n; i++) {
-                QRgb p;
-                if ((4 * i + 3) < count) {
-                    p = qRgba(mltLevels.at(4 * i), mltLevels.at(4 * i + 1), mltLevels.at(4 * i + 2), mltLevels.at(4 * i + 3));
-                } else {
-                    int last = mltLevels.last();
-                    int r = (4 * i + 0) < count ? mltLevels.at(4 * i + 0) : last;
-                    int g = (4 * i + 1) < count ? mltLevels.at(4 * i + 1) : last;
-                    int b = (4 * i + 2) < count ? mltLevels.at(4 * i + 2) : last;
-                    int a = last;
-                    p = qRgba(r, g, b, a);
-                }
-                image.setPixel(i / channels, i % channels, p);
-            }
-            image.save(cachePath);
             audioCreated = true;
             QMetaObject::invokeMethod(m_object, "updateAudioThumbnail", Q_ARG(bool, false));
         }
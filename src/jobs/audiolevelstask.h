@@ -12,12 +12,23 @@
 
 #include <QRunnable>
 #include <QObject>
+#include <QVector>
+
+#include <memory>
+
+namespace Mlt {
+class Producer;
+}
 
 class AudioLevelsTask : public AbstractTask
 {
 public:
     AudioLevelsTask(const ObjectId &owner, QObject* object);
     static void start(const ObjectId &owner, QObject* object, bool force = false);
+    /** @brief Attach the audio @p levels of @p stream to @p producer and save them as a cache image in @p cachePath.
+     *  @p levels contains @p channels interleaved values per frame */
+    static void storeLevels(const std::shared_ptr<Mlt::Producer> &producer, int stream, int channels, const QVector<uint8_t> &levels, uint maxLevel,
+                            const QString &cachePath);
 
 protected:
     void run() override;
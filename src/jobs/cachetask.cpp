@@ -23,15 +23,33 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 CacheTask::CacheTask(const ObjectId &owner, int thumbsCount, int in, int out, QObject *object)
     : AbstractTask(owner, AbstractTask::CACHEJOB, object)
-    , m_fullWidth(qFuzzyCompare(pCore->getCurrentSar(), 1.0) ? 0 : qRound(pCore->thumbProfile()->height() * pCore->getCurrentDar()))
+    , m_fullWidth(thumbnailWidth())
     , m_thumbsCount(thumbsCount)
     , m_in(in)
     , m_out(out)
 {
     m_description = i18n("Video thumbs");
-    if (m_fullWidth % 2 > 0) {
-        m_fullWidth++;
+}
+
+int CacheTask::thumbnailWidth()
+{
+    int width = qFuzzyCompare(pCore->getCurrentSar(), 1.0) ? 0 : qRound(pCore->thumbProfile()->height() * pCore->getCurrentDar());
+    if (width % 2 > 0) {
+        width++;
+    }
+    return width;
+}
+
+std::set<int> CacheTask::thumbnailPositions(int in, int duration, int thumbsCount)
+{
+    std::set<int> frames;
+    int steps = qCeil(qMax(pCore->getCurrentFps(), double(duration) / thumbsCount));
+    int pos = in;
+    for (int i = 1; i <= thumbsCount && pos <= in + duration; ++i) {
+        frames.insert(pos);
+        pos = in + (steps * i);
     }
+    return frames;
 }
 
 CacheTask::~CacheTask() {}
@@ -53,13 +71,7 @@ void CacheTask::generateThumbnail(std::shared_ptr<ProjectClip> binClip)
     if (binClip->clipType() != ClipType::Audio) {
         std::shared_ptr<Mlt::Producer> thumbProd(nullptr);
         int duration = m_out > 0 ? m_out - m_in : binClip->getFramePlaytime();
-        std::set<int> frames;
-        int steps = qCeil(qMax(pCore->getCurrentFps(), double(duration) / m_thumbsCount));
-        int pos = m_in;
-        for (int i = 1; i <= m_thumbsCount && pos <= m_in + duration; ++i) {
-            frames.insert(pos);
-            pos = m_in + (steps * i);
-        }
+        std::set<int> frames = thumbnailPositions(m_in, duration, m_thumbsCount);
         int size = int(frames.size());
         int count = 0;
         const QString clipId = QString::number(m_owner.second);
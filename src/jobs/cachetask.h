@@ -17,6 +17,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QObject>
 #include <QList>
 
+#include <set>
+
 class ProjectClip;
 
 class CacheTask : public AbstractTask
@@ -25,6 +27,10 @@ public:
     CacheTask(const ObjectId &owner, int thumbsCount, int in, int out, QObject* object);
     ~CacheTask() override;
     static void start(const ObjectId &owner, int thumbsCount = 30, int in = 0, int out = 0, QObject* object = nullptr, bool force = false);
+    /** @brief Width of the cached thumbnails, 0 when the project pixels are square */
+    static int thumbnailWidth();
+    /** @brief The positions of the @p thumbsCount thumbnails cached for a zone of @p duration frames starting at @p in */
+    static std::set<int> thumbnailPositions(int in, int duration, int thumbsCount);
 
 protected:
     void run() override;
@@ -34,7 +34,6 @@ CutTask::CutTask(const ObjectId &owner, const QString &destination, const QStrin
     , m_outPoint(GenTime(out, pCore->getCurrentFps()))
     , m_destination(destination)
     , m_encodingParams(encodingParams)
-    , m_jobDuration(0)
     , m_addToProject(addToProject)
 {
     m_description = i18n("Extracting zone");
@@ -220,7 +219,6 @@ void CutTask::run()
             return;
         }
         QStringList params = {QStringLiteral("-y"),
-                              QStringLiteral("-stats"),
                               QStringLiteral("-v"),
                               QStringLiteral("error"),
                               QStringLiteral("-noaccurate_seek"),
@@ -236,9 +234,11 @@ void CutTask::run()
                               QStringLiteral("-dn"),
                               QStringLiteral("-map"),
                               QStringLiteral("0")};
-        params << m_encodingParams << m_destination;
+        params << ProcessProgress::ffmpegArguments() << m_encodingParams << m_destination;
         m_jobProcess = std::make_unique<QProcess>(new QProcess);
         connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &CutTask::processLogInfo);
+        connect(m_jobProcess.get(), &QProcess::readyReadStandardOutput, this, &CutTask::processLogInfo);
+        m_processProgress = ProcessProgress(ProcessProgress::Format::FFmpeg, (m_outPoint - m_inPoint).seconds());
         connect(this, &CutTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
         qDebug() << "=== STARTING CUT JOB: " << params;
         m_jobProcess->start(KdenliveSettings::ffmpegpath(), params, QIODevice::ReadOnly);
@@ -268,35 +268,8 @@ void CutTask::run()
 
 void CutTask::processLogInfo()
 {
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
-    m_logDetails.append(buffer);
-    int progress = 0;
-    // Parse FFmpeg output
-    if (m_jobDuration == 0) {
-        if (buffer.contains(QLatin1String("Duration:"))) {
-            QString data = buffer.section(QStringLiteral("Duration:"), 1, 1).section(QLatin1Char(','), 0, 0).simplified();
-            if (!data.isEmpty()) {
-                QStringList numbers = data.split(QLatin1Char(':'));
-                if (numbers.size() < 3) {
-                    return;
-                }
-                m_jobDuration = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + numbers.at(2).toInt();
-            }
-        }
-    } else if (buffer.contains(QLatin1String("time="))) {
-        QString time = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0);
-        if (!time.isEmpty()) {
-            QStringList numbers = time.split(QLatin1Char(':'));
-            if (numbers.size() < 3) {
-                progress = time.toInt();
-                if (progress == 0) {
-                    return;
-                }
-            } else {
-                progress = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
-            }
-        }
-        m_progress = 100 * progress / m_jobDuration;
+    m_logDetails.append(QString::fromUtf8(m_jobProcess->readAllStandardError()));
+    if (parseProcessProgress(m_jobProcess->readAllStandardOutput())) {
         QMetaObject::invokeMethod(m_object, "updateJobProgress");
     }
 }
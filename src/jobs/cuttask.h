@@ -33,6 +33,5 @@ private:
     QString m_errorMessage;
     QString m_logDetails;
     std::unique_ptr<QProcess> m_jobProcess;
-    int m_jobDuration;
     bool m_addToProject;
 };
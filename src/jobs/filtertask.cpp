@@ -5,11 +5,13 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "filtertask.h"
+#include "analysissegments.h"
 #include "assets/model/assetparametermodel.hpp"
 #include "bin/bin.h"
 #include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
+#include "doc/kdenlivedoc.h"
 #include "effects/effectstack/model/effectstackmodel.hpp"
 #include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
@@ -18,11 +20,45 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "profiles/profilemodel.hpp"
 #include "xml/xml.hpp"
 
+#include <QCryptographicHash>
+#include <QFileInfo>
 #include <QProcess>
 #include <QThread>
 
 #include <KLocalizedString>
 
+namespace {
+/** @brief Length of the segments of a resumable analysis, a canceled analysis restarts from the last completed segment */
+const int ResumeSegmentFrames = 500;
+
+/** @brief Restrict the producer of an analysis @p scene to the @p in - @p out range, tracking @p rect from its first frame if it is not empty */
+void setSegment(QDomDocument &scene, int in, int out, const QString &rect)
+{
+    const QString rootId = scene.documentElement().attribute(QStringLiteral("producer"));
+    for (const QString &tag : {QStringLiteral("producer"), QStringLiteral("chain")}) {
+        QDomNodeList services = scene.elementsByTagName(tag);
+        for (int i = 0; i < services.count(); ++i) {
+            QDomElement service = services.item(i).toElement();
+            if (rootId.isEmpty() || service.attribute(QStringLiteral("id")) == rootId) {
+                service.setAttribute(QStringLiteral("in"), in);
+                service.setAttribute(QStringLiteral("out"), out);
+                break;
+            }
+        }
+    }
+    if (rect.isEmpty()) {
+        return;
+    }
+    QDomNodeList filters = scene.elementsByTagName(QStringLiteral("filter"));
+    for (int i = 0; i < filters.count(); ++i) {
+        QDomElement filter = filters.item(i).toElement();
+        if (Xml::getXmlProperty(filter, QStringLiteral("kdenlive:id")) == QLatin1String("kdenlive-analysis")) {
+            Xml::setXmlProperty(filter, QStringLiteral("rect"), rect);
+        }
+    }
+}
+} // namespace
+
 FilterTask::FilterTask(const ObjectId &owner, const QString &binId, const std::weak_ptr<AssetParameterModel> &model, const QString &assetId, int in, int out,
                        const QString &filterName, const std::unordered_map<QString, QVariant> &filterParams,
                        const std::unordered_map<QString, QString> &filterData, const QStringList &consumerArgs, QObject *object)
@@ -37,6 +73,8 @@ FilterTask::FilterTask(const ObjectId &owner, const QString &binId, const std::w
     , m_filterParams(filterParams)
     , m_filterData(filterData)
     , m_consumerArgs(consumerArgs)
+    , m_progressOffset(0)
+    , m_progressScale(100)
 {
     m_description = i18n("Processing filter %1", filterName);
 }
@@ -240,24 +278,21 @@ void FilterTask::run()
     consumerNode.setAttribute("resource", destFile.fileName());
     consumerNode.setAttribute("store", "kdenlive");
 
-    QFile f1(sourceFile.fileName());
-    f1.open(QIODevice::WriteOnly);
-    QTextStream stream(&f1);
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-    stream.setCodec("UTF-8");
-#endif
-    stream << dom.toString();
-    f1.close();
-    dom.clear();
+    paramVector params;
+    QString key("results");
+    if (m_filterData.find(QStringLiteral("key")) != m_filterData.end()) {
+        key = m_filterData.at(QStringLiteral("key"));
+    }
 
     // Step 2: process the xml file and save in another .mlt file
-    QStringList args({QStringLiteral("progress=1"), sourceFile.fileName()});
-    m_jobProcess.reset(new QProcess);
-    QObject::connect(this, &AbstractTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
-    QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &FilterTask::processLogInfo);
-    m_jobProcess->start(KdenliveSettings::rendererpath(), args);
-    m_jobProcess->waitForFinished(-1);
-    bool result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+    QString resultData;
+    bool result;
+    if (binClip && m_filterData.find(QStringLiteral("segmented")) != m_filterData.end()) {
+        result = processSegments(dom, url, sourceFile.fileName(), destFile.fileName(), key, resultData);
+    } else {
+        result = processScene(dom, sourceFile.fileName(), destFile.fileName(), key, resultData);
+    }
+    dom.clear();
     m_progress = 100;
     if (auto ptr = m_model.lock()) {
         QMetaObject::invokeMethod(ptr.get(), "setProgress", Q_ARG(int, 100));
@@ -270,25 +305,6 @@ void FilterTask::run()
         return;
     }
 
-    paramVector params;
-    QString key("results");
-    if (m_filterData.find(QStringLiteral("key")) != m_filterData.end()) {
-        key = m_filterData.at(QStringLiteral("key"));
-    }
-
-    QString resultData;
-    if (Xml::docContentFromFile(dom, destFile.fileName(), false)) {
-        qDebug() << "AAAA\nGOT DOC\n" << dom.toString();
-        QDomNodeList filters = dom.elementsByTagName(QLatin1String("filter"));
-        for (int i = 0; i < filters.count(); ++i) {
-            QDomElement currentParameter = filters.item(i).toElement();
-            if (Xml::getXmlProperty(currentParameter, QLatin1String("kdenlive:id")) == QLatin1String("kdenlive-analysis")) {
-                resultData = Xml::getXmlProperty(currentParameter, key);
-                break;
-            }
-        }
-    }
-
     if (m_inPoint > 0 && (m_filterData.find(QLatin1String("relativeInOut")) == m_filterData.end())) {
         // Motion tracker keyframes always start at master clip 0, so no need to set in/out points
         params.append({QStringLiteral("in"), m_inPoint});
@@ -311,18 +327,117 @@ void FilterTask::run()
     }
 }
 
-void FilterTask::processLogInfo()
+bool FilterTask::processScene(const QDomDocument &scene, const QString &sceneFile, const QString &resultFile, const QString &key, QString &resultData)
 {
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
-    m_logDetails.append(buffer);
-    // Parse MLT output
-    if (buffer.contains(QLatin1String("percentage:"))) {
-        int progress = buffer.section(QStringLiteral("percentage:"), 1).simplified().section(QLatin1Char(' '), 0, 0).toInt();
-        if (progress == m_progress) {
-            return;
+    QFile f1(sceneFile);
+    f1.open(QIODevice::WriteOnly);
+    QTextStream stream(&f1);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    stream.setCodec("UTF-8");
+#endif
+    stream << scene.toString();
+    f1.close();
+
+    QStringList args({QStringLiteral("progress=1"), sceneFile});
+    m_jobProcess.reset(new QProcess);
+    QObject::connect(this, &AbstractTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
+    QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &FilterTask::processLogInfo);
+    m_processProgress = ProcessProgress(ProcessProgress::Format::Melt, 0., pCore->getCurrentFps());
+    m_jobProcess->start(KdenliveSettings::rendererpath(), args);
+    m_jobProcess->waitForFinished(-1);
+    if (m_isCanceled || m_jobProcess->exitStatus() != QProcess::NormalExit) {
+        return false;
+    }
+
+    QDomDocument dom;
+    if (Xml::docContentFromFile(dom, resultFile, false)) {
+        qDebug() << "AAAA\nGOT DOC\n" << dom.toString();
+        QDomNodeList filters = dom.elementsByTagName(QLatin1String("filter"));
+        for (int i = 0; i < filters.count(); ++i) {
+            QDomElement currentParameter = filters.item(i).toElement();
+            if (Xml::getXmlProperty(currentParameter, QLatin1String("kdenlive:id")) == QLatin1String("kdenlive-analysis")) {
+                resultData = Xml::getXmlProperty(currentParameter, key);
+                break;
+            }
         }
+    }
+    return true;
+}
+
+bool FilterTask::processSegments(const QDomDocument &scene, const QString &url, const QString &sceneFile, const QString &resultFile, const QString &key,
+                                 QString &resultData)
+{
+    const QVector<QPair<int, int>> ranges =
+        AnalysisSegments::split(m_inPoint, m_outPoint, (m_outPoint - m_inPoint + 1) / ResumeSegmentFrames, ResumeSegmentFrames);
+    // The results of the completed segments of a canceled analysis are kept in the project cache and reused
+    // Editing or replacing the clip file invalidates the cached results
+    const QFileInfo sourceInfo(url);
+    QStringList keyParams = {m_filterName, url, QStringLiteral("%1-%2").arg(sourceInfo.size()).arg(sourceInfo.lastModified().toMSecsSinceEpoch())};
+    for (const auto &it : m_filterParams) {
+        keyParams << QStringLiteral("%1=%2").arg(it.first, it.second.toString());
+    }
+    keyParams.sort();
+    for (const auto &range : ranges) {
+        keyParams << QStringLiteral("%1-%2").arg(range.first).arg(range.second);
+    }
+    const QByteArray hash = QCryptographicHash::hash(keyParams.join(QLatin1Char('\n')).toUtf8(), QCryptographicHash::Md5).toHex();
+    const QString folderName = QStringLiteral("analysis-%1").arg(QString::fromLatin1(hash));
+    bool ok;
+    QDir folder = pCore->currentDoc()->getCacheDir(CacheTmpWorkFiles, &ok);
+    if (!ok) {
+        folder = QDir::temp();
+    }
+    if (!folder.mkpath(folderName) || !folder.cd(folderName)) {
+        return processScene(scene, sceneFile, resultFile, key, resultData);
+    }
+
+    const int totalFrames = m_outPoint - m_inPoint + 1;
+    QStringList results;
+    for (int i = 0; i < ranges.count(); ++i) {
+        if (m_isCanceled) {
+            return false;
+        }
+        QFile segmentFile(folder.absoluteFilePath(QStringLiteral("segment-%1.txt").arg(i)));
+        if (segmentFile.open(QIODevice::ReadOnly)) {
+            results << QString::fromUtf8(segmentFile.readAll());
+            continue;
+        }
+        // Start tracking from the last keyframe of the previous segment, with its rectangle
+        int segmentIn = ranges.at(i).first;
+        QString rect;
+        if (i > 0) {
+            const int lastPosition = AnalysisSegments::lastKeyframePosition(results.constLast());
+            if (lastPosition >= ranges.at(i - 1).first && lastPosition < segmentIn) {
+                segmentIn = lastPosition;
+                rect = AnalysisSegments::lastKeyframeValue(results.constLast());
+            }
+        }
+        QDomDocument segment = scene.cloneNode(true).toDocument();
+        setSegment(segment, segmentIn, ranges.at(i).second, rect);
+        m_progressOffset = 100 * (ranges.at(i).first - m_inPoint) / qMax(1, totalFrames);
+        m_progressScale = 100 * (ranges.at(i).second - ranges.at(i).first + 1) / qMax(1, totalFrames);
+        QString segmentResult;
+        if (!processScene(segment, sceneFile, resultFile, key, segmentResult) || segmentResult.isEmpty()) {
+            return false;
+        }
+        if (segmentFile.open(QIODevice::WriteOnly)) {
+            segmentFile.write(segmentResult.toUtf8());
+            segmentFile.close();
+        }
+        results << segmentResult;
+    }
+    resultData = AnalysisSegments::joinKeyframes(results);
+    folder.removeRecursively();
+    return true;
+}
+
+void FilterTask::processLogInfo()
+{
+    const QByteArray buffer = m_jobProcess->readAllStandardError();
+    m_logDetails.append(QString::fromUtf8(buffer));
+    if (parseProcessProgress(buffer)) {
+        m_progress = m_progressOffset + m_progress * m_progressScale / 100;
         if (auto ptr = m_model.lock()) {
-            m_progress = progress;
             QMetaObject::invokeMethod(ptr.get(), "setProgress", Q_ARG(int, m_progress));
         }
     }
@@ -20,6 +20,7 @@ class Event;
 } // namespace Mlt
 
 class AssetParameterModel;
+class QDomDocument;
 class QProcess;
 
 class FilterTask : public AbstractTask
@@ -48,4 +49,15 @@ private:
     QString m_errorMessage;
     QString m_logDetails;
     std::unique_ptr<QProcess> m_jobProcess;
+    /** @brief The part of the task progress covered by the running process, in percent */
+    int m_progressOffset;
+    int m_progressScale;
+    /** @brief Process the analysis @p scene and read the @p key property of the analysis filter from the @p resultFile it is saved to
+     *  @return false if the processing was canceled or failed */
+    bool processScene(const QDomDocument &scene, const QString &sceneFile, const QString &resultFile, const QString &key, QString &resultData);
+    /** @brief Same as processScene(), processing the clip in consecutive segments whose results are kept until the analysis completes.
+     *  Used for the analysis jobs with the "segmented" job parameter, their results are keyframes and the analysis of a segment
+     *  starts from the last keyframe of the previous segment, like motion tracking */
+    bool processSegments(const QDomDocument &scene, const QString &url, const QString &sceneFile, const QString &resultFile, const QString &key,
+                         QString &resultData);
 };
@@ -0,0 +1,102 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "loudnesstask.h"
+#include "audiomixer/loudnessmeter.hpp"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "doc/kdenlivedoc.h"
+#include "project/projectmanager.h"
+
+#include <KLocalizedString>
+#include <KMessageWidget>
+#include <QUrl>
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltProfile.h>
+
+LoudnessTask::LoudnessTask(const ObjectId &owner, const QString &sceneXml, QObject *object)
+    : AbstractTask(owner, AbstractTask::LOUDNESSJOB, object)
+    , m_sceneXml(sceneXml)
+{
+    m_description = i18n("Loudness analysis");
+}
+
+void LoudnessTask::start()
+{
+    KdenliveDoc *project = pCore->currentDoc();
+    if (project == nullptr) {
+        return;
+    }
+    const QString sequenceId = pCore->projectItemModel()->getSequenceId(pCore->currentTimelineId());
+    std::shared_ptr<ProjectClip> sequenceClip = pCore->projectItemModel()->getClipByBinID(sequenceId);
+    if (sequenceClip == nullptr) {
+        return;
+    }
+    const ObjectId owner(ObjectType::BinClip, sequenceId.toInt());
+    if (pCore->taskManager.hasPendingJob(owner, AbstractTask::LOUDNESSJOB)) {
+        return;
+    }
+    // Analyze exactly what would be rendered
+    const QString sceneXml =
+        pCore->projectManager()->projectSceneList(project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile());
+    LoudnessTask *task = new LoudnessTask(owner, sceneXml, sequenceClip.get());
+    pCore->taskManager.startTask(owner.second, task);
+}
+
+void LoudnessTask::run()
+{
+    AbstractTaskDone whenFinished(m_owner.second, this);
+    if (m_isCanceled || pCore->taskManager.isBlocked()) {
+        return;
+    }
+    QMutexLocker lock(&m_runMutex);
+    m_running = true;
+    Mlt::Producer producer(*pCore->getProjectProfile(), "xml-string", m_sceneXml.toUtf8().constData());
+    m_sceneXml.clear();
+    const int length = producer.is_valid() ? producer.get_playtime() : 0;
+    if (length <= 0) {
+        QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Cannot analyze the timeline loudness")),
+                                  Q_ARG(int, int(KMessageWidget::Warning)));
+        return;
+    }
+    const int frequency = 48000;
+    const int channels = qMax(1, pCore->audioChannels());
+    const double fps = producer.get_fps();
+    LoudnessMeter meter(frequency, channels);
+    producer.seek(0);
+    for (int pos = 0; pos < length && !m_isCanceled; ++pos) {
+        std::unique_ptr<Mlt::Frame> frame(producer.get_frame());
+        if (frame == nullptr || !frame->is_valid()) {
+            continue;
+        }
+        mlt_audio_format format = mlt_audio_f32le;
+        int frameFrequency = frequency;
+        int frameChannels = channels;
+        int samples = mlt_audio_calculate_frame_samples(float(fps), frequency, pos);
+        // Only audio is requested from the frame, so no video is decoded
+        const float *audio = static_cast<const float *>(frame->get_audio(format, frameFrequency, frameChannels, samples));
+        if (audio != nullptr && samples > 0) {
+            if (frameChannels != meter.channels() || frameFrequency != meter.sampleRate()) {
+                meter.setFormat(frameFrequency, frameChannels);
+            }
+            meter.process(audio, samples);
+        }
+        const int progress = int(100. * pos / length);
+        if (progress != m_progress) {
+            m_progress = progress;
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        }
+    }
+    if (m_isCanceled) {
+        return;
+    }
+    const QString result = i18n("Integrated loudness: %1 LUFS, maximum short-term loudness: %2 LUFS, true peak: %3 dBTP",
+                                QString::number(meter.integratedLoudness(), 'f', 1), QString::number(meter.maximumShortTermLoudness(), 'f', 1),
+                                QString::number(meter.truePeak(), 'f', 1));
+    QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection, Q_ARG(QString, result),
+                              Q_ARG(int, int(KMessageWidget::Information)));
+}
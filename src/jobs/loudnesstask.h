@@ -0,0 +1,29 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "abstracttask.h"
+
+#include <QObject>
+#include <QRunnable>
+
+/** @class LoudnessTask
+    @brief Measures the integrated loudness, maximum short-term loudness and true peak of a timeline,
+    rendering only its audio as fast as possible.
+ */
+class LoudnessTask : public AbstractTask
+{
+public:
+    LoudnessTask(const ObjectId &owner, const QString &sceneXml, QObject *object);
+    /** @brief Analyze the current timeline, the task is attached to its sequence clip */
+    static void start();
+
+protected:
+    void run() override;
+
+private:
+    QString m_sceneXml;
+};
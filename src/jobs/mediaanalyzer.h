@@ -0,0 +1,57 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+
+#include <cstdint>
+
+namespace Mlt {
+class Frame;
+}
+
+/** @brief A frame of a clip decoded by an AnalysisTask */
+struct AnalysisFrame
+{
+    int position;
+    Mlt::Frame *frame;
+    /** @brief rgba pixels at the thumbnail profile size, nullptr if no analyzer wanted the image of this frame */
+    const uint8_t *image;
+    int width;
+    int height;
+    /** @brief Interleaved signed 16 bit samples, nullptr if the audio is not analyzed */
+    const int16_t *audio;
+    int samples;
+    int channels;
+    int frequency;
+};
+
+/** @class MediaAnalyzer
+    @brief Base class of the analyses done on the frames decoded once by an AnalysisTask.
+    The task calls processFrame() for every frame of the clip, in order, and finish() at the end.
+    Image decoding is the costly part, so it is only done for the frames that at least one
+    analyzer asks for in wantsImage().
+ */
+class MediaAnalyzer
+{
+public:
+    virtual ~MediaAnalyzer() = default;
+    /** @brief The key of the results of this analyzer in the analysis cache */
+    virtual QString name() const = 0;
+    /** @brief Returns true if the image of the frame at @p position is needed */
+    virtual bool wantsImage(int position) const
+    {
+        Q_UNUSED(position)
+        return false;
+    }
+    /** @brief Returns true if the audio of the frames is needed */
+    virtual bool wantsAudio() const { return false; }
+    virtual void processFrame(const AnalysisFrame &frame) = 0;
+    /** @brief Called once all frames are processed, unless the task was canceled.
+     *  Results that should be kept in the analysis cache are inserted in @p results */
+    virtual void finish(QJsonObject &results) = 0;
+};
@@ -0,0 +1,150 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "processprogress.h"
+
+#include <QtGlobal>
+
+namespace {
+/** @brief Period of the melt throughput measure, in ms */
+const qint64 SamplePeriod = 1000;
+/** @brief Longest incomplete line kept between two calls, anything longer is not progress output */
+const int MaximumLineLength = 4096;
+
+/** @brief Returns the value following @p key in @p line, up to the next comma */
+QByteArray valueOf(const QByteArray &line, const char *key)
+{
+    const int start = line.indexOf(key);
+    if (start < 0) {
+        return QByteArray();
+    }
+    const int from = start + int(qstrlen(key));
+    const int end = line.indexOf(',', from);
+    return line.mid(from, end < 0 ? -1 : end - from).trimmed();
+}
+} // namespace
+
+ProcessProgress::ProcessProgress(Format format, double duration, double fps)
+    : m_format(format)
+    , m_duration(duration)
+    , m_frameRate(fps)
+    , m_percent(0)
+    , m_fps(0.)
+    , m_speed(0.)
+    , m_finished(false)
+    , m_sampleTime(-1)
+    , m_sampleFrame(0)
+{
+}
+
+QStringList ProcessProgress::ffmpegArguments()
+{
+    return {QStringLiteral("-progress"), QStringLiteral("pipe:1"), QStringLiteral("-nostats")};
+}
+
+bool ProcessProgress::parse(const QByteArray &data)
+{
+    if (!m_timer.isValid()) {
+        m_timer.start();
+    }
+    return parse(data, m_timer.elapsed());
+}
+
+bool ProcessProgress::parse(const QByteArray &data, qint64 msecs)
+{
+    const int percent = m_percent;
+    const double fps = m_fps;
+    const double speed = m_speed;
+    m_pending.append(data);
+    int start = 0;
+    for (int i = 0; i < m_pending.size(); ++i) {
+        const char c = m_pending.at(i);
+        if (c != '\n' && c != '\r') {
+            continue;
+        }
+        if (i > start) {
+            parseLine(QByteArray::fromRawData(m_pending.constData() + start, i - start), msecs);
+        }
+        start = i + 1;
+    }
+    m_pending.remove(0, start);
+    if (m_pending.size() > MaximumLineLength) {
+        m_pending.clear();
+    }
+    return m_percent != percent || !qFuzzyCompare(1. + m_fps, 1. + fps) || !qFuzzyCompare(1. + m_speed, 1. + speed);
+}
+
+void ProcessProgress::parseLine(const QByteArray &line, qint64 msecs)
+{
+    if (m_format == Format::Melt) {
+        if (!line.contains("percentage:")) {
+            return;
+        }
+        bool ok;
+        const int percent = valueOf(line, "percentage:").toInt(&ok);
+        if (ok) {
+            m_percent = qBound(0, percent, 100);
+        }
+        const int frame = valueOf(line, "Current Frame:").toInt(&ok);
+        if (!ok) {
+            return;
+        }
+        if (m_sampleTime < 0 || frame < m_sampleFrame) {
+            m_sampleTime = msecs;
+            m_sampleFrame = frame;
+        } else if (msecs - m_sampleTime >= SamplePeriod) {
+            m_fps = (frame - m_sampleFrame) * 1000. / (msecs - m_sampleTime);
+            m_speed = m_frameRate > 0. ? m_fps / m_frameRate : 0.;
+            m_sampleTime = msecs;
+            m_sampleFrame = frame;
+        }
+        return;
+    }
+    const int separator = line.indexOf('=');
+    if (separator <= 0) {
+        return;
+    }
+    const QByteArray key = line.left(separator).trimmed();
+    QByteArray value = line.mid(separator + 1).trimmed();
+    if (key == "out_time_us" || key == "out_time_ms") {
+        // Both are in microseconds, out_time_ms is the name used by older versions
+        bool ok;
+        const qint64 time = value.toLongLong(&ok);
+        if (ok && time >= 0 && m_duration > 0.) {
+            m_percent = qBound(0, int(time / (m_duration * 10000.)), 100);
+        }
+    } else if (key == "fps") {
+        m_fps = qMax(0., value.toDouble());
+    } else if (key == "speed") {
+        if (value.endsWith('x')) {
+            value.chop(1);
+        }
+        // N/A until the first frames are encoded
+        m_speed = qMax(0., value.toDouble());
+    } else if (key == "progress" && value == "end") {
+        m_finished = true;
+        m_percent = 100;
+    }
+}
+
+int ProcessProgress::percent() const
+{
+    return m_percent;
+}
+
+double ProcessProgress::fps() const
+{
+    return m_fps;
+}
+
+double ProcessProgress::speed() const
+{
+    return m_speed;
+}
+
+bool ProcessProgress::isFinished() const
+{
+    return m_finished;
+}
@@ -0,0 +1,58 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QStringList>
+
+/** @class ProcessProgress
+    @brief Incremental parser of the progress reported by the ffmpeg and melt processes started by the tasks.
+    ffmpeg is started with ffmpegArguments(), so that it writes blocks of key=value lines on its
+    standard output every half second, including the output time, fps and speed. melt is started
+    with progress=1 and writes a "Current Frame: N, percentage: P" line on its standard error for
+    every frame, its throughput is measured from the frame numbers.
+    The output is parsed as raw bytes when it arrives, incomplete lines are kept for the next call.
+ */
+class ProcessProgress
+{
+public:
+    enum class Format { FFmpeg, Melt };
+
+    /** @param duration length of the ffmpeg output, in seconds, to compute the percentage
+     *  @param fps frame rate of the melt output, to compute the speed factor */
+    explicit ProcessProgress(Format format = Format::Melt, double duration = 0., double fps = 0.);
+    /** @brief The ffmpeg arguments for a machine readable progress on the standard output */
+    static QStringList ffmpegArguments();
+    /** @brief Parse a block of the process output
+     *  @return true if the percentage or the throughput changed */
+    bool parse(const QByteArray &data);
+    /** @brief Same as parse(), with @p msecs the time elapsed since the process started */
+    bool parse(const QByteArray &data, qint64 msecs);
+    int percent() const;
+    /** @brief Frames processed per second, 0 if unknown */
+    double fps() const;
+    /** @brief Processing speed relative to realtime, 0 if unknown */
+    double speed() const;
+    /** @brief True once ffmpeg reported the end of the processing */
+    bool isFinished() const;
+
+private:
+    void parseLine(const QByteArray &line, qint64 msecs);
+
+    Format m_format;
+    double m_duration;
+    double m_frameRate;
+    QByteArray m_pending;
+    QElapsedTimer m_timer;
+    int m_percent;
+    double m_fps;
+    double m_speed;
+    bool m_finished;
+    /** @brief Start of the current melt throughput measure */
+    qint64 m_sampleTime;
+    int m_sampleFrame;
+};
@@ -22,7 +22,6 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 ProxyTask::ProxyTask(const ObjectId &owner, QObject *object)
     : AbstractTask(owner, AbstractTask::PROXYJOB, object)
-    , m_jobDuration(0)
     , m_isFfmpegJob(true)
     , m_jobProcess(nullptr)
 {
@@ -178,6 +177,7 @@ void ProxyTask::run()
         qDebug() << " :: STARTING PLAYLIST PROXY: " << mltParameters;
         QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
         QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
+        m_processProgress = ProcessProgress(ProcessProgress::Format::Melt, 0., pCore->getCurrentFps());
         m_jobProcess->start(KdenliveSettings::rendererpath(), mltParameters);
         AbstractTask::setPreferredPriority(m_jobProcess->processId());
         m_jobProcess->waitForFinished(-1);
@@ -258,7 +258,6 @@ void ProxyTask::run()
             QMetaObject::invokeMethod(m_object, "updateJobProgress");
             return;
         }
-        m_jobDuration = int(binClip->duration().seconds());
         QString proxyParams = pCore->currentDoc()->getDocumentProperty(QStringLiteral("proxyparams")).simplified();
         if (proxyParams.isEmpty()) {
             // Automatic setting, decide based on hw support
@@ -266,8 +265,8 @@ void ProxyTask::run()
         }
         int proxyResize = pCore->currentDoc()->getDocumentProperty(QStringLiteral("proxyresize")).toInt();
         // Only output error data, make sure we don't block when proxy file already exists
-        QStringList parameters = {QStringLiteral("-hide_banner"), QStringLiteral("-y"), QStringLiteral("-stats"), QStringLiteral("-v"),
-                                  QStringLiteral("error")};
+        QStringList parameters = {QStringLiteral("-hide_banner"), QStringLiteral("-y"), QStringLiteral("-v"), QStringLiteral("error")};
+        parameters << ProcessProgress::ffmpegArguments();
         if (!proxyParams.contains(QLatin1String("mjpeg")) && !proxyParams.contains(QLatin1String("mpeg2video"))) {
             parameters << QStringLiteral("-noautorotate");
         }
@@ -343,6 +342,8 @@ void ProxyTask::run()
         m_jobProcess.reset(new QProcess);
         // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
         QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
+        QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardOutput, this, &ProxyTask::processLogInfo);
+        m_processProgress = ProcessProgress(ProcessProgress::Format::FFmpeg, binClip->duration().seconds());
         QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
         m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
         AbstractTask::setPreferredPriority(m_jobProcess->processId());
@@ -379,45 +380,10 @@ void ProxyTask::run()
 
 void ProxyTask::processLogInfo()
 {
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
-    m_logDetails.append(buffer);
-    if (m_isFfmpegJob) {
-        // Parse FFmpeg output
-        if (m_jobDuration == 0) {
-            if (buffer.contains(QLatin1String("Duration:"))) {
-                QString data = buffer.section(QStringLiteral("Duration:"), 1, 1).section(QLatin1Char(','), 0, 0).simplified();
-                if (!data.isEmpty()) {
-                    QStringList numbers = data.split(QLatin1Char(':'));
-                    if (numbers.size() < 3) {
-                        return;
-                    }
-                    m_jobDuration = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + numbers.at(2).toInt();
-                }
-            }
-        } else if (buffer.contains(QLatin1String("time="))) {
-            int progress = 0;
-            QString time = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0);
-            if (!time.isEmpty()) {
-                QStringList numbers = time.split(QLatin1Char(':'));
-                if (numbers.size() < 3) {
-                    progress = time.toInt();
-                    if (progress == 0) {
-                        return;
-                    }
-                } else {
-                    progress = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
-                }
-            }
-            m_progress = 100 * progress / m_jobDuration;
-            QMetaObject::invokeMethod(m_object, "updateJobProgress");
-            // Q_EMIT jobProgress(int(100.0 * progress / m_jobDuration));
-        }
-    } else {
-        // Parse MLT output
-        if (buffer.contains(QLatin1String("percentage:"))) {
-            m_progress = buffer.section(QStringLiteral("percentage:"), 1).simplified().section(QLatin1Char(' '), 0, 0).toInt();
-            QMetaObject::invokeMethod(m_object, "updateJobProgress");
-            // Q_EMIT jobProgress(progress);
-        }
+    const QByteArray buffer = m_jobProcess->readAllStandardError();
+    m_logDetails.append(QString::fromUtf8(buffer));
+    // ffmpeg reports its progress on the standard output, melt in its log
+    if (parseProcessProgress(m_isFfmpegJob ? m_jobProcess->readAllStandardOutput() : buffer)) {
+        QMetaObject::invokeMethod(m_object, "updateJobProgress");
     }
 }
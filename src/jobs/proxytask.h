@@ -23,7 +23,6 @@ private Q_SLOTS:
     void processLogInfo();
 
 private:
-    int m_jobDuration;
     bool m_isFfmpegJob;
     std::unique_ptr<QProcess> m_jobProcess;
     QString m_errorMessage;
@@ -0,0 +1,100 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "scenechangedetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+SceneChangeDetector::SceneChangeDetector()
+    : m_previous(GridWidth * GridHeight)
+    , m_current(GridWidth * GridHeight)
+    , m_previousHistogram(HistogramBins)
+    , m_histogram(HistogramBins)
+    , m_cellSums(GridWidth)
+    , m_previousDifference(0.)
+    , m_previousHistogramDifference(0.)
+    , m_hasPrevious(false)
+{
+}
+
+void SceneChangeDetector::reset()
+{
+    m_hasPrevious = false;
+    m_previousDifference = 0.;
+    m_previousHistogramDifference = 0.;
+}
+
+void SceneChangeDetector::reduce(const uint8_t *rgba, int width, int height)
+{
+    // The loops below work on contiguous arrays without branches so that the compiler can vectorize them
+    m_row.resize(size_t(width));
+    std::fill(m_histogram.begin(), m_histogram.end(), 0);
+    uint16_t *row = m_row.data();
+    for (int gy = 0; gy < GridHeight; ++gy) {
+        const int y0 = gy * height / GridHeight;
+        const int y1 = std::max(y0 + 1, (gy + 1) * height / GridHeight);
+        std::fill(m_cellSums.begin(), m_cellSums.end(), 0);
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t *line = rgba + 4 * size_t(y) * size_t(width);
+            for (int x = 0; x < width; ++x) {
+                row[x] = uint16_t((77 * line[4 * x] + 150 * line[4 * x + 1] + 29 * line[4 * x + 2]) >> 8);
+            }
+            for (int x = 0; x < width; ++x) {
+                m_histogram[row[x]]++;
+            }
+            for (int gx = 0; gx < GridWidth; ++gx) {
+                const int x0 = gx * width / GridWidth;
+                const int x1 = std::max(x0 + 1, (gx + 1) * width / GridWidth);
+                int sum = 0;
+                for (int x = x0; x < x1; ++x) {
+                    sum += row[x];
+                }
+                m_cellSums[size_t(gx)] += sum;
+            }
+        }
+        for (int gx = 0; gx < GridWidth; ++gx) {
+            const int x0 = gx * width / GridWidth;
+            const int x1 = std::max(x0 + 1, (gx + 1) * width / GridWidth);
+            m_current[size_t(gy * GridWidth + gx)] = m_cellSums[size_t(gx)] / ((y1 - y0) * (x1 - x0));
+        }
+    }
+}
+
+double SceneChangeDetector::process(const uint8_t *rgba, int width, int height)
+{
+    if (rgba == nullptr || width <= 0 || height <= 0) {
+        return 0.;
+    }
+    reduce(rgba, width, height);
+    double score = 0.;
+    if (m_hasPrevious) {
+        int sad = 0;
+        for (size_t i = 0; i < m_current.size(); ++i) {
+            sad += std::abs(m_current[i] - m_previous[i]);
+        }
+        // Distance between the luma distributions, the area between the cumulative histograms
+        int pixels = 0;
+        int previousPixels = 0;
+        int64_t distance = 0;
+        for (size_t i = 0; i < m_histogram.size(); ++i) {
+            pixels += m_histogram[i];
+            previousPixels += m_previousHistogram[i];
+            distance += std::abs(pixels - previousPixels);
+        }
+        const double difference = double(sad) / double(m_current.size());
+        const double histogramDifference = double(distance) / (double(HistogramBins - 1) * std::max(1, pixels));
+        const double gridScore = std::min(1., std::min(difference, std::fabs(difference - m_previousDifference)) / 100.);
+        const double histogramScore = std::min(histogramDifference, std::fabs(histogramDifference - m_previousHistogramDifference));
+        score = (gridScore + histogramScore) / 2.;
+        m_previousDifference = difference;
+        m_previousHistogramDifference = histogramDifference;
+    }
+    std::swap(m_previous, m_current);
+    std::swap(m_previousHistogram, m_histogram);
+    m_hasPrevious = true;
+    return score;
+}
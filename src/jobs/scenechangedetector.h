@@ -0,0 +1,47 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/** @class SceneChangeDetector
+    @brief Computes a scene change score for consecutive frames, like the scene score of FFmpeg's select filter.
+    Frames are reduced to a small luma grid and a luma histogram. The score combines the mean absolute
+    difference of the grids and the distance between the luma distributions of the previous frame, each minus its
+    variation since the previous frame so that fades and camera motion, which change every frame by a
+    similar amount, score lower than a cut. The histogram is not sensitive to motion, the grid catches cuts
+    between shots with a similar exposure.
+ */
+class SceneChangeDetector
+{
+public:
+    static constexpr int GridWidth = 64;
+    static constexpr int GridHeight = 36;
+    static constexpr int HistogramBins = 256;
+
+    SceneChangeDetector();
+    /** @brief Process the next frame of the clip, given as rgba pixels
+     *  @return the scene change score between 0 and 1, 0 for the first frame */
+    double process(const uint8_t *rgba, int width, int height);
+    /** @brief Forget the previous frame, the next frame will be the first */
+    void reset();
+
+private:
+    /** @brief Fill the current grid and histogram from @p rgba */
+    void reduce(const uint8_t *rgba, int width, int height);
+
+    std::vector<int> m_previous;
+    std::vector<int> m_current;
+    std::vector<int> m_previousHistogram;
+    std::vector<int> m_histogram;
+    /** @brief Luma of the pixels of the row being reduced */
+    std::vector<uint16_t> m_row;
+    std::vector<int> m_cellSums;
+    double m_previousDifference;
+    double m_previousHistogramDifference;
+    bool m_hasPrevious;
+};
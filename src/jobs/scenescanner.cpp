@@ -0,0 +1,178 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "scenescanner.h"
+#include "mltcontroller/clipcontroller.h"
+#include "scenechangedetector.h"
+
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <mlt++/MltFilter.h>
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltProfile.h>
+
+SceneScanner::SceneScanner(Mlt::Profile &profile, Mlt::Producer &source)
+    : m_profile(profile)
+    , m_service(source.get("mlt_service"))
+    , m_resource(source.get("resource"))
+    , m_canceled(nullptr)
+    , m_minimumChunkLength(250)
+    , m_error(false)
+{
+    Mlt::Properties original(source.get_properties());
+    m_properties.pass_list(original, ClipController::getPassPropertiesList());
+    if (m_service == QLatin1String("avformat")) {
+        m_service = QStringLiteral("avformat-novalidate");
+    }
+}
+
+void SceneScanner::setCutsCallback(const CutsCallback &callback)
+{
+    m_cutsCallback = callback;
+}
+
+void SceneScanner::setProgressCallback(const ProgressCallback &callback)
+{
+    m_progressCallback = callback;
+}
+
+void SceneScanner::setCancelFlag(const QAtomicInt *canceled)
+{
+    m_canceled = canceled;
+}
+
+void SceneScanner::setMinimumChunkLength(int frames)
+{
+    m_minimumChunkLength = qMax(1, frames);
+}
+
+bool SceneScanner::hasError() const
+{
+    return m_error;
+}
+
+bool SceneScanner::isCanceled() const
+{
+    return m_canceled != nullptr && m_canceled->loadAcquire() != 0;
+}
+
+std::unique_ptr<Mlt::Producer> SceneScanner::createProducer()
+{
+    std::unique_ptr<Mlt::Producer> producer(new Mlt::Producer(m_profile, m_service.toUtf8().constData(), m_resource.toUtf8().constData()));
+    if (!producer->is_valid()) {
+        return nullptr;
+    }
+    Mlt::Properties props(producer->get_properties());
+    props.pass_list(m_properties, ClipController::getPassPropertiesList());
+    // Only the images are needed, scaled down to the profile size
+    producer->set("audio_index", -1);
+    Mlt::Filter scaler(m_profile, "swscale");
+    Mlt::Filter padder(m_profile, "resize");
+    Mlt::Filter converter(m_profile, "avcolor_space");
+    producer->attach(scaler);
+    producer->attach(padder);
+    producer->attach(converter);
+    return producer;
+}
+
+QVector<SceneScanner::Cut> SceneScanner::scan(int in, int out, double threshold, int chunks)
+{
+    QVector<Cut> cuts;
+    m_error = false;
+    if (out < in) {
+        return cuts;
+    }
+    const int length = out - in + 1;
+    if (chunks <= 0) {
+        chunks = QThread::idealThreadCount();
+    }
+    chunks = qBound(1, chunks, length / m_minimumChunkLength);
+    // Producers are opened before starting the threads, the decoders are then only used by their chunk
+    std::vector<std::unique_ptr<Mlt::Producer>> producers;
+    for (int i = 0; i < chunks; ++i) {
+        std::unique_ptr<Mlt::Producer> producer = createProducer();
+        if (producer == nullptr) {
+            m_error = true;
+            return cuts;
+        }
+        producers.push_back(std::move(producer));
+    }
+    m_processed = 0;
+    m_progress = -1;
+    QVector<QVector<Cut>> results(chunks);
+    QVector<bool> finished(chunks, false);
+    int reported = 0;
+    QMutex mutex;
+    auto scanIndex = [&](int index) {
+        const int start = in + int(qint64(length) * index / chunks);
+        const int end = in + int(qint64(length) * (index + 1) / chunks) - 1;
+        QVector<Cut> chunkCuts = scanChunk(*producers.at(size_t(index)), qMax(in, start - 2), start, end, threshold, length);
+        QMutexLocker lock(&mutex);
+        results[index] = chunkCuts;
+        finished[index] = true;
+        // Report the cuts as soon as all the previous chunks are done
+        while (reported < chunks && finished.at(reported) && !isCanceled()) {
+            if (m_cutsCallback && !results.at(reported).isEmpty()) {
+                m_cutsCallback(results.at(reported));
+            }
+            reported++;
+        }
+    };
+    if (chunks == 1) {
+        scanIndex(0);
+    } else {
+        QThreadPool pool;
+        pool.setMaxThreadCount(chunks);
+        for (int i = 0; i < chunks; ++i) {
+            QtConcurrent::run(&pool, [&scanIndex, i]() { scanIndex(i); });
+        }
+        pool.waitForDone();
+    }
+    for (const QVector<Cut> &chunkCuts : qAsConst(results)) {
+        cuts << chunkCuts;
+    }
+    return cuts;
+}
+
+QVector<SceneScanner::Cut> SceneScanner::scanChunk(Mlt::Producer &producer, int from, int start, int end, double threshold, int total)
+{
+    QVector<Cut> cuts;
+    SceneChangeDetector detector;
+    producer.seek(from);
+    for (int pos = from; pos <= end && !isCanceled(); ++pos) {
+        std::unique_ptr<Mlt::Frame> frame(producer.get_frame());
+        const uint8_t *image = nullptr;
+        int width = 0;
+        int height = 0;
+        if (frame != nullptr && frame->is_valid()) {
+            frame->set("consumer.deinterlacer", "onefield");
+            frame->set("consumer.top_field_first", -1);
+            frame->set("consumer.rescale", "nearest");
+            mlt_image_format format = mlt_image_rgba;
+            image = frame->get_image(format, width, height);
+        }
+        if (image == nullptr) {
+            detector.reset();
+            continue;
+        }
+        const double score = detector.process(image, width, height);
+        if (pos < start) {
+            continue;
+        }
+        if (score > threshold) {
+            cuts.append({pos, score});
+        }
+        if (m_progressCallback) {
+            const int percent = int(100. * (m_processed.fetchAndAddRelaxed(1) + 1) / total);
+            if (m_progress.fetchAndStoreRelaxed(percent) != percent) {
+                m_progressCallback(percent);
+            }
+        }
+    }
+    return cuts;
+}
@@ -0,0 +1,71 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+#include <memory>
+#include <mlt++/MltProperties.h>
+
+namespace Mlt {
+class Producer;
+class Profile;
+} // namespace Mlt
+
+/** @class SceneScanner
+    @brief Finds the scene changes of a clip with a SceneChangeDetector, decoding it through MLT.
+    The clip is decoded at the size of the given profile, usually the thumbnail profile, so the
+    cost is mostly the video decoding. The range to scan is split in chunks scanned concurrently,
+    each with its own producer. A chunk starts decoding two frames before its first position, so
+    that the scores are the same as with a single sequential scan.
+ */
+class SceneScanner
+{
+public:
+    struct Cut
+    {
+        int position;
+        double score;
+    };
+    /** @brief Called with the cuts found in a chunk. Calls are serialized and in time order, all the cuts before
+     *  the chunk were already reported */
+    using CutsCallback = std::function<void(const QVector<Cut> &cuts)>;
+    using ProgressCallback = std::function<void(int percent)>;
+
+    /** @param source the producer of the clip, its service, resource and decoding properties are used to open the scanning producers */
+    SceneScanner(Mlt::Profile &profile, Mlt::Producer &source);
+    void setCutsCallback(const CutsCallback &callback);
+    void setProgressCallback(const ProgressCallback &callback);
+    /** @brief The scan stops as soon as @p canceled is not 0 */
+    void setCancelFlag(const QAtomicInt *canceled);
+    /** @brief Chunks are never shorter than @p frames, to limit the cost of opening the producers */
+    void setMinimumChunkLength(int frames);
+    /** @brief Returns the positions from @p in to @p out (included) whose score is above @p threshold
+     *  @param chunks maximum number of chunks scanned concurrently, 0 for the number of cores */
+    QVector<Cut> scan(int in, int out, double threshold, int chunks = 0);
+    /** @brief True if the last scan could not open the clip */
+    bool hasError() const;
+
+private:
+    std::unique_ptr<Mlt::Producer> createProducer();
+    QVector<Cut> scanChunk(Mlt::Producer &producer, int from, int start, int end, double threshold, int total);
+    bool isCanceled() const;
+
+    Mlt::Profile &m_profile;
+    QString m_service;
+    QString m_resource;
+    Mlt::Properties m_properties;
+    CutsCallback m_cutsCallback;
+    ProgressCallback m_progressCallback;
+    const QAtomicInt *m_canceled;
+    int m_minimumChunkLength;
+    bool m_error;
+    QAtomicInt m_processed;
+    QAtomicInt m_progress;
+};
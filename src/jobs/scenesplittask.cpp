@@ -5,6 +5,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "scenesplittask.h"
+#include "analysistask.h"
+#include "scenescanner.h"
 #include "bin/bin.h"
 #include "bin/clipcreator.hpp"
 #include "bin/model/markerlistmodel.hpp"
@@ -23,9 +25,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QPointer>
-#include <QProcess>
-#include <QTemporaryFile>
 #include <QThread>
+#include <mlt++/MltProducer.h>
 
 #include <KLocalizedString>
 #include <project/projectmanager.h>
@@ -33,11 +34,11 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 SceneSplitTask::SceneSplitTask(const ObjectId &owner, double threshold, int markersCategory, bool addSubclips, int minDuration, QObject *object)
     : AbstractTask(owner, AbstractTask::ANALYSECLIPJOB, object)
     , m_threshold(threshold)
-    , m_jobDuration(0)
     , m_markersType(markersCategory)
     , m_subClips(addSubclips)
     , m_minInterval(minDuration)
-    , m_jobProcess(nullptr)
+    , m_markerCount(0)
+    , m_lastMarker(0)
 {
     m_description = i18n("Detecting scene change");
     qDebug() << "Threshold is" << threshold << QString::number(threshold);
@@ -109,7 +110,6 @@ void SceneSplitTask::run()
     QMutexLocker lock(&m_runMutex);
     m_running = true;
     auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.second));
-    const QString source = binClip->url();
     ClipType::ProducerType type = binClip->clipType();
     bool result;
     if (type != ClipType::AV && type != ClipType::Video) {
@@ -119,172 +119,106 @@ void SceneSplitTask::run()
         qDebug() << "=== ABORT 1";
         return;
     }
-    if (KdenliveSettings::ffmpegpath().isEmpty()) {
-        // FFmpeg not detected, cannot process the Job
-        QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection,
-                                  Q_ARG(QString, i18n("FFmpeg not found, please set path in Kdenlive's settings Environment.")),
-                                  Q_ARG(int, int(KMessageWidget::Warning)));
-        qDebug() << "=== ABORT 2";
-        return;
-    }
-    m_jobDuration = int(binClip->duration().seconds());
     int producerDuration = binClip->frameDuration();
-    // QStringList parameters =
-    // {QStringLiteral("-loglevel"),QStringLiteral("info"),QStringLiteral("-i"),source,QStringLiteral("-filter:v"),QString("scdet"),QStringLiteral("-f"),QStringLiteral("null"),QStringLiteral("-")};
-    QStringList parameters = {QStringLiteral("-y"),
-                              QStringLiteral("-loglevel"),
-                              QStringLiteral("info"),
-                              QStringLiteral("-i"),
-                              source,
-                              QStringLiteral("-filter:v"),
-                              QString("select='gt(scene,%1)',showinfo").arg(m_threshold),
-                              QStringLiteral("-vsync"),
-                              QStringLiteral("vfr"),
-                              QStringLiteral("-f"),
-                              QStringLiteral("null"),
-                              QStringLiteral("-")};
-
-    m_jobProcess.reset(new QProcess);
-    // m_jobProcess->setStandardErrorFile("/tmp/test_settings.txt");
-    m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
-    qDebug() << "=== READY TO START JOB:" << parameters;
-    QObject::connect(this, &SceneSplitTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
-    QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardOutput, this, &SceneSplitTask::processLogInfo);
-    QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &SceneSplitTask::processLogErr);
-    m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters);
-    // m_jobProcess->closeReadChannel(QProcess::StandardError);
-    m_jobProcess->waitForStarted();
-    // QString data;
-    /*while(m_jobProcess->waitForReadyRead()) {
-        //data.append(m_jobProcess->readAll());
-        qDebug()<<"???? READ: \n"<<m_jobProcess->readAll();
-    }*/
-    m_jobProcess->waitForFinished(-1);
-    result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+    const QJsonObject analysis = AnalysisTask::cachedResults(binClip.get());
+    if (m_threshold >= AnalysisTask::MinimumSceneScore && analysis.contains(QLatin1String("scenes"))) {
+        // The scene change scores were computed when the clip was imported, no need to decode it again
+        const QJsonArray scores = analysis.value(QLatin1String("scenes")).toArray();
+        for (const QJsonValue &value : scores) {
+            const QJsonArray score = value.toArray();
+            if (score.at(1).toDouble() > m_threshold) {
+                m_results << score.at(0).toInt();
+            }
+        }
+        if (m_markersType >= 0) {
+            importMarkers(m_results);
+        }
+        result = true;
+    } else {
+        std::shared_ptr<Mlt::Producer> producer = binClip->originalProducer();
+        SceneScanner scanner(*pCore->thumbProfile(), *producer.get());
+        scanner.setCancelFlag(&m_isCanceled);
+        scanner.setProgressCallback([this](int progress) {
+            m_progress = progress;
+            QMetaObject::invokeMethod(m_object, "updateJobProgress");
+        });
+        if (m_markersType >= 0) {
+            // Markers appear while the rest of the clip is analyzed
+            scanner.setCutsCallback([this](const QVector<SceneScanner::Cut> &cuts) {
+                QVector<int> positions;
+                for (const SceneScanner::Cut &cut : cuts) {
+                    positions << cut.position;
+                }
+                importMarkers(positions);
+            });
+        }
+        const QVector<SceneScanner::Cut> cuts = scanner.scan(0, producerDuration - 1, m_threshold, QThread::idealThreadCount());
+        for (const SceneScanner::Cut &cut : cuts) {
+            m_results << cut.position;
+        }
+        result = !scanner.hasError();
+    }
 
-    // remove temporary playlist if it exists
     m_progress = 100;
     QMetaObject::invokeMethod(m_object, "updateJobProgress");
-    if (result && !m_isCanceled) {
-        qDebug() << "========================\n\nGOR RESULTS: " << m_results << "\n\n=========";
-        auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(m_owner.second));
-        if (m_markersType >= 0) {
-            // Build json data for markers
-            QJsonArray list;
-            int ix = 1;
-            int lastCut = 0;
-            for (auto &marker : m_results) {
-                int pos = GenTime(marker).frames(pCore->getCurrentFps());
-                if (m_minInterval > 0 && ix > 1 && pos - lastCut < m_minInterval) {
-                    continue;
-                }
-                lastCut = pos;
-                QJsonObject currentMarker;
-                currentMarker.insert(QLatin1String("pos"), QJsonValue(pos));
-                currentMarker.insert(QLatin1String("comment"), QJsonValue(i18n("Scene %1", ix)));
-                currentMarker.insert(QLatin1String("type"), QJsonValue(m_markersType));
-                list.push_back(currentMarker);
-                ix++;
+    if (!result) {
+        QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Failed to analyse clip.")),
+                                  Q_ARG(int, int(KMessageWidget::Warning)));
+        return;
+    }
+    if (m_subClips && !m_isCanceled) {
+        // Create zones
+        int ix = 1;
+        int lastCut = 0;
+        QJsonArray list;
+        QJsonDocument json;
+        for (int pos : qAsConst(m_results)) {
+            if (pos <= lastCut + 1 || pos - lastCut < m_minInterval) {
+                continue;
             }
-            QJsonDocument json(list);
-            QMetaObject::invokeMethod(m_object, "importJsonMarkers", Q_ARG(QString, QString(json.toJson())));
+            QJsonObject currentZone;
+            currentZone.insert(QLatin1String("name"), QJsonValue(i18n("Scene %1", ix)));
+            currentZone.insert(QLatin1String("in"), QJsonValue(lastCut));
+            currentZone.insert(QLatin1String("out"), QJsonValue(pos - 1));
+            list.push_back(currentZone);
+            lastCut = pos;
+            ix++;
         }
-        if (m_subClips) {
-            // Create zones
-            int ix = 1;
-            int lastCut = 0;
-            QJsonArray list;
-            QJsonDocument json;
-            for (double &marker : m_results) {
-                int pos = GenTime(marker).frames(pCore->getCurrentFps());
-                if (pos <= lastCut + 1 || pos - lastCut < m_minInterval) {
-                    continue;
-                }
-                QJsonObject currentZone;
-                currentZone.insert(QLatin1String("name"), QJsonValue(i18n("Scene %1", ix)));
-                currentZone.insert(QLatin1String("in"), QJsonValue(lastCut));
-                currentZone.insert(QLatin1String("out"), QJsonValue(pos - 1));
-                list.push_back(currentZone);
-                lastCut = pos;
-                ix++;
-            }
-            if (lastCut < producerDuration) {
-                QJsonObject currentZone;
-                currentZone.insert(QLatin1String("name"), QJsonValue(i18n("Scene %1", ix)));
-                currentZone.insert(QLatin1String("in"), QJsonValue(lastCut));
-                currentZone.insert(QLatin1String("out"), QJsonValue(producerDuration));
-                list.push_back(currentZone);
-            }
-            json.setArray(list);
-            if (!json.isEmpty()) {
-                QString dataMap(json.toJson());
-                QMetaObject::invokeMethod(pCore->projectItemModel().get(), "loadSubClips", Q_ARG(QString, QString::number(m_owner.second)),
-                                          Q_ARG(QString, dataMap), Q_ARG(bool, true));
-            }
+        if (lastCut < producerDuration) {
+            QJsonObject currentZone;
+            currentZone.insert(QLatin1String("name"), QJsonValue(i18n("Scene %1", ix)));
+            currentZone.insert(QLatin1String("in"), QJsonValue(lastCut));
+            currentZone.insert(QLatin1String("out"), QJsonValue(producerDuration));
+            list.push_back(currentZone);
+        }
+        json.setArray(list);
+        if (!json.isEmpty()) {
+            QString dataMap(json.toJson());
+            QMetaObject::invokeMethod(pCore->projectItemModel().get(), "loadSubClips", Q_ARG(QString, QString::number(m_owner.second)),
+                                      Q_ARG(QString, dataMap), Q_ARG(bool, true));
         }
-    } else {
-        // Proxy process crashed
-        QMetaObject::invokeMethod(pCore.get(), "displayBinLogMessage", Qt::QueuedConnection, Q_ARG(QString, i18n("Failed to analyse clip.")),
-                                  Q_ARG(int, int(KMessageWidget::Warning)), Q_ARG(QString, m_logDetails));
     }
 }
 
-void SceneSplitTask::processLogErr()
-{
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
-    qDebug() << "ERROR: ----\n" << buffer;
-}
-
-void SceneSplitTask::processLogInfo()
+void SceneSplitTask::importMarkers(const QVector<int> &cuts)
 {
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardOutput());
-    m_logDetails.append(buffer);
-    int progress = 0;
-    // Parse FFmpeg output
-    qDebug() << "-------------\n" << buffer;
-    if (buffer.contains(QLatin1String("[Parsed_showinfo"))) {
-        QString timeMarker("pts_time:");
-        bool ok;
-        QStringList output = buffer.split("[Parsed_showinfo");
-        output.removeFirst();
-        for (const QString &o : qAsConst(output)) {
-            if (o.contains(timeMarker)) {
-                double res = o.section(timeMarker, 1).section(QLatin1Char(' '), 0, 0).toDouble(&ok);
-                if (ok) {
-                    m_results << res;
-                }
-            }
+    // Build json data for markers
+    QJsonArray list;
+    for (int pos : cuts) {
+        if (m_minInterval > 0 && m_markerCount > 0 && pos - m_lastMarker < m_minInterval) {
+            continue;
         }
+        m_lastMarker = pos;
+        m_markerCount++;
+        QJsonObject currentMarker;
+        currentMarker.insert(QLatin1String("pos"), QJsonValue(pos));
+        currentMarker.insert(QLatin1String("comment"), QJsonValue(i18n("Scene %1", m_markerCount)));
+        currentMarker.insert(QLatin1String("type"), QJsonValue(m_markersType));
+        list.push_back(currentMarker);
     }
-    if (m_jobDuration == 0) {
-        qDebug() << "=== NO DURATION!!!";
-        if (buffer.contains(QLatin1String("Duration:"))) {
-            QString data = buffer.section(QStringLiteral("Duration:"), 1, 1).section(QLatin1Char(','), 0, 0).simplified();
-            if (!data.isEmpty()) {
-                qDebug() << "==== GOT DURATION:" << data;
-                QStringList numbers = data.split(QLatin1Char(':'));
-                if (numbers.size() < 3) {
-                    return;
-                }
-                m_jobDuration = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + numbers.at(2).toInt();
-            }
-        }
-    } else if (buffer.contains(QLatin1String("time="))) {
-        QString time = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0);
-        qDebug() << "=== GOT PROGRESS TIME: " << time;
-        if (!time.isEmpty()) {
-            QStringList numbers = time.split(QLatin1Char(':'));
-            if (numbers.size() < 3) {
-                progress = time.toInt();
-                if (progress == 0) {
-                    return;
-                }
-            } else {
-                progress = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
-            }
-        }
-        m_progress = 100 * progress / m_jobDuration;
-        QMetaObject::invokeMethod(m_object, "updateJobProgress");
-        // Q_EMIT jobProgress(int(100.0 * progress / m_jobDuration));
+    if (list.isEmpty()) {
+        return;
     }
+    QJsonDocument json(list);
+    QMetaObject::invokeMethod(m_object, "importJsonMarkers", Q_ARG(QString, QString(json.toJson())));
 }
@@ -8,7 +8,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstracttask.h"
 
-class QProcess;
+#include <QVector>
 
 class SceneSplitTask : public AbstractTask
 {
@@ -19,18 +19,16 @@ public:
 protected:
     void run() override;
 
-private Q_SLOTS:
-    void processLogInfo();
-    void processLogErr();
-
 private:
+    /** @brief Add markers for the scene @p cuts, following the ones already added */
+    void importMarkers(const QVector<int> &cuts);
+
     double m_threshold;
-    int m_jobDuration;
     int m_markersType;
     bool m_subClips;
     int m_minInterval;
-    std::unique_ptr<QProcess> m_jobProcess;
-    QString m_errorMessage;
-    QString m_logDetails;
-    QList<double> m_results;
+    int m_markerCount;
+    int m_lastMarker;
+    /** @brief The positions of the scene changes */
+    QVector<int> m_results;
 };
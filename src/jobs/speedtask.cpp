@@ -232,6 +232,7 @@ void SpeedTask::run()
     QMetaObject::invokeMethod(m_object, "updateJobProgress");
     QObject::connect(this, &AbstractTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
     QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &SpeedTask::processLogInfo);
+    m_processProgress = ProcessProgress(ProcessProgress::Format::Melt, 0., pCore->getCurrentFps());
     qDebug() << "=== STARTING PROCESS: " << producerArgs;
     m_jobProcess->start(KdenliveSettings::rendererpath(), producerArgs);
     m_jobProcess->waitForFinished(-1);
@@ -253,15 +254,9 @@ void SpeedTask::run()
 
 void SpeedTask::processLogInfo()
 {
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
-    m_logDetails.append(buffer);
-    // Parse MLT output
-    if (buffer.contains(QLatin1String("percentage:"))) {
-        int progress = buffer.section(QStringLiteral("percentage:"), 1).simplified().section(QLatin1Char(' '), 0, 0).toInt();
-        if (progress == m_progress) {
-            return;
-        }
-        m_progress = progress;
+    const QByteArray buffer = m_jobProcess->readAllStandardError();
+    m_logDetails.append(QString::fromUtf8(buffer));
+    if (parseProcessProgress(buffer)) {
         QMetaObject::invokeMethod(m_object, "updateJobProgress");
     }
 }
@@ -5,12 +5,14 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "stabilizetask.h"
+#include "analysissegments.h"
 #include "assets/model/assetparametermodel.hpp"
 #include "bin/bin.h"
 #include "bin/projectclip.h"
 #include "bin/projectfolder.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
+#include "doc/kdenlivedoc.h"
 #include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
@@ -19,11 +21,22 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "project/clipstabilize.h"
 #include "xml/xml.hpp"
 
+#include <QCryptographicHash>
+#include <QDir>
+#include <QEventLoop>
+#include <QFileInfo>
 #include <QProcess>
 #include <QThread>
 
 #include <KLocalizedString>
 
+namespace {
+/** @brief vid.stab measures the motion of a frame against the previous frame */
+const int StabilizeOverlap = 1;
+/** @brief Segments shorter than this are not worth the cost of an additional melt process */
+const int MinimumSegmentFrames = 250;
+} // namespace
+
 StabilizeTask::StabilizeTask(const ObjectId &owner, const QString &binId, const QString &destination, int in, int out,
                              const std::unordered_map<QString, QVariant> &filterParams, QObject *object)
     : AbstractTask(owner, AbstractTask::STABILIZEJOB, object)
@@ -97,7 +110,10 @@ void StabilizeTask::run()
     QString url;
     auto binClip = pCore->projectItemModel()->getClipByBinID(m_binId);
     QString folderId = QLatin1String("-1");
-    QStringList producerArgs = {QStringLiteral("progress=1"), QStringLiteral("-profile"), pCore->getCurrentProfilePath()};
+    QStringList sourceArgs = {QStringLiteral("-profile"), pCore->getCurrentProfilePath()};
+    int in = 0;
+    int out = 0;
+    QString sourceVersion;
     if (binClip) {
         // Filter applied on a timeline or bin clip
         folderId = binClip->parent()->clipId();
@@ -107,15 +123,12 @@ void StabilizeTask::run()
                                       Q_ARG(int, int(KMessageWidget::Warning)));
             return;
         }
-        producerArgs << url;
-        producerArgs << binClip->enforcedParams();
-
-        if (m_inPoint > -1) {
-            producerArgs << QString("in=%1").arg(m_inPoint);
-        }
-        if (m_outPoint > -1) {
-            producerArgs << QString("out=%1").arg(m_outPoint);
-        }
+        sourceArgs << url;
+        sourceArgs << binClip->enforcedParams();
+        in = qMax(0, m_inPoint);
+        out = m_outPoint > -1 ? m_outPoint : int(binClip->frameDuration()) - 1;
+        const QFileInfo sourceInfo(url);
+        sourceVersion = QStringLiteral("%1-%2-%3").arg(binClip->hash(false)).arg(sourceInfo.size()).arg(sourceInfo.lastModified().toMSecsSinceEpoch());
     } else {
         // Filter applied on a track of master producer, leave config to source job
         // We are on master or track, configure producer accordingly
@@ -135,7 +148,7 @@ void StabilizeTask::run()
         }*/
     }
 
-    producerArgs << QStringLiteral("-attach") << QStringLiteral("vidstab");
+    QStringList filterArgs = {QStringLiteral("-attach"), QStringLiteral("vidstab")};
 
     // Process filter params
     qDebug() << " = = = = = CONFIGURING FILTER PARAMS = = = = =  ";
@@ -146,9 +159,9 @@ void StabilizeTask::run()
 #else
         if (it.second.typeId() == QMetaType::Double) {
 #endif
-            producerArgs << QString("%1=%2").arg(it.first, QString::number(it.second.toDouble()));
+            filterArgs << QString("%1=%2").arg(it.first, QString::number(it.second.toDouble()));
         } else {
-            producerArgs << QString("%1=%2").arg(it.first, it.second.toString());
+            filterArgs << QString("%1=%2").arg(it.first, it.second.toString());
         }
     }
     QString targetFile = m_destination + QStringLiteral(".trf");
@@ -157,21 +170,28 @@ void StabilizeTask::run()
         targetFile = m_destination + QString("-%1.trf").arg(count);
         count++;
     }
-    producerArgs << QString("filename=%1").arg(targetFile);
 
-    // Start the MLT Process
-    QProcess filterProcess;
-    producerArgs << QStringLiteral("-consumer") << QString("xml:%1").arg(m_destination) << QStringLiteral("all=1") << QStringLiteral("terminate_on_pause=1");
-    m_jobProcess.reset(new QProcess);
     QMetaObject::invokeMethod(m_object, "updateJobProgress");
-    QObject::connect(this, &AbstractTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
-    QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &StabilizeTask::processLogInfo);
-    qDebug() << "=== STARTING PROCESS: " << producerArgs;
-    m_jobProcess->start(KdenliveSettings::rendererpath(), producerArgs);
-    m_jobProcess->waitForFinished(-1);
-    qDebug() << " + + + + + + + + SOURCE FILE PROCESSED: " << m_jobProcess->exitStatus();
-    bool result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+    bool result = analyseSegments(sourceArgs, filterArgs, in, out, targetFile, sourceVersion);
+    if (result) {
+        // Write the clip with the stabilization filter reading the joined motion data, the xml consumer does not process frames without all=1
+        QStringList producerArgs = sourceArgs;
+        if (m_inPoint > -1) {
+            producerArgs << QString("in=%1").arg(m_inPoint);
+        }
+        if (m_outPoint > -1) {
+            producerArgs << QString("out=%1").arg(m_outPoint);
+        }
+        producerArgs << filterArgs << QString("filename=%1").arg(targetFile) << QString("results=%1").arg(targetFile);
+        producerArgs << QStringLiteral("-consumer") << QString("xml:%1").arg(m_destination);
+        QProcess clipProcess;
+        clipProcess.start(KdenliveSettings::rendererpath(), producerArgs);
+        clipProcess.waitForFinished(-1);
+        m_logDetails.append(QString::fromUtf8(clipProcess.readAllStandardError()));
+        result = clipProcess.exitStatus() == QProcess::NormalExit && QFile::exists(m_destination);
+    }
     m_progress = 100;
+    setProcessThroughput(0., 0.);
     QMetaObject::invokeMethod(m_object, "updateJobProgress");
     if (m_isCanceled || !result) {
         if (!m_isCanceled) {
@@ -184,17 +204,139 @@ void StabilizeTask::run()
                               Q_ARG(QString, folderId), Q_ARG(QString, QStringLiteral("stabilize")));
 }
 
-void StabilizeTask::processLogInfo()
+bool StabilizeTask::analyseSegments(const QStringList &sourceArgs, const QStringList &filterArgs, int in, int out, const QString &targetFile,
+                                    const QString &sourceVersion)
 {
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
-    m_logDetails.append(buffer);
-    // Parse MLT output
-    if (buffer.contains(QLatin1String("percentage:"))) {
-        int progress = buffer.section(QStringLiteral("percentage:"), 1).simplified().section(QLatin1Char(' '), 0, 0).toInt();
-        if (progress == m_progress) {
-            return;
+    const int concurrency = KdenliveSettings::analysissegments() > 0 ? KdenliveSettings::analysissegments() : QThread::idealThreadCount();
+    const QVector<QPair<int, int>> ranges = AnalysisSegments::split(in, out, concurrency, MinimumSegmentFrames);
+    // The completed segments of a canceled analysis are kept in the project cache and reused
+    QStringList keyArgs = filterArgs;
+    keyArgs.sort();
+    // A clip file replaced by another one at the same path must not reuse the old segments
+    QByteArray key = (sourceArgs + keyArgs + QStringList{sourceVersion}).join(QLatin1Char('\n')).toUtf8();
+    for (const auto &range : ranges) {
+        key += '\n' + QByteArray::number(range.first) + '-' + QByteArray::number(range.second);
+    }
+    const QString folderName = QStringLiteral("stabilize-%1").arg(QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex()));
+    bool ok;
+    QDir folder = pCore->currentDoc()->getCacheDir(CacheTmpWorkFiles, &ok);
+    if (!ok) {
+        folder = QDir::temp();
+    }
+    if (!folder.mkpath(folderName) || !folder.cd(folderName)) {
+        m_logDetails.append(i18n("Cannot create folder %1", folder.absoluteFilePath(folderName)));
+        return false;
+    }
+    const int totalFrames = out - in + 1;
+    int doneFrames = 0;
+
+    QEventLoop loop;
+    std::vector<std::unique_ptr<QProcess>> processes;
+    QVector<int> segmentFrames;
+    QVector<ProcessProgress> segmentProgress;
+    int running = 0;
+    bool failed = false;
+    auto updateProgress = [&]() {
+        int frames = doneFrames;
+        double fps = 0.;
+        double speed = 0.;
+        for (int i = 0; i < segmentProgress.count(); ++i) {
+            frames += segmentFrames.at(i) * segmentProgress.at(i).percent() / 100;
+            fps += segmentProgress.at(i).fps();
+            speed += segmentProgress.at(i).speed();
         }
-        m_progress = progress;
+        // Keep the last percent for writing the stabilized clip
+        m_progress = qMin(99, 100 * frames / qMax(1, totalFrames));
+        setProcessThroughput(fps, speed);
         QMetaObject::invokeMethod(m_object, "updateJobProgress");
+    };
+    for (int i = 0; i < ranges.count(); ++i) {
+        const QString segmentFile = folder.absoluteFilePath(QStringLiteral("segment-%1.trf").arg(i));
+        const int length = ranges.at(i).second - ranges.at(i).first + 1;
+        if (QFile::exists(segmentFile)) {
+            doneFrames += length;
+            continue;
+        }
+        // Analyse the frame before the segment, it is the reference of the motion of its first frame
+        const int segmentIn = i == 0 ? ranges.at(i).first : ranges.at(i).first - StabilizeOverlap;
+        const QString partFile = folder.absoluteFilePath(QStringLiteral("segment-%1.part.trf").arg(i));
+        QStringList args = {QStringLiteral("progress=1")};
+        args << sourceArgs << QString("in=%1").arg(segmentIn) << QString("out=%1").arg(ranges.at(i).second) << filterArgs;
+        args << QString("filename=%1").arg(partFile);
+        args << QStringLiteral("-consumer") << QString("xml:%1").arg(folder.absoluteFilePath(QStringLiteral("segment-%1.mlt").arg(i)))
+             << QStringLiteral("all=1") << QStringLiteral("terminate_on_pause=1");
+        const int index = segmentProgress.count();
+        segmentFrames << length;
+        segmentProgress << ProcessProgress(ProcessProgress::Format::Melt, 0., pCore->getCurrentFps());
+        processes.push_back(std::make_unique<QProcess>());
+        QProcess *process = processes.back().get();
+        QObject::connect(process, &QProcess::readyReadStandardError, &loop, [&, process, index]() {
+            const QByteArray buffer = process->readAllStandardError();
+            m_logDetails.append(QString::fromUtf8(buffer));
+            if (segmentProgress[index].parse(buffer)) {
+                updateProgress();
+            }
+        });
+        auto segmentFinished = [&, index, length, partFile, segmentFile](bool success) {
+            if (success && !m_isCanceled && QFile::rename(partFile, segmentFile)) {
+                doneFrames += length;
+            } else {
+                QFile::remove(partFile);
+                failed = true;
+            }
+            segmentFrames[index] = 0;
+            updateProgress();
+            if (--running == 0) {
+                loop.quit();
+            }
+        };
+        QObject::connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), &loop,
+                         [segmentFinished](int exitCode, QProcess::ExitStatus exitStatus) { segmentFinished(exitStatus == QProcess::NormalExit && exitCode == 0); });
+        QObject::connect(process, &QProcess::errorOccurred, &loop, [segmentFinished](QProcess::ProcessError error) {
+            // No finished signal follows a failed start
+            if (error == QProcess::FailedToStart) {
+                segmentFinished(false);
+            }
+        });
+        qDebug() << "=== STARTING PROCESS: " << args;
+        running++;
+        process->start(KdenliveSettings::rendererpath(), args);
+    }
+    if (running > 0) {
+        QObject::connect(
+            this, &AbstractTask::jobCanceled, &loop,
+            [&processes]() {
+                for (auto &process : processes) {
+                    process->kill();
+                }
+            },
+            Qt::QueuedConnection);
+        if (m_isCanceled) {
+            for (auto &process : processes) {
+                process->kill();
+            }
+        }
+        loop.exec();
+    }
+    if (m_isCanceled || failed) {
+        return false;
+    }
+
+    QVector<QByteArray> segments;
+    for (int i = 0; i < ranges.count(); ++i) {
+        QFile file(folder.absoluteFilePath(QStringLiteral("segment-%1.trf").arg(i)));
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        segments << file.readAll();
+    }
+    const QByteArray motionData = AnalysisSegments::joinMotionData(segments, StabilizeOverlap);
+    QFile target(targetFile);
+    if (motionData.isEmpty() || !target.open(QIODevice::WriteOnly) || target.write(motionData) != motionData.size()) {
+        m_logDetails.append(i18n("Cannot write file %1", targetFile));
+        return false;
     }
+    target.close();
+    folder.removeRecursively();
+    return true;
 }
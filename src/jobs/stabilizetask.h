@@ -11,8 +11,6 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <unordered_map>
 #include <mlt++/MltConsumer.h>
 
-class QProcess;
-
 class StabilizeTask : public AbstractTask
 {
 public:
@@ -20,9 +18,6 @@ public:
                   const std::unordered_map<QString, QVariant> &filterParams, QObject *object);
     static void start(QObject* object, bool force = false);
 
-private Q_SLOTS:
-    void processLogInfo();
-
 protected:
     void run() override;
 
@@ -35,5 +30,11 @@ private:
     QStringList m_consumerArgs;
     QString m_errorMessage;
     QString m_logDetails;
-    std::unique_ptr<QProcess> m_jobProcess;
+    /** @brief Analyse the @p in - @p out range of the clip in segments processed concurrently and write the joined motion data to @p targetFile
+     *  @param sourceArgs the melt arguments of the clip, without in and out points
+     *  @param filterArgs the melt arguments of the analysis filter, without the motion file
+     *  @param sourceVersion identifies the content of the clip file, so that segments analysed before it changed are not reused
+     *  @return false if the analysis was canceled or failed */
+    bool analyseSegments(const QStringList &sourceArgs, const QStringList &filterArgs, int in, int out, const QString &targetFile,
+                         const QString &sourceVersion);
 };
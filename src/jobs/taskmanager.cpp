@@ -14,6 +14,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "macros.hpp"
 #include "undohelper.hpp"
 
+#include <KLocalizedString>
 #include <KMessageWidget>
 #include <QFuture>
 #include <QThread>
@@ -233,9 +234,10 @@ int TaskManager::getJobProgressForClip(const ObjectId &owner)
     QStringList jobNames;
     QList<int> jobsProgress;
     QStringList jobsUuids;
+    QStringList jobsDetails;
     if (m_taskList.find(owner.second) == m_taskList.end()) {
         if (owner.second == displayedClip) {
-            Q_EMIT detailedProgress(owner, jobNames, jobsProgress, jobsUuids);
+            Q_EMIT detailedProgress(owner, jobNames, jobsProgress, jobsUuids, jobsDetails);
         }
         return 100;
     }
@@ -253,6 +255,17 @@ int TaskManager::getJobProgressForClip(const ObjectId &owner)
             jobNames << t->m_description;
             jobsProgress << t->m_progress;
             jobsUuids << t->m_uuid.toString();
+            // Throughput reported by the task process
+            const int fps = t->m_fps.loadAcquire();
+            const int speed = t->m_speed.loadAcquire();
+            if (fps <= 0) {
+                jobsDetails << QString();
+            } else if (speed <= 0) {
+                jobsDetails << i18nc("@info:progress processing speed", "%1 fps", QString::number(fps / 100., 'f', 1));
+            } else {
+                jobsDetails << i18nc("@info:progress processing speed, %2 is relative to realtime", "%1 fps, %2x", QString::number(fps / 100., 'f', 1),
+                                     QString::number(speed / 100., 'f', 2));
+            }
         }
         total += t->m_progress;
     }
@@ -261,7 +274,7 @@ int TaskManager::getJobProgressForClip(const ObjectId &owner)
     }
     total /= cnt;
     if (owner.second == displayedClip) {
-        Q_EMIT detailedProgress(owner, jobNames, jobsProgress, jobsUuids);
+        Q_EMIT detailedProgress(owner, jobNames, jobsProgress, jobsUuids, jobsDetails);
     }
     return total;
 }
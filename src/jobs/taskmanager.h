@@ -91,5 +91,6 @@ private:
 
 Q_SIGNALS:
     void jobCount(int);
-    void detailedProgress(const ObjectId &owner, const QStringList &, const QList<int> &, const QStringList &);
+    /** @brief The names, progress, uuids and throughput of the running jobs of @p owner */
+    void detailedProgress(const ObjectId &owner, const QStringList &, const QList<int> &, const QStringList &, const QStringList &);
 };
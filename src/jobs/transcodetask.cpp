@@ -26,7 +26,6 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 TranscodeTask::TranscodeTask(const ObjectId &owner, const QString &suffix, const QString &preParams, const QString &params, int in, int out,
                              bool replaceProducer, QObject *object, bool checkProfile)
     : AbstractTask(owner, AbstractTask::TRANSCODEJOB, object)
-    , m_jobDuration(0)
     , m_isFfmpegJob(true)
     , m_suffix(suffix)
     , m_transcodeParams(params)
@@ -170,6 +169,7 @@ void TranscodeTask::run()
         // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
         QObject::connect(this, &TranscodeTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
         QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &TranscodeTask::processLogInfo);
+        m_processProgress = ProcessProgress(ProcessProgress::Format::Melt, 0., pCore->getCurrentFps());
         m_jobProcess->start(KdenliveSettings::rendererpath(), mltParameters);
         AbstractTask::setPreferredPriority(m_jobProcess->processId());
         m_jobProcess->waitForFinished(-1);
@@ -184,12 +184,17 @@ void TranscodeTask::run()
                                       Q_ARG(int, int(KMessageWidget::Warning)));
             return;
         }
-        m_jobDuration = int(binClip->duration().seconds());
+        double duration = binClip->duration().seconds();
+        if (m_outPoint > -1) {
+            duration = GenTime(m_outPoint - qMax(0, m_inPoint), pCore->getCurrentFps()).seconds();
+        } else if (m_inPoint > -1) {
+            duration -= GenTime(m_inPoint, pCore->getCurrentFps()).seconds();
+        }
         parameters << QStringLiteral("-y");
         if (m_inPoint > -1) {
             parameters << QStringLiteral("-ss") << QString::number(GenTime(m_inPoint, pCore->getCurrentFps()).seconds());
         }
-        parameters << QStringLiteral("-stats");
+        parameters << ProcessProgress::ffmpegArguments();
         if (!m_transcodePreParams.isEmpty()) {
             parameters << m_transcodePreParams.split(QStringLiteral(" "));
         }
@@ -215,6 +220,8 @@ void TranscodeTask::run()
         // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
         QObject::connect(this, &TranscodeTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
         QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &TranscodeTask::processLogInfo);
+        QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardOutput, this, &TranscodeTask::processLogInfo);
+        m_processProgress = ProcessProgress(ProcessProgress::Format::FFmpeg, duration);
         m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
         AbstractTask::setPreferredPriority(m_jobProcess->processId());
         m_jobProcess->waitForFinished(-1);
@@ -272,44 +279,10 @@ void TranscodeTask::run()
 
 void TranscodeTask::processLogInfo()
 {
-    const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
-    m_logDetails.append(buffer);
-    if (m_isFfmpegJob) {
-        // Parse FFmpeg output
-        if (m_jobDuration == 0) {
-            if (buffer.contains(QLatin1String("Duration:"))) {
-                QString data = buffer.section(QStringLiteral("Duration:"), 1, 1).section(QLatin1Char(','), 0, 0).simplified();
-                if (!data.isEmpty()) {
-                    QStringList numbers = data.split(QLatin1Char(':'));
-                    if (numbers.size() < 3) {
-                        return;
-                    }
-                    m_jobDuration = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + numbers.at(2).toInt();
-                }
-            }
-        } else if (buffer.contains(QLatin1String("time="))) {
-            int progress = 0;
-            QString time = buffer.section(QStringLiteral("time="), 1, 1).simplified().section(QLatin1Char(' '), 0, 0);
-            if (!time.isEmpty()) {
-                QStringList numbers = time.split(QLatin1Char(':'));
-                if (numbers.size() < 3) {
-                    progress = time.toInt();
-                    if (progress == 0) {
-                        return;
-                    }
-                } else {
-                    progress = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
-                }
-            }
-            m_progress = 100 * progress / m_jobDuration;
-            QMetaObject::invokeMethod(m_object, "updateJobProgress");
-            // Q_EMIT jobProgress(int(100.0 * progress / m_jobDuration));
-        }
-    } else {
-        // Parse MLT output
-        if (buffer.contains(QLatin1String("percentage:"))) {
-            m_progress = buffer.section(QStringLiteral("percentage:"), 1).simplified().section(QLatin1Char(' '), 0, 0).toInt();
-            QMetaObject::invokeMethod(m_object, "updateJobProgress");
-        }
+    const QByteArray buffer = m_jobProcess->readAllStandardError();
+    m_logDetails.append(QString::fromUtf8(buffer));
+    // ffmpeg reports its progress on the standard output, melt in its log
+    if (parseProcessProgress(m_isFfmpegJob ? m_jobProcess->readAllStandardOutput() : buffer)) {
+        QMetaObject::invokeMethod(m_object, "updateJobProgress");
     }
 }
@@ -23,7 +23,6 @@ private Q_SLOTS:
     void processLogInfo();
 
 private:
-    int m_jobDuration;
     bool m_isFfmpegJob;
     QString m_suffix;
     QString m_transcodeParams;
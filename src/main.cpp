@@ -17,6 +17,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kcoreaddons_version.h"
 #include "kxmlgui_version.h"
 #include "mainwindow.h"
+#include "utils/tracer.hpp"
 
 #include <KAboutData>
 #include <KConfigGroup>
@@ -178,11 +179,15 @@ int main(int argc, char *argv[])
     parser.addOption(mltLogLevelOption);
     QCommandLineOption clipsOption(QStringLiteral("i"), i18n("Comma separated list of files to add as clips to the bin."), QStringLiteral("clips"));
     parser.addOption(clipsOption);
+    QCommandLineOption traceOption(QStringLiteral("trace"), i18n("Record the duration of startup and loading steps to a Chrome trace file."),
+                                   QStringLiteral("file"));
+    parser.addOption(traceOption);
     parser.addPositionalArgument(QStringLiteral("file"), i18n("Kdenlive document to open."));
 
     // Parse command line
     parser.process(app);
     aboutData.processCommandLine(&parser);
+    Tracer::instance().enable(parser.isSet(traceOption) ? parser.value(traceOption) : qEnvironmentVariable("KDENLIVE_TRACE"));
 
     qApp->processEvents(QEventLoop::AllEvents);
 
@@ -351,6 +356,7 @@ int main(int argc, char *argv[])
         pCore->initGUI(inSandbox, parser.value(mltPathOption), url, clipsToLoad);
         result = app.exec();
     }
+    Tracer::instance().write();
     Core::clean();
     if (result == EXIT_RESTART || result == EXIT_CLEAN_RESTART) {
         qCDebug(KDENLIVE_LOG) << "restarting app";
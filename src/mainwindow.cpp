@@ -35,9 +35,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivesettings.h"
 #include "layoutmanagement.h"
 #include "library/librarywidget.h"
-#ifdef NODBUS
 #include "render/renderserver.h"
-#else
+#ifndef NODBUS
 #include "mainwindowadaptor.h"
 #endif
 #include "dialogs/textbasededit.h"
@@ -65,6 +64,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "transitions/transitionlist/view/transitionlistwidget.hpp"
 #include "transitions/transitionsrepository.hpp"
 #include "utils/thememanager.h"
+#include "utils/tracer.hpp"
 #include "widgets/progressbutton.h"
 #include <config-kdenlive.h>
 
@@ -157,6 +157,7 @@ MainWindow::MainWindow(QWidget *parent)
 
 void MainWindow::init(const QString &mltPath)
 {
+    TRACE_SCOPE("MainWindow::init", "startup");
     QString desktopStyle = QApplication::style()->objectName();
     // Load themes
     auto themeManager = new ThemeManager(actionCollection());
@@ -213,11 +214,10 @@ void MainWindow::init(const QString &mltPath)
     }
     connect(stylesGroup, &QActionGroup::triggered, this, &MainWindow::slotChangeStyle);
     // QIcon::setThemeSearchPaths(QStringList() <<QStringLiteral(":/icons/"));
-#ifdef NODBUS
-    new RenderServer(this);
-#else
+#ifndef NODBUS
     new RenderingAdaptor(this);
 #endif
+    m_renderServer = new RenderServer(this);
     QString defaultProfile = KdenliveSettings::default_profile();
 
     // Initialise MLT connection
@@ -276,7 +276,10 @@ void MainWindow::init(const QString &mltPath)
     fr->setMaximumHeight(1);
     fr->setLineWidth(1);
     ctnLay->addWidget(fr);
-    setupActions();
+    {
+        TRACE_SCOPE("MainWindow::setupActions", "startup");
+        setupActions();
+    }
     auto *layoutManager = new LayoutManagement(this);
     pCore->bin()->setupMenu();
     pCore->buildDocks();
@@ -1587,6 +1590,11 @@ void MainWindow::setupActions()
         // Clear timeline selection so that any qml monitor scene is reset
         Q_EMIT pCore->monitorManager()->updatePreviewScaling();
     });
+    QAction *adaptiveScale = new QAction(i18n("Lower Resolution When Playback Lags"), this);
+    adaptiveScale->setCheckable(true);
+    adaptiveScale->setChecked(KdenliveSettings::autopreviewscaling());
+    addAction(QStringLiteral("scale_adaptive_preview"), adaptiveScale, QKeySequence(), resolutionActionCategory);
+    connect(adaptiveScale, &QAction::toggled, this, [](bool enabled) { KdenliveSettings::setAutopreviewscaling(enabled); });
 
     QAction *dropFrames = new QAction(QIcon(), i18n("Real Time (drop frames)"), this);
     dropFrames->setCheckable(true);
@@ -1665,6 +1673,10 @@ void MainWindow::setupActions()
                                             "Click on the down-arrow icon to get a list of options (for example: add preview render zone, remove all zones)."));
     addAction(QStringLiteral("stop_prerender_timeline"), i18n("Stop Preview Render"), this, SLOT(slotStopPreviewRender()),
               QIcon::fromTheme(QStringLiteral("preview-render-off")));
+    QAction *profileRender = addAction(QStringLiteral("profile_timeline_render"), i18n("Measure Render Time…"), this, SLOT(slotProfileRender()),
+                                       QIcon::fromTheme(QStringLiteral("chronometer")));
+    profileRender->setWhatsThis(xi18nc("@info:whatsthis", "Measure the time each track, clip, effect and composition adds to the render of the "
+                                                          "timeline zone, or of the whole timeline, with the preview render settings."));
 
     addAction(QStringLiteral("select_timeline_clip"), i18n("Select Clip"), this, SLOT(slotSelectTimelineClip()),
               QIcon::fromTheme(QStringLiteral("edit-select")), Qt::Key_Plus);
@@ -3037,6 +3049,13 @@ void MainWindow::slotStopPreviewRender()
     }
 }
 
+void MainWindow::slotProfileRender()
+{
+    if (pCore->currentDoc()) {
+        getCurrentTimeline()->controller()->profileRender();
+    }
+}
+
 void MainWindow::slotDefinePreviewRender()
 {
     if (pCore->currentDoc()) {
@@ -4436,6 +4455,11 @@ bool MainWindow::timelineVisible() const
     return !centralWidget()->isHidden();
 }
 
+RenderServer *MainWindow::renderServer() const
+{
+    return m_renderServer;
+}
+
 void MainWindow::slotActivateAudioTrackSequence()
 {
     auto *action = qobject_cast<QAction *>(sender());
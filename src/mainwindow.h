@@ -14,6 +14,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QEvent>
 #include <QImage>
 #include <QMap>
+#include <QPointer>
 #include <QShortcut>
 #include <QString>
 #include <QUndoView>
@@ -47,6 +48,7 @@ class KIconLoader;
 class KdenliveDoc;
 class Monitor;
 class Render;
+class RenderServer;
 class RenderWidget;
 class TimelineTabs;
 class TimelineWidget;
@@ -142,6 +144,9 @@ public:
     
     /** @brief Returns true if the timeline widget is visible */
     bool timelineVisible() const;
+
+    /** @brief Returns the server of the render jobs and workers */
+    RenderServer *renderServer() const;
     
     /** @brief Raise (show) the clip or project monitor */
     void raiseMonitor(bool clipMonitor);
@@ -265,6 +270,8 @@ private:
     QShortcut *m_shortcutRemoveFocus;
 
     RenderWidget *m_renderWidget{nullptr};
+    /** @brief Guarded, the timelines can still use it while the window is deleted */
+    QPointer<RenderServer> m_renderServer;
     StatusBarMessageLabel *m_messageLabel{nullptr};
     QList<QAction *> m_transitions;
     QAction *m_buttonAudioThumbs;
@@ -434,6 +441,7 @@ private Q_SLOTS:
     void slotLiftZone();
     void slotPreviewRender();
     void slotStopPreviewRender();
+    void slotProfileRender();
     void slotDefinePreviewRender();
     void slotRemovePreviewRender();
     void slotClearPreviewRender(bool resetZones = true);
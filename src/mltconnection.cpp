@@ -9,6 +9,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
 #include "mlt_config.h"
+#include "utils/tracer.hpp"
 #include <KLocalizedString>
 #include <KUrlRequester>
 #include <KUrlRequesterDialog>
@@ -50,6 +51,7 @@ static void mlt_log_handler(void *service, int mlt_level, const char *format, va
 std::unique_ptr<MltConnection> MltConnection::m_self;
 MltConnection::MltConnection(const QString &mltPath)
 {
+    TRACE_SCOPE("MltConnection", "startup");
     // Disable VDPAU that crashes in multithread environment.
     // TODO: make configurable
     setenv("MLT_NO_VDPAU", "1", 1);
@@ -180,6 +180,10 @@ void ClipController::getProducerXML(QDomDocument &document, bool includeMeta, bo
 void ClipController::getInfoForProducer()
 {
     QReadLocker lock(&m_producerLock);
+    if (m_properties->property_exists("_lazy_service")) {
+        // Deferred clip, restore the real service so that it is correctly saved and reloaded
+        m_properties->set("mlt_service", m_properties->get("_lazy_service"));
+    }
     m_service = m_properties->get("mlt_service");
     if (m_service == QLatin1String("qtext")) {
         // Placeholder clip, find real service
@@ -635,6 +639,11 @@ bool ClipController::sourceExists() const
     return QFile::exists(m_path);
 }
 
+bool ClipController::isLazy() const
+{
+    return hasProducerProperty(QStringLiteral("_lazy_service"));
+}
+
 QString ClipController::serviceName() const
 {
     return m_service;
@@ -54,6 +54,9 @@ public:
     /** @brief Returns true if the source file exists */
     bool sourceExists() const;
 
+    /** @brief Returns true if this clip is still backed by the lightweight placeholder created on project load */
+    bool isLazy() const;
+
     /** @brief Stores the file's creation time */
     QDateTime date;
 
@@ -15,11 +15,14 @@
 #include <QApplication>
 #include <QFontDatabase>
 #include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
 #include <QOpenGLFunctions_3_2_Core>
 #include <QPainter>
 #include <QQmlContext>
 #include <QQuickItem>
 #include <QtGlobal>
+#include <cstring>
+#include <utility>
 #include <memory>
 
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
@@ -100,6 +103,7 @@ GLWidget::GLWidget(int id, QWidget *parent)
     , m_colorspaceLocation(0)
     , m_zoom(1.0f)
     , m_profileSize(1920, 1080)
+    , m_consumerSize(1920, 1080)
     , m_colorSpace(601)
     , m_dar(1.78)
     , m_sendFrame(false)
@@ -122,6 +126,11 @@ GLWidget::GLWidget(int id, QWidget *parent)
     engine()->rootContext()->setContextObject(new KLocalizedContext(this));
 
     m_texture[0] = m_texture[1] = m_texture[2] = 0;
+    m_textureFence = nullptr;
+    m_uploadedTexture[0] = m_uploadedTexture[1] = m_uploadedTexture[2] = 0;
+    m_uploadedFence = nullptr;
+    m_uploadedAcquired = false;
+    m_paintedTexture = 0;
     qRegisterMetaType<Mlt::Frame>("Mlt::Frame");
     qRegisterMetaType<SharedFrame>("SharedFrame");
     setAcceptDrops(true);
@@ -157,6 +166,12 @@ GLWidget::GLWidget(int id, QWidget *parent)
     m_blackClip->set("kdenlive:id", "black");
     m_blackClip->set("out", 3);
     connect(&m_refreshTimer, &QTimer::timeout, this, &GLWidget::refresh);
+    m_prefetchOrigin = 0;
+    m_adaptiveScaling = 1;
+    m_playbackFrames = 0;
+    m_lastDropCount = 0;
+    m_prefetchTimer.setSingleShot(true);
+    connect(&m_prefetchTimer, &QTimer::timeout, this, &GLWidget::startPrefetch);
     m_producer = m_blackClip;
     rootContext()->setContextProperty("markersModel", nullptr);
     if (!initGPUAccel()) {
@@ -481,6 +496,18 @@ bool GLWidget::acquireSharedFrameTextures()
         if (m_sharedFrame.is_valid()) {
             m_texture[0] = *(reinterpret_cast<const GLuint *>(m_sharedFrame.get_image(mlt_image_opengl_texture)));
         }
+    } else {
+        // B
+        QMutexLocker locker(&m_contextSharedAccess);
+        for (int i = 0; i < 3; ++i) {
+            m_texture[i] = m_uploadedTexture[i];
+        }
+        if (m_texture[0]) {
+            // Take the fence, so that the frame renderer cannot delete it anymore
+            m_textureFence = m_uploadedFence;
+            m_uploadedFence = nullptr;
+            m_uploadedAcquired = true;
+        }
     }
 
     if (!m_texture[0]) {
@@ -602,6 +629,16 @@ void GLWidget::paintGL()
 
     if (!acquireSharedFrameTextures()) return;
 
+    if (m_textureFence) {
+        // Let the GPU wait for the frame renderer upload without blocking this thread
+        QOpenGLExtraFunctions *ef = QOpenGLContext::currentContext()->extraFunctions();
+        ef->glWaitSync(m_textureFence, 0, GL_TIMEOUT_IGNORED);
+        // The wait is queued in this context, the fence is only released once it is done
+        ef->glDeleteSync(m_textureFence);
+        m_textureFence = nullptr;
+        check_error(f);
+    }
+
     // Bind textures.
     for (uint i = 0; i < 3; ++i) {
         if (m_texture[i] != 0u) {
@@ -683,6 +720,18 @@ void GLWidget::paintGL()
         Q_EMIT analyseFrame(m_fbo->toImage());
         m_sendFrame = false;
     }
+    if (m_glslManager == nullptr && m_frameRenderer && m_frameRenderer->asyncUpload()) {
+        // The frame renderer must not upload a new frame in these textures before the GPU is done drawing them
+        QOpenGLExtraFunctions *ef = QOpenGLContext::currentContext()->extraFunctions();
+        GLsync readFence = ef->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ef->glFlush();
+        m_frameRenderer->setTextureReadFence(m_texture[0], readFence);
+        if (m_paintedTexture != m_texture[0]) {
+            // The previous frame will not be drawn anymore
+            m_frameRenderer->releaseTextures(m_paintedTexture);
+            m_paintedTexture = m_texture[0];
+        }
+    }
     // Cleanup
     m_shader->disableAttributeArray(m_vertexLocation);
     m_shader->disableAttributeArray(m_texCoordLocation);
@@ -726,9 +775,23 @@ bool GLWidget::isReady() const
 
 void GLWidget::requestSeek(int position, bool noAudioScrub)
 {
+    stopPrefetch();
     m_producer->seek(position);
     if (!qFuzzyIsNull(m_producer->get_speed())) {
         m_consumer->purge();
+    } else if (m_frameCacheEnabled) {
+        // Wait for the seeking to settle before rendering the neighbour frames
+        m_prefetchTimer.start(250);
+        if (showCachedFrame(position)) {
+            m_heldPosition = position;
+            if (!KdenliveSettings::audio_scrub() || noAudioScrub) {
+                // The frame is already on screen, the consumer is only needed for audio scrubbing
+                return;
+            }
+        } else {
+            m_heldPosition = -1;
+            m_frameCache.expect(position);
+        }
     }
     restartConsumer();
     m_consumer->set("refresh", 1);
@@ -739,6 +802,103 @@ void GLWidget::requestSeek(int position, bool noAudioScrub)
     }
 }
 
+void GLWidget::setFrameCacheEnabled(bool enabled)
+{
+    stopPrefetch();
+    m_heldPosition = -1;
+    m_frameCache.clear();
+    // With GPU processing, frames only reference textures that are reused
+    m_frameCacheEnabled = enabled && m_glslManager == nullptr && KdenliveSettings::monitor_framecache() > 0;
+    m_frameCache.setBudget(m_frameCacheEnabled ? qint64(KdenliveSettings::monitor_framecache()) * 1024 * 1024 : 0);
+}
+
+void GLWidget::invalidateFrameCache(int in, int out)
+{
+    // This also refuses the frames that are currently being rendered
+    m_frameCache.invalidate(in, out);
+}
+
+bool GLWidget::showCachedFrame(int position)
+{
+    const SharedFrame frame = m_frameCache.frame(position);
+    if (!frame.is_valid() || m_frameRenderer == nullptr || !m_frameRenderer->semaphore()->tryAcquire()) {
+        return false;
+    }
+    QMetaObject::invokeMethod(m_frameRenderer, "showCachedFrame", Qt::QueuedConnection, Q_ARG(SharedFrame, frame));
+    return true;
+}
+
+void GLWidget::startPrefetch()
+{
+    if (m_prefetchPosition >= 0) {
+        // The requested frame never came, it was probably dropped by the consumer
+        stopPrefetch();
+        return;
+    }
+    if (!m_frameCacheEnabled || !m_consumer || !m_producer || !qFuzzyIsNull(m_producer->get_speed())) {
+        return;
+    }
+    const int origin = m_proxy->getPosition();
+    int radius = 12;
+    m_contextSharedAccess.lock();
+    const SharedFrame current = m_sharedFrame;
+    m_contextSharedAccess.unlock();
+    const qint64 frameCost = current.is_valid() ? MonitorFrameCache::frameCost(current) : 0;
+    if (frameCost > 0) {
+        // Leave half of the budget to the frames visited while scrubbing
+        radius = qMin(radius, int(m_frameCache.budget() / frameCost / 4));
+    }
+    m_prefetchQueue.clear();
+    for (int i = 1; i <= radius; ++i) {
+        for (int position : {origin + i, origin - i}) {
+            if (position >= 0 && position < m_maxProducerPosition && !m_frameCache.contains(position)) {
+                m_prefetchQueue << position;
+            }
+        }
+    }
+    if (m_prefetchQueue.isEmpty()) {
+        return;
+    }
+    m_prefetchOrigin = origin;
+    m_prefetchPosition = origin;
+    if (m_heldPosition < 0) {
+        m_heldPosition = origin;
+    }
+    m_consumer->set("scrub_audio", 0);
+    prefetchNext();
+}
+
+void GLWidget::prefetchNext()
+{
+    if (m_prefetchPosition < 0) {
+        // The prefetch was stopped
+        return;
+    }
+    if (m_prefetchQueue.isEmpty()) {
+        stopPrefetch();
+        return;
+    }
+    const int position = m_prefetchQueue.takeFirst();
+    m_prefetchPosition = position;
+    m_frameCache.expect(position);
+    m_producer->seek(position);
+    m_consumer->set("refresh", 1);
+    m_prefetchTimer.start(2000);
+}
+
+void GLWidget::stopPrefetch()
+{
+    m_prefetchTimer.stop();
+    m_prefetchQueue.clear();
+    if (m_prefetchPosition.exchange(-1) >= 0 && m_producer) {
+        // Put the producer back on the playhead
+        m_producer->seek(m_prefetchOrigin);
+        if (m_consumer) {
+            m_consumer->purge();
+        }
+    }
+}
+
 void GLWidget::requestRefresh()
 {
     if (m_producer && qFuzzyIsNull(m_producer->get_speed())) {
@@ -755,6 +915,10 @@ QString GLWidget::frameToTime(int frames) const
 void GLWidget::refresh()
 {
     m_refreshTimer.stop();
+    // A refresh means that the rendered content changed
+    stopPrefetch();
+    m_heldPosition = -1;
+    m_frameCache.clear();
     QMutexLocker locker(&m_mltMutex);
     if (m_consumer) {
         restartConsumer();
@@ -766,6 +930,9 @@ bool GLWidget::checkFrameNumber(int pos, bool isPlaying)
 {
     const double speed = m_producer->get_speed();
     m_proxy->positionFromConsumer(pos, isPlaying);
+    if (isPlaying) {
+        measurePlayback();
+    }
     if (m_isLoopMode || m_isZoneMode) {
         // not sure why we need to check against pos + 1 but otherwise the
         // playback shows one frame after the intended out frame
@@ -780,6 +947,7 @@ bool GLWidget::checkFrameNumber(int pos, bool isPlaying)
                 m_proxy->setPosition(m_loopOut);
                 m_producer->seek(m_loopOut);
                 m_loopOut = 0;
+                resetAdaptiveScaling();
                 return false;
             }
             m_producer->seek(m_isZoneMode ? m_proxy->zoneIn() : m_loopIn);
@@ -798,6 +966,7 @@ bool GLWidget::checkFrameNumber(int pos, bool isPlaying)
             m_consumer->purge();
             m_proxy->setPosition(qMax(0, m_maxProducerPosition));
             m_producer->seek(qMax(0, m_maxProducerPosition));
+            resetAdaptiveScaling();
             return false;
         } else if (pos <= 0 && speed < 0.) {
             // rewinding reached 0, pause
@@ -807,6 +976,7 @@ bool GLWidget::checkFrameNumber(int pos, bool isPlaying)
             m_consumer->purge();
             m_proxy->setPosition(0);
             m_producer->seek(0);
+            resetAdaptiveScaling();
             return false;
         }
     }
@@ -815,6 +985,9 @@ bool GLWidget::checkFrameNumber(int pos, bool isPlaying)
 
 void GLWidget::mousePressEvent(QMouseEvent *event)
 {
+    if ((event->button() & Qt::LeftButton) != 0u) {
+        Q_EMIT leftButtonPressed(true);
+    }
     if ((rootObject() != nullptr) && rootObject()->property("captureRightClick").toBool() && !(event->modifiers() & Qt::ControlModifier) &&
         !(event->buttons() & Qt::MiddleButton)) {
         event->ignore();
@@ -965,7 +1138,12 @@ void GLWidget::stopGlsl()
     // some changes have created regression (see shotcut)
     // with respect to restarting the consumer in GPU mode.
     // m_glslManager->fire_event("close glsl");
+    QMutexLocker locker(&m_contextSharedAccess);
+    if (m_frameRenderer && !m_uploadedAcquired) {
+        m_frameRenderer->releaseTextures(m_uploadedTexture[0]);
+    }
     m_texture[0] = 0;
+    m_uploadedTexture[0] = 0;
 }
 
 static void onThreadStopped(mlt_properties owner, GLWidget *self, mlt_event_data)
@@ -1073,6 +1251,8 @@ void GLWidget::stopCapture()
 int GLWidget::reconfigure()
 {
     int error = 0;
+    // Cached frames do not match the new consumer settings
+    m_frameCache.clear();
     // use SDL for audio, OpenGL for video
     QString serviceName = property("mlt_service").toString();
     if ((m_consumer == nullptr) || !m_consumer->is_valid() || strcmp(m_consumer->get("mlt_service"), "multi") == 0) {
@@ -1118,8 +1298,8 @@ int GLWidget::reconfigure()
             if (KdenliveSettings::external_display()) {
                 m_consumer->set("terminate_on_pause", 0);
             }
-            m_consumer->set("width", m_profileSize.width());
-            m_consumer->set("height", m_profileSize.height());
+            m_consumer->set("width", m_consumerSize.width());
+            m_consumer->set("height", m_consumerSize.height());
             m_colorSpace = pCore->getCurrentProfile()->colorspace();
             m_dar = pCore->getCurrentDar();
         }
@@ -1148,8 +1328,8 @@ int GLWidget::reconfigure()
         }
         m_consumer->set("real_time", dropFrames);
         m_consumer->set("channels", pCore->audioChannels());
-        if (KdenliveSettings::previewScaling() > 1) {
-            m_consumer->set("scale", 1.0 / KdenliveSettings::previewScaling());
+        if (previewScaling() > 1) {
+            m_consumer->set("scale", 1.0 / previewScaling());
         }
         // C & D
         if (m_glslManager) {
@@ -1294,6 +1474,9 @@ void GLWidget::onFrameDisplayed(const SharedFrame &frame)
 void GLWidget::mouseReleaseEvent(QMouseEvent *event)
 {
     QQuickWidget::mouseReleaseEvent(event);
+    if ((event->button() & Qt::LeftButton) != 0u) {
+        Q_EMIT leftButtonPressed(false);
+    }
     /*if (m_dragStart.isNull() && m_panStart.isNull() && (rootObject() != nullptr) && rootObject()->objectName() != QLatin1String("root") &&
         !(event->modifiers() & Qt::ControlModifier)) {
         event->accept();
@@ -1372,17 +1555,47 @@ void GLWidget::resetConsumer(bool fullReset)
     reconfigure();
 }
 
-void GLWidget::updateTexture(GLuint yName, GLuint uName, GLuint vName)
+void GLWidget::updateTexture(GLuint yName, GLuint uName, GLuint vName, GLsync fence)
 {
-    m_texture[0] = yName;
-    m_texture[1] = uName;
-    m_texture[2] = vName;
+    // Called in the frame renderer thread, with its context current
+    QMutexLocker locker(&m_contextSharedAccess);
+    if (m_uploadedFence) {
+        // The previous frame was never displayed, its fence is replaced
+        m_frameRenderer->context()->extraFunctions()->glDeleteSync(m_uploadedFence);
+    }
+    if (!m_uploadedAcquired) {
+        // Nor are its textures, they can be reused
+        m_frameRenderer->releaseTextures(m_uploadedTexture[0]);
+    }
+    m_uploadedTexture[0] = yName;
+    m_uploadedTexture[1] = uName;
+    m_uploadedTexture[2] = vName;
+    m_uploadedFence = fence;
+    m_uploadedAcquired = false;
 }
 
 void GLWidget::on_frame_show(mlt_consumer, GLWidget *widget, mlt_event_data data)
 {
     auto frame = Mlt::EventData(data).to_frame();
     if (frame.is_valid() && frame.get_int("rendered")) {
+        if (widget->m_frameCacheEnabled && qFuzzyIsNull(frame.get_double("_speed"))) {
+            const int position = frame.get_position();
+            if (widget->m_frameCache.isExpected(position)) {
+                // Only keep a copy of the image and audio, not the references to the producer frames
+                SharedFrame rendered(frame);
+                Mlt::Frame copy = rendered.clone(true, true, false);
+                SharedFrame cached(copy);
+                widget->m_frameCache.insert(position, cached, MonitorFrameCache::frameCost(cached));
+            }
+            if (position == widget->m_prefetchPosition) {
+                QMetaObject::invokeMethod(widget, "prefetchNext", Qt::QueuedConnection);
+            }
+            const int held = widget->m_heldPosition;
+            if (held >= 0 && position != held) {
+                // The displayed frame comes from the cache, this one was only rendered to fill it
+                return;
+            }
+        }
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
         if ((widget->m_frameRenderer != nullptr) && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
@@ -1455,6 +1668,8 @@ FrameRenderer::FrameRenderer(QOpenGLContext *shareContext, QSurface *surface, GL
     , m_context(nullptr)
     , m_surface(surface)
     , m_ClientWaitSync(clientWaitSync)
+    , m_asyncUpload(false)
+    , m_uploadIndex(0)
     , m_gl32(nullptr)
     , sendAudioForAnalysis(false)
 {
@@ -1468,6 +1683,11 @@ FrameRenderer::FrameRenderer(QOpenGLContext *shareContext, QSurface *surface, GL
         m_context->setShareContext(shareContext);
         m_context->create();
         m_context->moveToThread(this);
+        // Pixel buffer mapping and fences need OpenGL 3.2 or OpenGL ES 3
+        if (KdenliveSettings::monitor_asyncupload() && m_context->isValid()) {
+            const QPair<int, int> version = m_context->format().version();
+            m_asyncUpload = version >= (m_context->isOpenGLES() ? qMakePair(3, 0) : qMakePair(3, 2));
+        }
     }
     setObjectName(QStringLiteral("FrameRenderer"));
     moveToThread(this);
@@ -1481,23 +1701,35 @@ FrameRenderer::~FrameRenderer()
 }
 
 void FrameRenderer::showFrame(Mlt::Frame frame)
+{
+    displayFrame(SharedFrame(frame));
+}
+
+void FrameRenderer::showCachedFrame(const SharedFrame &frame)
+{
+    displayFrame(frame);
+}
+
+void FrameRenderer::displayFrame(const SharedFrame &frame)
 {
     // Save this frame for future use and to keep a reference to the GL Texture.
-    m_displayFrame = SharedFrame(frame);
+    m_displayFrame = frame;
 
     if ((m_context != nullptr) && m_context->isValid()) {
         m_context->makeCurrent(m_surface);
-        // Upload each plane of YUV to a texture.
-        QOpenGLFunctions *f = m_context->functions();
-        uploadTextures(m_context, m_displayFrame, m_renderTexture);
-        f->glBindTexture(GL_TEXTURE_2D, 0);
-        check_error(f);
-        f->glFinish();
+        if (!m_asyncUpload || !uploadFrameAsync()) {
+            // Upload each plane of YUV to a texture.
+            QOpenGLFunctions *f = m_context->functions();
+            uploadTextures(m_context, m_displayFrame, m_renderTexture);
+            f->glBindTexture(GL_TEXTURE_2D, 0);
+            check_error(f);
+            f->glFinish();
 
-        for (int i = 0; i < 3; ++i) {
-            std::swap(m_renderTexture[i], m_displayTexture[i]);
+            for (int i = 0; i < 3; ++i) {
+                std::swap(m_renderTexture[i], m_displayTexture[i]);
+            }
+            Q_EMIT textureReady(m_displayTexture[0], m_displayTexture[1], m_displayTexture[2]);
         }
-        Q_EMIT textureReady(m_displayTexture[0], m_displayTexture[1], m_displayTexture[2]);
         m_context->doneCurrent();
     }
     // The frame is now done being modified and can be shared with the rest
@@ -1543,8 +1775,169 @@ void FrameRenderer::showGLNoSyncFrame(Mlt::Frame frame)
     m_semaphore.release();
 }
 
+bool FrameRenderer::uploadFrameAsync()
+{
+    const int width = m_displayFrame.get_image_width();
+    const int height = m_displayFrame.get_image_height();
+    const uint8_t *image = m_displayFrame.get_image(mlt_image_yuv420p);
+    if (image == nullptr || width <= 0 || height <= 0) {
+        return false;
+    }
+    const int planeWidth[3] = {width, width / 2, width / 2};
+    const int planeHeight[3] = {height, height / 2, height / 2};
+    const quintptr planeOffset[3] = {0, quintptr(width * height), quintptr(width * height + planeWidth[1] * planeHeight[1])};
+    const GLsizeiptr size = GLsizeiptr(planeOffset[2]) + planeWidth[2] * planeHeight[2];
+
+    QOpenGLExtraFunctions *f = m_context->extraFunctions();
+    int index = -1;
+    GLsync readFence = nullptr;
+    {
+        QMutexLocker locker(&m_slotMutex);
+        // The display may still draw the frame it shows and the last one it was given
+        for (int i = 0; i < UploadSlots && index == -1; ++i) {
+            if (!m_uploadSlots[(m_uploadIndex + i) % UploadSlots].displayed) {
+                index = (m_uploadIndex + i) % UploadSlots;
+            }
+        }
+        if (index == -1) {
+            // The display is late, do not overwrite a frame it may be drawing
+            return false;
+        }
+        std::swap(readFence, m_uploadSlots[index].readFence);
+    }
+    UploadSlot &slot = m_uploadSlots[index];
+    if (readFence) {
+        // Wait until the last draw of these textures by the display is done, it was flushed by the display
+        f->glClientWaitSync(readFence, 0, GL_TIMEOUT_IGNORED);
+        f->glDeleteSync(readFence);
+    }
+    if (slot.fence) {
+        // This slot was uploaded UploadSlots frames ago, so the wait normally returns immediately
+        f->glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        f->glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+    if (slot.buffer == 0u) {
+        f->glGenBuffers(1, &slot.buffer);
+        f->glGenTextures(3, slot.texture);
+        for (GLuint texture : slot.texture) {
+            f->glBindTexture(GL_TEXTURE_2D, texture);
+            f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        check_error(f);
+    }
+    const bool resized = slot.width != width || slot.height != height;
+
+    f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    if (resized) {
+        f->glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    }
+    // Invalidating the buffer lets the driver hand out fresh memory instead of waiting for a pending transfer
+    void *data = f->glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (data == nullptr) {
+        f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        qWarning() << "Cannot map monitor pixel buffer, falling back to synchronous upload";
+        m_asyncUpload = false;
+        return false;
+    }
+    memcpy(data, image, size_t(size));
+    if (f->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+        // The buffer content was lost, upload this frame the slow way
+        f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    // The planes of pixel data may not be a multiple of the default 4 bytes.
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < 3; ++i) {
+        f->glBindTexture(GL_TEXTURE_2D, slot.texture[i]);
+        if (resized) {
+            f->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, planeWidth[i], planeHeight[i], 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, nullptr);
+        }
+        // With a bound unpack buffer, the pointer argument is an offset in that buffer
+        f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, planeWidth[i], planeHeight[i], GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                           reinterpret_cast<const void *>(planeOffset[i]));
+    }
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+    f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    check_error(f);
+    slot.width = width;
+    slot.height = height;
+
+    // The slot fence stays with this thread to reuse the slot, the display gets its own fence
+    slot.fence = f->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    GLsync displayFence = slot.fence ? f->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+    if (displayFence) {
+        // Submit the transfer, the display side waits on the fence instead of this thread
+        f->glFlush();
+    } else {
+        f->glFinish();
+    }
+    m_uploadIndex = (index + 1) % UploadSlots;
+    m_slotMutex.lock();
+    slot.displayed = true;
+    m_slotMutex.unlock();
+    Q_EMIT textureReady(slot.texture[0], slot.texture[1], slot.texture[2], displayFence);
+    return true;
+}
+
+void FrameRenderer::setTextureReadFence(GLuint yName, GLsync fence)
+{
+    // Called in the display thread, with its context current
+    QOpenGLExtraFunctions *f = QOpenGLContext::currentContext()->extraFunctions();
+    QMutexLocker locker(&m_slotMutex);
+    for (UploadSlot &slot : m_uploadSlots) {
+        if (yName != 0u && slot.texture[0] == yName) {
+            // A later draw completes after the previous one
+            std::swap(slot.readFence, fence);
+            break;
+        }
+    }
+    if (fence) {
+        f->glDeleteSync(fence);
+    }
+}
+
+void FrameRenderer::releaseTextures(GLuint yName)
+{
+    QMutexLocker locker(&m_slotMutex);
+    for (UploadSlot &slot : m_uploadSlots) {
+        if (yName != 0u && slot.texture[0] == yName) {
+            slot.displayed = false;
+            break;
+        }
+    }
+}
+
+void FrameRenderer::releaseUploadSlots()
+{
+    QOpenGLExtraFunctions *f = m_context->extraFunctions();
+    QMutexLocker locker(&m_slotMutex);
+    for (UploadSlot &slot : m_uploadSlots) {
+        if (slot.fence) {
+            f->glDeleteSync(slot.fence);
+        }
+        if (slot.readFence) {
+            f->glDeleteSync(slot.readFence);
+        }
+        if (slot.buffer != 0u) {
+            f->glDeleteBuffers(1, &slot.buffer);
+            f->glDeleteTextures(3, slot.texture);
+        }
+        slot = UploadSlot();
+    }
+}
+
 void FrameRenderer::cleanup()
 {
+    if (m_context && m_uploadSlots[0].buffer != 0u) {
+        m_context->makeCurrent(m_surface);
+        releaseUploadSlots();
+        m_context->doneCurrent();
+    }
     if ((m_renderTexture[0] != 0u) && (m_renderTexture[1] != 0u) && (m_renderTexture[2] != 0u)) {
         m_context->makeCurrent(m_surface);
         m_context->functions()->glDeleteTextures(3, m_renderTexture);
@@ -1603,6 +1996,8 @@ void GLWidget::switchPlay(bool play, int offset, double speed)
     if (!m_producer || !m_consumer) {
         return;
     }
+    stopPrefetch();
+    m_heldPosition = -1;
     if (m_isZoneMode || m_isLoopMode) {
         resetZoneMode();
     }
@@ -1634,6 +2029,7 @@ void GLWidget::switchPlay(bool play, int offset, double speed)
         m_producer->set_speed(0);
         m_consumer->set("volume", 0);
         m_proxy->setSpeed(0);
+        resetAdaptiveScaling();
         m_producer->seek(m_consumer->position() + 1);
         m_consumer->purge();
         m_consumer->start();
@@ -1647,6 +2043,8 @@ bool GLWidget::playZone(bool loop)
         pCore->displayMessage(i18n("Select a zone to play"), ErrorMessage, 500);
         return false;
     }
+    stopPrefetch();
+    m_heldPosition = -1;
     m_producer->seek(m_proxy->zoneIn());
     m_producer->set_speed(0);
     m_proxy->setSpeed(0);
@@ -1683,6 +2081,8 @@ bool GLWidget::loopClip(QPoint inOut)
         pCore->displayMessage(i18n("Select a clip to play"), ErrorMessage, 500);
         return false;
     }
+    stopPrefetch();
+    m_heldPosition = -1;
     m_loopIn = inOut.x();
     m_producer->seek(inOut.x());
     m_producer->set_speed(0);
@@ -1766,6 +2166,8 @@ void GLWidget::startConsumer()
 void GLWidget::stop()
 {
     m_refreshTimer.stop();
+    stopPrefetch();
+    m_heldPosition = -1;
     // why this lock?
     QMutexLocker locker(&m_mltMutex);
     if (m_producer) {
@@ -1781,6 +2183,7 @@ void GLWidget::stop()
             m_consumer->stop();
         }
     }
+    resetAdaptiveScaling();
 }
 
 double GLWidget::playSpeed() const
@@ -1844,9 +2247,23 @@ void GLWidget::setConsumerProperty(const QString &name, const QString &value)
 }
 
 bool GLWidget::updateScaling()
+{
+    // The shared monitor profile follows the user preview resolution only
+    const QSize profileSize = scaledProfileSize(KdenliveSettings::previewScaling());
+    bool changed = false;
+    if (profileSize != m_profileSize) {
+        m_profileSize = profileSize;
+        pCore->getMonitorProfile().set_width(m_profileSize.width());
+        pCore->getMonitorProfile().set_height(m_profileSize.height());
+        changed = true;
+    }
+    return resizeConsumer() || changed;
+}
+
+QSize GLWidget::scaledProfileSize(int scaling) const
 {
     int previewHeight = pCore->getCurrentFrameSize().height();
-    switch (KdenliveSettings::previewScaling()) {
+    switch (scaling) {
     case 2:
         previewHeight = qMin(previewHeight, 720);
         break;
@@ -1866,21 +2283,80 @@ bool GLWidget::updateScaling()
     if (pWidth % 2 > 0) {
         pWidth++;
     }
-    QSize profileSize(pWidth, previewHeight);
-    if (profileSize == m_profileSize) {
+    return QSize(pWidth, previewHeight);
+}
+
+bool GLWidget::resizeConsumer()
+{
+    const int scaling = previewScaling();
+    const QSize consumerSize = scaledProfileSize(scaling);
+    if (consumerSize == m_consumerSize) {
         return false;
     }
-    m_profileSize = profileSize;
-    pCore->getMonitorProfile().set_width(m_profileSize.width());
-    pCore->getMonitorProfile().set_height(m_profileSize.height());
+    m_consumerSize = consumerSize;
+    m_frameCache.clear();
     if (m_consumer) {
-        m_consumer->set("width", m_profileSize.width());
-        m_consumer->set("height", m_profileSize.height());
+        m_consumer->set("width", m_consumerSize.width());
+        m_consumer->set("height", m_consumerSize.height());
+        m_consumer->set("scale", 1.0 / qMax(1, scaling));
         resizeGL(width(), height());
     }
     return true;
 }
 
+int GLWidget::previewScaling() const
+{
+    return qMax(KdenliveSettings::previewScaling(), m_adaptiveScaling);
+}
+
+void GLWidget::measurePlayback()
+{
+    if (!KdenliveSettings::autopreviewscaling() || m_glslManager != nullptr || !qFuzzyCompare(m_producer->get_speed(), 1.)) {
+        m_playbackTimer.invalidate();
+        return;
+    }
+    if (!m_playbackTimer.isValid()) {
+        m_playbackTimer.start();
+        m_playbackFrames = 0;
+        m_lastDropCount = droppedFrames();
+        return;
+    }
+    m_playbackFrames++;
+    const qint64 elapsed = m_playbackTimer.elapsed();
+    if (elapsed < 1000) {
+        return;
+    }
+    // The drop count can be reset by the monitor fps overlay
+    const int dropCount = droppedFrames();
+    const int dropped = dropCount >= m_lastDropCount ? dropCount - m_lastDropCount : dropCount;
+    const double fps = pCore->getCurrentFps();
+    const double frameTime = double(elapsed) / m_playbackFrames;
+    m_playbackTimer.restart();
+    m_playbackFrames = 0;
+    m_lastDropCount = dropCount;
+    // Lagging if more than 10% of the frames were dropped or displayed late
+    if ((dropped > fps / 10. || frameTime > 1100. / fps) && previewScaling() < 16) {
+        m_adaptiveScaling = previewScaling() * 2;
+        resizeConsumer();
+        qCDebug(KDENLIVE_LOG) << "Playback is lagging," << dropped << "dropped frames," << frameTime << "ms per frame, preview scaling:" << previewScaling();
+        // Let the new resolution settle before measuring again
+        m_playbackTimer.invalidate();
+    }
+}
+
+void GLWidget::resetAdaptiveScaling()
+{
+    m_playbackTimer.invalidate();
+    if (m_adaptiveScaling <= 1) {
+        return;
+    }
+    m_adaptiveScaling = 1;
+    if (resizeConsumer() && m_consumer && qFuzzyIsNull(m_producer->get_speed())) {
+        // Show the paused frame in full resolution
+        m_consumer->set("refresh", 1);
+    }
+}
+
 void GLWidget::switchRuler(bool show)
 {
     m_rulerHeight = show ? int(QFontInfo(QFontDatabase::systemFont(QFontDatabase::SmallestReadableFont)).pixelSize() * 1.5) : 0;
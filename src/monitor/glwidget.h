@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QFont>
 #include <QMutex>
 #include <QOffscreenSurface>
@@ -19,10 +20,13 @@
 #include <QSemaphore>
 #include <QThread>
 #include <QTimer>
+#include <QVector>
+#include <atomic>
 
 #include "bin/model/markerlistmodel.hpp"
 #include "definitions.h"
 #include "kdenlivesettings.h"
+#include "monitorframecache.h"
 #include "scopes/sharedframe.h"
 
 #include <mlt++/MltProfile.h>
@@ -126,6 +130,11 @@ public:
     void switchRuler(bool show);
     /** @brief Returns true if consumer is initialized */
     bool isReady() const;
+    /** @brief Keep rendered frames around the playhead so that seeking back to them does not need a render.
+     *  Only suitable for producers whose edits are reported through invalidateFrameCache */
+    void setFrameCacheEnabled(bool enabled);
+    /** @brief Drop the cached frames between @p in and @p out, a negative @p out means until the end */
+    void invalidateFrameCache(int in, int out);
 
 protected:
     void mouseReleaseEvent(QMouseEvent *event) override;
@@ -151,7 +160,7 @@ public Q_SLOTS:
     void releaseAnalyse();
     void switchPlay(bool play, int offset = 0, double speed = 1.0);
     void reloadProfile();
-    /** @brief Update MLT's consumer scaling 
+    /** @brief Update the monitor profile and MLT's consumer scaling from the preview resolution setting
      *  @returns true is scaling was changed
      */
     bool updateScaling();
@@ -176,6 +185,8 @@ Q_SIGNALS:
     void lockMonitor(bool);
     void passKeyEvent(QKeyEvent *);
     void panView(const QPoint &diff);
+    /** @brief The left mouse button was pressed (true) or released (false) over the monitor */
+    void leftButtonPressed(bool pressed);
 
 protected:
     Mlt::Filter *m_glslManager;
@@ -195,6 +206,17 @@ private:
     QRect m_rect;
     QRect m_effectRect;
     GLuint m_texture[3];
+    /** @brief Fence of the asynchronous upload of m_texture, paintGL waits on it before sampling and deletes it */
+    GLsync m_textureFence;
+    /** @brief Textures of the last frame uploaded by the frame renderer, guarded by m_contextSharedAccess */
+    GLuint m_uploadedTexture[3];
+    /** @brief Fence of the last frame uploaded by the frame renderer, guarded by m_contextSharedAccess.
+     *  It is owned by this widget: deleted once taken and waited on by the display, or when a newer frame replaces it */
+    GLsync m_uploadedFence;
+    /** @brief True once the display took m_uploadedTexture, guarded by m_contextSharedAccess */
+    bool m_uploadedAcquired;
+    /** @brief Luma texture of the frame drawn by the last paintGL, used to give its textures back to the frame renderer */
+    GLuint m_paintedTexture;
     QOpenGLShaderProgram *m_shader;
     QPoint m_panStart;
     QPoint m_dragStart;
@@ -219,6 +241,8 @@ private:
     QTimer m_refreshTimer;
     float m_zoom;
     QSize m_profileSize;
+    /** @brief Size of the consumer frames, lower than m_profileSize while playback is lagging */
+    QSize m_consumerSize;
     int m_colorSpace;
     double m_dar;
     bool m_sendFrame;
@@ -229,6 +253,38 @@ private:
     QPoint m_offset;
     MonitorProxy *m_proxy;
     std::shared_ptr<Mlt::Producer> m_blackClip;
+    /** @brief Frames rendered while paused, displayed directly when seeking back to their position */
+    MonitorFrameCache m_frameCache;
+    std::atomic<bool> m_frameCacheEnabled{false};
+    /** @brief Position displayed from the cache. While set, paused frames rendered for other positions are only cached */
+    std::atomic<int> m_heldPosition{-1};
+    /** @brief Position being rendered to fill the cache, -1 if no prefetch is running */
+    std::atomic<int> m_prefetchPosition{-1};
+    /** @brief Playhead position when the prefetch started, restored on the producer when it ends */
+    int m_prefetchOrigin;
+    QVector<int> m_prefetchQueue;
+    /** @brief Starts the prefetch once seeking settled, then guards against a prefetch frame that never comes */
+    QTimer m_prefetchTimer;
+    /** @brief Display the cached frame for @p position, returns false if it is not cached */
+    bool showCachedFrame(int position);
+    void stopPrefetch();
+    /** @brief Extra preview scaling applied while playback cannot keep up, 1 for none */
+    int m_adaptiveScaling;
+    /** @brief Start of the current playback measurement window */
+    QElapsedTimer m_playbackTimer;
+    int m_playbackFrames;
+    int m_lastDropCount;
+    /** @brief Returns the preview scaling in use, the user setting or a lower resolution chosen during playback */
+    int previewScaling() const;
+    /** @brief Count displayed and dropped frames during playback and lower the preview resolution if needed */
+    void measurePlayback();
+    /** @brief Return to the user preview scaling, for example when playback is paused */
+    void resetAdaptiveScaling();
+    /** @brief The size of the monitor frames for the preview @p scaling */
+    QSize scaledProfileSize(int scaling) const;
+    /** @brief Resize this monitor's consumer to the preview scaling in use, without touching the shared monitor profile
+     *  @returns true if the consumer size changed */
+    bool resizeConsumer();
     static void on_frame_show(mlt_consumer, GLWidget* widget, mlt_event_data);
     static void on_frame_render(mlt_consumer, GLWidget *widget, mlt_frame frame);
     static void on_gl_frame_show(mlt_consumer, GLWidget *widget, mlt_event_data data);
@@ -243,12 +299,15 @@ private:
      */
 private Q_SLOTS:
     void resizeGL(int width, int height);
-    void updateTexture(GLuint yName, GLuint uName, GLuint vName);
+    void updateTexture(GLuint yName, GLuint uName, GLuint vName, GLsync fence);
     void paintGL();
     void onFrameDisplayed(const SharedFrame &frame);
     int reconfigure();
     void refresh();
     void switchRecordState(bool on);
+    /** @brief Queue the uncached positions around the playhead for rendering into the frame cache */
+    void startPrefetch();
+    void prefetchNext();
 
 protected:
     QMutex m_contextSharedAccess;
@@ -313,25 +372,60 @@ public:
     ~FrameRenderer() override;
     QSemaphore *semaphore() { return &m_semaphore; }
     QOpenGLContext *context() const { return m_context; }
+    /** @brief True if frames are uploaded through the pixel buffer ring */
+    bool asyncUpload() const { return m_asyncUpload; }
+    /** @brief Called by the display after drawing the textures of @p yName, the renderer takes ownership of @p fence.
+     *  These textures are only uploaded again once @p fence is signaled */
+    void setTextureReadFence(GLuint yName, GLsync fence);
+    /** @brief Called by the display when the textures of @p yName will not be drawn anymore, so that they can be reused */
+    void releaseTextures(GLuint yName);
     Q_INVOKABLE void showFrame(Mlt::Frame frame);
     Q_INVOKABLE void showGLFrame(Mlt::Frame frame);
     Q_INVOKABLE void showGLNoSyncFrame(Mlt::Frame frame);
+    Q_INVOKABLE void showCachedFrame(const SharedFrame &frame);
 
 public Q_SLOTS:
     void cleanup();
 
 Q_SIGNALS:
-    void textureReady(GLuint yName, GLuint uName = 0, GLuint vName = 0);
+    /** @brief A frame was uploaded, the receiver takes ownership of @p fence */
+    void textureReady(GLuint yName, GLuint uName = 0, GLuint vName = 0, GLsync fence = nullptr);
     void frameDisplayed(const SharedFrame &frame);
 
 private:
+    /** @brief Textures of one frame and the pixel buffer they are uploaded from */
+    struct UploadSlot
+    {
+        GLuint buffer{0};
+        GLuint texture[3]{0, 0, 0};
+        GLsync fence{nullptr};
+        /** @brief Fence of the last draw of these textures in the display context, guarded by m_slotMutex */
+        GLsync readFence{nullptr};
+        /** @brief True from the upload until the display releases these textures, guarded by m_slotMutex */
+        bool displayed{false};
+        int width{0};
+        int height{0};
+    };
+    /** @brief Number of frames that can be in flight between upload and display */
+    static constexpr int UploadSlots = 3;
+
     QSemaphore m_semaphore;
     SharedFrame m_displayFrame;
     QOpenGLContext *m_context;
     QSurface *m_surface;
     GLWidget::ClientWaitSync_fp m_ClientWaitSync;
+    /** @brief True if frames are uploaded through the pixel buffer ring instead of a blocking upload */
+    bool m_asyncUpload;
+    UploadSlot m_uploadSlots[UploadSlots];
+    int m_uploadIndex;
+    QMutex m_slotMutex;
 
     void pipelineSyncToFrame(Mlt::Frame &);
+    void displayFrame(const SharedFrame &frame);
+    /** @brief Upload m_displayFrame through the next pixel buffer of the ring without waiting for the GPU.
+     *  @return false if the frame could not be uploaded this way and the blocking upload should be used */
+    bool uploadFrameAsync();
+    void releaseUploadSlots();
 
 public:
     GLuint m_renderTexture[3];
@@ -134,6 +134,7 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
     m_glMonitor = new GLWidget(id, this);
     connect(m_glMonitor, &GLWidget::passKeyEvent, this, &Monitor::doKeyPressEvent);
     connect(m_glMonitor, &GLWidget::panView, this, &Monitor::panView);
+    connect(m_glMonitor, &GLWidget::leftButtonPressed, this, &Monitor::effectDragged);
     connect(m_glMonitor->getControllerProxy(), &MonitorProxy::requestSeek, this, &Monitor::processSeek, Qt::DirectConnection);
     connect(m_glMonitor->getControllerProxy(), &MonitorProxy::positionChanged, this, &Monitor::slotSeekPosition);
     connect(m_glMonitor->getControllerProxy(), &MonitorProxy::addTimelineEffect, this, &Monitor::addTimelineEffect);
@@ -440,6 +441,8 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
         m_audioMeterWidget->setVisibility((KdenliveSettings::monitoraudio() & m_id) != 0);
         if (id == Kdenlive::ProjectMonitor) {
             connect(m_audioMeterWidget, &MonitorAudioLevel::audioLevelsAvailable, pCore.get(), &Core::audioLevelsAvailable);
+            connect(m_audioMeterWidget, &MonitorAudioLevel::audioLoudnessAvailable, pCore.get(), &Core::audioLoudnessAvailable);
+            connect(pCore.get(), &Core::resetAudioLoudness, m_audioMeterWidget, &MonitorAudioLevel::resetLoudness);
         }
     }
 
@@ -2630,6 +2633,17 @@ void Monitor::setProducer(std::shared_ptr<Mlt::Producer> producer, int pos)
     } else {
         m_markerModel.reset();
     }
+    // Frames can only be cached for the timeline, whose edits report the modified range
+    QObject::disconnect(m_frameCacheConnection);
+    bool cacheFrames = false;
+    if (producer && pCore->window() && pCore->window()->getCurrentTimeline()) {
+        auto timeline = pCore->window()->getCurrentTimeline()->model();
+        if (timeline && timeline->tractor() && timeline->tractor()->get_producer() == producer->get_producer()) {
+            cacheFrames = true;
+            m_frameCacheConnection = connect(timeline.get(), &TimelineModel::invalidateZone, m_glMonitor, &GLWidget::invalidateFrameCache);
+        }
+    }
+    m_glMonitor->setFrameCacheEnabled(cacheFrames);
     m_glMonitor->setProducer(std::move(producer), isActive(), pos);
 }
 
@@ -230,6 +230,8 @@ private:
     int m_speedIndex;
     QMetaObject::Connection m_switchConnection;
     QMetaObject::Connection m_captureConnection;
+    /** @brief Invalidates the monitor frame cache on timeline edits */
+    QMetaObject::Connection m_frameCacheConnection;
 
     void adjustScrollBars(float horizontal, float vertical);
     void loadQmlScene(MonitorSceneType type, const QVariant &sceneData = QVariant());
@@ -368,6 +370,8 @@ Q_SIGNALS:
     void requestFrameForAnalysis(bool);
     void effectChanged(const QRect &);
     void effectPointsChanged(const QVariantList &);
+    /** @brief An edit of the effect overlay with the mouse started (true) or ended (false) */
+    void effectDragged(bool dragging);
     void addRemoveKeyframe();
     void seekToNextKeyframe();
     void seekToPreviousKeyframe();
@@ -0,0 +1,149 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "monitorframecache.h"
+
+#include <QMutexLocker>
+#include <iterator>
+
+MonitorFrameCache::MonitorFrameCache(qint64 budget)
+    : m_budget(qMax(qint64(0), budget))
+    , m_cost(0)
+{
+}
+
+void MonitorFrameCache::setBudget(qint64 budget)
+{
+    QMutexLocker lk(&m_mutex);
+    m_budget = qMax(qint64(0), budget);
+    if (m_budget == 0) {
+        m_frames.clear();
+        m_expected.clear();
+        m_cost = 0;
+    } else if (!m_frames.isEmpty()) {
+        // Keep the frames around the middle of the cached range
+        const int middle = (m_frames.firstKey() + m_frames.lastKey()) / 2;
+        evict(middle);
+    }
+}
+
+qint64 MonitorFrameCache::budget() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_budget;
+}
+
+bool MonitorFrameCache::isEnabled() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_budget > 0;
+}
+
+void MonitorFrameCache::expect(int position)
+{
+    QMutexLocker lk(&m_mutex);
+    if (m_budget == 0) {
+        return;
+    }
+    if (m_expected.size() >= MaxExpected) {
+        // Positions skipped by the consumer are never inserted, do not let them accumulate
+        m_expected.clear();
+    }
+    m_expected.insert(position);
+}
+
+bool MonitorFrameCache::isExpected(int position) const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_expected.contains(position);
+}
+
+bool MonitorFrameCache::insert(int position, const SharedFrame &frame, qint64 cost)
+{
+    QMutexLocker lk(&m_mutex);
+    if (!m_expected.remove(position) || cost > m_budget || !frame.is_valid()) {
+        return false;
+    }
+    auto it = m_frames.find(position);
+    if (it != m_frames.end()) {
+        m_cost -= it->cost;
+        it->frame = frame;
+        it->cost = cost;
+    } else {
+        m_frames.insert(position, {frame, cost});
+    }
+    m_cost += cost;
+    evict(position);
+    return m_frames.contains(position);
+}
+
+void MonitorFrameCache::evict(int position)
+{
+    while (m_cost > m_budget && !m_frames.isEmpty()) {
+        // Drop the frame that is the farthest from the position
+        auto it = (position - m_frames.firstKey() > m_frames.lastKey() - position) ? m_frames.begin() : std::prev(m_frames.end());
+        m_cost -= it->cost;
+        m_frames.erase(it);
+    }
+}
+
+SharedFrame MonitorFrameCache::frame(int position) const
+{
+    QMutexLocker lk(&m_mutex);
+    auto it = m_frames.constFind(position);
+    return it == m_frames.constEnd() ? SharedFrame() : it->frame;
+}
+
+bool MonitorFrameCache::contains(int position) const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_frames.contains(position);
+}
+
+void MonitorFrameCache::invalidate(int in, int out)
+{
+    QMutexLocker lk(&m_mutex);
+    m_expected.clear();
+    if (in > out && out >= 0) {
+        std::swap(in, out);
+    }
+    auto it = m_frames.lowerBound(in);
+    while (it != m_frames.end() && (out < 0 || it.key() <= out)) {
+        m_cost -= it->cost;
+        it = m_frames.erase(it);
+    }
+}
+
+void MonitorFrameCache::clear()
+{
+    QMutexLocker lk(&m_mutex);
+    m_frames.clear();
+    m_expected.clear();
+    m_cost = 0;
+}
+
+int MonitorFrameCache::count() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_frames.count();
+}
+
+qint64 MonitorFrameCache::cost() const
+{
+    QMutexLocker lk(&m_mutex);
+    return m_cost;
+}
+
+qint64 MonitorFrameCache::frameCost(const SharedFrame &frame)
+{
+    const int width = frame.get_image_width();
+    const int height = frame.get_image_height();
+    // The native image is kept along with the yuv420p conversion used for display
+    qint64 cost = mlt_image_format_size(frame.get_image_format(), width, height, nullptr);
+    if (frame.get_image_format() != mlt_image_yuv420p) {
+        cost += mlt_image_format_size(mlt_image_yuv420p, width, height, nullptr);
+    }
+    return cost;
+}
@@ -0,0 +1,68 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "scopes/sharedframe.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+
+/** @class MonitorFrameCache
+    @brief Bounded cache of rendered monitor frames, keyed by position.
+    When the memory budget is exceeded, the frames that are the farthest away from the last
+    inserted position are dropped first, so that the cache keeps a window around the playhead.
+    Frames are only accepted for positions that were announced with expect() since the last
+    invalidation, so that a frame rendered before a timeline edit is never stored afterwards.
+    All methods are thread safe.
+ */
+class MonitorFrameCache
+{
+public:
+    /** @param budget maximum memory used by the cached frames, in bytes. 0 disables the cache */
+    explicit MonitorFrameCache(qint64 budget = 0);
+
+    void setBudget(qint64 budget);
+    qint64 budget() const;
+    bool isEnabled() const;
+
+    /** @brief Announce that the frame for @p position is about to be rendered */
+    void expect(int position);
+    /** @brief Returns true if a frame rendered for @p position would be accepted by insert() */
+    bool isExpected(int position) const;
+    /** @brief Store the frame of an expected position, using @p cost bytes of the budget
+     *  @return true if the frame was stored */
+    bool insert(int position, const SharedFrame &frame, qint64 cost);
+    /** @brief Returns the frame cached for @p position, or an invalid frame */
+    SharedFrame frame(int position) const;
+    bool contains(int position) const;
+    /** @brief Drop the frames between @p in and @p out (included) and all pending expectations.
+     *  A negative @p out means until the end */
+    void invalidate(int in, int out);
+    void clear();
+
+    int count() const;
+    /** @brief Memory used by the cached frames, in bytes */
+    qint64 cost() const;
+    /** @brief Memory used by a frame rendered by the monitor consumer and displayed as yuv420p */
+    static qint64 frameCost(const SharedFrame &frame);
+
+private:
+    struct Entry
+    {
+        SharedFrame frame;
+        qint64 cost;
+    };
+    /** @brief Maximum number of pending expectations */
+    static constexpr int MaxExpected = 256;
+    void evict(int position);
+
+    mutable QMutex m_mutex;
+    QMap<int, Entry> m_frames;
+    QSet<int> m_expected;
+    qint64 m_budget;
+    qint64 m_cost;
+};
@@ -526,7 +526,8 @@ void MonitorProxy::addEffect(const QString &effectData, const QString &effectSou
     }
 }
 
-void MonitorProxy::setJobsProgress(const ObjectId &owner, const QStringList &jobNames, const QList<int> &jobProgress, const QStringList &jobUuids)
+void MonitorProxy::setJobsProgress(const ObjectId &owner, const QStringList &jobNames, const QList<int> &jobProgress, const QStringList &jobUuids,
+                                   const QStringList &jobDetails)
 {
     if (owner.second != m_clipId) {
         // Not interested
@@ -538,6 +539,7 @@ void MonitorProxy::setJobsProgress(const ObjectId &owner, const QStringList &job
     }
     m_jobsProgress = jobProgress;
     m_jobsUuids = jobUuids;
+    m_jobsDetails = jobDetails;
     Q_EMIT jobsProgressChanged();
 }
 
@@ -59,6 +59,7 @@ class MonitorProxy : public QObject
     Q_PROPERTY(QStringList runningJobs MEMBER m_runningJobs NOTIFY runningJobsChanged)
     Q_PROPERTY(QList<int> jobsProgress MEMBER m_jobsProgress NOTIFY jobsProgressChanged)
     Q_PROPERTY(QStringList jobsUuids MEMBER m_jobsUuids NOTIFY jobsProgressChanged)
+    Q_PROPERTY(QStringList jobsDetails MEMBER m_jobsDetails NOTIFY jobsProgressChanged)
 
 public:
     MonitorProxy(GLWidget *parent);
@@ -128,7 +129,8 @@ public:
     void resetPosition();
     /** @brief Used to display qml info about speed*/
     void setSpeed(double speed);
-    void setJobsProgress(const ObjectId &owner, const QStringList &jobNames, const QList<int> &jobProgress, const QStringList &jobUuids);
+    void setJobsProgress(const ObjectId &owner, const QStringList &jobNames, const QList<int> &jobProgress, const QStringList &jobUuids,
+                         const QStringList &jobDetails);
 
 Q_SIGNALS:
     void positionChanged(int);
@@ -192,6 +194,7 @@ private:
     QStringList m_runningJobs;
     QList<int> m_jobsProgress;
     QStringList m_jobsUuids;
+    QStringList m_jobsDetails;
 
 public Q_SLOTS:
     void updateClipBounds(const QVector <QPoint>&bounds);
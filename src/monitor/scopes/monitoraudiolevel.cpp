@@ -25,6 +25,8 @@ MonitorAudioLevel::MonitorAudioLevel(int height, QWidget *parent)
     , m_channelHeight(height / 2)
     , m_channelDistance(1)
     , m_channelFillHeight(m_channelHeight)
+    , m_lastPosition(-1)
+    , m_resetLoudness(false)
 {
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Preferred);
     isValid = true;
@@ -63,10 +65,30 @@ void MonitorAudioLevel::refreshScope(const QSize & /*size*/, bool /*full*/)
                 }
             }
             Q_EMIT audioLevelsAvailable(levels);
+
+            // Loudness is only measured during continuous playback, not on seeks
+            const int position = sFrame.get_position();
+            const int frequency = sFrame.get_audio_frequency();
+            if (frequency <= 0) {
+                continue;
+            }
+            if (m_resetLoudness.exchange(false) || channels != m_loudness.channels() || frequency != m_loudness.sampleRate()) {
+                m_loudness.setFormat(frequency, channels);
+            } else if (position == m_lastPosition + 1) {
+                m_loudness.process(audio, sFrame.get_audio_samples());
+                Q_EMIT audioLoudnessAvailable(
+                    {m_loudness.momentaryLoudness(), m_loudness.shortTermLoudness(), m_loudness.integratedLoudness(), m_loudness.truePeak()});
+            }
+            m_lastPosition = position;
         }
     }
 }
 
+void MonitorAudioLevel::resetLoudness()
+{
+    m_resetLoudness = true;
+}
+
 void MonitorAudioLevel::resizeEvent(QResizeEvent *event)
 {
     drawBackground(m_peaks.size());
@@ -7,8 +7,10 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #pragma once
 
+#include "audiomixer/loudnessmeter.hpp"
 #include "scopewidget.h"
 #include <QWidget>
+#include <atomic>
 #include <memory>
 
 class MonitorAudioLevel : public ScopeWidget
@@ -35,12 +37,20 @@ private:
     int m_channelHeight;
     int m_channelDistance;
     int m_channelFillHeight;
+    /** @brief Loudness of the played audio, only accessed from the scope refresh thread */
+    LoudnessMeter m_loudness;
+    int m_lastPosition;
+    std::atomic<bool> m_resetLoudness;
     void drawBackground(int channels = 2);
     void refreshScope(const QSize &size, bool full) override;
 
 public Q_SLOTS:
     void setAudioValues(const QVector<double> &values);
+    /** @brief Restart the loudness measurement on the next frame */
+    void resetLoudness();
 
 Q_SIGNALS:
     void audioLevelsAvailable(const QVector<double>& levels);
+    /** @brief Momentary, short-term, integrated loudness and true peak of the played audio */
+    void audioLoudnessAvailable(const QVector<double> &loudness);
 };
@@ -680,7 +680,7 @@ Item {
                             horizontalAlignment: Text.AlignLeft
                             anchors.leftMargin: 4
                             padding: 2
-                            text: modelData
+                            text: controller.jobsDetails[model.index] ? modelData + " – " + controller.jobsDetails[model.index] : modelData
                             font.pointSize: fontMetrics.font.pointSize
                             elide: Text.ElideMiddle
                             color: 'white'
@@ -34,6 +34,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "timeline2/model/builders/meltBuilder.hpp"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/tracer.hpp"
 
 #include "utils/KMessageBox_KdenliveCompat.h"
 #include <KActionCollection>
@@ -443,6 +444,8 @@ bool ProjectManager::saveFileAs(const QString &outputFileName, bool saveACopy)
         }
     }
     m_project->updateWorkFilesAfterSave();
+    // Ensure a background autosave does not touch the autosave file while we save
+    m_project->waitForAutoSave();
     if (!m_project->saveSceneList(outputFileName, scene)) {
         return false;
     }
@@ -689,6 +692,7 @@ void ProjectManager::openFile(const QUrl &url)
 
 void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale, bool isBackup)
 {
+    TRACE_SCOPE("ProjectManager::doOpenFile", "project");
     Q_ASSERT(m_project == nullptr);
     m_fileRevert->setEnabled(true);
 
@@ -917,22 +921,19 @@ void ProjectManager::slotStartAutoSave()
 
 void ProjectManager::slotAutoSave()
 {
-    prepareSave();
-    QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
-    QString scene = projectSceneList(saveFolder);
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
-        while (i.hasNext()) {
-            i.next();
-            scene.replace(i.key(), i.value());
-        }
+    if (!m_project->autoSaveNeeded()) {
+        // Nothing changed since the last autosave
+        return;
     }
-    if (!scene.contains(QLatin1String("<track "))) {
-        // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted. Don't save in that case.
-        pCore->displayMessage(i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"), ErrorMessage);
+    if (m_project->isAutoSaving()) {
+        // Previous autosave is still being written, try again later
+        m_autoSaveTimer.start(3000);
         return;
     }
-    m_project->slotAutoSave(scene);
+    prepareSave();
+    QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
+    // The MLT scene list is the only part that needs the GUI thread, the document checks and replacements are done with the write
+    m_project->slotAutoSave(projectSceneList(saveFolder), m_replacementPattern);
     m_lastSave.start();
 }
 
@@ -1193,6 +1194,7 @@ void ProjectManager::requestBackup(const QString &errorMessage)
 
 bool ProjectManager::updateTimeline(int pos, bool createNewTab, const QString &chunks, const QString &dirty, const QDateTime &documentDate, bool enablePreview)
 {
+    TRACE_SCOPE("ProjectManager::updateTimeline", "project");
     pCore->taskManager.slotCancelJobs();
     const QUuid uuid = m_project->uuid();
     std::unique_ptr<Mlt::Producer> xmlProd(new Mlt::Producer(*pCore->getProjectProfile(), "xml-string", m_project->getAndClearProjectXml().constData()));
@@ -1899,6 +1901,8 @@ void ProjectManager::slotCreateSequenceFromSelection()
         undo();
         return;
     }
+    // The copied clips are kept as XML by the redo
+    FunctionalUndoCommand::reportMemoryCost(copiedData.second.size() * qint64(sizeof(QChar)));
     pCore->pushUndo(undo, redo, i18n("Create Sequence Clip"));
 }
 
@@ -0,0 +1,233 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "renderbroker.h"
+
+#include <QSet>
+
+const int RenderBroker::MaxAttempts = 3;
+const qint64 RenderBroker::HeartbeatTimeout = 10000;
+
+int RenderBroker::addTask(const QString &queue, const QString &program, const QStringList &arguments)
+{
+    Task task;
+    task.id = m_nextTask++;
+    task.queue = queue;
+    task.program = program;
+    task.arguments = arguments;
+    m_tasks.insert(task.id, task);
+    m_pending[queue].append(task.id);
+    return task.id;
+}
+
+int RenderBroker::cancelTask(int id)
+{
+    auto it = m_tasks.find(id);
+    if (it == m_tasks.end()) {
+        return -1;
+    }
+    int worker = it->worker;
+    if (worker < 0) {
+        removePending(it->queue, id);
+    }
+    m_tasks.erase(it);
+    return worker;
+}
+
+QVector<int> RenderBroker::cancelQueue(const QString &queue)
+{
+    QVector<int> workers;
+    auto it = m_tasks.begin();
+    while (it != m_tasks.end()) {
+        if (it->queue != queue) {
+            ++it;
+            continue;
+        }
+        if (it->worker >= 0) {
+            workers << it->worker;
+        }
+        it = m_tasks.erase(it);
+    }
+    m_pending.remove(queue);
+    return workers;
+}
+
+const RenderBroker::Task *RenderBroker::task(int id) const
+{
+    auto it = m_tasks.constFind(id);
+    return it == m_tasks.constEnd() ? nullptr : &it.value();
+}
+
+QVector<int> RenderBroker::waitingTasks() const
+{
+    QVector<int> waiting;
+    for (const QList<int> &tasks : m_pending) {
+        for (int id : tasks) {
+            waiting << id;
+        }
+    }
+    return waiting;
+}
+
+int RenderBroker::taskCount(const QString &queue) const
+{
+    int count = 0;
+    for (const Task &task : m_tasks) {
+        if (task.queue == queue) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void RenderBroker::addWorker(int worker, qint64 now)
+{
+    Worker w;
+    w.heartbeat = now;
+    m_workers.insert(worker, w);
+}
+
+std::pair<int, RenderBroker::Outcome> RenderBroker::removeWorker(int worker)
+{
+    std::pair<int, Outcome> result{-1, Canceled};
+    if (currentTask(worker) >= 0) {
+        result = taskFinished(worker, false);
+    }
+    m_workers.remove(worker);
+    return result;
+}
+
+void RenderBroker::heartbeat(int worker, qint64 now)
+{
+    auto it = m_workers.find(worker);
+    if (it != m_workers.end()) {
+        it->heartbeat = now;
+    }
+}
+
+QVector<int> RenderBroker::expiredWorkers(qint64 now) const
+{
+    QVector<int> expired;
+    for (auto it = m_workers.constBegin(); it != m_workers.constEnd(); ++it) {
+        if (now - it->heartbeat > HeartbeatTimeout) {
+            expired << it.key();
+        }
+    }
+    return expired;
+}
+
+int RenderBroker::workerCount() const
+{
+    return m_workers.count();
+}
+
+int RenderBroker::currentTask(int worker) const
+{
+    auto it = m_workers.constFind(worker);
+    return it == m_workers.constEnd() ? -1 : it->task;
+}
+
+QVector<std::pair<int, int>> RenderBroker::assign()
+{
+    QVector<std::pair<int, int>> started;
+    for (auto it = m_workers.begin(); it != m_workers.end() && !m_pending.isEmpty(); ++it) {
+        if (it->task >= 0) {
+            continue;
+        }
+        int id = takeTask(it->queue);
+        if (id < 0) {
+            break;
+        }
+        Task &task = m_tasks[id];
+        task.worker = it.key();
+        task.attempts++;
+        it->task = id;
+        it->queue = task.queue;
+        started.append({it.key(), id});
+    }
+    return started;
+}
+
+std::pair<int, RenderBroker::Outcome> RenderBroker::taskFinished(int worker, bool success)
+{
+    auto w = m_workers.find(worker);
+    if (w == m_workers.end() || w->task < 0) {
+        return {-1, Canceled};
+    }
+    int id = w->task;
+    w->task = -1;
+    auto it = m_tasks.find(id);
+    if (it == m_tasks.end()) {
+        return {id, Canceled};
+    }
+    if (success) {
+        m_tasks.erase(it);
+        return {id, Succeeded};
+    }
+    if (it->attempts >= MaxAttempts) {
+        m_tasks.erase(it);
+        return {id, Failed};
+    }
+    it->worker = -1;
+    m_pending[it->queue].prepend(id);
+    return {id, Retried};
+}
+
+int RenderBroker::takeTask(const QString &home)
+{
+    if (m_pending.isEmpty()) {
+        return -1;
+    }
+    // Queues that have a worker
+    QSet<QString> served;
+    for (const Worker &worker : qAsConst(m_workers)) {
+        if (worker.task >= 0) {
+            served.insert(worker.queue);
+        }
+    }
+    QString queue;
+    bool first = true;
+    for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+        if (!served.contains(it.key())) {
+            // Don't let a queue wait for the end of another one
+            queue = it.key();
+            break;
+        }
+    }
+    if (queue.isEmpty()) {
+        if (m_pending.contains(home)) {
+            queue = home;
+        } else {
+            // Steal from the end of the longest queue, its first tasks are left to the workers already on it.
+            // A new worker has nothing to steal from and simply joins the queue
+            int count = 0;
+            for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+                if (it->count() > count) {
+                    queue = it.key();
+                    count = it->count();
+                }
+            }
+            first = home.isEmpty();
+        }
+    }
+    QList<int> &tasks = m_pending[queue];
+    int id = first ? tasks.takeFirst() : tasks.takeLast();
+    if (tasks.isEmpty()) {
+        m_pending.remove(queue);
+    }
+    return id;
+}
+
+void RenderBroker::removePending(const QString &queue, int id)
+{
+    auto it = m_pending.find(queue);
+    if (it == m_pending.end()) {
+        return;
+    }
+    it->removeAll(id);
+    if (it->isEmpty()) {
+        m_pending.erase(it);
+    }
+}
@@ -0,0 +1,106 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <utility>
+
+/** @class RenderBroker
+    @brief Distributes render tasks to a pool of worker processes.
+    Tasks are added to named queues, one per client: a timeline preview or a delivery render. A worker
+    keeps taking the first task of the queue of its previous task, so it stays on the same scene while
+    there is work. A queue with waiting tasks and no worker gets the next idle worker, and a worker whose
+    queue is empty steals the last task of the longest queue.
+    Workers send a heartbeat every second, a worker that missed them for HeartbeatTimeout is considered
+    dead. A task that failed, or was running on a dead worker, is retried at the front of its queue until
+    it was attempted MaxAttempts times.
+    This class only does the bookkeeping, RenderServer handles the processes and their communication.
+ */
+class RenderBroker
+{
+public:
+    enum Outcome {
+        Succeeded,
+        /** @brief The task failed and is waiting to be retried */
+        Retried,
+        Failed,
+        /** @brief The task was canceled while running */
+        Canceled
+    };
+
+    struct Task
+    {
+        int id = -1;
+        QString queue;
+        /** @brief "melt" or "ffmpeg", the worker uses its own path of the executable */
+        QString program;
+        QStringList arguments;
+        /** @brief Number of times the task was started */
+        int attempts = 0;
+        /** @brief The worker running the task, -1 if it is waiting */
+        int worker = -1;
+    };
+
+    static const int MaxAttempts;
+    /** @brief Delay after which a worker that did not send a heartbeat is considered dead, in milliseconds */
+    static const qint64 HeartbeatTimeout;
+
+    /** @brief Add a task at the end of @p queue, returns its id */
+    int addTask(const QString &queue, const QString &program, const QStringList &arguments);
+    /** @brief Remove a task, returns the worker running it or -1 if it was waiting */
+    int cancelTask(int id);
+    /** @brief Remove all tasks of @p queue, returns the workers running some of them */
+    QVector<int> cancelQueue(const QString &queue);
+    /** @brief Returns the task @p id, nullptr if it ended or was canceled */
+    const Task *task(int id) const;
+    /** @brief Returns the waiting tasks of all queues */
+    QVector<int> waitingTasks() const;
+    /** @brief Number of waiting and running tasks of @p queue */
+    int taskCount(const QString &queue) const;
+
+    /** @brief Register a worker ready to run tasks, @p now is the time of its first heartbeat in milliseconds */
+    void addWorker(int worker, qint64 now);
+    /** @brief Forget a worker that stopped or is dead, its task is retried or failed.
+     *  @return the task of the worker, -1 if it was idle, and what happened to it */
+    std::pair<int, Outcome> removeWorker(int worker);
+    void heartbeat(int worker, qint64 now);
+    /** @brief Returns the workers that did not send a heartbeat for HeartbeatTimeout before @p now */
+    QVector<int> expiredWorkers(qint64 now) const;
+    int workerCount() const;
+    /** @brief Returns the task running on @p worker, -1 if it is idle */
+    int currentTask(int worker) const;
+
+    /** @brief Give a waiting task to the idle workers
+     *  @return the pairs of worker and task to start */
+    QVector<std::pair<int, int>> assign();
+    /** @brief The task running on @p worker ended
+     *  @return the task, -1 if the worker was idle, and what happened to it */
+    std::pair<int, Outcome> taskFinished(int worker, bool success);
+
+private:
+    struct Worker
+    {
+        /** @brief The running task, -1 when idle. Stays set for a canceled task until the worker reports its end */
+        int task = -1;
+        /** @brief The queue of the last task of this worker */
+        QString queue;
+        qint64 heartbeat = 0;
+    };
+
+    int m_nextTask = 0;
+    QMap<int, Task> m_tasks;
+    /** @brief The waiting tasks of each queue, in order. Queues without waiting task are removed */
+    QMap<QString, QList<int>> m_pending;
+    QMap<int, Worker> m_workers;
+
+    /** @brief Take the next task for a worker whose last task was in @p home, returns -1 if nothing is waiting */
+    int takeTask(const QString &home);
+    void removePending(const QString &queue, int id);
+};
@@ -0,0 +1,103 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "renderprofilereport.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVariantMap>
+
+#include <algorithm>
+
+bool RenderProfileReport::load(const QByteArray &data)
+{
+    QJsonParseError error;
+    const QJsonObject json = QJsonDocument::fromJson(data, &error).object();
+    if (error.error != QJsonParseError::NoError || !json.contains(QLatin1String("items"))) {
+        return false;
+    }
+    m_in = json[QLatin1String("in")].toInt();
+    m_out = json[QLatin1String("out")].toInt();
+    m_msPerFrame = json[QLatin1String("msPerFrame")].toDouble();
+    m_items.clear();
+    m_samples.clear();
+    static const QStringList types = {QStringLiteral("track"), QStringLiteral("clip"), QStringLiteral("effect"), QStringLiteral("composition")};
+    const QJsonArray items = json[QLatin1String("items")].toArray();
+    for (const auto &value : items) {
+        const QJsonObject object = value.toObject();
+        const int type = types.indexOf(object[QLatin1String("type")].toString());
+        if (type < 0) {
+            continue;
+        }
+        Item item;
+        item.type = Item::Type(type);
+        item.owner = object[QLatin1String("owner")].toString();
+        item.track = object[QLatin1String("track")].toInt(-1);
+        item.playlist = object[QLatin1String("playlist")].toInt();
+        item.position = object[QLatin1String("position")].toInt();
+        item.index = object[QLatin1String("index")].toInt(-1);
+        item.id = object[QLatin1String("id")].toString();
+        item.service = object[QLatin1String("service")].toString();
+        item.in = object[QLatin1String("in")].toInt();
+        item.out = object[QLatin1String("out")].toInt();
+        item.frames = object[QLatin1String("frames")].toInt();
+        item.msPerFrame = object[QLatin1String("msPerFrame")].toDouble();
+        m_items << item;
+    }
+    const QJsonArray samples = json[QLatin1String("samples")].toArray();
+    for (const auto &value : samples) {
+        const QJsonObject object = value.toObject();
+        m_samples << qMakePair(object[QLatin1String("position")].toInt(), object[QLatin1String("ms")].toDouble());
+    }
+    std::sort(m_samples.begin(), m_samples.end());
+    return true;
+}
+
+int RenderProfileReport::in() const
+{
+    return m_in;
+}
+
+int RenderProfileReport::out() const
+{
+    return m_out;
+}
+
+double RenderProfileReport::msPerFrame() const
+{
+    return m_msPerFrame;
+}
+
+const QVector<RenderProfileReport::Item> &RenderProfileReport::items() const
+{
+    return m_items;
+}
+
+QVariantList RenderProfileReport::heatmap() const
+{
+    QVariantList ranges;
+    double slowest = 0.;
+    for (const auto &sample : m_samples) {
+        slowest = qMax(slowest, sample.second);
+    }
+    if (slowest <= 0.) {
+        return ranges;
+    }
+    // Each measured frame stands for the frames closer to it than to the other measured frames
+    for (int i = 0; i < m_samples.count(); i++) {
+        const int start = i == 0 ? m_in : (m_samples.at(i - 1).first + m_samples.at(i).first + 1) / 2;
+        const int end = i == m_samples.count() - 1 ? m_out + 1 : (m_samples.at(i).first + m_samples.at(i + 1).first + 1) / 2;
+        if (end <= start) {
+            continue;
+        }
+        QVariantMap range;
+        range.insert(QStringLiteral("x"), start);
+        range.insert(QStringLiteral("width"), end - start);
+        range.insert(QStringLiteral("level"), m_samples.at(i).second / slowest);
+        ranges << range;
+    }
+    return ranges;
+}
@@ -0,0 +1,65 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QPair>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+
+/** @class RenderProfileReport
+    @brief The render time of the items of a timeline, measured by "kdenlive_render profile".
+    Items are identified by their MLT track index and start position, effects by their index in the
+    effect stack of their clip, track or of the master. Render times are given per rendered frame.
+ */
+class RenderProfileReport
+{
+public:
+    struct Item
+    {
+        enum Type { Track, Clip, Effect, Composition };
+        Type type = Track;
+        /** @brief "clip", "track" or "master" for an effect */
+        QString owner;
+        /** @brief The MLT index of the track, the B track of a composition */
+        int track = -1;
+        /** @brief The playlist of the track containing a clip */
+        int playlist = 0;
+        /** @brief The start of a clip or composition */
+        int position = 0;
+        /** @brief The index of an effect in its stack */
+        int index = -1;
+        /** @brief The asset id of an effect or composition */
+        QString id;
+        /** @brief The MLT service of a clip */
+        QString service;
+        /** @brief The measured range */
+        int in = 0;
+        int out = 0;
+        /** @brief Number of frames measured in the range */
+        int frames = 0;
+        double msPerFrame = 0.;
+    };
+
+    /** @brief Read the JSON report, returns false if it is not valid */
+    bool load(const QByteArray &data);
+    int in() const;
+    int out() const;
+    /** @brief The mean render time of the measured frames */
+    double msPerFrame() const;
+    const QVector<Item> &items() const;
+    /** @brief The render time along the timeline, as a list of maps with the first frame "x", the "width" in frames
+     *  and the "level" of the render time, from 0 to 1 for the slowest frames */
+    QVariantList heatmap() const;
+
+private:
+    int m_in = 0;
+    int m_out = -1;
+    double m_msPerFrame = 0.;
+    QVector<Item> m_items;
+    /** @brief The position and render time of the measured frames, in timeline order */
+    QVector<QPair<int, double>> m_samples;
+};
@@ -5,13 +5,25 @@
 
 #include "renderserver.h"
 #include "core.h"
+#include "kdenlivesettings.h"
 #include "mainwindow.h"
 #include <KLocalizedString>
 #include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
 #include <QJsonDocument>
+#include <QStandardPaths>
+#include <QThread>
+
+namespace {
+/** @brief Number of workers exiting before being ready after which the pool is considered broken */
+const int MaxStartFailures = 3;
+} // namespace
 
 RenderServer::RenderServer(QObject *parent)
     : QObject(parent)
+    , m_nextWorker(0)
+    , m_startFailures(0)
 {
     qWarning() << "Starting render server";
     m_server.setSocketOptions(QLocalServer::UserAccessOption);
@@ -22,12 +34,43 @@ RenderServer::RenderServer(QObject *parent)
         pCore->displayMessage(i18n("Can't open communication with render job %1", servername), ErrorMessage);
         qWarning() << "Render server failed to listen on " << servername;
     }
+#ifdef NODBUS
     connect(pCore->window(), &MainWindow::abortRenderJob, this, &RenderServer::abortJob);
     connect(this, &RenderServer::setRenderingProgress, pCore->window(), &MainWindow::setRenderingProgress);
     connect(this, &RenderServer::setRenderingFinished, pCore->window(), &MainWindow::setRenderingFinished);
+#endif
+    // Find path for Kdenlive renderer
+#ifdef Q_OS_WIN
+    m_renderer = QCoreApplication::applicationDirPath() + QStringLiteral("/kdenlive_render.exe");
+#else
+    m_renderer = QCoreApplication::applicationDirPath() + QStringLiteral("/kdenlive_render");
+#endif
+    if (!QFile::exists(m_renderer)) {
+        m_renderer = QStandardPaths::findExecutable(QStringLiteral("kdenlive_render"));
+    }
+    m_clock.start();
+    m_heartbeatTimer.setInterval(1000);
+    connect(&m_heartbeatTimer, &QTimer::timeout, this, &RenderServer::checkWorkers);
+}
+
+RenderServer::~RenderServer()
+{
+    for (const Worker &worker : qAsConst(m_workers)) {
+        worker.process->disconnect(this);
+        worker.process->kill();
+        worker.process->waitForFinished();
+    }
+}
+
+int RenderServer::workerCount()
+{
+    return KdenliveSettings::renderworkers();
 }
 
-RenderServer::~RenderServer() {}
+QString RenderServer::serverName() const
+{
+    return m_server.serverName();
+}
 
 void RenderServer::jobConnected()
 {
@@ -38,12 +81,10 @@ void RenderServer::jobConnected()
 void RenderServer::jobSent()
 {
     QLocalSocket *socket = reinterpret_cast<QLocalSocket *>(sender());
-    QTextStream text(socket);
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-    text.setCodec("UTF-8");
-#endif
-    QString block, line;
-    while (text.readLineInto(&line)) {
+    // A message can arrive in several parts, keep the incomplete object for the next read
+    QString block = socket->property("pendingBlock").toString();
+    while (socket->canReadLine()) {
+        const QString line = QString::fromUtf8(socket->readLine()).chopped(1);
         block.append(line);
         if (line == QLatin1String("}")) { // end of json object
             QJsonParseError error;
@@ -56,6 +97,7 @@ void RenderServer::jobSent()
             block.clear();
         }
     }
+    socket->setProperty("pendingBlock", block);
 }
 
 void RenderServer::handleJson(const QJsonObject &json, QLocalSocket *socket)
@@ -76,6 +118,88 @@ void RenderServer::handleJson(const QJsonObject &json, QLocalSocket *socket)
         Q_EMIT setRenderingFinished(url, status, error);
         m_jobSocket.remove(url);
     }
+    // Messages of the workers
+    if (json.contains("workerReady")) {
+        const int id = json["workerReady"]["worker"].toInt(-1);
+        if (!m_workers.contains(id) || m_workers.value(id).socket) {
+            qWarning() << "Unknown render worker" << id;
+            return;
+        }
+        m_workers[id].socket = socket;
+        connect(socket, &QLocalSocket::disconnected, this, [this, id]() { removeWorker(id); });
+        m_startFailures = 0;
+        m_broker.addWorker(id, m_clock.elapsed());
+        dispatch();
+        return;
+    }
+    const QStringList workerMessages = {QStringLiteral("heartbeat"), QStringLiteral("taskFinished")};
+    for (const QString &message : workerMessages) {
+        if (!json.contains(message)) {
+            continue;
+        }
+        const QJsonObject args = json[message].toObject();
+        const int id = args["worker"].toInt(-1);
+        if (!m_workers.contains(id) || m_workers.value(id).socket != socket) {
+            qWarning() << "Unknown render worker" << id;
+            return;
+        }
+        m_broker.heartbeat(id, m_clock.elapsed());
+        const RenderBroker::Task *task = m_broker.task(m_broker.currentTask(id));
+        const QString queue = task ? task->queue : QString();
+        if (message == QLatin1String("heartbeat")) {
+            const int progress = args["progress"].toInt(-1);
+            if (task && progress >= 0) {
+                QJsonObject progressArgs;
+                progressArgs["progress"] = progress;
+                notifyTask(task->id, queue, QStringLiteral("taskProgress"), progressArgs);
+            }
+        } else {
+            const auto result = m_broker.taskFinished(id, args["status"].toInt() == 0);
+            taskEnded(result.first, result.second, queue, args["error"].toString());
+            dispatch();
+        }
+        return;
+    }
+    // Tasks submitted by the render jobs
+    if (json.contains("submitTask")) {
+        const QJsonObject args = json["submitTask"].toObject();
+        const QString queue = QStringLiteral("job:") + args["queue"].toString();
+        if (!m_remoteQueues.contains(socket)) {
+            m_remoteQueues.insert(socket, queue);
+            // Abort the tasks of a job that stopped
+            connect(socket, &QLocalSocket::disconnected, this, [this, socket]() { cancelQueue(m_remoteQueues.take(socket)); });
+        }
+        QStringList arguments;
+        const QJsonArray array = args["arguments"].toArray();
+        for (const auto &argument : array) {
+            arguments << argument.toString();
+        }
+        if (!acceptsTasks()) {
+            QJsonObject reply;
+            reply["id"] = args["id"];
+            reply["status"] = 1;
+            reply["error"] = i18n("Cannot start the render workers.");
+            send(socket, QStringLiteral("taskFinished"), reply);
+            return;
+        }
+        const int task = m_broker.addTask(queue, args["program"].toString(), arguments);
+        m_remoteTasks.insert(task, {socket, args["id"].toInt()});
+        dispatch();
+        return;
+    }
+    if (json.contains("cancelTask")) {
+        const int remoteId = json["cancelTask"]["id"].toInt(-1);
+        for (auto it = m_remoteTasks.begin(); it != m_remoteTasks.end(); ++it) {
+            if (it->socket == socket && it->id == remoteId) {
+                const int worker = m_broker.cancelTask(it.key());
+                if (worker >= 0 && m_workers.contains(worker)) {
+                    send(m_workers.value(worker).socket, QStringLiteral("abortTask"), QJsonObject());
+                }
+                m_remoteTasks.erase(it);
+                break;
+            }
+        }
+    }
 }
 
 void RenderServer::abortJob(const QString &job)
@@ -87,3 +211,203 @@ void RenderServer::abortJob(const QString &job)
         pCore->displayMessage(i18n("Can't open communication with render job %1", job), ErrorMessage);
     }
 }
+
+bool RenderServer::acceptsTasks() const
+{
+    return workerCount() > 0 && !m_renderer.isEmpty() && m_server.isListening() && m_startFailures < MaxStartFailures;
+}
+
+int RenderServer::submitTask(const QString &queue, const QString &program, const QStringList &arguments)
+{
+    if (!acceptsTasks()) {
+        return -1;
+    }
+    const int task = m_broker.addTask(queue, program, arguments);
+    // Let the caller store the task id before it is reported as started
+    QMetaObject::invokeMethod(this, [this]() { dispatch(); }, Qt::QueuedConnection);
+    return task;
+}
+
+void RenderServer::cancelQueue(const QString &queue)
+{
+    const QVector<int> workers = m_broker.cancelQueue(queue);
+    for (int worker : workers) {
+        if (m_workers.contains(worker)) {
+            send(m_workers.value(worker).socket, QStringLiteral("abortTask"), QJsonObject());
+        }
+    }
+    auto it = m_remoteTasks.begin();
+    while (it != m_remoteTasks.end()) {
+        if (m_broker.task(it.key()) == nullptr) {
+            it = m_remoteTasks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int RenderServer::taskCount(const QString &queue) const
+{
+    return m_broker.taskCount(queue);
+}
+
+void RenderServer::startWorkers()
+{
+    const int count = workerCount();
+    if (m_broker.waitingTasks().isEmpty() || m_workers.count() >= count || m_startFailures >= MaxStartFailures) {
+        return;
+    }
+    // Give each worker its own cores, so that the workers don't compete for the same caches
+    const int cores = QThread::idealThreadCount();
+    const int coresPerWorker = cores / count;
+    QVector<bool> usedSlots(count, false);
+    for (const Worker &worker : qAsConst(m_workers)) {
+        if (worker.slot < count) {
+            usedSlots[worker.slot] = true;
+        }
+    }
+    for (int slot = 0; slot < count; ++slot) {
+        if (usedSlots.at(slot)) {
+            continue;
+        }
+        const int id = m_nextWorker++;
+        QStringList args = {QStringLiteral("worker"), m_server.serverName(), KdenliveSettings::rendererpath(), QStringLiteral("--id"), QString::number(id)};
+        if (!KdenliveSettings::ffmpegpath().isEmpty()) {
+            args << QStringLiteral("--ffmpeg") << KdenliveSettings::ffmpegpath();
+        }
+        if (KdenliveSettings::renderworkerpinning() && coresPerWorker > 0) {
+            args << QStringLiteral("--cpus") << QStringLiteral("%1-%2").arg(slot * coresPerWorker).arg((slot + 1) * coresPerWorker - 1);
+        }
+        Worker worker;
+        worker.process = new QProcess(this);
+        worker.slot = slot;
+        worker.process->setProcessChannelMode(QProcess::ForwardedChannels);
+        connect(worker.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [this, id]() {
+            if (m_workers.contains(id) && !m_workers.value(id).socket) {
+                // The worker stopped before being ready
+                m_startFailures++;
+            }
+            removeWorker(id);
+        });
+        connect(worker.process, &QProcess::errorOccurred, this, [this, id](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                m_startFailures++;
+                // Don't restart a worker from within startWorkers()
+                QTimer::singleShot(0, this, [this, id]() { removeWorker(id); });
+            }
+        });
+        m_workers.insert(id, worker);
+        worker.process->start(m_renderer, args);
+    }
+    m_heartbeatTimer.start();
+}
+
+void RenderServer::removeWorker(int worker)
+{
+    if (!m_workers.contains(worker)) {
+        return;
+    }
+    const Worker w = m_workers.take(worker);
+    w.process->disconnect(this);
+    if (w.process->state() != QProcess::NotRunning) {
+        w.process->kill();
+        w.process->waitForFinished();
+    }
+    w.process->deleteLater();
+    if (w.socket) {
+        w.socket->disconnect(this);
+        w.socket->abort();
+        w.socket->deleteLater();
+    }
+    const RenderBroker::Task *task = m_broker.task(m_broker.currentTask(worker));
+    const QString queue = task ? task->queue : QString();
+    const auto result = m_broker.removeWorker(worker);
+    taskEnded(result.first, result.second, queue, i18n("The render worker stopped."));
+    if (m_startFailures >= MaxStartFailures) {
+        // Don't restart workers forever, fail the waiting tasks
+        qWarning() << "Cannot start render workers" << m_renderer;
+        const QVector<int> waiting = m_broker.waitingTasks();
+        for (int id : waiting) {
+            const QString taskQueue = m_broker.task(id)->queue;
+            m_broker.cancelTask(id);
+            taskEnded(id, RenderBroker::Failed, taskQueue, i18n("Cannot start the render workers."));
+        }
+    }
+    if (m_workers.isEmpty()) {
+        m_heartbeatTimer.stop();
+    }
+    dispatch();
+}
+
+void RenderServer::checkWorkers()
+{
+    const QVector<int> expired = m_broker.expiredWorkers(m_clock.elapsed());
+    for (int worker : expired) {
+        qWarning() << "Render worker" << worker << "stopped responding";
+        removeWorker(worker);
+    }
+}
+
+void RenderServer::dispatch()
+{
+    startWorkers();
+    const auto started = m_broker.assign();
+    for (const auto &pair : started) {
+        const RenderBroker::Task *task = m_broker.task(pair.second);
+        QJsonObject args;
+        args["program"] = task->program;
+        args["arguments"] = QJsonArray::fromStringList(task->arguments);
+        send(m_workers.value(pair.first).socket, QStringLiteral("runTask"), args);
+        notifyTask(task->id, task->queue, QStringLiteral("taskStarted"), QJsonObject());
+    }
+}
+
+void RenderServer::taskEnded(int task, RenderBroker::Outcome outcome, const QString &queue, const QString &error)
+{
+    if (task < 0) {
+        return;
+    }
+    switch (outcome) {
+    case RenderBroker::Retried:
+        qWarning() << "Render task" << task << "of" << queue << "failed, retrying:" << error;
+        return;
+    case RenderBroker::Canceled:
+        m_remoteTasks.remove(task);
+        return;
+    default:
+        break;
+    }
+    QJsonObject args;
+    args["status"] = outcome == RenderBroker::Succeeded ? 0 : 1;
+    args["error"] = error;
+    notifyTask(task, queue, QStringLiteral("taskFinished"), args);
+    m_remoteTasks.remove(task);
+}
+
+void RenderServer::notifyTask(int task, const QString &queue, const QString &message, QJsonObject args)
+{
+    if (m_remoteTasks.contains(task)) {
+        const RemoteTask &remote = m_remoteTasks[task];
+        args["id"] = remote.id;
+        send(remote.socket, message, args);
+        return;
+    }
+    if (message == QLatin1String("taskStarted")) {
+        Q_EMIT taskStarted(queue, task);
+    } else if (message == QLatin1String("taskProgress")) {
+        Q_EMIT taskProgress(queue, task, args["progress"].toInt());
+    } else if (message == QLatin1String("taskFinished")) {
+        Q_EMIT taskFinished(queue, task, args["status"].toInt() == 0, args["error"].toString());
+    }
+}
+
+void RenderServer::send(QLocalSocket *socket, const QString &method, const QJsonObject &args)
+{
+    if (socket == nullptr || socket->state() != QLocalSocket::ConnectedState) {
+        return;
+    }
+    QJsonObject message;
+    message[method] = args;
+    socket->write(QJsonDocument(message).toJson());
+    socket->flush();
+}
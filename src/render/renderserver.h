@@ -5,22 +5,52 @@
 
 #pragma once
 
+#include "renderbroker.h"
+
+#include <QElapsedTimer>
 #include <QJsonObject>
 #include <QLocalServer>
 #include <QLocalSocket>
 #include <QPointer>
 #include <QProcess>
+#include <QTimer>
 
+/** @class RenderServer
+    @brief Local socket server of the kdenlive_render processes.
+    Delivery render jobs report their progress through it in builds without DBus. It is also the broker of
+    a pool of kdenlive_render worker processes: timeline previews and segmented delivery renders submit
+    their melt and ffmpeg commands as tasks, and a RenderBroker distributes them to the workers.
+    Workers are started on the first task, restarted when they crash or stop sending heartbeats, and
+    stopped when the server is deleted. Each message is a JSON object.
+ */
 class RenderServer : public QObject
 {
     Q_OBJECT
 public:
     RenderServer(QObject *parent);
     ~RenderServer() override;
+    /** @brief The number of workers set in the settings, 0 if the tasks should not be run by workers */
+    static int workerCount();
+    /** @brief The name of the local socket the workers and render jobs connect to */
+    QString serverName() const;
+    /** @brief Queue a task to run on the workers
+     *  @param queue the name of the tasks of a client, tasks are started in queue order
+     *  @param program "melt" or "ffmpeg"
+     *  @return the id of the task, -1 if it cannot run */
+    int submitTask(const QString &queue, const QString &program, const QStringList &arguments);
+    /** @brief Remove the waiting tasks of @p queue and abort the running ones */
+    void cancelQueue(const QString &queue);
+    /** @brief Returns the number of tasks of @p queue that are waiting or running */
+    int taskCount(const QString &queue) const;
 
 Q_SIGNALS:
     void setRenderingProgress(const QString &url, int progress, int frame);
     void setRenderingFinished(const QString &url, int status, const QString &error);
+    void taskStarted(const QString &queue, int task);
+    /** @brief Progress of a running task, in percent */
+    void taskProgress(const QString &queue, int task, int progress);
+    /** @brief A task ended, it failed if it could not succeed after several attempts */
+    void taskFinished(const QString &queue, int task, bool success, const QString &error);
 
 public Q_SLOTS:
     void abortJob(const QString &job);
@@ -29,8 +59,48 @@ private Q_SLOTS:
     void jobConnected();
     void handleJson(const QJsonObject &json, QLocalSocket *socket);
     void jobSent();
+    void checkWorkers();
 
 private:
+    struct Worker
+    {
+        QProcess *process = nullptr;
+        /** @brief The connection of the worker, null until it is ready */
+        QPointer<QLocalSocket> socket;
+        /** @brief Position of the worker in the pool, used to choose its cores */
+        int slot = 0;
+    };
+    /** @brief A task submitted by a render job through the socket */
+    struct RemoteTask
+    {
+        QPointer<QLocalSocket> socket;
+        int id;
+    };
+
     QLocalServer m_server;
     QHash<QString, QLocalSocket*> m_jobSocket;
+    RenderBroker m_broker;
+    QMap<int, Worker> m_workers;
+    int m_nextWorker;
+    /** @brief Number of workers that stopped before being ready since the last ready one */
+    int m_startFailures;
+    /** @brief The tasks submitted by render jobs, by broker task id */
+    QHash<int, RemoteTask> m_remoteTasks;
+    /** @brief The queue of each render job socket submitting tasks */
+    QHash<QLocalSocket *, QString> m_remoteQueues;
+    QTimer m_heartbeatTimer;
+    QElapsedTimer m_clock;
+    QString m_renderer;
+
+    /** @brief Returns false if the workers are disabled or cannot be started */
+    bool acceptsTasks() const;
+    /** @brief Start workers up to the size of the pool */
+    void startWorkers();
+    /** @brief Kill a worker that crashed or stopped responding, its task is retried */
+    void removeWorker(int worker);
+    /** @brief Start the waiting tasks on the idle workers */
+    void dispatch();
+    void taskEnded(int task, RenderBroker::Outcome outcome, const QString &queue, const QString &error);
+    void notifyTask(int task, const QString &queue, const QString &message, QJsonObject args);
+    void send(QLocalSocket *socket, const QString &method, const QJsonObject &args);
 };
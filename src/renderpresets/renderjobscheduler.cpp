@@ -0,0 +1,130 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "renderjobscheduler.hpp"
+
+#include <QFile>
+#include <algorithm>
+
+namespace {
+/** @brief Memory used by a render process independently of the frame size, in MB */
+const int BaseMemory = 150;
+} // namespace
+
+RenderJobScheduler::RenderJobScheduler(int cpuBudget, int memoryBudget)
+    : m_cpuBudget(qMax(1, cpuBudget))
+    , m_memoryBudget(qMax(1, memoryBudget))
+{
+}
+
+QVector<int> RenderJobScheduler::jobsToStart(const QVector<Job> &running, const QVector<Job> &waiting) const
+{
+    int usedThreads = 0;
+    int usedMemory = 0;
+    QStringList busy;
+    for (const Job &job : running) {
+        usedThreads += job.threads;
+        usedMemory += job.memory;
+        busy << job.destination << job.playlist;
+    }
+    QVector<int> candidates;
+    for (int i = 0; i < waiting.count(); ++i) {
+        const Job &job = waiting.at(i);
+        // A second pass waits for its first pass, and only one job at a time writes a file
+        const QString first = firstPass(job.playlist);
+        if (busy.contains(job.destination) || (!first.isEmpty() && busy.contains(first))) {
+            busy << job.destination << job.playlist;
+            continue;
+        }
+        busy << job.destination << job.playlist;
+        candidates << i;
+    }
+    if (candidates.isEmpty()) {
+        return {};
+    }
+    const auto fits = [this, &usedThreads, &usedMemory](const Job &job) {
+        return usedThreads + job.threads <= m_cpuBudget && usedMemory + job.memory <= m_memoryBudget;
+    };
+    // The oldest waiting job keeps its place: if it does not fit, no other job starts until enough
+    // running jobs are finished, otherwise shorter jobs could keep it waiting forever
+    const int head = candidates.takeFirst();
+    if (!running.isEmpty() && !fits(waiting.at(head))) {
+        return {};
+    }
+    usedThreads += waiting.at(head).threads;
+    usedMemory += waiting.at(head).memory;
+    QVector<int> toStart = {head};
+    std::stable_sort(candidates.begin(), candidates.end(), [&waiting](int a, int b) { return waiting.at(a).work < waiting.at(b).work; });
+    for (int index : qAsConst(candidates)) {
+        const Job &job = waiting.at(index);
+        if (!fits(job)) {
+            continue;
+        }
+        usedThreads += job.threads;
+        usedMemory += job.memory;
+        toStart << index;
+    }
+    std::stable_sort(toStart.begin(), toStart.end(), [&waiting](int a, int b) { return waiting.at(a).work < waiting.at(b).work; });
+    return toStart;
+}
+
+RenderJobScheduler::Job RenderJobScheduler::estimate(const QDomDocument &doc)
+{
+    Job job;
+    const QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    const QDomElement profile = doc.documentElement().firstChildElement(QStringLiteral("profile"));
+    job.destination = consumer.attribute(QStringLiteral("target"));
+    int width = consumer.attribute(QStringLiteral("width"), profile.attribute(QStringLiteral("width"))).toInt();
+    int height = consumer.attribute(QStringLiteral("height"), profile.attribute(QStringLiteral("height"))).toInt();
+    const double scale = consumer.attribute(QStringLiteral("scale")).toDouble();
+    if (scale > 0.) {
+        width = int(width * scale);
+        height = int(height * scale);
+    }
+    const int in = qMax(0, consumer.attribute(QStringLiteral("in"), QStringLiteral("0")).toInt());
+    const int out = consumer.attribute(QStringLiteral("out"), QStringLiteral("-1")).toInt();
+    const int frames = qMax(1, out - in + 1);
+
+    job.threads = qMax(1, qAbs(consumer.attribute(QStringLiteral("real_time"), QStringLiteral("-1")).toInt()));
+    // With automatic encoder threads (0), the encoder adapts to the available cores
+    job.threads = qMax(job.threads, consumer.attribute(QStringLiteral("threads")).toInt());
+    if (consumer.attribute(QStringLiteral("vn")).toInt() == 1 || consumer.attribute(QStringLiteral("video_off")).toInt() == 1) {
+        // Audio only render
+        job.threads = 1;
+        job.memory = BaseMemory;
+        job.work = frames;
+        return job;
+    }
+    // The consumer buffers frames ahead, and every frame thread holds a source and a rendered image
+    const int buffer = consumer.attribute(QStringLiteral("buffer"), QStringLiteral("25")).toInt();
+    const qint64 frameSize = qint64(width) * height * 4;
+    job.memory = BaseMemory + int(frameSize * (buffer + 2 * job.threads) / (1024 * 1024));
+    job.work = qint64(width) * height * frames / 1000;
+    return job;
+}
+
+RenderJobScheduler::Job RenderJobScheduler::estimate(const QString &playlist, const QString &destination)
+{
+    QDomDocument doc;
+    QFile file(playlist);
+    if (file.open(QIODevice::ReadOnly)) {
+        doc.setContent(&file, false);
+        file.close();
+    }
+    Job job = estimate(doc);
+    job.playlist = playlist;
+    job.destination = destination;
+    return job;
+}
+
+QString RenderJobScheduler::firstPass(const QString &playlist)
+{
+    static const QString secondPass = QStringLiteral("-pass2");
+    const QString name = playlist.section(QLatin1Char('.'), 0, -2);
+    if (!name.endsWith(secondPass)) {
+        return QString();
+    }
+    return name.chopped(secondPass.size()) + QLatin1Char('.') + playlist.section(QLatin1Char('.'), -1);
+}
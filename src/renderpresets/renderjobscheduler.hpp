@@ -0,0 +1,54 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDomDocument>
+#include <QString>
+#include <QVector>
+
+/** @class RenderJobScheduler
+    @brief Decides which waiting render jobs can run at the same time.
+    Each job has a cost estimated from its scene list: the threads it uses, its memory and the amount
+    of pixels to render. The oldest waiting job is started as soon as it fits in the CPU and memory
+    budgets, and no other job starts while it does not fit, so that it cannot be starved. The
+    remaining budget is filled shortest job first, which minimizes the average time until a job of
+    the queue is finished. A job that is larger than the budgets is only started when no other job is running.
+    Jobs writing the same file, like the passes of a 2 pass encoding, always run in queue order.
+ */
+class RenderJobScheduler
+{
+public:
+    struct Job
+    {
+        QString playlist;
+        QString destination;
+        /** @brief Threads used by the render process */
+        int threads = 1;
+        /** @brief Estimated memory used by the render process, in MB */
+        int memory = 0;
+        /** @brief Estimated amount of pixels to render, in kilopixels */
+        qint64 work = 0;
+    };
+
+    /** @param cpuBudget number of threads the running jobs can use
+     *  @param memoryBudget memory the running jobs can use, in MB */
+    RenderJobScheduler(int cpuBudget, int memoryBudget);
+
+    /** @brief Returns the indexes in @p waiting of the jobs to start, in start order.
+     *  @param waiting the waiting jobs, in queue order */
+    QVector<int> jobsToStart(const QVector<Job> &running, const QVector<Job> &waiting) const;
+
+    /** @brief Estimate the cost of the render described by @p doc */
+    static Job estimate(const QDomDocument &doc);
+    /** @brief Estimate the cost of rendering the scene list @p playlist to @p destination */
+    static Job estimate(const QString &playlist, const QString &destination);
+    /** @brief Returns the scene list of the first pass of @p playlist if it is a second pass, or an empty string */
+    static QString firstPass(const QString &playlist);
+
+private:
+    int m_cpuBudget;
+    int m_memoryBudget;
+};
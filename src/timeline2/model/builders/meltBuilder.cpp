@@ -13,6 +13,7 @@
 #include "bin/projectitemmodel.h"
 #include "core.h"
 #include "kdenlivesettings.h"
+#include "utils/tracer.hpp"
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -314,6 +315,7 @@ bool constructTimelineFromTractor(const std::shared_ptr<TimelineItemModel> &time
 bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, Mlt::Tractor tractor, QProgressDialog *progressDialog,
                                const QString &originalDecimalPoint, const QString &chunks, const QString &dirty, bool enablePreview, bool *projectErrors)
 {
+    TRACE_SCOPE("constructTimelineFromMelt", "project");
     if (tractor.count() == 0) {
         // Trying to load invalid tractor, abort
         return false;
@@ -603,7 +603,8 @@ void ClipModel::requestRemapResize(int inPoint, int outPoint, int oldIn, int old
                                   .arg(m_producer->frames_to_time(j.key() + offset, mlt_time_clock))
                                   .arg(GenTime(j.value(), pCore->getCurrentFps()).seconds());
                 }
-                Fun operation = [this, kfrData = result.join(QLatin1Char(';'))]() {
+                const QString kfrData = result.join(QLatin1Char(';'));
+                Fun operation = [this, kfrData]() {
                     setRemapValue("map", kfrData.toUtf8().constData());
                     if (auto ptr = m_parent.lock()) {
                         QModelIndex ix = ptr->makeClipIndexFromID(m_id);
@@ -620,6 +621,7 @@ void ClipModel::requestRemapResize(int inPoint, int outPoint, int oldIn, int old
                     return true;
                 };
                 operation();
+                FunctionalUndoCommand::reportMemoryCost((kfrData.size() + oldKfrData.size()) * qint64(sizeof(QChar)));
                 PUSH_LAMBDA(operation, redo);
                 PUSH_FRONT_LAMBDA(reverse, undo);
             }
@@ -1159,6 +1161,7 @@ void ClipModel::setInOut(int in, int out)
 {
     MoveableItem::setInOut(in, out);
     m_clipMarkerModel->updateSnapModelInOut({in, out, qMax(0, m_mixDuration - m_mixCutPos)});
+    m_effectStack->updateDescriptors();
 }
 
 void ClipModel::setCurrentTrackId(int tid, bool finalMove)
@@ -1182,6 +1185,7 @@ void ClipModel::setCurrentTrackId(int tid, bool finalMove)
     if (finalMove && m_lastTrackId != m_currentTrackId) {
         if (tid != -1) {
             refreshProducerFromBin(m_currentTrackId);
+            m_effectStack->updateDescriptors();
         }
         m_lastTrackId = m_currentTrackId;
     }
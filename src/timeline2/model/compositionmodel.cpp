@@ -280,6 +280,7 @@ void CompositionModel::setInOut(int in, int out)
     MoveableItem::setInOut(in, out);
     m_duration = out - in;
     setPosition(in);
+    updateDescriptors();
 }
 
 void CompositionModel::setGrab(bool grab)
@@ -314,6 +315,9 @@ void CompositionModel::setCurrentTrackId(int tid, bool finalMove)
 {
     Q_UNUSED(finalMove);
     MoveableItem::setCurrentTrackId(tid);
+    if (tid != -1) {
+        updateDescriptors();
+    }
 }
 
 int CompositionModel::getOut() const
@@ -0,0 +1,165 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "renderprofiledialog.h"
+#include "core.h"
+#include "effects/effectsrepository.hpp"
+#include "effects/effectstack/model/effectstackmodel.hpp"
+#include "timeline2/model/timelineitemmodel.hpp"
+#include "timeline2/view/timelinecontroller.h"
+#include "transitions/transitionsrepository.hpp"
+
+#include <KLocalizedString>
+#include <QCheckBox>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace {
+enum Columns { NameColumn, TypeColumn, TrackColumn, PositionColumn, TimeColumn, ShareColumn };
+/** @brief The id of the timeline item, -1 for a track or an effect */
+const int ItemIdRole = Qt::UserRole + 1;
+
+/** @brief Sorts the numeric columns by value instead of text */
+class ProfileTreeItem : public QTreeWidgetItem
+{
+public:
+    using QTreeWidgetItem::QTreeWidgetItem;
+
+private:
+    bool operator<(const QTreeWidgetItem &other) const override
+    {
+        int column = treeWidget()->sortColumn();
+        if (column == PositionColumn || column == TimeColumn || column == ShareColumn) {
+            return data(column, Qt::UserRole).toDouble() < other.data(column, Qt::UserRole).toDouble();
+        }
+        return text(column).toLower() < other.text(column).toLower();
+    }
+};
+} // namespace
+
+RenderProfileDialog::RenderProfileDialog(const RenderProfileReport &report, TimelineController *controller, QWidget *parent)
+    : QDialog(parent)
+    , m_report(report)
+    , m_controller(controller)
+{
+    setWindowTitle(i18nc("@title:window", "Timeline Render Time"));
+    setAttribute(Qt::WA_DeleteOnClose);
+    auto *layout = new QVBoxLayout(this);
+    const Timecode tc = pCore->timecode();
+    auto *summary = new QLabel(i18n("Mean render time from %1 to %2: %3 ms per frame", tc.getDisplayTimecodeFromFrames(m_report.in(), false),
+                                    tc.getDisplayTimecodeFromFrames(m_report.out(), false), QString::number(m_report.msPerFrame(), 'f', 1)),
+                               this);
+    summary->setWordWrap(true);
+    layout->addWidget(summary);
+    m_tree = new QTreeWidget(this);
+    m_tree->setRootIsDecorated(false);
+    m_tree->setAlternatingRowColors(true);
+    m_tree->setHeaderLabels({i18n("Item"), i18n("Type"), i18n("Track"), i18n("Position"), i18n("Time per frame (ms)"), i18n("Share of frame time")});
+    m_tree->setToolTip(i18n("The time an item adds to the render of each frame it covers, clips include their effects. Double click to select the item."));
+    layout->addWidget(m_tree);
+    auto *heatmap = new QCheckBox(i18n("Show the render time in the timeline ruler"), this);
+    layout->addWidget(heatmap);
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(heatmap, &QCheckBox::toggled, this, [this](bool show) {
+        if (m_controller) {
+            m_controller->setRenderHeatmap(show ? m_report.heatmap() : QVariantList());
+        }
+    });
+    connect(m_tree, &QTreeWidget::itemDoubleClicked, this, &RenderProfileDialog::showItem);
+    fillReport();
+    resize(700, 450);
+}
+
+RenderProfileDialog::~RenderProfileDialog()
+{
+    if (m_controller) {
+        m_controller->setRenderHeatmap(QVariantList());
+    }
+}
+
+void RenderProfileDialog::fillReport()
+{
+    if (!m_controller) {
+        return;
+    }
+    auto model = m_controller->getModel();
+    const Timecode tc = pCore->timecode();
+    for (const RenderProfileReport::Item &item : m_report.items()) {
+        // The black background track is the first MLT track
+        const int trackId = item.track > 0 && item.track <= model->getTracksCount() ? model->getTrackIndexFromPosition(item.track - 1) : -1;
+        const QString trackTag = trackId > -1 ? model->getTrackTagById(trackId) : QString();
+        QString name;
+        QString type;
+        int itemId = -1;
+        switch (item.type) {
+        case RenderProfileReport::Item::Track: {
+            type = i18n("Track");
+            name = trackId > -1 ? model->getTrackProperty(trackId, QStringLiteral("kdenlive:track_name")).toString() : QString();
+            if (name.isEmpty()) {
+                name = trackTag;
+            }
+            break;
+        }
+        case RenderProfileReport::Item::Clip:
+            type = i18n("Clip");
+            itemId = trackId > -1 ? model->getClipByPosition(trackId, item.position, item.playlist) : -1;
+            name = itemId > -1 ? model->getClipName(itemId) : item.service;
+            break;
+        case RenderProfileReport::Item::Effect: {
+            std::shared_ptr<EffectStackModel> stack;
+            if (item.owner == QLatin1String("master")) {
+                type = i18n("Master effect");
+                stack = model->getMasterEffectStackModel();
+            } else if (item.owner == QLatin1String("track")) {
+                type = i18n("Track effect");
+                stack = trackId > -1 ? model->getTrackEffectStackModel(trackId) : nullptr;
+            } else {
+                type = i18n("Clip effect");
+                const int clipId = trackId > -1 ? model->getClipByPosition(trackId, item.position, item.playlist) : -1;
+                stack = clipId > -1 ? model->getClipEffectStack(clipId) : nullptr;
+            }
+            const QStringList names = stack ? stack->effectNames().split(QLatin1Char('/')) : QStringList();
+            name = names.value(item.index, EffectsRepository::get()->getName(item.id));
+            break;
+        }
+        case RenderProfileReport::Item::Composition:
+            type = i18n("Composition");
+            itemId = trackId > -1 ? model->getCompositionByPosition(trackId, item.position) : -1;
+            name = TransitionsRepository::get()->getName(item.id);
+            break;
+        }
+        auto *row = new ProfileTreeItem(m_tree, {name, type, trackTag, tc.getDisplayTimecodeFromFrames(item.in, false), QString::number(item.msPerFrame, 'f', 2)});
+        const double share = m_report.msPerFrame() > 0. ? 100. * item.msPerFrame / m_report.msPerFrame() : 0.;
+        row->setText(ShareColumn, i18n("%1%", QString::number(share, 'f', 1)));
+        row->setData(PositionColumn, Qt::UserRole, item.in);
+        row->setData(TimeColumn, Qt::UserRole, item.msPerFrame);
+        row->setData(ShareColumn, Qt::UserRole, share);
+        row->setData(NameColumn, ItemIdRole, itemId);
+        if (item.frames == 0) {
+            row->setToolTip(TimeColumn, i18n("No frame of this item was measured"));
+        }
+    }
+    m_tree->setSortingEnabled(true);
+    m_tree->sortByColumn(TimeColumn, Qt::DescendingOrder);
+    m_tree->header()->resizeSections(QHeaderView::ResizeToContents);
+}
+
+void RenderProfileDialog::showItem(QTreeWidgetItem *item)
+{
+    if (!m_controller) {
+        return;
+    }
+    m_controller->setPosition(item->data(PositionColumn, Qt::UserRole).toInt());
+    const int itemId = item->data(NameColumn, ItemIdRole).toInt();
+    if (itemId > -1 && (m_controller->getModel()->isClip(itemId) || m_controller->getModel()->isComposition(itemId))) {
+        m_controller->selectItems(QList<int>{itemId});
+    }
+}
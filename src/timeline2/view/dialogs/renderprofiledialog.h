@@ -0,0 +1,41 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "render/renderprofilereport.h"
+
+#include <QDialog>
+#include <QPointer>
+
+class QTreeWidget;
+class QTreeWidgetItem;
+class TimelineController;
+
+/** @class RenderProfileDialog
+    @brief Shows the render time of the tracks, clips, effects and compositions of a timeline.
+    The items of the report are matched with the timeline items, double clicking an item selects it in
+    the timeline. The render time along the timeline can be shown as a heatmap in the timeline ruler
+    while the dialog is open.
+ */
+class RenderProfileDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit RenderProfileDialog(const RenderProfileReport &report, TimelineController *controller, QWidget *parent = nullptr);
+    ~RenderProfileDialog() override;
+
+private Q_SLOTS:
+    void showItem(QTreeWidgetItem *item);
+
+private:
+    RenderProfileReport m_report;
+    QPointer<TimelineController> m_controller;
+    QTreeWidget *m_tree;
+
+    void fillReport();
+};
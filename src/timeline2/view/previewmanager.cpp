@@ -13,6 +13,7 @@
 #include "mainwindow.h"
 #include "monitor/monitor.h"
 #include "profiles/profilemodel.hpp"
+#include "render/renderserver.h"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
 #include "xml/xml.hpp"
@@ -59,6 +60,13 @@ PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *paren
 
 PreviewManager::~PreviewManager()
 {
+    if (m_profileProcess.state() != QProcess::NotRunning) {
+        m_profileProcess.disconnect(this);
+        m_profileProcess.kill();
+        m_profileProcess.waitForFinished();
+        m_cacheDir.remove(QStringLiteral("profile.mlt"));
+        m_cacheDir.remove(QStringLiteral("profile.json"));
+    }
     if (m_initialized) {
         abortRendering();
         if (m_undoDir.dirName() == QLatin1String("undo")) {
@@ -125,6 +133,10 @@ bool PreviewManager::initialize()
     connect(&m_previewTimer, &QTimer::timeout, this, &PreviewManager::startPreviewRender);
     connect(this, &PreviewManager::previewRender, this, &PreviewManager::gotPreviewRender, Qt::DirectConnection);
     connect(&m_previewGatherTimer, &QTimer::timeout, this, &PreviewManager::slotProcessDirtyChunks);
+    if (pCore->window() && pCore->window()->renderServer()) {
+        connect(pCore->window()->renderServer(), &RenderServer::taskStarted, this, &PreviewManager::workerTaskStarted);
+        connect(pCore->window()->renderServer(), &RenderServer::taskFinished, this, &PreviewManager::workerTaskFinished);
+    }
     m_initialized = true;
     return true;
 }
@@ -481,12 +493,12 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
     }
     if (add) {
         Q_EMIT dirtyChunksChanged();
-        if (m_previewProcess.state() == QProcess::NotRunning && KdenliveSettings::autopreview()) {
+        if (m_previewProcess.state() == QProcess::NotRunning && m_workerChunks.isEmpty() && KdenliveSettings::autopreview()) {
             m_previewTimer.start();
         }
     } else {
         // Remove processed chunks
-        bool isRendering = m_previewProcess.state() != QProcess::NotRunning;
+        bool isRendering = m_previewProcess.state() != QProcess::NotRunning || !m_workerChunks.isEmpty();
         m_previewGatherTimer.stop();
         abortRendering();
         m_tractor->lock();
@@ -516,6 +528,12 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
 
 void PreviewManager::abortRendering()
 {
+    if (!m_workerChunks.isEmpty()) {
+        abortWorkerRender();
+        // Re-init time estimation
+        Q_EMIT previewRender(-1, QString(), 1000);
+        return;
+    }
     if (m_previewProcess.state() == QProcess::NotRunning) {
         return;
     }
@@ -546,23 +564,66 @@ void PreviewManager::startPreviewRender()
         // clear log
         m_errorLog.clear();
         const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
-        if (!KdenliveSettings::proxypreview() && pCore->currentDoc()->useProxy()) {
-            const QString playlist =
-                pCore->projectItemModel()->sceneList(m_cacheDir.absolutePath(), QString(), QString(), pCore->currentDoc()->getTimeline(m_uuid)->tractor(), -1);
-            QDomDocument doc;
-            doc.setContent(playlist);
-            KdenliveDoc::useOriginals(doc);
-            if (!Xml::docContentToFile(doc, sceneList)) {
-                return;
-            }
-        } else {
-            pCore->currentDoc()->getTimeline(m_uuid)->sceneList(m_cacheDir.absolutePath(), sceneList);
+        if (!writeSceneList(sceneList)) {
+            return;
         }
         m_previewTimer.stop();
         doPreviewRender(sceneList);
     }
 }
 
+bool PreviewManager::writeSceneList(const QString &path)
+{
+    if (!KdenliveSettings::proxypreview() && pCore->currentDoc()->useProxy()) {
+        const QString playlist =
+            pCore->projectItemModel()->sceneList(m_cacheDir.absolutePath(), QString(), QString(), pCore->currentDoc()->getTimeline(m_uuid)->tractor(), -1);
+        QDomDocument doc;
+        doc.setContent(playlist);
+        KdenliveDoc::useOriginals(doc);
+        return Xml::docContentToFile(doc, path);
+    }
+    pCore->currentDoc()->getTimeline(m_uuid)->sceneList(m_cacheDir.absolutePath(), path);
+    return true;
+}
+
+void PreviewManager::profileRender(int in, int out)
+{
+    if (m_profileProcess.state() != QProcess::NotRunning) {
+        pCore->displayMessage(i18n("The render time of the timeline is already being measured"), InformationMessage);
+        return;
+    }
+    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("profile.mlt"));
+    const QString report = m_cacheDir.absoluteFilePath(QStringLiteral("profile.json"));
+    if (!writeSceneList(sceneList)) {
+        pCore->displayMessage(i18n("Cannot write to file %1", sceneList), ErrorMessage);
+        return;
+    }
+    m_profileProcess.disconnect(this);
+    connect(&m_profileProcess, &QProcess::readyReadStandardError, this, [this]() {
+        const QStringList lines = QString::fromLocal8Bit(m_profileProcess.readAllStandardError()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+        for (const QString &line : lines) {
+            if (line.startsWith(QLatin1String("PROGRESS:"))) {
+                pCore->displayMessage(i18n("Measuring the render time of the timeline"), ProcessingJobMessage,
+                                      line.section(QLatin1Char(':'), 1).simplified().toInt());
+            }
+        }
+    });
+    connect(&m_profileProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, sceneList, report](int exitCode, QProcess::ExitStatus status) {
+                QFile::remove(sceneList);
+                QFile file(report);
+                if (status == QProcess::CrashExit || exitCode != 0 || !file.open(QIODevice::ReadOnly)) {
+                    pCore->displayMessage(i18n("Measuring the render time of the timeline failed"), ErrorMessage);
+                } else {
+                    pCore->displayMessage(QString(), OperationCompletedMessage, 100);
+                    Q_EMIT renderProfileReady(file.readAll());
+                }
+                file.remove();
+            });
+    m_profileProcess.start(m_renderer, {QStringLiteral("profile"), sceneList, report, QStringLiteral("--mlt-profile"), pCore->getCurrentProfilePath(),
+                                        QStringLiteral("--in"), QString::number(in), QStringLiteral("--out"), QString::number(out)});
+}
+
 void PreviewManager::receivedStderr()
 {
     QStringList resultList = QString::fromLocal8Bit(m_previewProcess.readAllStandardError()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
@@ -605,6 +666,9 @@ void PreviewManager::doPreviewRender(const QString &scene)
                      m_extension,
                      m_consumerParams.join(QLatin1Char(' '))};
     pCore->currentDoc()->previewProgress(0);
+    if (RenderServer::workerCount() > 0 && renderOnWorkers(scene)) {
+        return;
+    }
     m_previewProcess.start(m_renderer, args);
     if (m_previewProcess.waitForStarted()) {
         qDebug() << " -  - -STARTING PREVIEW JOBS . . . STARTED";
@@ -632,6 +696,100 @@ void PreviewManager::processEnded(int exitCode, QProcess::ExitStatus status)
     Q_EMIT workingPreviewChanged();
 }
 
+QString PreviewManager::workerQueue() const
+{
+    return QStringLiteral("preview:") + m_uuid.toString();
+}
+
+bool PreviewManager::renderOnWorkers(const QString &scene)
+{
+    RenderServer *server = pCore->window() ? pCore->window()->renderServer() : nullptr;
+    if (server == nullptr) {
+        return false;
+    }
+    int chunkSize = KdenliveSettings::timelinechunks();
+    QStringList consumerParams;
+    for (const QString &param : qAsConst(m_consumerParams)) {
+        if (param.contains(QLatin1Char('='))) {
+            consumerParams << param;
+        }
+    }
+    consumerParams << QStringLiteral("terminate_on_pause=1");
+    // Each chunk is a separate melt task, so that the workers can render them in parallel
+    for (const QVariant &chunk : qAsConst(m_dirtyChunks)) {
+        int frame = chunk.toInt();
+        const QString fileName = m_cacheDir.absoluteFilePath(QStringLiteral("%1.%2").arg(frame).arg(m_extension));
+        QStringList args{QStringLiteral("-progress"),
+                         QStringLiteral("-profile"),
+                         pCore->getCurrentProfilePath(),
+                         scene,
+                         QStringLiteral("in=%1").arg(frame),
+                         QStringLiteral("out=%1").arg(frame + chunkSize - 1),
+                         QStringLiteral("-consumer"),
+                         QStringLiteral("avformat:") + fileName};
+        args << consumerParams;
+        int task = server->submitTask(workerQueue(), QStringLiteral("melt"), args);
+        if (task < 0) {
+            abortWorkerRender();
+            return false;
+        }
+        m_workerChunks.insert(task, frame);
+    }
+    return true;
+}
+
+void PreviewManager::abortWorkerRender()
+{
+    if (pCore->window() && pCore->window()->renderServer()) {
+        pCore->window()->renderServer()->cancelQueue(workerQueue());
+    }
+    // Remove the incomplete chunks
+    for (int frame : qAsConst(m_workerChunks)) {
+        m_cacheDir.remove(QStringLiteral("%1.%2").arg(frame).arg(m_extension));
+    }
+    m_workerChunks.clear();
+    QFile::remove(m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt")));
+    if (workingPreview >= 0) {
+        workingPreview = -1;
+        Q_EMIT workingPreviewChanged();
+    }
+}
+
+void PreviewManager::workerTaskStarted(const QString &queue, int task)
+{
+    if (queue != workerQueue() || !m_workerChunks.contains(task)) {
+        return;
+    }
+    workingPreview = m_workerChunks.value(task);
+    Q_EMIT workingPreviewChanged();
+}
+
+void PreviewManager::workerTaskFinished(const QString &queue, int task, bool success, const QString &error)
+{
+    if (queue != workerQueue() || !m_workerChunks.contains(task)) {
+        return;
+    }
+    int frame = m_workerChunks.take(task);
+    const QString fileName = m_cacheDir.absoluteFilePath(QStringLiteral("%1.%2").arg(frame).arg(m_extension));
+    if (!success) {
+        // The chunk failed on several workers, stop the preview
+        m_errorLog.append(error);
+        m_cacheDir.remove(fileName);
+        abortWorkerRender();
+        Q_EMIT previewRender(0, m_errorLog, -1);
+        return;
+    }
+    m_processedChunks++;
+    Q_EMIT previewRender(frame, fileName, 1000 * m_processedChunks / m_chunksToRender);
+    if (m_workerChunks.isEmpty() && workingPreview >= 0) {
+        // All chunks are rendered
+        QFile::remove(m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt")));
+        pCore->currentDoc()->previewProgress(1000);
+        workingPreview = -1;
+        Q_EMIT workingPreviewChanged();
+    }
+}
+
 void PreviewManager::slotProcessDirtyChunks()
 {
     if (m_dirtyChunks.isEmpty()) {
@@ -672,7 +830,7 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
     int end = endFrame - endFrame % chunkSize;
 
     m_previewGatherTimer.stop();
-    bool previewWasRunning = m_previewProcess.state() == QProcess::Running;
+    bool previewWasRunning = m_previewProcess.state() == QProcess::Running || !m_workerChunks.isEmpty();
     bool alreadyRendered = false;
     bool wasInDirtyZone = false;
     if (!m_renderedChunks.isEmpty()) {
@@ -805,6 +963,9 @@ void PreviewManager::corruptedChunk(int frame, const QString &fileName)
 {
     Q_EMIT abortPreview();
     m_previewProcess.waitForFinished();
+    if (!m_workerChunks.isEmpty()) {
+        abortWorkerRender();
+    }
     if (workingPreview >= 0) {
         workingPreview = -1;
         Q_EMIT workingPreviewChanged();
@@ -905,5 +1066,5 @@ int PreviewManager::addedTracks() const
 
 bool PreviewManager::isRunning() const
 {
-    return workingPreview >= 0 || m_previewProcess.state() != QProcess::NotRunning;
+    return workingPreview >= 0 || m_previewProcess.state() != QProcess::NotRunning || !m_workerChunks.isEmpty();
 }
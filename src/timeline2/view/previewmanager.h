@@ -10,6 +10,7 @@
 
 #include <QDir>
 #include <QFuture>
+#include <QMap>
 #include <QMutex>
 #include <QProcess>
 #include <QTimer>
@@ -79,6 +80,9 @@ public:
     bool hasDefinedRange() const;
     /** @brief Returns true if the render process is still running */
     bool isRunning() const;
+    /** @brief Measure the render time of the timeline items between @p in and @p out with the preview settings,
+     *  renderProfileReady is emitted with the report */
+    void profileRender(int in, int out);
 
 private:
     Mlt::Tractor *m_tractor;
@@ -91,6 +95,8 @@ private:
     QString m_renderer;
     /** @brief: The kdenlive timeline preview process. */
     QProcess m_previewProcess;
+    /** @brief: The process measuring the render time of the timeline items. */
+    QProcess m_profileProcess;
     /** @brief: The directory used to store the preview files. */
     QDir m_cacheDir;
     /** @brief: The directory used to store undo history of preview files (child of m_cacheDir). */
@@ -111,12 +117,22 @@ private:
     int m_processedChunks;
     /** @brief: The render process output, useful in case of failure */
     QString m_errorLog;
+    /** @brief: The chunk rendered by each task submitted to the render workers */
+    QMap<int, int> m_workerChunks;
     /** @brief: After an undo/redo, if we have preview history, use it. */
     void reloadChunks(const QVariantList &chunks);
     /** @brief: A chunk failed to render, abort. */
     void corruptedChunk(int workingPreview, const QString &fileName);
     /** @brief: Get a compressed list of chunks, like: "0-500,525,575". */
     const QStringList getCompressedList(const QVariantList items) const;
+    /** @brief: The name of the tasks of this timeline in the render server. */
+    QString workerQueue() const;
+    /** @brief: Submit the dirty chunks to the render workers, returns false if the workers are not available. */
+    bool renderOnWorkers(const QString &scene);
+    /** @brief: Cancel the chunks submitted to the render workers. */
+    void abortWorkerRender();
+    /** @brief: Write the scene list rendered by the preview to @p path, returns false if it failed. */
+    bool writeSceneList(const QString &path);
 
     /** @brief Compare two chunks for usage by std::sort
      * @returns true if @param c1 is less than @param c2
@@ -135,6 +151,8 @@ private Q_SLOTS:
     /** @brief: Process preview rendering output. */
     void receivedStderr();
     void processEnded(int exitCode, QProcess::ExitStatus status);
+    void workerTaskStarted(const QString &queue, int task);
+    void workerTaskFinished(const QString &queue, int task, bool success, const QString &error);
 
 public Q_SLOTS:
     /** @brief: Prepare and start rendering. */
@@ -160,4 +178,6 @@ Q_SIGNALS:
     void dirtyChunksChanged();
     void renderedChunksChanged();
     void workingPreviewChanged();
+    /** @brief: The render time of the timeline items was measured, @p report is the JSON report of kdenlive_render. */
+    void renderProfileReady(const QByteArray &report);
 };
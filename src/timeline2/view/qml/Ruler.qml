@@ -85,6 +85,19 @@ Item {
             color: 'darkgreen'
         }
     }
+    // Render time measured by the timeline profiler, from green to red for the slowest frames
+    Repeater {
+        model: timeline.renderHeatmap
+        anchors.fill: parent
+        delegate: Rectangle {
+            x: modelData.x * timeline.scaleFactor
+            anchors.bottom: parent.bottom
+            anchors.bottomMargin: zoneHeight + previewHeight
+            width: modelData.width * timeline.scaleFactor
+            height: previewHeight
+            color: Qt.rgba(modelData.level, 1 - modelData.level, 0, 0.8)
+        }
+    }
     Rectangle {
         id: working
         x: rulerRoot.workingPreview * timeline.scaleFactor
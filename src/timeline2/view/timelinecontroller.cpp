@@ -36,6 +36,7 @@
 #include "timeline2/model/snapmodel.hpp"
 #include "timeline2/model/trackmodel.hpp"
 #include "timeline2/view/dialogs/clipdurationdialog.h"
+#include "timeline2/view/dialogs/renderprofiledialog.h"
 #include "timeline2/view/dialogs/trackdialog.h"
 #include "timeline2/view/timelinewidget.h"
 #include "transitions/transitionsrepository.hpp"
@@ -2497,6 +2498,41 @@ void TimelineController::stopPreviewRender()
     }
 }
 
+void TimelineController::profileRender()
+{
+    if (!m_model->hasTimelinePreview()) {
+        initializePreview();
+    }
+    if (!m_model->hasTimelinePreview()) {
+        return;
+    }
+    int in = 0;
+    int out = m_model->duration() - 1;
+    if (m_zone.x() >= 0 && m_zone.y() > m_zone.x()) {
+        in = m_zone.x();
+        out = m_zone.y() - 1;
+    }
+    connect(m_model->previewManager().get(), &PreviewManager::renderProfileReady, this, &TimelineController::showRenderProfile, Qt::UniqueConnection);
+    m_model->previewManager()->profileRender(in, out);
+}
+
+void TimelineController::showRenderProfile(const QByteArray &report)
+{
+    RenderProfileReport profile;
+    if (!profile.load(report)) {
+        pCore->displayMessage(i18n("Cannot read the render time report"), ErrorMessage);
+        return;
+    }
+    auto *dialog = new RenderProfileDialog(profile, this, qApp->activeWindow());
+    dialog->show();
+}
+
+void TimelineController::setRenderHeatmap(const QVariantList &heatmap)
+{
+    m_renderHeatmap = heatmap;
+    Q_EMIT renderHeatmapChanged();
+}
+
 void TimelineController::initializePreview()
 {
     if (m_model->hasTimelinePreview()) {
@@ -44,6 +44,7 @@ class TimelineController : public QObject
     Q_PROPERTY(QVariantList dirtyChunks READ dirtyChunks NOTIFY dirtyChunksChanged)
     Q_PROPERTY(QVariantList renderedChunks READ renderedChunks NOTIFY renderedChunksChanged)
     Q_PROPERTY(QVariantList masterEffectZones MEMBER m_masterEffectZones NOTIFY masterZonesChanged)
+    Q_PROPERTY(QVariantList renderHeatmap MEMBER m_renderHeatmap NOTIFY renderHeatmapChanged)
     Q_PROPERTY(int workingPreview READ workingPreview NOTIFY workingPreviewChanged)
     Q_PROPERTY(bool useRuler READ useRuler NOTIFY useRulerChanged)
     Q_PROPERTY(bool scrollVertically READ scrollVertically NOTIFY scrollVerticallyChanged)
@@ -571,6 +572,10 @@ public:
     void clearPreviewRange(bool resetZones);
     void startPreviewRender();
     void stopPreviewRender();
+    /** @brief Measure the render time of the timeline items in the timeline zone, or the whole timeline, and show the report */
+    void profileRender();
+    /** @brief Show the render time along the timeline in the ruler, see RenderProfileReport::heatmap() */
+    void setRenderHeatmap(const QVariantList &heatmap);
     QVariantList dirtyChunks() const;
     QVariantList renderedChunks() const;
     /** @brief returns the frame currently processed by timeline preview, -1 if none
@@ -711,6 +716,7 @@ public Q_SLOTS:
     Q_INVOKABLE void autofitTrackHeight(int timelineHeight, int collapsedHeight);
 
 private Q_SLOTS:
+    void showRenderProfile(const QByteArray &report);
     void updateClipActions();
     void updateVideoTarget();
     void updateAudioTarget();
@@ -759,6 +765,7 @@ private:
     QPoint m_effectZone;
     bool m_autotrackHeight;
     QVariantList m_masterEffectZones;
+    QVariantList m_renderHeatmap;
     /** @brief The clip that is displayed in the preview monitor during a trimming operation*/
     int m_trimmingMainClip;
 
@@ -824,6 +831,7 @@ Q_SIGNALS:
     void guidesLockedChanged();
     void effectZoneChanged();
     void masterZonesChanged();
+    void renderHeatmapChanged();
     Q_INVOKABLE void ungrabHack();
     void regainFocus();
     void updateAssetPosition(int itemId);
@@ -24,6 +24,7 @@
 #include "timelinecontroller.h"
 #include "timelinewidget.h"
 #include "utils/clipboardproxy.hpp"
+#include "utils/tracer.hpp"
 
 #include <QAction>
 #include <QActionGroup>
@@ -200,7 +201,10 @@ void TimelineWidget::setModel(const std::shared_ptr<TimelineItemModel> &model, M
     const QStringList effs = sortedItems(KdenliveSettings::favorite_effects(), false).values();
     const QStringList trans = sortedItems(KdenliveSettings::favorite_transitions(), true).values();
 
-    setSource(QUrl(QStringLiteral("qrc:/qml/timeline.qml")));
+    {
+        TRACE_SCOPE("Timeline QML loading", "qml");
+        setSource(QUrl(QStringLiteral("qrc:/qml/timeline.qml")));
+    }
     connect(rootObject(), SIGNAL(mousePosChanged(int)), pCore->window(), SLOT(slotUpdateMousePosition(int)));
     connect(rootObject(), SIGNAL(zoomIn(bool)), pCore->window(), SLOT(slotZoomIn(bool)));
     connect(rootObject(), SIGNAL(zoomOut(bool)), pCore->window(), SLOT(slotZoomOut(bool)));
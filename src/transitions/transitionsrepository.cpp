@@ -6,6 +6,7 @@
 #include "transitionsrepository.hpp"
 #include "core.h"
 #include "kdenlivesettings.h"
+#include "utils/tracer.hpp"
 #include "xml/xml.hpp"
 #include <QFile>
 #include <QStandardPaths>
@@ -19,6 +20,7 @@ std::once_flag TransitionsRepository::m_onceFlag;
 TransitionsRepository::TransitionsRepository()
     : AbstractAssetsRepository<AssetListType::AssetType>()
 {
+    TRACE_SCOPE("TransitionsRepository", "startup");
     init();
     QStringList invalidTransition;
     for (const QString &effect : KdenliveSettings::favorite_transitions()) {
@@ -143,6 +145,11 @@ QString TransitionsRepository::assetPreferredListPath() const
     return QLatin1String("");
 }
 
+QString TransitionsRepository::assetCacheName() const
+{
+    return QStringLiteral("transitions.cache");
+}
+
 std::unique_ptr<Mlt::Transition> TransitionsRepository::getTransition(const QString &transitionId) const
 {
     Q_ASSERT(exists(transitionId));
@@ -8,13 +8,26 @@
 #include "logger.hpp"
 #endif
 #include <QDebug>
+#include <cstring>
+#include <mlt++/MltProperties.h>
 #include <utility>
+
+namespace {
+// The functors of most operations only capture ids and a few values
+constexpr qint64 BaseMemoryCost = 512;
+// Cost of the data captured by the operation being built, see reportMemoryCost()
+thread_local qint64 pendingMemoryCost = 0;
+} // namespace
+
 FunctionalUndoCommand::FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent)
     : QUndoCommand(parent)
     , m_undo(std::move(undo))
     , m_redo(std::move(redo))
     , m_undone(false)
+    , m_compacted(false)
+    , m_memoryCost(BaseMemoryCost + text.size() * qint64(sizeof(QChar)) + pendingMemoryCost)
 {
+    pendingMemoryCost = 0;
     setText(text);
 }
 
@@ -24,6 +37,10 @@ void FunctionalUndoCommand::undo()
 #ifdef CRASH_AUTO_TEST
     Logger::log_undo(true);
 #endif
+    if (m_compacted) {
+        // History was discarded, nothing to undo
+        return;
+    }
     m_undone = true;
     bool res = m_undo();
     Q_ASSERT(res);
@@ -31,7 +48,7 @@ void FunctionalUndoCommand::undo()
 
 void FunctionalUndoCommand::redo()
 {
-    if (m_undone) {
+    if (m_undone && !m_compacted) {
         // qDebug() << "REDOING " <<text();
 #ifdef CRASH_AUTO_TEST
         Logger::log_undo(false);
@@ -40,3 +57,33 @@ void FunctionalUndoCommand::redo()
         Q_ASSERT(res);
     }
 }
+
+qint64 FunctionalUndoCommand::memoryCost() const
+{
+    return m_compacted ? 0 : m_memoryCost;
+}
+
+void FunctionalUndoCommand::compact()
+{
+    m_undo = Fun();
+    m_redo = Fun();
+    m_compacted = true;
+    setObsolete(true);
+}
+
+void FunctionalUndoCommand::reportMemoryCost(qint64 bytes)
+{
+    pendingMemoryCost += bytes;
+}
+
+qint64 FunctionalUndoCommand::propertiesCost(Mlt::Properties &properties)
+{
+    qint64 cost = 0;
+    const int count = properties.count();
+    for (int i = 0; i < count; ++i) {
+        const char *name = properties.get_name(i);
+        const char *value = properties.get(i);
+        cost += (name ? qint64(strlen(name)) : 0) + (value ? qint64(strlen(value)) : 0);
+    }
+    return cost;
+}
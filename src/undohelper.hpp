@@ -27,6 +27,10 @@ using Fun = std::function<bool(void)>;
 
 #include <QUndoCommand>
 
+namespace Mlt {
+class Properties;
+}
+
 /** @brief this is a generic class that takes fonctors as undo and redo actions. It just executes them when required by Qt
   Note that QUndoStack actually executes redo() when we push the undoCommand to the stack
   This is bad for us because we execute the command as we construct the undo Function. So to prevent it to be executed twice, there is a small hack in this
@@ -38,8 +42,19 @@ public:
     FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent = nullptr);
     void undo() override;
     void redo() override;
+    /** @brief Returns the approximate memory held by the undo and redo functors, in bytes. */
+    qint64 memoryCost() const;
+    /** @brief Release the undo and redo functors to free memory. The command becomes a no-op and is discarded from the stack when undone. */
+    void compact();
+    /** @brief Report the approximate memory of large data (XML, producers) captured by the functors of the operation being built.
+     *  It is added to the cost of the next command created on this thread. */
+    static void reportMemoryCost(qint64 bytes);
+    /** @brief Returns the approximate memory used by the names and values of MLT properties, in bytes. */
+    static qint64 propertiesCost(Mlt::Properties &properties);
 
 private:
     Fun m_undo, m_redo;
     bool m_undone;
+    bool m_compacted;
+    qint64 m_memoryCost;
 };
@@ -0,0 +1,91 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "tracer.hpp"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+
+Tracer &Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::enable(const QString &outputFile)
+{
+    QMutexLocker lock(&m_mutex);
+    if (outputFile.isEmpty() || m_enabled) {
+        return;
+    }
+    m_outputFile = outputFile;
+    m_timer.start();
+    m_enabled.store(true);
+}
+
+qint64 Tracer::timestamp() const
+{
+    return m_timer.nsecsElapsed() / 1000;
+}
+
+void Tracer::addEvent(const char *name, const char *category, qint64 start, qint64 duration)
+{
+    const qint64 thread = qint64(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    QMutexLocker lock(&m_mutex);
+    m_events.append({name, category, start, duration, thread});
+}
+
+bool Tracer::write()
+{
+    if (!isEnabled()) {
+        return false;
+    }
+    QMutexLocker lock(&m_mutex);
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+    for (const Event &event : qAsConst(m_events)) {
+        QJsonObject entry;
+        entry.insert(QStringLiteral("name"), QString::fromUtf8(event.name));
+        entry.insert(QStringLiteral("cat"), QString::fromUtf8(event.category));
+        entry.insert(QStringLiteral("ph"), QStringLiteral("X"));
+        entry.insert(QStringLiteral("ts"), event.start);
+        entry.insert(QStringLiteral("dur"), event.duration);
+        entry.insert(QStringLiteral("pid"), pid);
+        entry.insert(QStringLiteral("tid"), event.thread);
+        events.append(entry);
+    }
+    QJsonObject root;
+    root.insert(QStringLiteral("traceEvents"), events);
+    root.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+    QSaveFile file(m_outputFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write trace file" << m_outputFile;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+TraceScope::TraceScope(const char *name, const char *category)
+    : m_name(name)
+    , m_category(category)
+{
+    if (Tracer::instance().isEnabled()) {
+        m_start = Tracer::instance().timestamp();
+    }
+}
+
+TraceScope::~TraceScope()
+{
+    if (m_start >= 0) {
+        Tracer &tracer = Tracer::instance();
+        tracer.addEvent(m_name, m_category, m_start, tracer.timestamp() - m_start);
+    }
+}
@@ -0,0 +1,77 @@
+/*
+    SPDX-FileCopyrightText: 2023 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+/** @class Tracer
+    @brief Records the duration of named phases (startup steps, project loading, ...) and writes them
+    in the Chrome trace event format, which can be opened in chrome://tracing or Perfetto.
+    Tracing is disabled by default, it is enabled with the --trace command line option or the
+    KDENLIVE_TRACE environment variable, both giving the output file.
+    Phases are recorded with the TRACE_SCOPE macro, which costs a single atomic read when tracing is disabled.
+ * Note that this class is a Singleton
+ */
+class Tracer
+{
+public:
+    static Tracer &instance();
+
+    /** @brief Start recording events, they will be written to @p outputFile */
+    void enable(const QString &outputFile);
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /** @brief Returns the time in microseconds since tracing was enabled */
+    qint64 timestamp() const;
+
+    /** @brief Record a completed phase. @p name and @p category must outlive the tracer (string literals) */
+    void addEvent(const char *name, const char *category, qint64 start, qint64 duration);
+
+    /** @brief Write all the events recorded so far to the output file */
+    bool write();
+
+private:
+    Tracer() = default;
+
+    struct Event
+    {
+        const char *name;
+        const char *category;
+        qint64 start;
+        qint64 duration;
+        qint64 thread;
+    };
+
+    std::atomic<bool> m_enabled{false};
+    QString m_outputFile;
+    QElapsedTimer m_timer;
+    QMutex m_mutex;
+    QVector<Event> m_events;
+};
+
+/** @class TraceScope
+    @brief Records the lifetime of the object as a phase of the tracer
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name, const char *category = "kdenlive");
+    ~TraceScope();
+
+private:
+    const char *m_name;
+    const char *m_category;
+    qint64 m_start{-1};
+};
+
+#define TRACE_SCOPE_CONCAT_IMPL(a, b) a##b
+#define TRACE_SCOPE_CONCAT(a, b) TRACE_SCOPE_CONCAT_IMPL(a, b)
+/** @brief Record the enclosing scope as a phase named @p name, with an optional category */
+#define TRACE_SCOPE(...) TraceScope TRACE_SCOPE_CONCAT(traceScope, __LINE__)(__VA_ARGS__)
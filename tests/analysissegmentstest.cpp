@@ -0,0 +1,45 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "jobs/analysissegments.h"
+
+TEST_CASE("Analysis segments", "[Jobs]")
+{
+    SECTION("Ranges are contiguous and not too short")
+    {
+        auto ranges = AnalysisSegments::split(10, 1009, 4, 100);
+        REQUIRE(ranges.count() == 4);
+        REQUIRE(ranges.first().first == 10);
+        REQUIRE(ranges.last().second == 1009);
+        for (int i = 1; i < ranges.count(); ++i) {
+            REQUIRE(ranges.at(i).first == ranges.at(i - 1).second + 1);
+        }
+        REQUIRE(AnalysisSegments::split(0, 299, 8, 100).count() == 3);
+        REQUIRE(AnalysisSegments::split(0, 49, 8, 100).count() == 1);
+        REQUIRE(AnalysisSegments::split(10, 5, 2, 1).isEmpty());
+    }
+
+    SECTION("Motion data is joined without the overlapping frames")
+    {
+        const QByteArray first = "VID.STAB 1\n#      accuracy = 15\nFrame 1 (List 0 [])\nFrame 2 (List 1 [(LM 1 2 3 4 5 6 7)])\n";
+        const QByteArray second = "VID.STAB 1\n#      accuracy = 15\nFrame 1 (List 0 [])\nFrame 2 (List 1 [(LM 8 9 3 4 5 6 7)])\nFrame 3 (List 0 [])\n";
+        const QByteArray joined = AnalysisSegments::joinMotionData({first, second}, 1);
+        REQUIRE(joined ==
+                QByteArray("VID.STAB 1\n#      accuracy = 15\nFrame 1 (List 0 [])\nFrame 2 (List 1 [(LM 1 2 3 4 5 6 7)])\nFrame 3 (List 1 [(LM 8 9 3 4 5 6 7)])\n"
+                           "Frame 4 (List 0 [])\n"));
+        REQUIRE(AnalysisSegments::joinMotionData({first, QByteArray("invalid")}, 1).isEmpty());
+    }
+
+    SECTION("Keyframes are joined from the last keyframe of the previous segment")
+    {
+        const QString first = QStringLiteral("0~=10 10 50 50 0;5~=12 10 50 50 0;10~=15 11 50 50 0");
+        REQUIRE(AnalysisSegments::lastKeyframePosition(first) == 10);
+        REQUIRE(AnalysisSegments::lastKeyframeValue(first) == QStringLiteral("15 11 50 50 0"));
+        REQUIRE(AnalysisSegments::lastKeyframePosition(QString()) == -1);
+        const QString second = QStringLiteral("10~=15 11 50 50 0;15~=20 12 50 50 0");
+        REQUIRE(AnalysisSegments::joinKeyframes({first, second}) ==
+                QStringLiteral("0~=10 10 50 50 0;5~=12 10 50 50 0;10~=15 11 50 50 0;15~=20 12 50 50 0"));
+    }
+}
@@ -0,0 +1,67 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "audiomixer/audiolevelbuffer.hpp"
+
+#include <QVector>
+#include <thread>
+
+TEST_CASE("Audio level buffer", "[AudioMixer]")
+{
+    AudioLevelBuffer buffer(30);
+    QVector<double> levels;
+
+    SECTION("Read published levels")
+    {
+        const double values[] = {-12., -6.};
+        REQUIRE_FALSE(buffer.read(5, levels));
+        buffer.publish(5, values, 2);
+        REQUIRE(buffer.read(5, levels));
+        REQUIRE(levels == QVector<double>({-12., -6.}));
+        // Another position mapping to the same slot is not confused with this one
+        REQUIRE_FALSE(buffer.read(35, levels));
+    }
+
+    SECTION("Old frames are overwritten")
+    {
+        const double values[] = {-20.};
+        buffer.publish(1, values, 1);
+        buffer.publish(31, values, 1);
+        REQUIRE_FALSE(buffer.read(1, levels));
+        REQUIRE(buffer.read(31, levels));
+        REQUIRE(levels.size() == 1);
+    }
+
+    SECTION("Clear discards stored levels")
+    {
+        const double values[] = {-3., -4.};
+        buffer.publish(10, values, 2);
+        buffer.clear();
+        REQUIRE_FALSE(buffer.read(10, levels));
+        buffer.publish(10, values, 2);
+        REQUIRE(buffer.read(10, levels));
+    }
+
+    SECTION("Concurrent reads never return torn levels")
+    {
+        const int frames = 20000;
+        std::thread producer([&buffer]() {
+            for (int pos = 0; pos < frames; ++pos) {
+                const double values[] = {double(pos), double(pos), double(pos), double(pos)};
+                buffer.publish(pos, values, 4);
+            }
+        });
+        for (int i = 0; i < frames; ++i) {
+            if (buffer.read(i, levels)) {
+                REQUIRE(levels.size() == 4);
+                for (double value : qAsConst(levels)) {
+                    REQUIRE(int(value) == i);
+                }
+            }
+        }
+        producer.join();
+        REQUIRE(buffer.read(frames - 1, levels));
+    }
+}
@@ -261,4 +261,29 @@ TEST_CASE("Keyframe model", "[KeyframeModel]")
         undoStack->undo();
         state1(6.1);
     }
+
+    SECTION("Interpolated values match MLT")
+    {
+        auto checkInterpolation = [&]() {
+            Mlt::Properties props;
+            props.set("key", model->getAnimProperty().toUtf8().constData());
+            (void)props.anim_get_double("key", 0, 200);
+            for (int frame = 0; frame < 200; ++frame) {
+                double expected = props.anim_get_double("key", frame);
+                REQUIRE(qAbs(model->getInterpolatedValue(frame).toDouble() - expected) < 1e-6);
+            }
+        };
+        REQUIRE(model->addKeyframe(GenTime(1.), KeyframeType::Curve, 10));
+        REQUIRE(model->addKeyframe(GenTime(2.), KeyframeType::Linear, 60));
+        REQUIRE(model->addKeyframe(GenTime(3.), KeyframeType::Discrete, 20));
+        REQUIRE(model->addKeyframe(GenTime(4.), KeyframeType::Curve, 80));
+        REQUIRE(model->addKeyframe(GenTime(5.), KeyframeType::Curve, 30));
+        checkInterpolation();
+
+        // The cached curve must follow keyframe changes
+        undoStack->undo();
+        checkInterpolation();
+        REQUIRE(model->updateKeyframe(GenTime(2.), QVariant(5.)));
+        checkInterpolation();
+    }
 }
@@ -0,0 +1,81 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "audiomixer/loudnessmeter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+std::vector<float> stereoSine(double frequency, double amplitudeDb, double seconds, int sampleRate = 48000, double phase = 0.)
+{
+    const double pi = std::acos(-1.);
+    const double amplitude = std::pow(10., amplitudeDb / 20.);
+    const int frames = int(seconds * sampleRate);
+    std::vector<float> samples(size_t(2 * frames));
+    for (int i = 0; i < frames; ++i) {
+        const float value = float(amplitude * std::sin(2. * pi * frequency * i / sampleRate + phase));
+        samples[size_t(2 * i)] = value;
+        samples[size_t(2 * i + 1)] = value;
+    }
+    return samples;
+}
+} // namespace
+
+TEST_CASE("Loudness meter", "[AudioMixer]")
+{
+    LoudnessMeter meter(48000, 2);
+
+    SECTION("Silence")
+    {
+        REQUIRE(meter.integratedLoudness() == LoudnessMeter::Silence);
+        std::vector<float> silence(48000 * 2 * 2, 0.f);
+        meter.process(silence.data(), 48000 * 2);
+        REQUIRE(meter.momentaryLoudness() == LoudnessMeter::Silence);
+        REQUIRE(meter.integratedLoudness() == LoudnessMeter::Silence);
+        REQUIRE(meter.truePeak() == LoudnessMeter::Silence);
+    }
+
+    SECTION("EBU reference stereo sine")
+    {
+        // EBU Tech 3341: a 1kHz stereo sine at -23dBFS measures -23 LUFS
+        std::vector<float> samples = stereoSine(1000., -23., 20.);
+        // Feed in blocks not aligned on the 100ms measurement step
+        const int frames = int(samples.size() / 2);
+        for (int i = 0; i < frames; i += 1001) {
+            meter.process(samples.data() + 2 * i, std::min(1001, frames - i));
+        }
+        CHECK(meter.momentaryLoudness() == Approx(-23.).margin(0.1));
+        CHECK(meter.shortTermLoudness() == Approx(-23.).margin(0.1));
+        CHECK(meter.integratedLoudness() == Approx(-23.).margin(0.1));
+        CHECK(meter.maximumShortTermLoudness() == Approx(-23.).margin(0.1));
+        CHECK(meter.truePeak() == Approx(-23.).margin(0.2));
+        meter.reset();
+        REQUIRE(meter.integratedLoudness() == LoudnessMeter::Silence);
+    }
+
+    SECTION("Quiet parts are gated out of integrated loudness")
+    {
+        std::vector<float> loud = stereoSine(1000., -23., 10.);
+        std::vector<float> quiet = stereoSine(1000., -60., 10.);
+        meter.process(loud.data(), int(loud.size() / 2));
+        meter.process(quiet.data(), int(quiet.size() / 2));
+        CHECK(meter.integratedLoudness() == Approx(-23.).margin(0.2));
+        CHECK(meter.shortTermLoudness() < -50.);
+    }
+
+    SECTION("True peak detects inter-sample peaks")
+    {
+        // A sine at a quarter of the sample rate with a 45° phase never hits its peak on a sample
+        std::vector<float> samples = stereoSine(12000., -6., 1., 48000, std::acos(-1.) / 4);
+        std::vector<int16_t> integerSamples(samples.size());
+        for (size_t i = 0; i < samples.size(); ++i) {
+            integerSamples[i] = int16_t(std::lround(samples[i] * 32767.));
+        }
+        meter.process(integerSamples.data(), int(integerSamples.size() / 2));
+        CHECK(meter.truePeak() == Approx(-6.).margin(0.3));
+    }
+}
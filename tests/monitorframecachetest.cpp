@@ -0,0 +1,82 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "monitor/monitorframecache.h"
+
+namespace {
+SharedFrame makeFrame(int position)
+{
+    Mlt::Frame frame(mlt_frame_init(nullptr));
+    mlt_frame_set_position(frame.get_frame(), position);
+    return SharedFrame(frame);
+}
+
+void store(MonitorFrameCache &cache, int position, qint64 cost = 10)
+{
+    cache.expect(position);
+    REQUIRE(cache.insert(position, makeFrame(position), cost));
+}
+} // namespace
+
+TEST_CASE("Monitor frame cache", "[Monitor]")
+{
+    MonitorFrameCache cache(100);
+
+    SECTION("Only expected frames are stored")
+    {
+        REQUIRE_FALSE(cache.insert(3, makeFrame(3), 10));
+        REQUIRE_FALSE(cache.contains(3));
+        store(cache, 3);
+        REQUIRE(cache.contains(3));
+        REQUIRE(cache.frame(3).get_position() == 3);
+        REQUIRE_FALSE(cache.frame(4).is_valid());
+        // An expectation is consumed by the insertion
+        REQUIRE_FALSE(cache.isExpected(3));
+        REQUIRE(cache.cost() == 10);
+    }
+
+    SECTION("Frames far from the last insertion are evicted first")
+    {
+        for (int i = 0; i < 10; ++i) {
+            store(cache, 50 + i);
+        }
+        REQUIRE(cache.count() == 10);
+        store(cache, 60);
+        // Budget exceeded, the farthest frame from 60 is 50
+        REQUIRE(cache.count() == 10);
+        REQUIRE_FALSE(cache.contains(50));
+        store(cache, 49);
+        REQUIRE(cache.contains(49));
+        REQUIRE_FALSE(cache.contains(60));
+        REQUIRE(cache.cost() <= 100);
+    }
+
+    SECTION("Invalidation drops a range and pending renders")
+    {
+        for (int i = 0; i < 5; ++i) {
+            store(cache, i * 10);
+        }
+        cache.expect(100);
+        cache.invalidate(15, 30);
+        REQUIRE(cache.contains(10));
+        REQUIRE_FALSE(cache.contains(20));
+        REQUIRE_FALSE(cache.contains(30));
+        REQUIRE(cache.contains(40));
+        // A frame requested before the edit is refused
+        REQUIRE_FALSE(cache.insert(100, makeFrame(100), 10));
+        cache.invalidate(20, -1);
+        REQUIRE(cache.count() == 2);
+        REQUIRE(cache.cost() == 20);
+    }
+
+    SECTION("Disabled cache")
+    {
+        cache.setBudget(0);
+        REQUIRE_FALSE(cache.isEnabled());
+        cache.expect(1);
+        REQUIRE_FALSE(cache.insert(1, makeFrame(1), 1));
+        REQUIRE(cache.count() == 0);
+    }
+}
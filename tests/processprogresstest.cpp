@@ -0,0 +1,71 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "jobs/processprogress.h"
+
+TEST_CASE("Process progress parsing", "[Jobs]")
+{
+    SECTION("ffmpeg progress blocks")
+    {
+        // 10 seconds output
+        ProcessProgress progress(ProcessProgress::Format::FFmpeg, 10.);
+        REQUIRE(progress.percent() == 0);
+        REQUIRE(progress.parse(QByteArrayLiteral("frame=50\nfps=48.5\nout_time_us=2500000\nspeed=1.5x\nprogress=continue\n"), 500));
+        REQUIRE(progress.percent() == 25);
+        REQUIRE(progress.fps() == Approx(48.5));
+        REQUIRE(progress.speed() == Approx(1.5));
+        REQUIRE_FALSE(progress.isFinished());
+
+        // Lines split between two reads are only parsed once complete
+        REQUIRE_FALSE(progress.parse(QByteArrayLiteral("out_time_us=50"), 1000));
+        REQUIRE(progress.percent() == 25);
+        REQUIRE(progress.parse(QByteArrayLiteral("00000\r\n"), 1000));
+        REQUIRE(progress.percent() == 50);
+
+        // Output of older ffmpeg versions
+        REQUIRE(progress.parse(QByteArrayLiteral("out_time_ms=7500000\n"), 1500));
+        REQUIRE(progress.percent() == 75);
+
+        REQUIRE(progress.parse(QByteArrayLiteral("progress=end\n"), 2000));
+        REQUIRE(progress.percent() == 100);
+        REQUIRE(progress.isFinished());
+    }
+
+    SECTION("ffmpeg values not available yet")
+    {
+        ProcessProgress progress(ProcessProgress::Format::FFmpeg, 10.);
+        REQUIRE_FALSE(progress.parse(QByteArrayLiteral("fps=0.00\nout_time_us=N/A\nspeed=N/A\n"), 0));
+        REQUIRE(progress.percent() == 0);
+        REQUIRE(progress.fps() == 0.);
+        REQUIRE(progress.speed() == 0.);
+    }
+
+    SECTION("ffmpeg output of unknown duration")
+    {
+        ProcessProgress progress(ProcessProgress::Format::FFmpeg);
+        REQUIRE(progress.parse(QByteArrayLiteral("fps=25\nout_time_us=2500000\n"), 0));
+        REQUIRE(progress.percent() == 0);
+        REQUIRE(progress.fps() == Approx(25.));
+    }
+
+    SECTION("melt progress lines")
+    {
+        // 25 fps output
+        ProcessProgress progress(ProcessProgress::Format::Melt, 0., 25.);
+        REQUIRE(progress.parse(QByteArrayLiteral("Current Frame:         10, percentage:          5\r"), 0));
+        REQUIRE(progress.percent() == 5);
+        // No throughput until a full sample period elapsed
+        REQUIRE(progress.fps() == 0.);
+        progress.parse(QByteArrayLiteral("Current Frame:         30, percentage:         15\r"), 500);
+        REQUIRE(progress.fps() == 0.);
+        REQUIRE(progress.parse(QByteArrayLiteral("Current Frame:         60, percentage:         30\r"), 1000));
+        REQUIRE(progress.percent() == 30);
+        REQUIRE(progress.fps() == Approx(50.));
+        REQUIRE(progress.speed() == Approx(2.));
+        // Other log messages are ignored
+        REQUIRE_FALSE(progress.parse(QByteArrayLiteral("[consumer avformat] some warning\n"), 1200));
+        REQUIRE(progress.percent() == 30);
+    }
+}
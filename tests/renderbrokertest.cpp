@@ -0,0 +1,137 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "render/renderbroker.h"
+
+namespace {
+QVector<int> addTasks(RenderBroker &broker, const QString &queue, int count)
+{
+    QVector<int> ids;
+    for (int i = 0; i < count; ++i) {
+        ids << broker.addTask(queue, QStringLiteral("melt"), {QStringLiteral("%1-%2").arg(queue).arg(i)});
+    }
+    return ids;
+}
+} // namespace
+
+TEST_CASE("Render broker", "[Render]")
+{
+    RenderBroker broker;
+
+    SECTION("Idle workers take the tasks in queue order")
+    {
+        const QVector<int> ids = addTasks(broker, QStringLiteral("preview"), 3);
+        broker.addWorker(0, 0);
+        broker.addWorker(1, 0);
+        auto started = broker.assign();
+        REQUIRE(started.count() == 2);
+        REQUIRE(started.at(0) == std::make_pair(0, ids.at(0)));
+        REQUIRE(started.at(1) == std::make_pair(1, ids.at(1)));
+        REQUIRE(broker.task(ids.at(0))->worker == 0);
+        // Busy workers get nothing
+        REQUIRE(broker.assign().isEmpty());
+        REQUIRE(broker.taskFinished(1, true) == std::make_pair(ids.at(1), RenderBroker::Succeeded));
+        REQUIRE(broker.task(ids.at(1)) == nullptr);
+        started = broker.assign();
+        REQUIRE(started.count() == 1);
+        REQUIRE(started.at(0) == std::make_pair(1, ids.at(2)));
+        REQUIRE(broker.taskCount(QStringLiteral("preview")) == 2);
+    }
+
+    SECTION("A queue without worker gets the next idle worker")
+    {
+        const QVector<int> delivery = addTasks(broker, QStringLiteral("delivery"), 4);
+        broker.addWorker(0, 0);
+        broker.addWorker(1, 0);
+        REQUIRE(broker.assign().count() == 2);
+        const QVector<int> preview = addTasks(broker, QStringLiteral("preview"), 2);
+        REQUIRE(broker.taskFinished(0, true).second == RenderBroker::Succeeded);
+        auto started = broker.assign();
+        REQUIRE(started.count() == 1);
+        REQUIRE(started.at(0) == std::make_pair(0, preview.at(0)));
+        // Once served, each worker stays on the queue of its previous task
+        REQUIRE(broker.taskFinished(1, true).second == RenderBroker::Succeeded);
+        started = broker.assign();
+        REQUIRE(started.count() == 1);
+        REQUIRE(started.at(0) == std::make_pair(1, delivery.at(2)));
+        REQUIRE(broker.taskFinished(0, true).second == RenderBroker::Succeeded);
+        started = broker.assign();
+        REQUIRE(started.at(0) == std::make_pair(0, preview.at(1)));
+    }
+
+    SECTION("A worker with an empty queue steals the last task of the longest queue")
+    {
+        const QVector<int> preview = addTasks(broker, QStringLiteral("preview"), 1);
+        const QVector<int> delivery = addTasks(broker, QStringLiteral("delivery"), 4);
+        broker.addWorker(0, 0);
+        broker.addWorker(1, 0);
+        auto started = broker.assign();
+        REQUIRE(started.count() == 2);
+        REQUIRE(started.at(0) == std::make_pair(0, delivery.at(0)));
+        REQUIRE(started.at(1) == std::make_pair(1, preview.at(0)));
+        REQUIRE(broker.taskFinished(1, true).second == RenderBroker::Succeeded);
+        started = broker.assign();
+        REQUIRE(started.count() == 1);
+        REQUIRE(started.at(0) == std::make_pair(1, delivery.at(3)));
+        // The thief now works on the front of its new queue
+        REQUIRE(broker.taskFinished(1, true).second == RenderBroker::Succeeded);
+        started = broker.assign();
+        REQUIRE(started.at(0) == std::make_pair(1, delivery.at(1)));
+    }
+
+    SECTION("Failed tasks are retried first, then failed")
+    {
+        const QVector<int> ids = addTasks(broker, QStringLiteral("delivery"), 2);
+        broker.addWorker(0, 0);
+        for (int attempt = 1; attempt < RenderBroker::MaxAttempts; ++attempt) {
+            auto started = broker.assign();
+            REQUIRE(started.count() == 1);
+            REQUIRE(started.at(0).second == ids.at(0));
+            REQUIRE(broker.task(ids.at(0))->attempts == attempt);
+            REQUIRE(broker.taskFinished(0, false) == std::make_pair(ids.at(0), RenderBroker::Retried));
+            REQUIRE(broker.task(ids.at(0))->worker == -1);
+        }
+        REQUIRE(broker.assign().at(0).second == ids.at(0));
+        REQUIRE(broker.taskFinished(0, false) == std::make_pair(ids.at(0), RenderBroker::Failed));
+        REQUIRE(broker.task(ids.at(0)) == nullptr);
+        REQUIRE(broker.assign().at(0).second == ids.at(1));
+    }
+
+    SECTION("Workers missing their heartbeats expire and their task is retried")
+    {
+        const QVector<int> ids = addTasks(broker, QStringLiteral("delivery"), 1);
+        broker.addWorker(0, 0);
+        broker.addWorker(1, 0);
+        REQUIRE(broker.assign().at(0) == std::make_pair(0, ids.at(0)));
+        broker.heartbeat(1, 8000);
+        REQUIRE(broker.expiredWorkers(9000).isEmpty());
+        REQUIRE(broker.expiredWorkers(RenderBroker::HeartbeatTimeout + 1) == QVector<int>({0}));
+        REQUIRE(broker.removeWorker(0) == std::make_pair(ids.at(0), RenderBroker::Retried));
+        REQUIRE(broker.workerCount() == 1);
+        REQUIRE(broker.assign().at(0) == std::make_pair(1, ids.at(0)));
+        REQUIRE(broker.task(ids.at(0))->attempts == 2);
+        // An idle worker has nothing to retry
+        broker.addWorker(2, 0);
+        REQUIRE(broker.removeWorker(2).first == -1);
+    }
+
+    SECTION("Canceled tasks keep their worker busy until it reports")
+    {
+        const QVector<int> preview = addTasks(broker, QStringLiteral("preview"), 3);
+        const QVector<int> delivery = addTasks(broker, QStringLiteral("delivery"), 1);
+        broker.addWorker(0, 0);
+        REQUIRE(broker.assign().at(0) == std::make_pair(0, delivery.at(0)));
+        REQUIRE(broker.cancelTask(delivery.at(0)) == 0);
+        REQUIRE(broker.currentTask(0) == delivery.at(0));
+        REQUIRE(broker.assign().isEmpty());
+        REQUIRE(broker.taskFinished(0, false) == std::make_pair(delivery.at(0), RenderBroker::Canceled));
+        REQUIRE(broker.assign().at(0) == std::make_pair(0, preview.at(0)));
+        REQUIRE(broker.cancelTask(preview.at(1)) == -1);
+        REQUIRE(broker.cancelQueue(QStringLiteral("preview")) == QVector<int>({0}));
+        REQUIRE(broker.taskCount(QStringLiteral("preview")) == 0);
+        REQUIRE(broker.taskFinished(0, true).second == RenderBroker::Canceled);
+        REQUIRE(broker.assign().isEmpty());
+    }
+}
@@ -0,0 +1,84 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "renderpresets/renderjobscheduler.hpp"
+
+namespace {
+RenderJobScheduler::Job makeJob(const QString &name, int threads, int memory, qint64 work, const QString &destination = QString())
+{
+    RenderJobScheduler::Job job;
+    job.playlist = QStringLiteral("/tmp/%1.mlt").arg(name);
+    job.destination = destination.isEmpty() ? QStringLiteral("/tmp/%1.mp4").arg(name) : destination;
+    job.threads = threads;
+    job.memory = memory;
+    job.work = work;
+    return job;
+}
+} // namespace
+
+TEST_CASE("Render job scheduler", "[RenderPresets]")
+{
+    RenderJobScheduler scheduler(8, 4000);
+
+    SECTION("Shortest jobs start first within the budget")
+    {
+        QVector<RenderJobScheduler::Job> waiting = {makeJob(QStringLiteral("short"), 2, 500, 100), makeJob(QStringLiteral("long"), 4, 1000, 5000),
+                                                    makeJob(QStringLiteral("medium"), 4, 500, 1000)};
+        REQUIRE(scheduler.jobsToStart({}, waiting) == QVector<int>({0, 2}));
+        // With a running job using most threads, only the short job fits
+        QVector<RenderJobScheduler::Job> running = {makeJob(QStringLiteral("running"), 6, 500, 100)};
+        REQUIRE(scheduler.jobsToStart(running, waiting) == QVector<int>({0}));
+    }
+
+    SECTION("The oldest waiting job is not starved by shorter jobs")
+    {
+        QVector<RenderJobScheduler::Job> waiting = {makeJob(QStringLiteral("long"), 4, 1000, 5000), makeJob(QStringLiteral("short"), 2, 500, 100),
+                                                    makeJob(QStringLiteral("medium"), 4, 500, 1000)};
+        // The oldest job starts first, the shortest remaining job fills the budget
+        REQUIRE(scheduler.jobsToStart({}, waiting) == QVector<int>({1, 0}));
+        // While it does not fit, no shorter job overtakes it
+        QVector<RenderJobScheduler::Job> running = {makeJob(QStringLiteral("running"), 6, 500, 100)};
+        REQUIRE(scheduler.jobsToStart(running, waiting).isEmpty());
+    }
+
+    SECTION("A job over budget runs alone")
+    {
+        QVector<RenderJobScheduler::Job> waiting = {makeJob(QStringLiteral("huge"), 16, 8000, 100)};
+        REQUIRE(scheduler.jobsToStart({}, waiting) == QVector<int>({0}));
+        QVector<RenderJobScheduler::Job> running = {makeJob(QStringLiteral("running"), 1, 200, 10)};
+        REQUIRE(scheduler.jobsToStart(running, waiting).isEmpty());
+        // Memory is part of the budget
+        waiting = {makeJob(QStringLiteral("big"), 1, 3900, 10)};
+        REQUIRE(scheduler.jobsToStart(running, waiting).isEmpty());
+    }
+
+    SECTION("Two pass jobs keep their order")
+    {
+        const QString target = QStringLiteral("/tmp/movie.mp4");
+        REQUIRE(RenderJobScheduler::firstPass(QStringLiteral("/tmp/movie-pass2.mlt")) == QStringLiteral("/tmp/movie.mlt"));
+        REQUIRE(RenderJobScheduler::firstPass(QStringLiteral("/tmp/movie.mlt")).isEmpty());
+        RenderJobScheduler::Job first = makeJob(QStringLiteral("movie"), 1, 200, 1000, target);
+        RenderJobScheduler::Job second = makeJob(QStringLiteral("movie-pass2"), 1, 200, 10, target);
+        // The second pass is shorter but must wait for the first one
+        REQUIRE(scheduler.jobsToStart({}, {first, second}) == QVector<int>({0}));
+        REQUIRE(scheduler.jobsToStart({first}, {second}).isEmpty());
+        REQUIRE(scheduler.jobsToStart({}, {second}) == QVector<int>({0}));
+    }
+
+    SECTION("Cost estimation")
+    {
+        QDomDocument doc;
+        doc.setContent(QStringLiteral("<mlt><profile width=\"1920\" height=\"1080\" frame_rate_num=\"25\" frame_rate_den=\"1\"/>"
+                                      "<consumer in=\"0\" out=\"249\" real_time=\"-4\" threads=\"0\" target=\"/tmp/out.mp4\"/></mlt>"));
+        RenderJobScheduler::Job job = RenderJobScheduler::estimate(doc);
+        REQUIRE(job.destination == QStringLiteral("/tmp/out.mp4"));
+        REQUIRE(job.threads == 4);
+        REQUIRE(job.work == qint64(1920) * 1080 * 250 / 1000);
+        doc.documentElement().firstChildElement(QStringLiteral("consumer")).setAttribute(QStringLiteral("scale"), 0.5);
+        RenderJobScheduler::Job scaled = RenderJobScheduler::estimate(doc);
+        REQUIRE(scaled.work * 4 == job.work);
+        REQUIRE(scaled.memory < job.memory);
+    }
+}
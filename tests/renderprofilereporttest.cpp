@@ -0,0 +1,70 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "render/renderprofilereport.h"
+
+#include <QVariantMap>
+
+TEST_CASE("Render profile report", "[Render]")
+{
+    RenderProfileReport report;
+
+    SECTION("Invalid reports are rejected")
+    {
+        REQUIRE_FALSE(report.load(QByteArray("not json")));
+        REQUIRE_FALSE(report.load(QByteArray("{\"in\": 0}")));
+    }
+
+    SECTION("Items and heatmap are read from the report")
+    {
+        const QByteArray data = R"({
+            "in": 0, "out": 99, "msPerFrame": 15,
+            "samples": [{"position": 50, "ms": 20}, {"position": 0, "ms": 10}],
+            "items": [
+                {"type": "track", "track": 1, "in": 0, "out": 99, "frames": 2, "msPerFrame": 12},
+                {"type": "clip", "track": 1, "playlist": 1, "position": 40, "service": "avformat", "in": 40, "out": 99, "frames": 1, "msPerFrame": 8},
+                {"type": "effect", "owner": "clip", "track": 1, "playlist": 1, "position": 40, "index": 2, "id": "frei0r.glow", "in": 40, "out": 99,
+                 "frames": 1, "msPerFrame": 5.5},
+                {"type": "composition", "track": 2, "aTrack": 1, "position": 10, "id": "wipe", "in": 10, "out": 30, "frames": 1, "msPerFrame": 1},
+                {"type": "unknown"}
+            ]
+        })";
+        REQUIRE(report.load(data));
+        REQUIRE(report.in() == 0);
+        REQUIRE(report.out() == 99);
+        REQUIRE(report.msPerFrame() == 15.);
+        REQUIRE(report.items().count() == 4);
+        const RenderProfileReport::Item &effect = report.items().at(2);
+        REQUIRE(effect.type == RenderProfileReport::Item::Effect);
+        REQUIRE(effect.owner == QStringLiteral("clip"));
+        REQUIRE(effect.playlist == 1);
+        REQUIRE(effect.position == 40);
+        REQUIRE(effect.index == 2);
+        REQUIRE(effect.id == QStringLiteral("frei0r.glow"));
+        REQUIRE(effect.msPerFrame == 5.5);
+        REQUIRE(report.items().at(0).index == -1);
+        REQUIRE(report.items().at(1).service == QStringLiteral("avformat"));
+        REQUIRE(report.items().at(3).type == RenderProfileReport::Item::Composition);
+
+        // The samples cover the whole range, the slowest one has level 1
+        const QVariantList heatmap = report.heatmap();
+        REQUIRE(heatmap.count() == 2);
+        const QVariantMap first = heatmap.at(0).toMap();
+        const QVariantMap second = heatmap.at(1).toMap();
+        REQUIRE(first.value(QStringLiteral("x")).toInt() == 0);
+        REQUIRE(first.value(QStringLiteral("width")).toInt() == 25);
+        REQUIRE(first.value(QStringLiteral("level")).toDouble() == 0.5);
+        REQUIRE(second.value(QStringLiteral("x")).toInt() == 25);
+        REQUIRE(second.value(QStringLiteral("width")).toInt() == 75);
+        REQUIRE(second.value(QStringLiteral("level")).toDouble() == 1.);
+    }
+
+    SECTION("A report without render time has no heatmap")
+    {
+        REQUIRE(report.load(QByteArray(R"({"in": 0, "out": 10, "items": [], "samples": [{"position": 0, "ms": 0}]})")));
+        REQUIRE(report.items().isEmpty());
+        REQUIRE(report.heatmap().isEmpty());
+    }
+}
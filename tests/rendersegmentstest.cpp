@@ -0,0 +1,119 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "renderer/rendersegments.h"
+
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+namespace {
+QDomDocument renderDocument(const QString &target, const QString &extraAttributes = QString())
+{
+    QDomDocument doc;
+    doc.setContent(QStringLiteral("<mlt><profile width=\"1920\" height=\"1080\" frame_rate_num=\"25\" frame_rate_den=\"1\" progressive=\"1\"/>"
+                                  "<consumer mlt_service=\"avformat\" f=\"mp4\" vcodec=\"libx264\" in=\"0\" out=\"1499\" real_time=\"-4\" target=\"%1\" %2/></mlt>")
+                       .arg(target, extraAttributes));
+    return doc;
+}
+
+QDomElement segmentConsumer(const RenderSegment &segment)
+{
+    QDomDocument doc;
+    QFile file(segment.scenelist);
+    if (file.open(QIODevice::ReadOnly)) {
+        doc.setContent(&file, false);
+    }
+    return doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+}
+} // namespace
+
+TEST_CASE("Render segments", "[Render]")
+{
+    SECTION("Ranges are contiguous and start on a keyframe")
+    {
+        for (int gop : {1, 12, 48, 250}) {
+            const auto ranges = RenderSegments::split(10, 3009, 4, gop, 100);
+            REQUIRE(ranges.count() == 4);
+            REQUIRE(ranges.first().first == 10);
+            REQUIRE(ranges.last().second == 3009);
+            for (int i = 1; i < ranges.count(); ++i) {
+                REQUIRE(ranges.at(i).first == ranges.at(i - 1).second + 1);
+                REQUIRE((ranges.at(i).first - 10) % gop == 0);
+            }
+        }
+        REQUIRE(RenderSegments::split(0, 999, 4, 50, 100) == QVector<QPair<int, int>>({{0, 249}, {250, 499}, {500, 749}, {750, 999}}));
+        // Too short ranges are merged
+        REQUIRE(RenderSegments::split(0, 299, 8, 25, 100).count() == 3);
+        REQUIRE(RenderSegments::split(0, 49, 8, 25, 100).count() == 1);
+        REQUIRE(RenderSegments::split(10, 5, 2, 25, 1).isEmpty());
+    }
+
+    SECTION("Unsupported renders are not segmented")
+    {
+        REQUIRE(RenderSegments::unsupportedReason(renderDocument(QStringLiteral("/tmp/out-%05d.png"))) == QStringLiteral("image sequence"));
+        REQUIRE(RenderSegments::unsupportedReason(renderDocument(QStringLiteral("/tmp/out.mp4"), QStringLiteral("pass=\"2\""))) ==
+                QStringLiteral("2 pass encoding"));
+        REQUIRE(RenderSegments::unsupportedReason(renderDocument(QStringLiteral("/tmp/out.mp4"), QStringLiteral("vn=\"1\""))) ==
+                QStringLiteral("audio only render"));
+    }
+
+    SECTION("Segment scene lists")
+    {
+        QTemporaryDir folder;
+        REQUIRE(folder.isValid());
+        const QString source = folder.filePath(QStringLiteral("render.mlt"));
+        const QString target = folder.filePath(QStringLiteral("out.mp4"));
+        if (QStandardPaths::findExecutable(QStringLiteral("ffmpeg")).isEmpty()) {
+            // The segments cannot be joined
+            REQUIRE(RenderSegments::prepare(renderDocument(target), source, 3, folder.path()).isEmpty());
+            return;
+        }
+        REQUIRE(RenderSegments::prepare(renderDocument(target), source, 1, folder.path()).isEmpty());
+
+        // Without a GOP size in the render, a fixed one is set on every segment
+        QVector<RenderSegment> segments = RenderSegments::prepare(renderDocument(target), source, 3, folder.path());
+        REQUIRE(segments.count() == 4);
+        const QVector<QPair<int, int>> expected = {{0, 499}, {500, 999}, {1000, 1499}};
+        for (int i = 0; i < 3; ++i) {
+            const RenderSegment &segment = segments.at(i + 1);
+            REQUIRE_FALSE(segment.audio);
+            REQUIRE(segment.copyArguments.isEmpty());
+            REQUIRE(qMakePair(segment.in, segment.out) == expected.at(i));
+            const QDomElement consumer = segmentConsumer(segment);
+            REQUIRE(consumer.attribute(QStringLiteral("g")) == QStringLiteral("250"));
+            REQUIRE(consumer.attribute(QStringLiteral("an")) == QStringLiteral("1"));
+            REQUIRE(consumer.attribute(QStringLiteral("in")).toInt() == segment.in);
+            REQUIRE(consumer.attribute(QStringLiteral("out")).toInt() == segment.out);
+            REQUIRE(consumer.attribute(QStringLiteral("target")) == segment.target);
+            // The frame threads of the render are shared between the segments
+            REQUIRE(consumer.attribute(QStringLiteral("real_time")) == QStringLiteral("-1"));
+        }
+
+        // The audio of the whole range is encoded by a single pass, started first
+        const RenderSegment &audio = segments.first();
+        REQUIRE(audio.audio);
+        REQUIRE(audio.in == 0);
+        REQUIRE(audio.out == 1499);
+        REQUIRE(audio.target.endsWith(QStringLiteral(".mp4")));
+        const QDomElement audioConsumer = segmentConsumer(audio);
+        REQUIRE(audioConsumer.attribute(QStringLiteral("vn")) == QStringLiteral("1"));
+        REQUIRE_FALSE(audioConsumer.hasAttribute(QStringLiteral("an")));
+
+        // The segment boundaries follow the GOP size of the render
+        segments = RenderSegments::prepare(renderDocument(target, QStringLiteral("g=\"120\"")), source, 3, folder.path());
+        REQUIRE(segments.count() == 4);
+        REQUIRE(segments.at(2).in == 480);
+        REQUIRE(segments.at(3).in == 960);
+        REQUIRE(segmentConsumer(segments.at(2)).attribute(QStringLiteral("g")) == QStringLiteral("120"));
+
+        // No audio pass for a render without audio
+        segments = RenderSegments::prepare(renderDocument(target, QStringLiteral("an=\"1\"")), source, 3, folder.path());
+        REQUIRE(segments.count() == 3);
+        for (const RenderSegment &segment : qAsConst(segments)) {
+            REQUIRE_FALSE(segment.audio);
+        }
+    }
+}
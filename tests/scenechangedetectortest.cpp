@@ -0,0 +1,98 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "jobs/scenechangedetector.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+std::vector<uint8_t> grayFrame(int width, int height, uint8_t value)
+{
+    std::vector<uint8_t> pixels(size_t(4 * width * height), value);
+    for (size_t i = 3; i < pixels.size(); i += 4) {
+        pixels[i] = 255;
+    }
+    return pixels;
+}
+
+std::vector<uint8_t> squareFrame(int width, int height, int x, int size)
+{
+    std::vector<uint8_t> pixels = grayFrame(width, height, 0);
+    for (int row = 0; row < size; ++row) {
+        for (int column = x; column < x + size; ++column) {
+            uint8_t *pixel = pixels.data() + 4 * (row * width + column);
+            pixel[0] = pixel[1] = pixel[2] = 255;
+        }
+    }
+    return pixels;
+}
+} // namespace
+
+TEST_CASE("Scene change detector", "[Jobs]")
+{
+    const int width = 160;
+    const int height = 90;
+    SceneChangeDetector detector;
+
+    SECTION("Identical frames never score")
+    {
+        const std::vector<uint8_t> frame = grayFrame(width, height, 80);
+        REQUIRE(detector.process(frame.data(), width, height) == 0.);
+        for (int i = 0; i < 5; ++i) {
+            REQUIRE(detector.process(frame.data(), width, height) == 0.);
+        }
+    }
+
+    SECTION("A cut scores high")
+    {
+        const std::vector<uint8_t> black = grayFrame(width, height, 0);
+        const std::vector<uint8_t> white = grayFrame(width, height, 255);
+        detector.process(black.data(), width, height);
+        detector.process(black.data(), width, height);
+        REQUIRE(detector.process(white.data(), width, height) > 0.9);
+        // The frame after the cut is part of the new scene
+        REQUIRE(detector.process(white.data(), width, height) == 0.);
+    }
+
+    SECTION("A slow fade does not look like a cut")
+    {
+        double maxScore = 0.;
+        for (int value = 0; value <= 250; value += 2) {
+            const std::vector<uint8_t> frame = grayFrame(width, height, uint8_t(value));
+            const double score = detector.process(frame.data(), width, height);
+            if (value > 2) {
+                maxScore = std::max(maxScore, score);
+            }
+        }
+        REQUIRE(maxScore < 0.01);
+    }
+
+    SECTION("Motion does not look like a cut")
+    {
+        double maxScore = 0.;
+        for (int x = 0; x < 100; x += 2) {
+            const std::vector<uint8_t> frame = squareFrame(width, height, x, 40);
+            maxScore = std::max(maxScore, detector.process(frame.data(), width, height));
+        }
+        REQUIRE(maxScore < 0.1);
+    }
+
+    SECTION("Reset forgets the previous frame")
+    {
+        const std::vector<uint8_t> black = grayFrame(width, height, 0);
+        const std::vector<uint8_t> white = grayFrame(width, height, 255);
+        detector.process(black.data(), width, height);
+        detector.reset();
+        REQUIRE(detector.process(white.data(), width, height) == 0.);
+    }
+
+    SECTION("Invalid frames are ignored")
+    {
+        REQUIRE(detector.process(nullptr, width, height) == 0.);
+        const std::vector<uint8_t> frame = grayFrame(width, height, 80);
+        REQUIRE(detector.process(frame.data(), 0, height) == 0.);
+    }
+}
@@ -0,0 +1,114 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "jobs/scenescanner.h"
+#include "tests_definitions.h"
+
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <mlt++/MltProducer.h>
+#include <mlt++/MltProfile.h>
+
+namespace {
+/** @brief Write a scene list playing 5 frames of each color clip of the dataset */
+bool writeColorsPlaylist(QTemporaryFile &file)
+{
+    if (!file.open()) {
+        return false;
+    }
+    QTextStream stream(&file);
+    stream << "<mlt>";
+    const QStringList colors = {QStringLiteral("blue"), QStringLiteral("green"), QStringLiteral("red"), QStringLiteral("yellow")};
+    for (const QString &color : colors) {
+        stream << QStringLiteral("<producer id=\"%1\"><property name=\"resource\">%2/dataset/%1.mpg</property>"
+                                 "<property name=\"mlt_service\">avformat</property></producer>")
+                      .arg(color, sourcesPath);
+    }
+    stream << "<playlist id=\"main\">";
+    for (const QString &color : colors) {
+        stream << QStringLiteral("<entry producer=\"%1\" in=\"0\" out=\"4\"/>").arg(color);
+    }
+    stream << "</playlist></mlt>";
+    stream.flush();
+    file.close();
+    return true;
+}
+
+QVector<int> positions(const QVector<SceneScanner::Cut> &cuts)
+{
+    QVector<int> result;
+    for (const SceneScanner::Cut &cut : cuts) {
+        result << cut.position;
+    }
+    return result;
+}
+} // namespace
+
+TEST_CASE("Scene scanner", "[Jobs]")
+{
+    Mlt::Profile profile;
+    profile.set_width(256);
+    profile.set_height(144);
+    profile.set_frame_rate(25, 1);
+    profile.set_sample_aspect(1, 1);
+    profile.set_display_aspect(16, 9);
+    profile.set_progressive(1);
+    profile.set_explicit(true);
+    QTemporaryFile file(QStringLiteral("XXXXXX.mlt"));
+    REQUIRE(writeColorsPlaylist(file));
+    Mlt::Producer source(profile, "xml", file.fileName().toUtf8().constData());
+    REQUIRE(source.is_valid());
+    const int length = source.get_playtime();
+    REQUIRE(length == 20);
+    SceneScanner scanner(profile, source);
+    const QVector<int> expected = {5, 10, 15};
+
+    SECTION("Cuts are found at the clip boundaries")
+    {
+        const QVector<SceneScanner::Cut> cuts = scanner.scan(0, length - 1, 0.2, 1);
+        REQUIRE_FALSE(scanner.hasError());
+        REQUIRE(positions(cuts) == expected);
+        for (const SceneScanner::Cut &cut : cuts) {
+            REQUIRE(cut.score > 0.2);
+            REQUIRE(cut.score <= 1.);
+        }
+        // A threshold above every score finds nothing
+        REQUIRE(scanner.scan(0, length - 1, 1., 1).isEmpty());
+    }
+
+    SECTION("Concurrent chunks find the same cuts and report them in order")
+    {
+        scanner.setMinimumChunkLength(3);
+        QVector<int> reported;
+        scanner.setCutsCallback([&reported](const QVector<SceneScanner::Cut> &cuts) {
+            for (const SceneScanner::Cut &cut : cuts) {
+                reported << cut.position;
+            }
+        });
+        int progress = 0;
+        scanner.setProgressCallback([&progress](int percent) { progress = qMax(progress, percent); });
+        // With 4 chunks every chunk starts on a cut, which is found thanks to the overlap with the previous chunk
+        REQUIRE(positions(scanner.scan(0, length - 1, 0.2, 4)) == expected);
+        REQUIRE(reported == expected);
+        REQUIRE(progress == 100);
+        reported.clear();
+        REQUIRE(positions(scanner.scan(0, length - 1, 0.2, 3)) == expected);
+        REQUIRE(reported == expected);
+    }
+
+    SECTION("Scan a zone")
+    {
+        REQUIRE(positions(scanner.scan(6, 14, 0.2, 1)) == QVector<int>({10}));
+        // The first frame of the zone has no previous frame
+        REQUIRE(scanner.scan(5, 9, 0.2, 1).isEmpty());
+    }
+
+    SECTION("Canceled scan")
+    {
+        QAtomicInt canceled(1);
+        scanner.setCancelFlag(&canceled);
+        REQUIRE(scanner.scan(0, length - 1, 0.2, 2).isEmpty());
+    }
+}
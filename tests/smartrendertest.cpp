@@ -0,0 +1,120 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+
+#include "renderer/smartrender.h"
+
+namespace {
+/** @brief A timeline as written by Kdenlive in a render scene list:
+ *  0-99 a.mp4 from frame 10, 100-149 blank, 150-199 b.mp4 with a speed change, 200-249 c.mp4 which has a proxy,
+ *  with a composition from 60 to 69 and an audio track */
+const QString timeline = QStringLiteral(
+    "<mlt><profile width=\"1920\" height=\"1080\" frame_rate_num=\"25\" frame_rate_den=\"1\" progressive=\"1\"/>"
+    "<producer id=\"black_track\"><property name=\"mlt_service\">color</property><property name=\"resource\">black</property></producer>"
+    "<producer id=\"clip1\"><property name=\"mlt_service\">avformat</property><property name=\"resource\">a.mp4</property>"
+    "<property name=\"video_index\">0</property><filter><property name=\"mlt_service\">volume</property></filter></producer>"
+    "<chain id=\"clip2\"><property name=\"mlt_service\">avformat-novalidate</property><property name=\"resource\">b.mp4</property>"
+    "<link><property name=\"mlt_service\">timeremap</property></link></chain>"
+    "<producer id=\"clip3\"><property name=\"mlt_service\">avformat</property><property name=\"resource\">c.mp4</property>"
+    "<property name=\"kdenlive:proxy\">proxy/c.mkv</property></producer>"
+    "<playlist id=\"playlist0\"><entry producer=\"clip1\" in=\"10\" out=\"109\"/><blank length=\"50\"/>"
+    "<entry producer=\"clip2\" in=\"0\" out=\"49\"/><entry producer=\"clip3\" in=\"0\" out=\"49\"/></playlist>"
+    "<tractor id=\"track1\"><multitrack><track producer=\"playlist0\"/></multitrack></tractor>"
+    "<playlist id=\"playlist1\"><entry producer=\"clip1\" in=\"0\" out=\"249\"/></playlist>"
+    "<tractor id=\"track2\"><multitrack><track producer=\"playlist1\"/></multitrack></tractor>"
+    "<tractor id=\"maintractor\"><multitrack><track producer=\"black_track\"/><track producer=\"track2\" hide=\"video\"/><track producer=\"track1\"/></multitrack>"
+    "<transition in=\"60\" out=\"69\"><property name=\"mlt_service\">qtblend</property></transition>"
+    "<transition><property name=\"mlt_service\">qtblend</property><property name=\"internal_added\">237</property></transition>"
+    "</tractor></mlt>");
+
+SourceSpan span(SourceSpan::Kind kind, int in, int out, const QString &resource = QString(), int stream = -1, int sourceIn = 0)
+{
+    return SourceSpan{kind, in, out, resource, stream, sourceIn};
+}
+
+bool sameSpans(const QVector<SourceSpan> &spans, const QVector<SourceSpan> &expected)
+{
+    if (spans.count() != expected.count()) {
+        return false;
+    }
+    for (int i = 0; i < spans.count(); ++i) {
+        const SourceSpan &a = spans.at(i);
+        const SourceSpan &b = expected.at(i);
+        if (a.kind != b.kind || a.in != b.in || a.out != b.out) {
+            return false;
+        }
+        if (a.kind == SourceSpan::Source && (a.resource != b.resource || a.stream != b.stream || a.sourceIn != b.sourceIn)) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+TEST_CASE("Smart render", "[Render]")
+{
+    QDomDocument doc;
+    doc.setContent(timeline);
+    const QString root = QStringLiteral("/tmp/project");
+    const QString a = QStringLiteral("/tmp/project/a.mp4");
+    const QString c = QStringLiteral("/tmp/project/c.mp4");
+
+    SECTION("Blanks, compositions, speed changes and proxies")
+    {
+        // Audio filters, the automatic track compositing, the background and the audio tracks do not change the image.
+        // The original clip is rendered in place of its proxy
+        const QVector<SourceSpan> expected = {span(SourceSpan::Source, 0, 59, a, 0, 10),   span(SourceSpan::Rendered, 60, 69),
+                                              span(SourceSpan::Source, 70, 99, a, 0, 80),  span(SourceSpan::Blank, 100, 149),
+                                              span(SourceSpan::Rendered, 150, 199), span(SourceSpan::Source, 200, 249, c, -1, 0)};
+        REQUIRE(sameSpans(SmartRender::sourceSpans(doc, 0, 249, root), expected));
+    }
+
+    SECTION("Zone")
+    {
+        const QVector<SourceSpan> expected = {span(SourceSpan::Source, 30, 59, a, 0, 40), span(SourceSpan::Rendered, 60, 69),
+                                              span(SourceSpan::Source, 70, 99, a, 0, 80), span(SourceSpan::Blank, 100, 119)};
+        REQUIRE(sameSpans(SmartRender::sourceSpans(doc, 30, 119, root), expected));
+    }
+
+    SECTION("Track effect")
+    {
+        QDomElement track = doc.documentElement().firstChildElement(QStringLiteral("tractor"));
+        while (track.attribute(QStringLiteral("id")) != QLatin1String("track1")) {
+            track = track.nextSiblingElement(QStringLiteral("tractor"));
+        }
+        QDomElement filter = doc.createElement(QStringLiteral("filter"));
+        QDomElement service = doc.createElement(QStringLiteral("property"));
+        service.setAttribute(QStringLiteral("name"), QStringLiteral("mlt_service"));
+        service.appendChild(doc.createTextNode(QStringLiteral("avfilter.eq")));
+        filter.appendChild(service);
+        track.appendChild(filter);
+        const QVector<SourceSpan> expected = {span(SourceSpan::Rendered, 0, 249)};
+        REQUIRE(sameSpans(SmartRender::sourceSpans(doc, 0, 249, root), expected));
+
+        // A disabled effect is ignored
+        QDomElement disable = doc.createElement(QStringLiteral("property"));
+        disable.setAttribute(QStringLiteral("name"), QStringLiteral("disable"));
+        disable.appendChild(doc.createTextNode(QStringLiteral("1")));
+        filter.appendChild(disable);
+        REQUIRE(SmartRender::sourceSpans(doc, 0, 249, root).count() == 6);
+    }
+
+    SECTION("Only closed groups of pictures can be copied")
+    {
+        // Closed GOPs: the pictures decoded after a keyframe are displayed after it
+        const QByteArray closed = "0.000000,K__\n0.120000,___\n0.040000,___\n0.080000,___\n"
+                                  "0.160000,K__\n0.280000,___\n0.200000,___\n0.240000,___\n";
+        QMap<int, QString> keys = SmartRender::closedKeyframes(closed, 0., 25.);
+        REQUIRE(keys.keys() == QList<int>({0, 4}));
+        REQUIRE(keys.value(4) == QStringLiteral("0.160000"));
+        // The second keyframe opens an open GOP, its leading pictures are displayed before it
+        const QByteArray open = "0.000000,K__\n0.120000,___\n0.040000,___\n0.080000,___\n"
+                                "0.240000,K__\n0.160000,___\n0.200000,___\n0.360000,___\n0.280000,___\n0.320000,___\n";
+        keys = SmartRender::closedKeyframes(open, 0., 25.);
+        REQUIRE(keys.keys() == QList<int>({0}));
+        // The frame numbers are counted from the start time of the stream
+        keys = SmartRender::closedKeyframes("1.400000,K_\nN/A,__\n", 1., 25.);
+        REQUIRE(keys.keys() == QList<int>({10}));
+    }
+}
@@ -0,0 +1,188 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "doc/docundostack.hpp"
+#include "doc/kdenlivedoc.h"
+#include "test_utils.hpp"
+
+#include "definitions.h"
+#define private public
+#define protected public
+#include "core.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+/* Timing of common timeline model operations on a large synthetic project.
+ * This is not run by ctest, launch the timelinebenchmark executable manually.
+ * KDENLIVE_BENCHMARK_CLIPS sets the number of clips (default 2000), results are written
+ * as json to the file given by KDENLIVE_BENCHMARK_OUTPUT (default timelinebenchmark.json) */
+
+namespace {
+class BenchmarkReport
+{
+public:
+    explicit BenchmarkReport(int clipCount)
+        : m_clipCount(clipCount)
+    {
+    }
+
+    template <typename F> void measure(const QString &name, int iterations, F &&operation)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        operation();
+        const qint64 elapsed = timer.nsecsElapsed();
+        QJsonObject entry;
+        entry.insert(QStringLiteral("name"), name);
+        entry.insert(QStringLiteral("iterations"), iterations);
+        entry.insert(QStringLiteral("total_ns"), elapsed);
+        entry.insert(QStringLiteral("ns_per_iteration"), elapsed / qMax(1, iterations));
+        m_results.append(entry);
+        qDebug().noquote() << QStringLiteral("%1: %2 ms for %3 iterations").arg(name).arg(elapsed / 1000000.).arg(iterations);
+    }
+
+    bool write() const
+    {
+        QJsonObject root;
+        root.insert(QStringLiteral("clips"), m_clipCount);
+        root.insert(QStringLiteral("date"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+        root.insert(QStringLiteral("results"), m_results);
+        QFile file(qEnvironmentVariable("KDENLIVE_BENCHMARK_OUTPUT", QStringLiteral("timelinebenchmark.json")));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+        return file.write(QJsonDocument(root).toJson()) > 0;
+    }
+
+private:
+    int m_clipCount;
+    QJsonArray m_results;
+};
+} // namespace
+
+TEST_CASE("Timeline model operations", "[Benchmark]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    undoStack->setUndoLimit(0);
+
+    KdenliveDoc document(undoStack, {4, 8});
+    pCore->projectManager()->m_project = &document;
+    QDateTime documentDate = QDateTime::currentDateTime();
+    pCore->projectManager()->updateTimeline(0, false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->m_activeTimelineModel = timeline;
+    pCore->projectManager()->testSetActiveDocument(&document, timeline);
+
+    bool ok = false;
+    int clipCount = qEnvironmentVariableIntValue("KDENLIVE_BENCHMARK_CLIPS", &ok);
+    if (!ok || clipCount < 2) {
+        clipCount = 2000;
+    }
+    BenchmarkReport report(clipCount);
+
+    const int length = 20;
+    QString binId = createProducer(*timeline->getProfile(), "red", binModel, length);
+    std::vector<int> videoTracks;
+    for (int i = 0; i < timeline->getTracksCount(); ++i) {
+        int tid = timeline->getTrackIndexFromPosition(i);
+        if (!timeline->isAudioTrack(tid)) {
+            videoTracks.push_back(tid);
+        }
+    }
+    REQUIRE(!videoTracks.empty());
+    const int tracksCount = int(videoTracks.size());
+
+    std::vector<int> clips;
+    clips.reserve(size_t(clipCount));
+    report.measure(QStringLiteral("clip_insertion"), clipCount, [&]() {
+        for (int i = 0; i < clipCount; ++i) {
+            int cid = -1;
+            // Leave a small gap between clips so that spacer operations have something to work on
+            REQUIRE(timeline->requestClipInsertion(binId, videoTracks[size_t(i % tracksCount)], (i / tracksCount) * (length + 5), cid));
+            clips.push_back(cid);
+        }
+    });
+    REQUIRE(timeline->getClipsCount() == clipCount);
+    const int timelineLength = (clipCount / tracksCount + 1) * (length + 5);
+
+    const int snapQueries = 1000;
+    report.measure(QStringLiteral("snap_query"), snapQueries, [&]() {
+        for (int i = 0; i < snapQueries; ++i) {
+            timeline->suggestSnapPoint((i * 7919) % timelineLength, 10);
+        }
+    });
+
+    const int spacerOperations = 10;
+    report.measure(QStringLiteral("spacer"), spacerOperations, [&]() {
+        for (int i = 0; i < spacerOperations; ++i) {
+            std::pair<int, int> spacerOp = TimelineFunctions::requestSpacerStartOperation(timeline, videoTracks.front(), timelineLength / 2);
+            int cid = spacerOp.first;
+            REQUIRE(cid > -1);
+            Fun undo = []() { return true; };
+            Fun redo = []() { return true; };
+            int start = timeline->getItemPosition(cid);
+            REQUIRE(TimelineFunctions::requestSpacerEndOperation(timeline, cid, start, start + 2, videoTracks.front(), -1, undo, redo));
+        }
+    });
+
+    const int cutOperations = 10;
+    report.measure(QStringLiteral("cut_all"), cutOperations, [&]() {
+        for (int i = 0; i < cutOperations; ++i) {
+            // Cut in the middle of a clip column
+            TimelineFunctions::requestClipCutAll(timeline, i * (length + 5) + length / 2);
+        }
+    });
+
+    // Build a binary tree of groups over all the original clips
+    int rootGroup = -1;
+    std::vector<int> level = clips;
+    report.measure(QStringLiteral("deep_grouping"), clipCount - 1, [&]() {
+        while (level.size() > 1) {
+            std::vector<int> nextLevel;
+            for (size_t j = 0; j < level.size(); j += 2) {
+                if (j + 1 < level.size()) {
+                    int gid = timeline->requestClipsGroup({level[j], level[j + 1]});
+                    REQUIRE(gid > -1);
+                    nextLevel.push_back(gid);
+                } else {
+                    nextLevel.push_back(level[j]);
+                }
+            }
+            level = nextLevel;
+        }
+        rootGroup = level.front();
+    });
+
+    const int groupMoves = 10;
+    report.measure(QStringLiteral("group_move"), groupMoves, [&]() {
+        for (int i = 0; i < groupMoves; ++i) {
+            REQUIRE(timeline->requestGroupMove(clips.front(), rootGroup, 0, (i % 2 == 0) ? 50 : -50));
+        }
+    });
+
+    const int undoSteps = undoStack->count();
+    report.measure(QStringLiteral("undo_all"), undoSteps, [&]() {
+        while (undoStack->canUndo()) {
+            undoStack->undo();
+        }
+    });
+    REQUIRE(timeline->getClipsCount() == 0);
+
+    report.measure(QStringLiteral("redo_all"), undoSteps, [&]() {
+        while (undoStack->canRedo()) {
+            undoStack->redo();
+        }
+    });
+    REQUIRE(timeline->getClipsCount() >= clipCount);
+
+    REQUIRE(report.write());
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
@@ -0,0 +1,88 @@
+/*
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "doc/docundostack.hpp"
+#include "undohelper.hpp"
+
+TEST_CASE("Undo history memory budget", "[UndoStack]")
+{
+    DocUndoStack stack(nullptr);
+    stack.setMemoryBudget(0);
+    int value = 0;
+    auto pushStep = [&](qint64 capturedData) {
+        int previous = value;
+        value++;
+        int current = value;
+        Fun undo = [&value, previous]() {
+            value = previous;
+            return true;
+        };
+        Fun redo = [&value, current]() {
+            value = current;
+            return true;
+        };
+        FunctionalUndoCommand::reportMemoryCost(capturedData);
+        stack.push(new FunctionalUndoCommand(undo, redo, QString()));
+    };
+    const qint64 baseCost = FunctionalUndoCommand([]() { return true; }, []() { return true; }, QString()).memoryCost();
+
+    SECTION("Reported costs are tracked")
+    {
+        pushStep(0);
+        REQUIRE(stack.memoryUsage() == baseCost);
+        pushStep(100000);
+        REQUIRE(stack.memoryUsage() == 2 * baseCost + 100000);
+        // The reported cost is only charged once
+        pushStep(0);
+        REQUIRE(stack.memoryUsage() == 3 * baseCost + 100000);
+        // Steps that could be redone are deleted by a new step
+        stack.undo();
+        stack.undo();
+        pushStep(0);
+        REQUIRE(stack.count() == 2);
+        REQUIRE(stack.memoryUsage() == 2 * baseCost);
+        stack.clear();
+        REQUIRE(stack.memoryUsage() == 0);
+    }
+
+    SECTION("No limit keeps the full history")
+    {
+        for (int i = 0; i < 5; ++i) {
+            pushStep(100000);
+        }
+        REQUIRE(stack.count() == 5);
+        while (stack.canUndo()) {
+            stack.undo();
+        }
+        REQUIRE(value == 0);
+    }
+
+    SECTION("Oldest steps are discarded when exceeding the budget")
+    {
+        stack.setMemoryBudget(3 * (baseCost + 100000));
+        for (int i = 0; i < 5; ++i) {
+            pushStep(100000);
+        }
+        REQUIRE(value == 5);
+        REQUIRE(stack.memoryUsage() == 3 * (baseCost + 100000));
+        // Small steps do not use much of the budget
+        for (int i = 0; i < 5; ++i) {
+            pushStep(0);
+        }
+        REQUIRE(value == 10);
+        REQUIRE(stack.memoryUsage() <= 3 * (baseCost + 100000));
+        while (stack.canUndo()) {
+            stack.undo();
+        }
+        // The 2 most recent large steps and the small ones could be undone, the discarded ones were dropped
+        REQUIRE(value == 3);
+        REQUIRE(stack.count() == 7);
+        while (stack.canRedo()) {
+            stack.redo();
+        }
+        REQUIRE(value == 10);
+    }
+}